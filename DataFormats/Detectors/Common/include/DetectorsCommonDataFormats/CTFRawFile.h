@@ -0,0 +1,144 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file CTFRawFile.h
+/// \brief Non-ROOT container for the CTFs: flat EncodedBlocks images followed by an index footer
+
+#ifndef ALICEO2_CTF_RAWFILE_H
+#define ALICEO2_CTF_RAWFILE_H
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <gsl/span>
+#include "DetectorsCommonDataFormats/DetID.h"
+#include "DetectorsCommonDataFormats/CTFHeader.h"
+
+namespace o2
+{
+namespace ctf
+{
+
+/// Layout of the raw CTF file:
+/// FileHeader | payloads of the TF 0 | payloads of the TF 1 | ... | TFEntry[nTFs] | Trailer
+/// Every payload is the flat (relocatable) EncodedBlocks image of a detector, as produced by the
+/// entropy encoders, starting at an offset aligned to Alignment bytes. The index (TFEntry array)
+/// is located via the Trailer at the end of the file, so that the file can be written in one pass.
+struct CTFRawFile {
+  static constexpr uint64_t Magic = 0x574152465443324f; // "O2CTFRAW" read as little-endian
+  static constexpr uint32_t Version = 1;
+  static constexpr size_t Alignment = 16;
+  static constexpr std::string_view FileExtension = ".ctf";
+
+  struct FileHeader {
+    uint64_t magic = Magic;
+    uint32_t version = Version;
+    uint32_t nDetectors = o2::detectors::DetID::nDetectors;
+  };
+
+  struct Payload {
+    uint64_t offset = 0; // from the start of the file
+    uint64_t size = 0;   // in bytes, 0 if the detector is absent
+  };
+
+  struct TFEntry {
+    uint64_t run = 0;
+    uint64_t creationTime = 0;
+    uint32_t firstTForbit = 0;
+    uint32_t tfCounter = 0;
+    uint64_t detectors = 0; // mask of the stored detectors
+    uint64_t begin = 0;     // offset of the 1st byte of the TF payloads
+    uint64_t end = 0;       // offset after the last byte of the TF payloads
+    std::array<Payload, o2::detectors::DetID::nDetectors> payloads{};
+  };
+
+  struct Trailer {
+    uint64_t indexOffset = 0;
+    uint64_t nTFs = 0;
+    uint64_t magic = Magic;
+  };
+
+  static size_t alignSize(size_t sz) { return (sz + Alignment - 1) / Alignment * Alignment; }
+  /// check if the file name corresponds to the raw CTF file
+  static bool isRawFile(const std::string& name);
+};
+
+/// Writes the CTFs to the raw file: the payloads are added as they come, the index is written by close()
+class CTFRawFileWriter
+{
+ public:
+  CTFRawFileWriter() = default;
+  ~CTFRawFileWriter();
+  CTFRawFileWriter(const CTFRawFileWriter&) = delete;
+  CTFRawFileWriter& operator=(const CTFRawFileWriter&) = delete;
+
+  void open(const std::string& name);
+  void close();
+  bool isOpen() const { return mFile.is_open(); }
+
+  /// add the flat EncodedBlocks image of the detector to the current TF, return the number of bytes written
+  size_t addDetector(o2::detectors::DetID det, const void* data, size_t size);
+  /// finish the current TF with its header, return the number of bytes it will take in the index
+  size_t addTF(const CTFHeader& header);
+
+  size_t getNTFs() const { return mIndex.size(); }
+  size_t getSize() const { return mOffset; }
+
+ private:
+  void write(const void* data, size_t size);
+
+  std::ofstream mFile;
+  std::string mName;
+  std::vector<CTFRawFile::TFEntry> mIndex;
+  CTFRawFile::TFEntry mCurrent{};
+  uint64_t mOffset = 0;
+};
+
+/// Maps the raw CTF file to memory, the payloads are accessed directly from the mapped pages
+class CTFRawFileReader
+{
+ public:
+  CTFRawFileReader() = default;
+  ~CTFRawFileReader() { close(); }
+  CTFRawFileReader(const CTFRawFileReader&) = delete;
+  CTFRawFileReader& operator=(const CTFRawFileReader&) = delete;
+
+  void open(const std::string& name);
+  void close();
+  bool isOpen() const { return mData != nullptr; }
+  const std::string& getName() const { return mName; }
+
+  size_t getNTFs() const { return mIndex.size(); }
+  CTFHeader getHeader(size_t tf) const;
+  /// image of the detector in the TF, empty if the detector is absent
+  gsl::span<const uint8_t> getDetector(size_t tf, o2::detectors::DetID det) const;
+
+  /// ask the kernel to read ahead the pages of the TF
+  void prefetch(size_t tf) const;
+  /// tell the kernel that the pages of the TF are not needed anymore
+  void release(size_t tf) const;
+
+ private:
+  void advise(size_t tf, int advice) const;
+
+  std::string mName;
+  const uint8_t* mData = nullptr;
+  size_t mSize = 0;
+  gsl::span<const CTFRawFile::TFEntry> mIndex;
+};
+
+} // namespace ctf
+} // namespace o2
+
+#endif
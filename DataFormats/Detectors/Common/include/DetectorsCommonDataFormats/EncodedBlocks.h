@@ -20,6 +20,8 @@
 // #include <cassert>
 #include <type_traits>
 #include <cstddef>
+#include <limits>
+#include <vector>
 #include <Rtypes.h>
 #include <any>
 
@@ -66,17 +68,26 @@ inline constexpr bool is_iterator_v = is_iterator<T>::value;
 
 inline constexpr bool mayEEncode(Metadata::OptStore opt) noexcept
 {
-  return (opt == Metadata::OptStore::EENCODE) || (opt == Metadata::OptStore::EENCODE_OR_PACK);
+  return (opt == Metadata::OptStore::EENCODE) || (opt == Metadata::OptStore::EENCODE_OR_PACK) || (opt == Metadata::OptStore::ADAPTIVE);
 }
 
 inline constexpr bool mayPack(Metadata::OptStore opt) noexcept
 {
-  return (opt == Metadata::OptStore::PACK) || (opt == Metadata::OptStore::EENCODE_OR_PACK);
+  return (opt == Metadata::OptStore::PACK) || (opt == Metadata::OptStore::EENCODE_OR_PACK) || (opt == Metadata::OptStore::ADAPTIVE);
 }
 
+/// can the delta and run-length codecs of the ADAPTIVE option be applied to this type
+template <typename T>
+inline constexpr bool isAdaptiveCodable_v = std::is_integral_v<T> && !std::is_same_v<T, bool> && (sizeof(T) <= 4);
+
 } // namespace detail
 constexpr size_t PackingThreshold = 512;
 
+// The codec of an ADAPTIVE block is chosen from at most AdaptiveSampleSize samples, taken in AdaptiveSampleChunks
+// contiguous chunks spread over the block, so that the cost of the choice does not grow with the block size
+constexpr size_t AdaptiveSampleSize = 1 << 16;
+constexpr size_t AdaptiveSampleChunks = 16;
+
 constexpr size_t Alignment = 16;
 
 constexpr int WrappersSplitLevel = 99;
@@ -450,6 +461,11 @@ class EncodedBlocks
   template <typename VD>
   static auto create(VD& v);
 
+  /// create container from vector, in which only the given slot will be encoded, to be copied to the
+  /// same slot of another container with copyBlock. This allows to encode the slots concurrently.
+  template <typename VD>
+  static auto createForSlot(VD& v, int slot, const ANSHeader& ansHeader);
+
   /// estimate free size needed to add new block
   static size_t estimateBlockSize(int n) { return Block<W>::estimateSize(n); }
 
@@ -503,6 +519,10 @@ class EncodedBlocks
   template <typename input_IT, typename buffer_T>
   o2::ctf::CTFIOSize encode(const input_IT srcBegin, const input_IT srcEnd, int slot, uint8_t symbolTablePrecision, Metadata::OptStore opt, buffer_T* buffer = nullptr, const std::any& encoderExt = {}, float memfc = 1.f);
 
+  /// fill the block at provided slot with a copy of the same slot of a container created by createForSlot
+  template <typename buffer_T>
+  void copyBlock(const EncodedBlocks& src, int slot, buffer_T* buffer);
+
   /// decode block at provided slot to destination vector (will be resized as needed)
   template <class container_T, class container_IT = typename container_T::iterator>
   o2::ctf::CTFIOSize decode(container_T& dest, int slot, const std::any& decoderExt = {}) const;
@@ -630,6 +650,19 @@ class EncodedBlocks
   template <typename input_IT, typename buffer_T>
   o2::ctf::CTFIOSize store(const input_IT srcBegin, const input_IT srcEnd, int slot, Metadata::OptStore opt, buffer_T* buffer = nullptr);
 
+  /// choose the codec of the ADAPTIVE block giving the smallest estimated size on a sample of the data
+  template <typename input_IT>
+  static Metadata::OptStore selectCodec(const input_IT srcBegin, const input_IT srcEnd);
+
+  template <typename input_IT, typename buffer_T>
+  o2::ctf::CTFIOSize encodeAdaptive(const input_IT srcBegin, const input_IT srcEnd, int slot, buffer_T* buffer = nullptr, double_t sizeEstimateSafetyFactor = 1);
+
+  template <typename input_IT, typename buffer_T>
+  o2::ctf::CTFIOSize encodeDelta(const input_IT srcBegin, const input_IT srcEnd, int slot, buffer_T* buffer = nullptr, double_t sizeEstimateSafetyFactor = 1);
+
+  template <typename input_IT, typename buffer_T>
+  o2::ctf::CTFIOSize encodeRLE(const input_IT srcBegin, const input_IT srcEnd, int slot, buffer_T* buffer = nullptr);
+
   // decode
   template <typename dst_IT>
   CTFIOSize decodeCompatImpl(dst_IT dest, int slot, const std::any& decoderExt) const;
@@ -643,6 +676,12 @@ class EncodedBlocks
   template <typename dst_IT>
   CTFIOSize decodeCopyImpl(dst_IT dest, int slot) const;
 
+  template <typename dst_IT>
+  CTFIOSize decodeDeltaImpl(dst_IT dest, int slot) const;
+
+  template <typename dst_IT>
+  CTFIOSize decodeRLEImpl(dst_IT dest, int slot) const;
+
   ClassDefNV(EncodedBlocks, 3);
 }; // namespace ctf
 
@@ -878,6 +917,39 @@ inline auto EncodedBlocks<H, N, W>::create(VD& v)
   return create(v.data(), v.size() * vsz);
 }
 
+///_____________________________________________________________________________
+/// create container from vector, with all the slots before the given one marked as filled
+template <typename H, int N, typename W>
+template <typename VD>
+inline auto EncodedBlocks<H, N, W>::createForSlot(VD& v, int slot, const ANSHeader& ansHeader)
+{
+  auto b = create(v);
+  b->mRegistry.nFilledBlocks = slot;
+  b->setANSHeader(ansHeader);
+  return b;
+}
+
+///_____________________________________________________________________________
+/// copy the block and metadata of a slot encoded separately
+template <typename H, int N, typename W>
+template <typename buffer_T>
+void EncodedBlocks<H, N, W>::copyBlock(const EncodedBlocks& src, int slot, buffer_T* buffer)
+{
+  assert(slot == mRegistry.nFilledBlocks);
+  assert(src.mRegistry.nFilledBlocks == slot + 1);
+  mRegistry.nFilledBlocks++;
+  const auto& srcBlock = src.mBlocks[slot];
+  const auto& srcMetadata = src.mMetadata[slot];
+  if (srcMetadata.opt == Metadata::OptStore::NODATA) {
+    mMetadata[slot] = srcMetadata; // empty source message, the block is not touched
+    return;
+  }
+  // after expansion this is not valid anymore
+  auto [thisBlock, thisMetadata] = expandStorage(slot, srcBlock.getNStored(), buffer);
+  thisBlock->store(srcBlock.getNDict(), srcBlock.getNData(), srcBlock.getNLiterals(), srcBlock.getDict(), srcBlock.getData(), srcBlock.getLiterals());
+  *thisMetadata = srcMetadata;
+}
+
 ///_____________________________________________________________________________
 /// print itself
 template <typename H, int N, typename W>
@@ -942,11 +1014,16 @@ CTFIOSize EncodedBlocks<H, N, W>::decode(D_IT dest,                        // it
     if (md.opt == Metadata::OptStore::PACK) {
       return decodeUnpackImpl(dest, slot);
     }
+    if (md.opt == Metadata::OptStore::RLE) { // a single run is fully described by the metadata
+      return decodeRLEImpl(dest, slot);
+    }
     if (!block.getNStored()) {
       return {0, md.getUncompressedSize(), md.getCompressedSize()};
     }
     if (md.opt == Metadata::OptStore::EENCODE) {
       return decodeRansV1Impl(dest, slot, decoderExt);
+    } else if (md.opt == Metadata::OptStore::DELTA_EENCODE) {
+      return decodeDeltaImpl(dest, slot);
     } else {
       return decodeCopyImpl(dest, slot);
     }
@@ -1101,6 +1178,58 @@ CTFIOSize EncodedBlocks<H, N, W>::decodeCopyImpl(dst_IT dest, int slot) const
   return {0, md.getUncompressedSize(), md.getCompressedSize()};
 };
 
+template <typename H, int N, typename W>
+template <typename dst_IT>
+CTFIOSize EncodedBlocks<H, N, W>::decodeDeltaImpl(dst_IT dest, int slot) const
+{
+  using dest_t = typename std::iterator_traits<dst_IT>::value_type;
+  const auto& md = mMetadata[slot];
+
+  if constexpr (!detail::isAdaptiveCodable_v<dest_t>) {
+    throw std::runtime_error(fmt::format("delta encoded slot {} cannot be decoded to the requested type", slot));
+  } else {
+    using delta_t = std::make_signed_t<dest_t>;
+    using udelta_t = std::make_unsigned_t<dest_t>;
+
+    std::vector<delta_t> deltas(md.messageLength);
+    decodeRansV1Impl(deltas.data(), slot, {});
+    udelta_t value = 0;
+    for (const auto delta : deltas) {
+      value += static_cast<udelta_t>(delta);
+      *dest++ = static_cast<dest_t>(value);
+    }
+  }
+  return {0, md.getUncompressedSize(), md.getCompressedSize()};
+};
+
+template <typename H, int N, typename W>
+template <typename dst_IT>
+CTFIOSize EncodedBlocks<H, N, W>::decodeRLEImpl(dst_IT dest, int slot) const
+{
+  using dest_t = typename std::iterator_traits<dst_IT>::value_type;
+  using run_t = uint32_t;
+
+  const auto& block = mBlocks[slot];
+  const auto& md = mMetadata[slot];
+
+  // the number of runs is stored as the number of literals, the values as data and the run lengths as literals
+  const size_t nRuns = md.nLiterals;
+  std::vector<dest_t> values(nRuns, static_cast<dest_t>(md.min));
+  std::vector<run_t> runs(nRuns, static_cast<run_t>(md.literalsPackingOffset));
+  if (md.probabilityBits) {
+    rans::unpack(block.getData(), nRuns, values.data(), md.probabilityBits, static_cast<dest_t>(md.min));
+  }
+  if (md.literalsPackingWidth) {
+    rans::unpack(block.getLiterals(), nRuns, runs.data(), md.literalsPackingWidth, static_cast<run_t>(md.literalsPackingOffset));
+  }
+  for (size_t ir = 0; ir < nRuns; ir++) {
+    for (run_t i = 0; i < runs[ir]; i++) {
+      *dest++ = values[ir];
+    }
+  }
+  return {0, md.getUncompressedSize(), md.getCompressedSize()};
+};
+
 ///_____________________________________________________________________________
 template <typename H, int N, typename W>
 template <typename input_IT, typename buffer_T>
@@ -1284,6 +1413,8 @@ o2::ctf::CTFIOSize EncodedBlocks<H, N, W>::entropyCodeRANSV1(const input_IT srcB
 
     if (encoderExt.has_value()) {
       encoderStatistics = encodeRANSV1External(srcBegin, srcEnd, slot, encoderExt, buffer, memfc);
+    } else if (opt == Metadata::OptStore::ADAPTIVE) {
+      encoderStatistics = encodeAdaptive(srcBegin, srcEnd, slot, buffer, memfc);
     } else {
       encoderStatistics = encodeRANSV1Inplace(srcBegin, srcEnd, slot, opt, buffer, memfc);
     }
@@ -1516,6 +1647,194 @@ o2::ctf::CTFIOSize EncodedBlocks<H, N, W>::store(const input_IT srcBegin, const
   return {0, thisMetadata->getUncompressedSize(), thisMetadata->getCompressedSize()};
 };
 
+template <typename H, int N, typename W>
+template <typename input_IT>
+Metadata::OptStore EncodedBlocks<H, N, W>::selectCodec(const input_IT srcBegin, const input_IT srcEnd)
+{
+  using input_t = typename std::iterator_traits<input_IT>::value_type;
+
+  if constexpr (!detail::isAdaptiveCodable_v<input_t>) {
+    return Metadata::OptStore::EENCODE_OR_PACK;
+  } else {
+    using delta_t = std::make_signed_t<input_t>;
+    using udelta_t = std::make_unsigned_t<input_t>;
+
+    const size_t messageLength = std::distance(srcBegin, srcEnd);
+    const size_t nChunks = messageLength > AdaptiveSampleSize ? AdaptiveSampleChunks : 1;
+    const size_t chunkSize = std::min(messageLength, AdaptiveSampleSize) / nChunks;
+
+    // collect the samples, their differences and the statistics of the runs, within each chunk
+    std::vector<input_t> samples;
+    std::vector<delta_t> deltas;
+    samples.reserve(nChunks * chunkSize);
+    deltas.reserve(nChunks * chunkSize);
+    size_t nRuns = 0;
+    size_t minRun = messageLength, maxRun = 0;
+    for (size_t ic = 0; ic < nChunks; ic++) {
+      auto it = std::next(srcBegin, ic * (messageLength / nChunks));
+      size_t run = 0;
+      bool truncatedRun = true; // the 1st and the last runs of the chunk may be truncated
+      for (size_t is = 0; is < chunkSize; is++, ++it) {
+        const input_t value = *it;
+        if (is > 0) {
+          const input_t prev = samples.back();
+          deltas.push_back(static_cast<delta_t>(static_cast<udelta_t>(static_cast<udelta_t>(value) - static_cast<udelta_t>(prev))));
+          if (value == prev) {
+            run++;
+            samples.push_back(value);
+            continue;
+          }
+          if (!truncatedRun) {
+            minRun = std::min(minRun, run);
+          }
+          maxRun = std::max(maxRun, run);
+          truncatedRun = false;
+        }
+        nRuns++;
+        run = 1;
+        samples.push_back(value);
+      }
+      maxRun = std::max(maxRun, run);
+    }
+    minRun = std::min(minRun, maxRun);
+
+    // estimated sizes in bytes, extrapolated from the sample to the full block
+    const double scale = static_cast<double>(messageLength) / samples.size();
+    auto entropyCodedSize = [scale](const auto& metrics) -> double {
+      const rans::SizeEstimate sizeEstimate = metrics.getSizeEstimate();
+      return scale * (sizeEstimate.getCompressedDatasetSize(1.) + sizeEstimate.getIncompressibleSize(1.)) + sizeEstimate.getCompressedDictionarySize(1.);
+    };
+
+    Metadata::OptStore codec = Metadata::OptStore::EENCODE;
+    double codecSize = std::numeric_limits<double>::max();
+    auto consider = [&codec, &codecSize](Metadata::OptStore opt, double size) {
+      if (size < codecSize) {
+        codec = opt;
+        codecSize = size;
+      }
+    };
+
+    // in case of equal sizes the codec which decodes faster wins
+    const auto [minIter, maxIter] = std::minmax_element(samples.begin(), samples.end());
+    const size_t valueBits = rans::utils::getRangeBits(*minIter, *maxIter);
+    consider(Metadata::OptStore::PACK, scale * samples.size() * valueBits / 8.);
+    try {
+      consider(Metadata::OptStore::EENCODE, entropyCodedSize(internal::InplaceEntropyCoder<input_t>{samples.data(), samples.data() + samples.size()}.getMetrics()));
+    } catch (const rans::HistogramError& error) {
+      LOGP(debug, "No rANS estimate for the adaptive codec: {}", error.what());
+    }
+    consider(Metadata::OptStore::RLE, scale * nRuns * (valueBits + rans::utils::getRangeBits(minRun, maxRun)) / 8.);
+    if (!deltas.empty()) {
+      try {
+        consider(Metadata::OptStore::DELTA_EENCODE, entropyCodedSize(internal::InplaceEntropyCoder<delta_t>{deltas.data(), deltas.data() + deltas.size()}.getMetrics()));
+      } catch (const rans::HistogramError& error) {
+        LOGP(debug, "No delta rANS estimate for the adaptive codec: {}", error.what());
+      }
+    }
+    LOGP(debug, "Adaptive codec {} with estimated size {} B for {} samples", (int)codec, codecSize, messageLength);
+    return codec;
+  }
+};
+
+template <typename H, int N, typename W>
+template <typename input_IT, typename buffer_T>
+o2::ctf::CTFIOSize EncodedBlocks<H, N, W>::encodeAdaptive(const input_IT srcBegin, const input_IT srcEnd, int slot, buffer_T* buffer, double_t sizeEstimateSafetyFactor)
+{
+  const auto codec = selectCodec(srcBegin, srcEnd);
+  if (codec == Metadata::OptStore::PACK) {
+    return pack(srcBegin, srcEnd, slot, buffer);
+  } else if (codec == Metadata::OptStore::DELTA_EENCODE) {
+    return encodeDelta(srcBegin, srcEnd, slot, buffer, sizeEstimateSafetyFactor);
+  } else if (codec == Metadata::OptStore::RLE) {
+    return encodeRLE(srcBegin, srcEnd, slot, buffer);
+  }
+  return encodeRANSV1Inplace(srcBegin, srcEnd, slot, codec, buffer, sizeEstimateSafetyFactor);
+};
+
+template <typename H, int N, typename W>
+template <typename input_IT, typename buffer_T>
+o2::ctf::CTFIOSize EncodedBlocks<H, N, W>::encodeDelta(const input_IT srcBegin, const input_IT srcEnd, int slot, buffer_T* buffer, double_t sizeEstimateSafetyFactor)
+{
+  using input_t = typename std::iterator_traits<input_IT>::value_type;
+
+  if constexpr (!detail::isAdaptiveCodable_v<input_t>) {
+    throw std::runtime_error(fmt::format("delta encoding is not supported for the type of slot {}", slot));
+  } else {
+    using delta_t = std::make_signed_t<input_t>;
+    using udelta_t = std::make_unsigned_t<input_t>;
+
+    // differences modulo the type range, the 1st sample is stored as a difference to 0
+    std::vector<delta_t> deltas;
+    deltas.reserve(std::distance(srcBegin, srcEnd));
+    udelta_t prev = 0;
+    for (auto it = srcBegin; it != srcEnd; ++it) {
+      const auto value = static_cast<udelta_t>(*it);
+      deltas.push_back(static_cast<delta_t>(static_cast<udelta_t>(value - prev)));
+      prev = value;
+    }
+    const auto ioSize = encodeRANSV1Inplace(deltas.data(), deltas.data() + deltas.size(), slot, Metadata::OptStore::EENCODE, buffer, sizeEstimateSafetyFactor);
+
+    // after the expansion of the storage this is not guaranteed to be valid
+    auto* thisMetadata = buffer ? &(get(buffer->data())->mMetadata[slot]) : &mMetadata[slot];
+    if (thisMetadata->opt != Metadata::OptStore::EENCODE) {
+      throw std::runtime_error(fmt::format("failed to entropy encode the differences of slot {}", slot));
+    }
+    thisMetadata->opt = Metadata::OptStore::DELTA_EENCODE;
+    return ioSize;
+  }
+};
+
+template <typename H, int N, typename W>
+template <typename input_IT, typename buffer_T>
+o2::ctf::CTFIOSize EncodedBlocks<H, N, W>::encodeRLE(const input_IT srcBegin, const input_IT srcEnd, int slot, buffer_T* buffer)
+{
+  using storageBuffer_t = W;
+  using input_t = typename std::iterator_traits<input_IT>::value_type;
+  using run_t = uint32_t;
+  constexpr run_t MaxRun = std::numeric_limits<int32_t>::max(); // the offset of the run lengths is stored as int32_t
+
+  std::vector<input_t> values;
+  std::vector<run_t> runs;
+  for (auto it = srcBegin; it != srcEnd; ++it) {
+    if (values.empty() || *it != values.back() || runs.back() == MaxRun) {
+      values.push_back(*it);
+      runs.push_back(0);
+    }
+    runs.back()++;
+  }
+
+  // a width of 0 means that all values (run lengths) are equal to the offset stored in the metadata
+  internal::Packer<input_t> valuesPacker{values.data(), values.data() + values.size()};
+  internal::Packer<run_t> runsPacker{runs.data(), runs.data() + runs.size()};
+  const size_t valuesBufferWords = valuesPacker.getPackingWidth() ? valuesPacker.template getPackingBufferSize<storageBuffer_t>(values.size()) : 0;
+  const size_t runsBufferWords = runsPacker.getPackingWidth() ? runsPacker.template getPackingBufferSize<storageBuffer_t>(runs.size()) : 0;
+
+  auto* thisBlock = &mBlocks[slot];
+  auto* thisMetadata = &mMetadata[slot];
+  size_t valuesSize = 0, runsSize = 0;
+  if (valuesBufferWords + runsBufferWords) {
+    std::tie(thisBlock, thisMetadata) = expandStorage(slot, valuesBufferWords + runsBufferWords, buffer);
+  }
+  if (valuesBufferWords) {
+    auto valuesEnd = valuesPacker.pack(values.data(), values.size(), thisBlock->getCreateData(), thisBlock->getEndOfBlock());
+    valuesSize = std::distance(thisBlock->getCreateData(), valuesEnd);
+    thisBlock->setNData(valuesSize);
+    thisBlock->realignBlock();
+  }
+  if (runsBufferWords) {
+    auto runsEnd = runsPacker.pack(runs.data(), runs.size(), thisBlock->getCreateLiterals(), thisBlock->getEndOfBlock());
+    runsSize = std::distance(thisBlock->getCreateLiterals(), runsEnd);
+    thisBlock->setNLiterals(runsSize);
+    thisBlock->realignBlock();
+  }
+  *thisMetadata = detail::makeMetadataRLE<input_t, storageBuffer_t>(std::distance(srcBegin, srcEnd), runs.size(),
+                                                                    valuesPacker.getPackingWidth(), valuesPacker.getOffset(),
+                                                                    runsPacker.getPackingWidth(), runsPacker.getOffset(),
+                                                                    valuesSize, runsSize);
+  LOGP(debug, "StoreRLE {} runs in {} + {} bytes", runs.size(), valuesSize * sizeof(storageBuffer_t), runsSize * sizeof(storageBuffer_t));
+  return {0, thisMetadata->getUncompressedSize(), thisMetadata->getCompressedSize()};
+};
+
 /// create a special EncodedBlocks containing only dictionaries made from provided vector of frequency tables
 template <typename H, int N, typename W>
 std::vector<char> EncodedBlocks<H, N, W>::createDictionaryBlocks(const std::vector<rans::DenseHistogram<int32_t>>& vfreq, const std::vector<Metadata>& vmd)
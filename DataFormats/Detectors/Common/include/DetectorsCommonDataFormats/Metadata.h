@@ -30,7 +30,10 @@ struct Metadata {
     NONE,                         // original data repacked to array with slot-size = streamSize and saved w/o compression
     NODATA,                       // no data was provided
     PACK,                         // use Bitpacking
-    EENCODE_OR_PACK               // decide at runtime if to encode or pack
+    EENCODE_OR_PACK,              // decide at runtime if to encode or pack
+    ADAPTIVE,                     // decide at runtime between PACK, EENCODE, DELTA_EENCODE and RLE from a sample of the data
+    DELTA_EENCODE,                // entropy encoding applied to the differences of consecutive samples
+    RLE                           // run-length encoding: bitpacked values of the runs as data, bitpacked run lengths as literals
   };
   uint8_t nStreams = 0;              // Amount of concurrent Streams used by the encoder. only used by rANS version >=1.
   size_t messageLength = 0;          // Message length (multiply with messageWordSize to get size in Bytes).
@@ -166,6 +169,29 @@ template <typename source_T>
     static_cast<int32_t>(0)};
 };
 
+template <typename source_T, typename buffer_T>
+[[nodiscard]] inline constexpr Metadata makeMetadataRLE(size_t messageLength, size_t nRuns, size_t valuesPackingWidth,
+                                                        source_T valuesPackingOffset, size_t runsPackingWidth, uint32_t runsPackingOffset,
+                                                        size_t dataWords, size_t runsWords) noexcept
+{
+  return Metadata{
+    static_cast<uint8_t>(1),
+    messageLength,
+    nRuns,
+    static_cast<uint8_t>(sizeof(source_T)),
+    static_cast<uint8_t>(0),
+    static_cast<uint8_t>(sizeof(buffer_T)),
+    static_cast<uint8_t>(valuesPackingWidth),
+    Metadata::OptStore::RLE,
+    static_cast<int32_t>(valuesPackingOffset),
+    static_cast<int32_t>(0),
+    static_cast<int32_t>(runsPackingOffset),
+    static_cast<uint8_t>(runsPackingWidth),
+    static_cast<int32_t>(0),
+    static_cast<int32_t>(dataWords),
+    static_cast<int32_t>(runsWords)};
+};
+
 template <typename source_T, typename buffer_T>
 [[nodiscard]] inline constexpr Metadata makeMetadataStore(size_t messageLength, Metadata::OptStore opStore, size_t dataWords) noexcept
 {
@@ -0,0 +1,234 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file CTFRawFile.cxx
+/// \brief Non-ROOT container for the CTFs: flat EncodedBlocks images followed by an index footer
+
+#include "DetectorsCommonDataFormats/CTFRawFile.h"
+#include <Framework/Logger.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace o2::ctf;
+using DetID = o2::detectors::DetID;
+
+//___________________________________________________________________
+bool CTFRawFile::isRawFile(const std::string& name)
+{
+  return name.size() > FileExtension.size() && name.compare(name.size() - FileExtension.size(), FileExtension.size(), FileExtension) == 0;
+}
+
+//___________________________________________________________________
+CTFRawFileWriter::~CTFRawFileWriter()
+{
+  try {
+    close();
+  } catch (const std::exception& e) {
+    LOG(error) << e.what();
+  }
+}
+
+//___________________________________________________________________
+void CTFRawFileWriter::open(const std::string& name)
+{
+  close();
+  mFile.open(name, std::ios::binary | std::ios::trunc);
+  if (!mFile.is_open()) {
+    throw std::runtime_error(fmt::format("failed to open raw CTF file {}", name));
+  }
+  mName = name;
+  mOffset = 0;
+  mIndex.clear();
+  mCurrent = CTFRawFile::TFEntry{};
+  CTFRawFile::FileHeader header;
+  write(&header, sizeof(header));
+  mCurrent.begin = mCurrent.end = mOffset;
+}
+
+//___________________________________________________________________
+void CTFRawFileWriter::write(const void* data, size_t size)
+{
+  // pad to the alignment, so that the next payload starts at the aligned offset
+  static const char padding[CTFRawFile::Alignment] = {0};
+  mFile.write(reinterpret_cast<const char*>(data), size);
+  auto sz = CTFRawFile::alignSize(size);
+  if (sz > size) {
+    mFile.write(padding, sz - size);
+  }
+  if (!mFile) {
+    throw std::runtime_error(fmt::format("failed to write {} bytes to raw CTF file {}", sz, mName));
+  }
+  mOffset += sz;
+}
+
+//___________________________________________________________________
+size_t CTFRawFileWriter::addDetector(DetID det, const void* data, size_t size)
+{
+  auto& payload = mCurrent.payloads[det];
+  if (payload.size) {
+    throw std::runtime_error(fmt::format("{} was already added to the current TF in {}", det.getName(), mName));
+  }
+  auto offset = mOffset;
+  write(data, size);
+  payload.offset = offset;
+  payload.size = size;
+  mCurrent.end = mOffset;
+  return mOffset - offset;
+}
+
+//___________________________________________________________________
+size_t CTFRawFileWriter::addTF(const CTFHeader& header)
+{
+  mCurrent.run = header.run;
+  mCurrent.creationTime = header.creationTime;
+  mCurrent.firstTForbit = header.firstTForbit;
+  mCurrent.tfCounter = header.tfCounter;
+  mCurrent.detectors = header.detectors.to_ulong();
+  mIndex.push_back(mCurrent);
+  mCurrent = CTFRawFile::TFEntry{};
+  mCurrent.begin = mCurrent.end = mOffset;
+  return sizeof(CTFRawFile::TFEntry);
+}
+
+//___________________________________________________________________
+void CTFRawFileWriter::close()
+{
+  if (!mFile.is_open()) {
+    return;
+  }
+  CTFRawFile::Trailer trailer;
+  trailer.indexOffset = mOffset;
+  trailer.nTFs = mIndex.size();
+  write(mIndex.data(), mIndex.size() * sizeof(CTFRawFile::TFEntry));
+  mFile.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer)); // must be the last bytes of the file, no padding
+  mFile.close();
+  if (!mFile) {
+    throw std::runtime_error(fmt::format("failed to close raw CTF file {}", mName));
+  }
+  mIndex.clear();
+}
+
+//___________________________________________________________________
+void CTFRawFileReader::open(const std::string& name)
+{
+  close();
+  int fd = ::open(name.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    throw std::runtime_error(fmt::format("failed to open raw CTF file {}: {}", name, strerror(errno)));
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1 || size_t(st.st_size) < sizeof(CTFRawFile::FileHeader) + sizeof(CTFRawFile::Trailer)) {
+    ::close(fd);
+    throw std::runtime_error(fmt::format("raw CTF file {} is truncated", name));
+  }
+  void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // the mapping keeps the file referenced
+  if (data == MAP_FAILED) {
+    throw std::runtime_error(fmt::format("failed to map raw CTF file {}: {}", name, strerror(errno)));
+  }
+  mData = reinterpret_cast<const uint8_t*>(data);
+  mSize = st.st_size;
+  mName = name;
+
+  CTFRawFile::FileHeader header;
+  CTFRawFile::Trailer trailer;
+  memcpy(&header, mData, sizeof(header));
+  memcpy(&trailer, mData + mSize - sizeof(trailer), sizeof(trailer));
+  std::string error;
+  if (header.magic != CTFRawFile::Magic || trailer.magic != CTFRawFile::Magic) {
+    error = "is not a raw CTF file or was not closed";
+  } else if (header.version != CTFRawFile::Version || header.nDetectors != DetID::nDetectors) {
+    error = fmt::format("has version {} with {} detectors, while version {} with {} detectors is supported", header.version, header.nDetectors, CTFRawFile::Version, DetID::nDetectors);
+  } else if (trailer.indexOffset + trailer.nTFs * sizeof(CTFRawFile::TFEntry) > mSize - sizeof(trailer)) {
+    error = "has corrupted index";
+  }
+  if (!error.empty()) {
+    close();
+    throw std::runtime_error(fmt::format("raw CTF file {} {}", name, error));
+  }
+  mIndex = {reinterpret_cast<const CTFRawFile::TFEntry*>(mData + trailer.indexOffset), size_t(trailer.nTFs)};
+  // the TFs are mostly read in order, let the kernel read ahead
+  madvise(const_cast<uint8_t*>(mData), mSize, MADV_SEQUENTIAL);
+}
+
+//___________________________________________________________________
+void CTFRawFileReader::close()
+{
+  if (mData) {
+    munmap(const_cast<uint8_t*>(mData), mSize);
+  }
+  mData = nullptr;
+  mSize = 0;
+  mIndex = {};
+}
+
+//___________________________________________________________________
+CTFHeader CTFRawFileReader::getHeader(size_t tf) const
+{
+  const auto& entry = mIndex[tf];
+  CTFHeader header;
+  header.run = entry.run;
+  header.creationTime = entry.creationTime;
+  header.firstTForbit = entry.firstTForbit;
+  header.tfCounter = entry.tfCounter;
+  header.detectors = DetID::mask_t(uint32_t(entry.detectors));
+  return header;
+}
+
+//___________________________________________________________________
+gsl::span<const uint8_t> CTFRawFileReader::getDetector(size_t tf, DetID det) const
+{
+  const auto& payload = mIndex[tf].payloads[det];
+  if (payload.offset + payload.size > mSize) {
+    throw std::runtime_error(fmt::format("{} payload of TF {} is outside of raw CTF file {}", det.getName(), tf, mName));
+  }
+  return {mData + payload.offset, size_t(payload.size)};
+}
+
+//___________________________________________________________________
+void CTFRawFileReader::prefetch(size_t tf) const
+{
+  advise(tf, MADV_WILLNEED);
+}
+
+//___________________________________________________________________
+void CTFRawFileReader::release(size_t tf) const
+{
+  advise(tf, MADV_DONTNEED);
+}
+
+//___________________________________________________________________
+void CTFRawFileReader::advise(size_t tf, int advice) const
+{
+  if (!mData || tf >= mIndex.size()) {
+    return;
+  }
+  // madvise needs page aligned address. Prefetching extends the range to the enclosing pages, while
+  // releasing is restricted to the pages holding only this TF, the neighbouring ones may still be in use.
+  // The last page of the file has nothing after the TF, its length is rounded up by madvise itself.
+  static const size_t pageSize = sysconf(_SC_PAGESIZE);
+  size_t begin = mIndex[tf].begin / pageSize * pageSize, end = std::min<size_t>(mIndex[tf].end, mSize);
+  if (advice == MADV_DONTNEED) {
+    begin = (mIndex[tf].begin + pageSize - 1) / pageSize * pageSize;
+    if (end < mSize) {
+      end = end / pageSize * pageSize;
+    }
+  }
+  if (end > begin) {
+    madvise(const_cast<uint8_t*>(mData) + begin, end - begin, advice);
+  }
+}
@@ -30,6 +30,7 @@
 #include <boost/mp11.hpp>
 #include <fmt/core.h>
 
+#include "DetectorsCommonDataFormats/EncodedBlocks.h"
 #include "DetectorsCommonDataFormats/internal/Packer.h"
 #include "DetectorsCommonDataFormats/internal/ExternalEntropyCoder.h"
 #include "DetectorsCommonDataFormats/internal/InplaceEntropyCoder.h"
@@ -347,4 +348,69 @@ BOOST_AUTO_TEST_CASE(testExternalEncoderCombinedIterator)
   auto [begin, end] = makeInputIterators(testMessage1.data(), testMessage2.data(), testMessage1.size(), ShiftFunctor<uint16_t, rans::utils::toBits<uint8_t>()>{});
 
   encodeExternal(begin, end);
-};
\ No newline at end of file
+};
+using AdaptiveTestBlocks = ctf::EncodedBlocks<ctf::CTFDictHeader, 4, buffer_type>;
+
+template <typename source_T>
+void encodeAdaptive(const std::vector<source_T>& message, ctf::Metadata::OptStore expected)
+{
+  std::vector<ctf::BufferType> buffer;
+  auto* blocks = AdaptiveTestBlocks::create(buffer);
+  blocks->setANSHeader(ctf::ANSVersion1);
+  // the same message with ADAPTIVE, EENCODE_OR_PACK, ADAPTIVE and ADAPTIVE on the iterators
+  blocks->encode(message.data(), message.data() + message.size(), 0, 0, ctf::Metadata::OptStore::ADAPTIVE, &buffer);
+  AdaptiveTestBlocks::get(buffer.data())->encode(message.data(), message.data() + message.size(), 1, 0, ctf::Metadata::OptStore::EENCODE_OR_PACK, &buffer);
+  AdaptiveTestBlocks::get(buffer.data())->encode(message.begin(), message.end(), 2, 0, ctf::Metadata::OptStore::ADAPTIVE, &buffer);
+  std::vector<source_T> empty{};
+  AdaptiveTestBlocks::get(buffer.data())->encode(empty.begin(), empty.end(), 3, 0, ctf::Metadata::OptStore::ADAPTIVE, &buffer);
+
+  const auto* encoded = AdaptiveTestBlocks::get(buffer.data());
+  const auto& md = encoded->getMetadata(0);
+  BOOST_CHECK(md.opt == expected);
+  BOOST_CHECK(encoded->getMetadata(2).opt == expected);
+  BOOST_CHECK(encoded->getBlock(0).getNStored() <= encoded->getBlock(1).getNStored());
+
+  for (int slot = 0; slot < 3; slot++) {
+    std::vector<source_T> decoded(message.size());
+    encoded->decode(decoded.begin(), slot);
+    BOOST_CHECK_EQUAL_COLLECTIONS(decoded.begin(), decoded.end(), message.begin(), message.end());
+  }
+};
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(testAdaptiveCodecRLE, source_T, source_types)
+{
+  // short runs of random values, limited to 20 bits to keep the dictionary of the rANS reference small
+  std::vector<source_T> message;
+  std::mt19937 mt(0);
+  const int64_t min = std::numeric_limits<source_T>::min();
+  std::uniform_int_distribution<int64_t> values(min, std::min<int64_t>(std::numeric_limits<source_T>::max(), min + rans::utils::pow2(20)));
+  while (message.size() < rans::utils::pow2(17)) {
+    message.insert(message.end(), 5, static_cast<source_T>(values(mt)));
+  }
+  encodeAdaptive(message, ctf::Metadata::OptStore::RLE);
+};
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(testAdaptiveCodecDelta, source_T, source_types)
+{
+  // slowly varying values, wrapping around the range of the type, except for uint32_t where the dictionary of the rANS
+  // reference would not fit the int32_t range of the metadata
+  std::vector<source_T> message(rans::utils::pow2(17));
+  std::mt19937 mt(0);
+  std::binomial_distribution<int> steps(16, 0.5);
+  source_T value = std::is_same_v<source_T, uint32_t> ? 100 : std::numeric_limits<source_T>::max() - 100;
+  for (auto& v : message) {
+    v = value;
+    value += static_cast<source_T>(steps(mt));
+  }
+  encodeAdaptive(message, ctf::Metadata::OptStore::DELTA_EENCODE);
+};
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(testAdaptiveCodecEntropy, source_T, source_types)
+{
+  const auto& testMessage = MessageProxy.getMessage<source_T>();
+  std::vector<source_T> message;
+  for (int i = 0; i < 64; i++) {
+    message.insert(message.end(), testMessage.begin(), testMessage.end());
+  }
+  encodeAdaptive(message, ctf::Metadata::OptStore::EENCODE);
+};
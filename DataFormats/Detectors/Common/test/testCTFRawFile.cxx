@@ -0,0 +1,87 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test CTFRawFile
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <vector>
+#include "DetectorsCommonDataFormats/CTFRawFile.h"
+
+using namespace o2::ctf;
+using DetID = o2::detectors::DetID;
+
+BOOST_AUTO_TEST_CASE(CTFRawFile_test)
+{
+  const std::string name = "testCTFRawFile.ctf";
+  BOOST_CHECK(CTFRawFile::isRawFile(name));
+  BOOST_CHECK(!CTFRawFile::isRawFile("o2_ctf_run00000000_orbit0000000000_tf0000000000_host.root"));
+
+  // payloads of different sizes, not multiple of the alignment
+  std::vector<uint8_t> its(1001), tpc(77);
+  std::iota(its.begin(), its.end(), 0);
+  std::iota(tpc.begin(), tpc.end(), 100);
+  constexpr int NTF = 3;
+  {
+    CTFRawFileWriter writer;
+    writer.open(name);
+    for (int itf = 0; itf < NTF; itf++) {
+      CTFHeader header{uint64_t(123456), uint64_t(1700000000000 + itf), uint32_t(256 * itf), uint32_t(itf)};
+      writer.addDetector(DetID::ITS, its.data(), its.size());
+      header.detectors.set(DetID::ITS);
+      if (itf != 1) {
+        writer.addDetector(DetID::TPC, tpc.data(), tpc.size());
+        header.detectors.set(DetID::TPC);
+      }
+      writer.addTF(header);
+    }
+    BOOST_CHECK(writer.getNTFs() == NTF);
+  }
+
+  CTFRawFileReader reader;
+  reader.open(name);
+  BOOST_CHECK(reader.getNTFs() == NTF);
+  for (int itf = 0; itf < NTF; itf++) {
+    reader.prefetch(itf);
+    auto header = reader.getHeader(itf);
+    BOOST_CHECK(header.run == 123456);
+    BOOST_CHECK(header.creationTime == uint64_t(1700000000000 + itf));
+    BOOST_CHECK(header.firstTForbit == uint32_t(256 * itf));
+    BOOST_CHECK(header.tfCounter == uint32_t(itf));
+    BOOST_CHECK(header.detectors[DetID::ITS]);
+    BOOST_CHECK(header.detectors[DetID::TPC] == (itf != 1));
+    auto itsImage = reader.getDetector(itf, DetID::ITS);
+    BOOST_CHECK(std::vector<uint8_t>(itsImage.begin(), itsImage.end()) == its);
+    BOOST_CHECK(reinterpret_cast<uintptr_t>(itsImage.data()) % CTFRawFile::Alignment == 0);
+    auto tpcImage = reader.getDetector(itf, DetID::TPC);
+    if (itf != 1) {
+      BOOST_CHECK(std::vector<uint8_t>(tpcImage.begin(), tpcImage.end()) == tpc);
+    } else {
+      BOOST_CHECK(tpcImage.empty());
+    }
+    BOOST_CHECK(reader.getDetector(itf, DetID::TOF).empty());
+    reader.release(itf);
+  }
+  reader.close();
+
+  // a file which was not closed has no index
+  {
+    std::ofstream fl(name, std::ios::binary | std::ios::trunc);
+    CTFRawFile::FileHeader header;
+    fl.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    fl.write(reinterpret_cast<const char*>(its.data()), its.size());
+  }
+  BOOST_CHECK_THROW(reader.open(name), std::runtime_error);
+  std::filesystem::remove(name);
+}
@@ -329,6 +329,8 @@ constexpr o2::header::SerializationMethod gSerializationMethodROOT{"ROOT"};
 constexpr o2::header::SerializationMethod gSerializationMethodCCDB{"CCDB"};
 constexpr o2::header::SerializationMethod gSerializationMethodFlatBuf{"FLATBUF"};
 constexpr o2::header::SerializationMethod gSerializationMethodArrow{"ARROW"};
+/// std::vector<std::vector<T>> of trivially copyable T, flattened to offsets + data
+constexpr o2::header::SerializationMethod gSerializationMethodFlatVector{"FLATVEC"};
 
 //__________________________________________________________________________________________________
 /// @struct BaseHeader
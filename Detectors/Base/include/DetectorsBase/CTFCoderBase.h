@@ -27,6 +27,7 @@
 #include "DetectorsCommonDataFormats/CTFIOSize.h"
 #include "DataFormatsCTP/TriggerOffsetsParam.h"
 #include "DetectorsCommonDataFormats/ANSHeader.h"
+#include "DetectorsCommonDataFormats/Metadata.h"
 #include "rANS/factory.h"
 #include "rANS/compat.h"
 #include "rANS/histogram.h"
@@ -35,12 +36,14 @@
 #include "Framework/ConcreteDataMatcher.h"
 #include "Framework/ConfigParamRegistry.h"
 #include <any>
+#include <functional>
 
 namespace o2
 {
 namespace framework
 {
 class ProcessingContext;
+class WorkerPool;
 }
 namespace ctf
 {
@@ -121,6 +124,12 @@ class CTFCoderBase
   void setVerbosity(int v) { mVerbosity = v; }
   int getVerbosity() const { return mVerbosity; }
 
+  void setNThreads(int n);
+  int getNThreads() const { return mNThreads; }
+
+  void setAdaptiveCodecs(bool v) { mAdaptiveCodecs = v; }
+  bool getAdaptiveCodecs() const { return mAdaptiveCodecs; }
+
   const CTFDictHeader& getExtDictHeader() const { return mExtHeader; }
 
   template <typename T>
@@ -172,6 +181,14 @@ class CTFCoderBase
     return diff < 0 ? true : diff >= shift;
   }
   bool canApplyBCShift(const o2::InteractionRecord& ir) const { return canApplyBCShift(ir, mBCShift); }
+  // run the independent jobs (e.g. encoding/decoding of different blocks) on up to mNThreads threads of the coder pool
+  void runBlockJobs(size_t nJobs, const std::function<void(size_t)>& job) const;
+  // storage option of the block to encode: entropy coded blocks become ADAPTIVE if the adaptive codecs are requested
+  ctf::Metadata::OptStore getOptStore(ctf::Metadata::OptStore opt) const
+  {
+    const bool entropyCoded = opt == ctf::Metadata::OptStore::EENCODE || opt == ctf::Metadata::OptStore::EENCODE_OR_PACK;
+    return mAdaptiveCodecs && entropyCoded ? ctf::Metadata::OptStore::ADAPTIVE : opt;
+  }
 
   template <typename source_IT>
   [[nodiscard]] size_t estimateBufferSize(size_t slot, source_IT samplesBegin, source_IT samplesEnd);
@@ -204,6 +221,9 @@ class CTFCoderBase
   size_t mIRFrameSelMarginFwd = 0; // margin in BC to add to the IRFrame upper boundary when selection is requested
   long mIRFrameSelShift = 0;       // Global shift of the IRFrames, to account for e.g. detector latency
   int mVerbosity = 0;
+  int mNThreads = 1;            // number of threads for encoding/decoding of the blocks
+  bool mAdaptiveCodecs = false; // choose the codec of each entropy coded block from a sample of its data
+  std::shared_ptr<o2::framework::WorkerPool> mBlockJobsPool; // threads kept between the TFs, created when mNThreads > 1
 };
 
 ///________________________________
@@ -313,6 +333,12 @@ void CTFCoderBase::init(o2::framework::InitContext& ic)
   if (ic.options().hasOption("irframe-shift")) {
     mIRFrameSelShift = (long)ic.options().get<int32_t>("irframe-shift");
   }
+  if (ic.options().hasOption("ctf-threads")) {
+    setNThreads(ic.options().get<int>("ctf-threads"));
+  }
+  if (ic.options().hasOption("ctf-adaptive")) {
+    setAdaptiveCodecs(ic.options().get<bool>("ctf-adaptive"));
+  }
   if (ic.options().hasOption("ans-version")) {
     if (ic.options().isSet("ans-version")) {
       const std::string ansVersionString = ic.options().get<std::string>("ans-version");
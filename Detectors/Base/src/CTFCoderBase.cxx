@@ -18,6 +18,7 @@
 #include "Framework/ProcessingContext.h"
 #include "Framework/InputRecord.h"
 #include "Framework/TimingInfo.h"
+#include "Framework/WorkerPool.h"
 
 using namespace o2::ctf;
 using namespace o2::framework;
@@ -46,6 +47,28 @@ void CTFCoderBase::assignDictVersion(CTFDictHeader& h) const
   //  }
 }
 
+void CTFCoderBase::setNThreads(int n)
+{
+  mNThreads = n > 1 ? n : 1;
+  if (mNThreads > 1 && !mBlockJobsPool) {
+    mBlockJobsPool = std::make_shared<WorkerPool>();
+  }
+}
+
+// Jobs are picked by the threads in the order of their indices, the 1st exception thrown is rethrown
+// once all threads are done. The threads are kept by the pool between the TFs, with a single thread
+// the jobs are executed sequentially in the caller thread.
+void CTFCoderBase::runBlockJobs(size_t nJobs, const std::function<void(size_t)>& job) const
+{
+  if (mNThreads <= 1 || !mBlockJobsPool) {
+    for (size_t i = 0; i < nJobs; i++) {
+      job(i);
+    }
+    return;
+  }
+  mBlockJobsPool->run(nJobs, mNThreads, job);
+}
+
 void CTFCoderBase::updateTimeDependentParams(ProcessingContext& pc, bool askTree)
 {
   setFirstTFOrbit(pc.services().get<o2::framework::TimingInfo>().firstTForbit);
@@ -199,3 +199,93 @@ BOOST_DATA_TEST_CASE(CTFTest, boost_data::make(ANSVersions) ^ boost_data::make(C
   BOOST_CHECK(triggers.size() == triggersR.size());
   BOOST_CHECK(memcmp(triggers.data(), triggersR.data(), triggers.size() * sizeof(o2::tpc::TriggerInfoDLBZS)) == 0);
 }
+
+BOOST_DATA_TEST_CASE(CTFTestThreads, boost_data::make(ANSVersions) ^ boost_data::make(CombineColumns), ansVersion, combineColumns)
+{
+  // the blocks encoded in parallel (createForSlot + copyBlock) must give the same CTF as the sequential encoding
+  CompressedClusters c;
+  c.nAttachedClusters = 20000;
+  c.nUnattachedClusters = 30000;
+  c.nAttachedClustersReduced = 19000;
+  c.nTracks = 1000;
+
+  std::vector<char> bVec;
+  CompressedClustersFlat* ccFlat = nullptr;
+  size_t sizeCFlatBody = CTFCoder::alignSize(ccFlat);
+  size_t sz = sizeCFlatBody + CTFCoder::estimateSize(c);
+  bVec.resize(sz);
+  ccFlat = reinterpret_cast<CompressedClustersFlat*>(bVec.data());
+  auto buff = reinterpret_cast<void*>(reinterpret_cast<char*>(bVec.data()) + sizeCFlatBody);
+  {
+    CTFCoder coder(o2::ctf::CTFCoderBase::OpType::Encoder);
+    coder.setCompClusAddresses(c, buff);
+    coder.setCombineColumns(combineColumns);
+  }
+  ccFlat->set(sz, c);
+
+  gRandom->SetSeed(1234);
+  for (int i = 0; i < c.nUnattachedClusters; i++) {
+    c.qTotU[i] = gRandom->Integer(1000);
+    c.qMaxU[i] = gRandom->Integer(200);
+    c.flagsU[i] = gRandom->Integer(4);
+    c.padDiffU[i] = gRandom->Integer(100);
+    c.timeDiffU[i] = gRandom->Integer(500);
+    c.sigmaPadU[i] = gRandom->Integer(50);
+    c.sigmaTimeU[i] = gRandom->Integer(50);
+  }
+  for (int i = 0; i < c.nAttachedClusters; i++) {
+    c.qTotA[i] = gRandom->Integer(1000);
+    c.qMaxA[i] = gRandom->Integer(200);
+    c.flagsA[i] = gRandom->Integer(4);
+    c.sigmaPadA[i] = gRandom->Integer(50);
+    c.sigmaTimeA[i] = gRandom->Integer(50);
+  }
+  for (int i = 0; i < c.nAttachedClustersReduced; i++) {
+    c.rowDiffA[i] = gRandom->Integer(3);
+    c.sliceLegDiffA[i] = gRandom->Integer(2);
+    c.padResA[i] = gRandom->Integer(20);
+    c.timeResA[i] = gRandom->Integer(20);
+  }
+  for (int i = 0; i < c.nTracks; i++) {
+    c.qPtA[i] = gRandom->Integer(128);
+    c.rowA[i] = gRandom->Integer(152);
+    c.sliceA[i] = gRandom->Integer(36);
+    c.timeA[i] = gRandom->Integer(100000);
+    c.padA[i] = gRandom->Integer(140);
+    c.nTrackClusters[i] = 20;
+  }
+  for (int i = 0; i < c.nSliceRows; i++) {
+    c.nSliceRowClusters[i] = i % 40;
+  }
+
+  auto encode = [&](int nThreads) {
+    std::vector<o2::ctf::BufferType> vecIO;
+    CTFCoder coder(o2::ctf::CTFCoderBase::OpType::Encoder);
+    coder.setCombineColumns(combineColumns);
+    coder.setANSVersion(ansVersion);
+    coder.setNThreads(nThreads);
+    o2::tpc::detail::TriggerInfo trigComp;
+    coder.encode(vecIO, c, c, trigComp);
+    return vecIO;
+  };
+  auto vecIOSeq = encode(1);
+  for (int nThreads : {2, 4, 8}) {
+    auto vecIOPar = encode(nThreads);
+    BOOST_CHECK(vecIOPar.size() == vecIOSeq.size());
+    BOOST_CHECK(memcmp(vecIOPar.data(), vecIOSeq.data(), vecIOSeq.size() * sizeof(o2::ctf::BufferType)) == 0);
+
+    // the decoding of the same CTF with 1 and N threads must restore the original clusters
+    for (int nThreadsDec : {1, nThreads}) {
+      std::vector<char> vecIn;
+      std::vector<o2::tpc::TriggerInfoDLBZS> triggersR;
+      const auto ctfImage = o2::tpc::CTF::getImage(vecIOPar.data());
+      CTFCoder coder(o2::ctf::CTFCoderBase::OpType::Decoder);
+      coder.setCombineColumns(true);
+      coder.setNThreads(nThreadsDec);
+      coder.decode(ctfImage, vecIn, triggersR);
+      BOOST_CHECK(vecIn.size() == bVec.size());
+      BOOST_CHECK(memcmp(vecIn.data() + sizeof(o2::tpc::CompressedClustersCounters), bVec.data() + sizeof(o2::tpc::CompressedClustersCounters), bVec.size() - sizeof(o2::tpc::CompressedClustersCounters)) == 0);
+      BOOST_CHECK(triggersR.empty());
+    }
+  }
+}
@@ -11,6 +11,7 @@
 
 /// @file   CTFReaderSpec.cxx
 
+#include <cstring>
 #include <vector>
 #include <TFile.h>
 #include <TTree.h>
@@ -29,6 +30,7 @@
 #include "DetectorsCommonDataFormats/EncodedBlocks.h"
 #include "CommonUtils/NameConf.h"
 #include "DetectorsCommonDataFormats/CTFHeader.h"
+#include "DetectorsCommonDataFormats/CTFRawFile.h"
 #include "Headers/STFHeader.h"
 #include "DataFormatsITSMFT/CTF.h"
 #include "DataFormatsTPC/CTF.h"
@@ -89,6 +91,9 @@ class CTFReaderSpec : public o2::framework::Task
   void openCTFFile(const std::string& flname);
   bool processTF(ProcessingContext& pc);
   void checkTreeEntries();
+  bool isCTFFileOpen() const { return mCTFTree || mCTFRawFile; }
+  long getNCTFEntries() const { return mCTFRawFile ? long(mCTFRawFile->getNTFs()) : mCTFTree->GetEntries(); }
+  const char* getCTFFileName() const { return mCTFRawFile ? mCTFRawFile->getName().c_str() : mCTFFile->GetName(); }
   void stopReader();
   template <typename C>
   void processDetector(DetID det, const CTFHeader& ctfHeader, ProcessingContext& pc) const;
@@ -100,6 +105,7 @@ class CTFReaderSpec : public o2::framework::Task
   std::unique_ptr<o2::utils::FileFetcher> mFileFetcher;
   std::unique_ptr<TFile> mCTFFile;
   std::unique_ptr<TTree> mCTFTree;
+  std::unique_ptr<CTFRawFileReader> mCTFRawFile; // alternative to mCTFFile/mCTFTree for the raw CTF files
   bool mRunning = false;
   bool mUseLocalTFCounter = false;
   int mConvRunTimeRangesToOrbits = -1; // not defined yet
@@ -148,6 +154,7 @@ void CTFReaderSpec::stopReader()
     mCTFFile->Close();
   }
   mCTFFile.reset();
+  mCTFRawFile.reset();
 }
 
 ///_______________________________________
@@ -285,6 +292,16 @@ void CTFReaderSpec::openCTFFile(const std::string& flname)
 {
   try {
     mFilesRead++;
+    if (CTFRawFile::isRawFile(flname)) { // mapped to memory, the TFs are read from it without ROOT deserialization
+      mCTFRawFile = std::make_unique<CTFRawFileReader>();
+      mCTFRawFile->open(flname);
+      if (mCTFRawFile->getNTFs() < 1) {
+        throw std::runtime_error(fmt::format("raw CTF file {} has 0 entries, skipping", flname));
+      }
+      mCTFRawFile->prefetch(0);
+      mCurrTreeEntry = 0;
+      return;
+    }
     mCTFFile.reset(TFile::Open(flname.c_str()));
     if (!mCTFFile || !mCTFFile->IsOpen() || mCTFFile->IsZombie()) {
       throw std::runtime_error(fmt::format("failed to open CTF file {}, skipping", flname));
@@ -300,6 +317,7 @@ void CTFReaderSpec::openCTFFile(const std::string& flname)
     LOG(error) << "Cannot process " << flname << ", reason: " << e.what();
     mCTFTree.reset();
     mCTFFile.reset();
+    mCTFRawFile.reset();
     mNFailedFiles++;
     if (mFileFetcher) {
       mFileFetcher->popFromQueue(mInput.maxLoops < 1);
@@ -319,7 +337,7 @@ void CTFReaderSpec::run(ProcessingContext& pc)
   long startWait = 0;
 
   while (mRunning) {
-    if (mCTFTree) { // there is a tree open with multiple CTF
+    if (isCTFFileOpen()) { // there is a tree (or raw file) open with multiple CTF
       if (mInput.ctfIDs.empty() || mInput.ctfIDs[mSelIDEntry] == mCTFCounter) { // no selection requested or matching CTF ID is found
         LOG(debug) << "TF " << mCTFCounter << " of " << mInput.maxTFs << " loop " << mFileFetcher->getNLoops();
         mSelIDEntry++;
@@ -328,7 +346,7 @@ void CTFReaderSpec::run(ProcessingContext& pc)
         }
       }
       // explict CTF ID selection list or IRFrame was provided and current entry is not selected
-      LOGP(info, "Skipping CTF#{} ({} of {} in {})", mCTFCounter, mCurrTreeEntry, mCTFTree->GetEntries(), mCTFFile->GetName());
+      LOGP(info, "Skipping CTF#{} ({} of {} in {})", mCTFCounter, mCurrTreeEntry, getNCTFEntries(), getCTFFileName());
       checkTreeEntries();
       mCTFCounter++;
       continue;
@@ -362,7 +380,7 @@ void CTFReaderSpec::run(ProcessingContext& pc)
   if (mCTFCounter >= mInput.maxTFs || (!mInput.ctfIDs.empty() && mSelIDEntry >= mInput.ctfIDs.size())) { // done
     LOGP(info, "All CTFs from selected range were injected, stopping");
     mRunning = false;
-  } else if (mRunning && !mCTFTree && mFileFetcher->getNextFileInQueue().empty() && !mFileFetcher->isRunning()) { // previous tree was done, can we read more?
+  } else if (mRunning && !isCTFFileOpen() && mFileFetcher->getNextFileInQueue().empty() && !mFileFetcher->isRunning()) { // previous tree was done, can we read more?
     mRunning = false;
   }
 
@@ -392,7 +410,9 @@ bool CTFReaderSpec::processTF(ProcessingContext& pc)
 
   static RateLimiter limiter;
   CTFHeader ctfHeader;
-  if (!readFromTree(*(mCTFTree.get()), "CTFHeader", ctfHeader, mCurrTreeEntry)) {
+  if (mCTFRawFile) {
+    ctfHeader = mCTFRawFile->getHeader(mCurrTreeEntry);
+  } else if (!readFromTree(*(mCTFTree.get()), "CTFHeader", ctfHeader, mCurrTreeEntry)) {
     throw std::runtime_error("did not find CTFHeader");
   }
   if (mImposeRunStartMS > 0) {
@@ -471,7 +491,7 @@ bool CTFReaderSpec::processTF(ProcessingContext& pc)
     stfDist.runNumber = uint32_t(ctfHeader.run);
   }
 
-  auto entryStr = fmt::format("({} of {} in {})", mCurrTreeEntry, mCTFTree->GetEntries(), mCTFFile->GetName());
+  auto entryStr = fmt::format("({} of {} in {})", mCurrTreeEntry, getNCTFEntries(), getCTFFileName());
   checkTreeEntries();
   mTimer.Stop();
 
@@ -497,10 +517,17 @@ bool CTFReaderSpec::processTF(ProcessingContext& pc)
 void CTFReaderSpec::checkTreeEntries()
 {
   // check if the tree has entries left, if needed, close current tree/file
-  if (++mCurrTreeEntry >= mCTFTree->GetEntries() || (mInput.maxTFsPerFile > 0 && mCurrTreeEntry >= mInput.maxTFsPerFile)) { // this file is done, check if there are other files
+  if (mCTFRawFile) { // the current TF was already copied to the output, read ahead the next one
+    mCTFRawFile->release(mCurrTreeEntry);
+    mCTFRawFile->prefetch(mCurrTreeEntry + 1);
+  }
+  if (++mCurrTreeEntry >= getNCTFEntries() || (mInput.maxTFsPerFile > 0 && mCurrTreeEntry >= mInput.maxTFsPerFile)) { // this file is done, check if there are other files
     mCTFTree.reset();
-    mCTFFile->Close();
+    if (mCTFFile) {
+      mCTFFile->Close();
+    }
     mCTFFile.reset();
+    mCTFRawFile.reset();
     if (mFileFetcher) {
       mFileFetcher->popFromQueue(mInput.maxLoops < 1);
     }
@@ -528,10 +555,19 @@ void CTFReaderSpec::processDetector(DetID det, const CTFHeader& ctfHeader, Proce
 {
   if (mInput.detMask[det]) {
     const auto lbl = det.getName();
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({lbl, mInput.subspec}, ctfHeader.detectors[det] ? sizeof(C) : 0);
-    if (ctfHeader.detectors[det]) {
-      C::readFromTree(bufVec, *(mCTFTree.get()), lbl, mCurrTreeEntry);
-    } else if (!mInput.allowMissingDetectors) {
+    if (mCTFRawFile) { // the flat image is copied from the mapped file as it is, the decoder will relocate it
+      auto image = ctfHeader.detectors[det] ? mCTFRawFile->getDetector(mCurrTreeEntry, det) : gsl::span<const uint8_t>{};
+      auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({lbl, mInput.subspec}, image.size());
+      if (!image.empty()) {
+        std::memcpy(bufVec.data(), image.data(), image.size());
+      }
+    } else {
+      auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({lbl, mInput.subspec}, ctfHeader.detectors[det] ? sizeof(C) : 0);
+      if (ctfHeader.detectors[det]) {
+        C::readFromTree(bufVec, *(mCTFTree.get()), lbl, mCurrTreeEntry);
+      }
+    }
+    if (!ctfHeader.detectors[det] && !mInput.allowMissingDetectors) {
       throw std::runtime_error(fmt::format("Requested detector {} is missing in the CTF", lbl));
     }
     //    setMessageHeader(pc, ctfHeader, lbl);
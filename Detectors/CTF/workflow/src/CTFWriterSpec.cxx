@@ -24,6 +24,7 @@
 #include "DataFormatsParameters/GRPECSObject.h"
 #include "CTFWorkflow/CTFWriterSpec.h"
 #include "DetectorsCommonDataFormats/CTFHeader.h"
+#include "DetectorsCommonDataFormats/CTFRawFile.h"
 #include "CommonUtils/NameConf.h"
 #include "CommonUtils/FileSystemUtils.h"
 #include "DetectorsCommonDataFormats/EncodedBlocks.h"
@@ -115,6 +116,7 @@ class CTFWriterSpec : public o2::framework::Task
   void storeDictionaries();
   void closeTFTreeAndFile();
   void prepareTFTreeAndFile();
+  bool isCTFFileOpen() const { return mCTFTreeOut || mCTFRawOut; }
   size_t estimateCTFSize(ProcessingContext& pc);
   size_t getAvailableDiskSpace(const std::string& path, int level);
   void createLockFile(int level);
@@ -152,6 +154,7 @@ class CTFWriterSpec : public o2::framework::Task
   int mRejRate = 0;                // CTF rejection rule (>0: percentage to reject randomly, <0: reject if timeslice%|value|!=0)
   int mCTFFileCompression = 0;     // CTF file compression level (if >= 0)
   bool mFillMD5 = false;
+  bool mRawFileFormat = false;     // write raw CTF files (flat images with index) instead of ROOT trees
   std::vector<uint32_t> mTFOrbits{}; // 1st orbits of TF accumulated in current file
   o2::framework::DataTakingContext mDataTakingContext{};
   o2::framework::TimingInfo mTimingInfo{};
@@ -170,6 +173,7 @@ class CTFWriterSpec : public o2::framework::Task
   int mLockFD = -1;
   std::unique_ptr<TFile> mCTFFileOut;
   std::unique_ptr<TTree> mCTFTreeOut;
+  std::unique_ptr<CTFRawFileWriter> mCTFRawOut;
 
   std::unique_ptr<TFile> mDictFileOut; // file to store dictionary
   std::unique_ptr<TTree> mDictTreeOut; // tree to store dictionary
@@ -222,6 +226,12 @@ void CTFWriterSpec::init(InitContext& ic)
   mSaveDictAfter = ic.options().get<int>("save-dict-after");
   mCTFAutoSave = ic.options().get<long>("save-ctf-after");
   mCTFFileCompression = ic.options().get<int>("ctf-file-compression");
+  auto fileFormat = ic.options().get<std::string>("ctf-file-format");
+  if (fileFormat == "raw") {
+    mRawFileFormat = true;
+  } else if (fileFormat != "root") {
+    throw std::invalid_argument(fmt::format("Invalid ctf-file-format {}, must be root or raw", fileFormat));
+  }
   mCTFMetaFileDir = ic.options().get<std::string>("meta-output-dir");
   if (mCTFMetaFileDir != "/dev/null") {
     mCTFMetaFileDir = o2::utils::Str::rectifyDirectory(mCTFMetaFileDir);
@@ -314,7 +324,7 @@ size_t CTFWriterSpec::processDet(o2::framework::ProcessingContext& pc, DetID det
     const auto ctfImage = C::getImage(bdata);
     ctfImage.print(o2::utils::Str::concat_string(det.getName(), ": "), mVerbosity);
     if (mWriteCTF && !mRejectCurrentTF) {
-      sz = ctfImage.appendToTree(*tree, det.getName());
+      sz = mRawFileFormat ? mCTFRawOut->addDetector(det, bdata, ctfBuffer.size()) : ctfImage.appendToTree(*tree, det.getName());
       header.detectors.set(det);
     } else {
       sz = ctfBuffer.size();
@@ -332,7 +342,7 @@ size_t CTFWriterSpec::processDet(o2::framework::ProcessingContext& pc, DetID det
       for (int ib = 0; ib < C::getNBlocks(); ib++) {
         if (!mIsSaturatedFrequencyTable[det][ib]) {
           const auto& bl = ctfImage.getBlock(ib);
-          if (bl.getNDict()) {
+          if (bl.getNDict() && ctfImage.getMetadata(ib).opt != o2::ctf::Metadata::OptStore::DELTA_EENCODE) { // dictionary of the differences is not the one of the data
             auto freq = mFreqsAccumulation[det][ib];
             auto& mdSave = mFreqsMetaData[det][ib];
             const auto& md = ctfImage.getMetadata(ib);
@@ -445,7 +455,7 @@ void CTFWriterSpec::run(ProcessingContext& pc)
       constexpr size_t MB = 1024 * 1024;
       constexpr int showFirstN = 10, prsecaleWarnings = 50;
       try {
-        const auto si = std::filesystem::space(mCTFFileOut->GetName());
+        const auto si = std::filesystem::space(o2::utils::Str::concat_string(mCurrentCTFFileNameFull, TMPFileEnding));
         std::string wmsg{};
         if (mCheckDiskFull > 0.f && si.available < mCheckDiskFull) {
           nwaitCycles++;
@@ -503,10 +513,15 @@ void CTFWriterSpec::run(ProcessingContext& pc)
   mTimer.Stop();
 
   if (mWriteCTF && !mRejectCurrentTF) {
-    szCTF += appendToTree(*mCTFTreeOut.get(), "CTFHeader", header);
     size_t prevSizeMB = mAccCTFSize / (1 << 20);
+    if (mRawFileFormat) {
+      szCTF += mCTFRawOut->addTF(header);
+      ++mNAccCTF;
+    } else {
+      szCTF += appendToTree(*mCTFTreeOut.get(), "CTFHeader", header);
+      mCTFTreeOut->SetEntries(++mNAccCTF);
+    }
     mAccCTFSize += szCTF;
-    mCTFTreeOut->SetEntries(++mNAccCTF);
     mTFOrbits.push_back(mTimingInfo.firstTForbit);
     LOG(info) << "TF#" << mNCTF << ": wrote CTF{" << header << "} of size " << szCTF << " to " << mCurrentCTFFileNameFull << " in " << mTimer.CpuTime() - cput << " s";
     if (mNAccCTF > 1) {
@@ -522,7 +537,7 @@ void CTFWriterSpec::run(ProcessingContext& pc)
 
     if (mAccCTFSize >= mMinSize || (mMaxCTFPerFile > 0 && mNAccCTF >= mMaxCTFPerFile)) {
       closeTFTreeAndFile();
-    } else if ((mCTFAutoSave > 0 && mNAccCTF % mCTFAutoSave == 0) || (mCTFAutoSave < 0 && int(prevSizeMB / (-mCTFAutoSave)) != size_t(mAccCTFSize / (1 << 20)) / (-mCTFAutoSave))) {
+    } else if (!mRawFileFormat && ((mCTFAutoSave > 0 && mNAccCTF % mCTFAutoSave == 0) || (mCTFAutoSave < 0 && int(prevSizeMB / (-mCTFAutoSave)) != size_t(mAccCTFSize / (1 << 20)) / (-mCTFAutoSave)))) { // raw file index is written only at closing
       mCTFTreeOut->AutoSave("override");
     }
   } else {
@@ -564,7 +579,7 @@ void CTFWriterSpec::prepareTFTreeAndFile()
     return;
   }
   bool needToOpen = false;
-  if (!mCTFTreeOut) {
+  if (!isCTFFileOpen()) {
     needToOpen = true;
   } else {
     if ((mAccCTFSize >= mMinSize) ||                                                         // min size exceeded, may close the file.
@@ -595,13 +610,18 @@ void CTFWriterSpec::prepareTFTreeAndFile()
         LOGP(info, "Created {} directory for CTFs output", ctfDir);
       }
     }
-    mCurrentCTFFileName = o2::base::NameConf::getCTFFileName(mTimingInfo.runNumber, mTimingInfo.firstTForbit, mTimingInfo.tfCounter, mHostName);
+    mCurrentCTFFileName = o2::base::NameConf::getCTFFileName(mTimingInfo.runNumber, mTimingInfo.firstTForbit, mTimingInfo.tfCounter, mHostName, "o2_ctf", mRawFileFormat ? CTFRawFile::FileExtension : std::string_view{".root"});
     mCurrentCTFFileNameFull = fmt::format("{}{}", ctfDir, mCurrentCTFFileName);
-    mCTFFileOut.reset(TFile::Open(fmt::format("{}{}", mCurrentCTFFileNameFull, TMPFileEnding).c_str(), "recreate")); // to prevent premature external usage, use temporary name
-    if (mCTFFileCompression >= 0) {
-      mCTFFileOut->SetCompressionLevel(mCTFFileCompression);
+    if (mRawFileFormat) {
+      mCTFRawOut = std::make_unique<CTFRawFileWriter>();
+      mCTFRawOut->open(fmt::format("{}{}", mCurrentCTFFileNameFull, TMPFileEnding)); // to prevent premature external usage, use temporary name
+    } else {
+      mCTFFileOut.reset(TFile::Open(fmt::format("{}{}", mCurrentCTFFileNameFull, TMPFileEnding).c_str(), "recreate")); // to prevent premature external usage, use temporary name
+      if (mCTFFileCompression >= 0) {
+        mCTFFileOut->SetCompressionLevel(mCTFFileCompression);
+      }
+      mCTFTreeOut = std::make_unique<TTree>(std::string(o2::base::NameConf::CTFTREENAME).c_str(), "O2 CTF tree");
     }
-    mCTFTreeOut = std::make_unique<TTree>(std::string(o2::base::NameConf::CTFTREENAME).c_str(), "O2 CTF tree");
 
     mNCTFFiles++;
   }
@@ -610,13 +630,18 @@ void CTFWriterSpec::prepareTFTreeAndFile()
 //___________________________________________________________________
 void CTFWriterSpec::closeTFTreeAndFile()
 {
-  if (mCTFTreeOut) {
+  if (isCTFFileOpen()) {
     try {
-      mCTFFileOut->cd();
-      mCTFTreeOut->Write();
-      mCTFTreeOut.reset();
-      mCTFFileOut->Close();
-      mCTFFileOut.reset();
+      if (mCTFRawOut) {
+        mCTFRawOut->close(); // writes the index
+        mCTFRawOut.reset();
+      } else {
+        mCTFFileOut->cd();
+        mCTFTreeOut->Write();
+        mCTFTreeOut.reset();
+        mCTFFileOut->Close();
+        mCTFFileOut.reset();
+      }
       // write CTF file metaFile data
       auto actualFileName = TMPFileEnding.empty() ? mCurrentCTFFileNameFull : o2::utils::Str::concat_string(mCurrentCTFFileNameFull, TMPFileEnding);
       if (mStoreMetaFile) {
@@ -817,6 +842,7 @@ DataProcessorSpec getCTFWriterSpec(DetID::mask_t dets, const std::string& outTyp
             {"max-ctf-per-file", VariantType::Int, 0, {"if > 0, avoid storing more than requested CTFs per file"}},
             {"ctf-rejection", VariantType::Int, 0, {">0: percentage to reject randomly, <0: reject if timeslice%|value|!=0"}},
             {"ctf-file-compression", VariantType::Int, 0, {"if >= 0: impose CTF file compression level"}},
+            {"ctf-file-format", VariantType::String, "root", {"CTF file format: root (tree) or raw (flat images with index, read via mmap)"}},
             {"require-free-disk", VariantType::Float, 0.f, {"pause writing op. if available disk space is below this margin, in bytes if >0, as a fraction of total if <0"}},
             {"wait-for-free-disk", VariantType::Float, 10.f, {"if paused due to the low disk space, recheck after this time (in s)"}},
             {"max-wait-for-free-disk", VariantType::Float, 60.f, {"produce fatal if paused due to the low disk space for more than this amount in s."}},
@@ -20,9 +20,11 @@
 #include <iterator>
 #include <string>
 #include <cassert>
+#include <functional>
 #include <tuple>
 #include <type_traits>
 #include <typeinfo>
+#include <utility>
 #include <vector>
 #include "DataFormatsTPC/CTF.h"
 #include "DataFormatsTPC/CompressedClusters.h"
@@ -230,20 +232,30 @@ o2::ctf::CTFIOSize CTFCoder::encode(VEC& buff, const CompressedClusters& ccl, co
   ec->setANSHeader(mANSVersion);
 
   o2::ctf::CTFIOSize iosize;
-  auto encodeTPC = [&buff, &optField, &coders = mCoders, mfc = this->getMemMarginFactor(), &iosize](auto begin, auto end, CTF::Slots slot, size_t probabilityBits, std::vector<bool>* reject = nullptr) {
-    // at every encoding the buffer might be autoexpanded, so we don't work with fixed pointer ec
+  // with multiple threads every block is encoded to its own scratch container and then copied to the output
+  using scratch_t = std::vector<typename VEC::value_type>;
+  std::vector<std::pair<int, std::function<o2::ctf::CTFIOSize(scratch_t&)>>> jobs;
+  auto encodeTPC = [this, &buff, &optField, &coders = mCoders, mfc = this->getMemMarginFactor(), &iosize, &jobs, nThreads = getNThreads()](auto begin, auto end, CTF::Slots slot, size_t probabilityBits, std::vector<bool>* reject = nullptr) {
     const auto slotVal = static_cast<int>(slot);
-    if (reject && begin != end) {
-      std::vector<std::decay_t<decltype(*begin)>> tmp;
-      tmp.reserve(std::distance(begin, end));
-      for (auto i = begin; i != end; i++) {
-        if (!(*reject)[std::distance(begin, i)]) {
-          tmp.emplace_back(*i);
+    const auto opt = getOptStore(optField[slotVal]);
+    auto job = [opt, &coders, mfc, begin, end, slotVal, probabilityBits, reject](auto& dest) {
+      // at every encoding the buffer might be autoexpanded, so we don't work with fixed pointer ec
+      if (reject && begin != end) {
+        std::vector<std::decay_t<decltype(*begin)>> tmp;
+        tmp.reserve(std::distance(begin, end));
+        for (auto i = begin; i != end; i++) {
+          if (!(*reject)[std::distance(begin, i)]) {
+            tmp.emplace_back(*i);
+          }
         }
+        return CTF::get(dest.data())->encode(tmp.begin(), tmp.end(), slotVal, probabilityBits, opt, &dest, coders[slotVal], mfc);
       }
-      iosize += CTF::get(buff.data())->encode(tmp.begin(), tmp.end(), slotVal, probabilityBits, optField[slotVal], &buff, coders[slotVal], mfc);
+      return CTF::get(dest.data())->encode(begin, end, slotVal, probabilityBits, opt, &dest, coders[slotVal], mfc);
+    };
+    if (nThreads > 1) {
+      jobs.emplace_back(slotVal, job);
     } else {
-      iosize += CTF::get(buff.data())->encode(begin, end, slotVal, probabilityBits, optField[slotVal], &buff, coders[slotVal], mfc);
+      iosize += job(buff);
     }
   };
 
@@ -314,6 +326,19 @@ o2::ctf::CTFIOSize CTFCoder::encode(VEC& buff, const CompressedClusters& ccl, co
   encodeTPC(trigComp.deltaBC.begin(), trigComp.deltaBC.end(), CTF::BLCTrigBCInc, 0);
   encodeTPC(trigComp.triggerType.begin(), trigComp.triggerType.end(), CTF::BLCTrigType, 0);
 
+  if (!jobs.empty()) {
+    std::vector<scratch_t> scratch(jobs.size());
+    std::vector<o2::ctf::CTFIOSize> jobsIOSize(jobs.size());
+    runBlockJobs(jobs.size(), [&](size_t i) {
+      CTF::createForSlot(scratch[i], jobs[i].first, mANSVersion);
+      jobsIOSize[i] = jobs[i].second(scratch[i]);
+    });
+    for (size_t i = 0; i < jobs.size(); i++) { // blocks must be filled in the order of their slots
+      CTF::get(buff.data())->copyBlock(*CTF::get(scratch[i].data()), jobs[i].first, &buff);
+      iosize += jobsIOSize[i];
+    }
+  }
+
   CTF::get(buff.data())->print(getPrefix(), mVerbosity);
   finaliseCTFOutput<CTF>(buff);
   iosize.rawIn = iosize.ctfIn;
@@ -344,10 +369,12 @@ o2::ctf::CTFIOSize CTFCoder::decode(const CTF::base& ec, VEC& buffVec, TRIGVEC&
   ec.print(getPrefix(), mVerbosity);
 
   // decode encoded data directly to destination buff
+  // the blocks are decoded to distinct destinations, so with multiple threads they are decoded concurrently
   o2::ctf::CTFIOSize iosize;
-  auto decodeTPC = [&ec, &coders = mCoders, &iosize](auto begin, CTF::Slots slot) {
+  std::vector<std::function<o2::ctf::CTFIOSize()>> jobs;
+  auto decodeTPC = [&ec, &coders = mCoders, &jobs](auto begin, CTF::Slots slot) {
     const auto slotVal = static_cast<int>(slot);
-    iosize += ec.decode(begin, slotVal, coders[slotVal]);
+    jobs.emplace_back([&ec, &coders, begin, slotVal]() { return ec.decode(begin, slotVal, coders[slotVal]); });
   };
 
   if (mCombineColumns) {
@@ -408,6 +435,11 @@ o2::ctf::CTFIOSize CTFCoder::decode(const CTF::base& ec, VEC& buffVec, TRIGVEC&
   decodeTPC(trigInfo.deltaOrbit.data(), CTF::BLCTrigOrbitInc);
   decodeTPC(trigInfo.deltaBC.data(), CTF::BLCTrigBCInc);
   decodeTPC(trigInfo.triggerType.data(), CTF::BLCTrigType);
+  std::vector<o2::ctf::CTFIOSize> jobsIOSize(jobs.size());
+  runBlockJobs(jobs.size(), [&](size_t i) { jobsIOSize[i] = jobs[i](); });
+  for (const auto& sz : jobsIOSize) {
+    iosize += sz;
+  }
   // convert trigger info to output format
   uint32_t prevOrbit = header.firstOrbitTrig;
   uint16_t prevBC = 0;
@@ -78,6 +78,8 @@ void EntropyEncoderSpec::init(o2::framework::InitContext& ic)
   }
 
   mNThreads = ic.options().get<unsigned int>("nThreads-tpc-encoder");
+  // the same threads count is used for the cluster selection and then for the entropy coding of the CTF blocks
+  mCTFCoder.setNThreads(mNThreads);
   mMaxZ = ic.options().get<float>("irframe-clusters-maxz");
   mMaxEta = ic.options().get<float>("irframe-clusters-maxeta");
 
@@ -332,7 +334,8 @@ DataProcessorSpec getEntropyEncoderSpec(bool inputFromFile, bool selIR)
             {"irframe-clusters-maxeta", VariantType::Float, 1.5f, {"Max eta for non-assigned clusters"}},
             {"irframe-clusters-maxz", VariantType::Float, 25.f, {"Max z for non assigned clusters (combined with maxeta)"}},
             {"mem-factor", VariantType::Float, 1.f, {"Memory allocation margin factor"}},
-            {"nThreads-tpc-encoder", VariantType::UInt32, 1u, {"number of threads to use for decoding"}},
+            {"nThreads-tpc-encoder", VariantType::UInt32, 1u, {"number of threads to use for the clusters selection and for the encoding of the CTF blocks"}},
+            {"ctf-adaptive", VariantType::Bool, false, {"choose the codec of each entropy coded block from a sample of its data (w/o external dictionary only)"}},
             {"ans-version", VariantType::String, {"version of ans entropy coder implementation to use"}}}};
 }
 
@@ -11,16 +11,20 @@
 
 #include <map>
 #include <list>
+#include <vector>
 #include <fstream>
+#include <future>
 #include <getopt.h>
 
 #include "TSystem.h"
+#include "TROOT.h"
 #include "TFile.h"
 #include "TTree.h"
 #include "TList.h"
 #include "TKey.h"
 #include "TDirectory.h"
 #include "TObjString.h"
+#include "TNamed.h"
 #include <TGrid.h>
 #include <TMap.h>
 #include <TLeaf.h>
@@ -40,6 +44,9 @@ int main(int argc, char* argv[])
   int verbosity = 2;
   int exitCode = 0; // 0: success, >0: failure
   int compression = 505;
+  int threads = 1;
+  long maxMemory = 0;
+  bool allowFastCopy = true;
 
   int option_index = 0;
   static struct option long_options[] = {
@@ -49,6 +56,9 @@ int main(int argc, char* argv[])
     {"skip-non-existing-files", no_argument, nullptr, 3},
     {"skip-parent-files-list", no_argument, nullptr, 4},
     {"compression", required_argument, nullptr, 5},
+    {"threads", required_argument, nullptr, 6},
+    {"max-memory", required_argument, nullptr, 7},
+    {"no-fast-copy", no_argument, nullptr, 8},
     {"verbosity", required_argument, nullptr, 'v'},
     {"help", no_argument, nullptr, 'h'},
     {nullptr, 0, nullptr, 0}};
@@ -69,6 +79,12 @@ int main(int argc, char* argv[])
       skipParentFilesList = true;
     } else if (c == 5) {
       compression = atoi(optarg);
+    } else if (c == 6) {
+      threads = atoi(optarg);
+    } else if (c == 7) {
+      maxMemory = atol(optarg);
+    } else if (c == 8) {
+      allowFastCopy = false;
     } else if (c == 'v') {
       verbosity = atoi(optarg);
     } else if (c == 'h') {
@@ -79,6 +95,9 @@ int main(int argc, char* argv[])
       printf("  --skip-non-existing-files    Flag to allow skipping of non-existing files in the input list.\n");
       printf("  --skip-parent-files-list     Flag to allow skipping the merging of the parent files list.\n");
       printf("  --compression <root compression id>  Compression algorithm / level to use (default: %d)\n", compression);
+      printf("  --threads <n>                Threads used to (de)compress the baskets and open the next input file in advance. Default: %d\n", threads);
+      printf("  --max-memory <size in Bytes> Memory budget for the read cache and the output baskets. Default: %ld (no limit)\n", maxMemory);
+      printf("  --no-fast-copy               Rewrite all the trees entry by entry, instead of copying the compressed baskets of the trees without index columns.\n");
       printf("  --verbosity <flag>           Verbosity of output (default: %d).\n", verbosity);
       return -1;
     } else {
@@ -90,44 +109,93 @@ int main(int argc, char* argv[])
   printf("  Input file: %s\n", inputCollection.c_str());
   printf("  Output file name: %s\n", outputFileName.c_str());
   printf("  Maximal folder size (uncompressed): %ld\n", maxDirSize);
+  printf("  Threads: %d\n", threads);
+  if (maxMemory > 0) {
+    printf("  Memory budget: %ld\n", maxMemory);
+  }
+  if (!allowFastCopy) {
+    printf("  Fast copy disabled\n");
+  }
   if (skipNonExistingFiles) {
     printf("  WARNING: Skipping non-existing files.\n");
   }
 
+  if (threads > 1) {
+    // baskets are unzipped in parallel in GetEntry and zipped in parallel when flushed by Fill
+    ROOT::EnableImplicitMT(threads);
+  }
+  // a quarter of the budget for the read cache, the rest for the baskets of the output trees
+  long readCacheSize = maxMemory / 4;
+  long outputBasketsMemory = maxMemory - readCacheSize;
+
   std::map<std::string, TTree*> trees;
   std::map<std::string, uint64_t> sizeCompressed;
   std::map<std::string, uint64_t> sizeUncompressed;
   std::map<std::string, int> offsets;
   std::map<std::string, int> unassignedIndexOffset;
+  // last value written to the delta encoded index columns, by tree and branch
+  std::map<std::string, uint32_t> deltaOutputs;
+  // the chains of the delta encoded columns continue in the next dataframe,
+  // store where they stopped like the writer does
+  auto storeDeltaOutputs = [&deltaOutputs](std::string const& treeName, TTree* tree) {
+    for (auto const& [name, value] : deltaOutputs) {
+      if (name.compare(0, treeName.size() + 1, treeName + "/") != 0) {
+        continue;
+      }
+      auto* entry = (TNamed*)tree->GetUserInfo()->FindObject(Form("columnCodec_%s", name.c_str() + treeName.size() + 1));
+      if (entry != nullptr) {
+        entry->SetTitle(Form("delta %u", value));
+      }
+    }
+  };
 
   auto outputFile = TFile::Open(outputFileName.c_str(), "RECREATE", "", compression);
   TDirectory* outputDir = nullptr;
   long currentDirSize = 0;
 
+  std::vector<TString> inputFiles;
   std::ifstream in;
   in.open(inputCollection);
   TString line;
   bool connectedToAliEn = false;
-  TMap* metaData = nullptr;
-  TMap* parentFiles = nullptr;
-  int totalMergedDFs = 0;
-  int mergedDFs = 0;
-  while (in.good() && exitCode == 0) {
+  while (in.good()) {
     in >> line;
-
     if (line.Length() == 0) {
       continue;
     }
-
     if (line.BeginsWith("alien:") && !connectedToAliEn) {
       printf("Connecting to AliEn...");
       TGrid::Connect("alien:");
       connectedToAliEn = true; // Only try once
     }
+    inputFiles.push_back(line);
+  }
+
+  // the next input file is opened while the current one is merged, at most one file is kept open in advance
+  auto openInputFile = [](TString const& fileName) { return TFile::Open(fileName); };
+  std::future<TFile*> nextInputFile;
+  if (threads > 1 && !inputFiles.empty()) {
+    nextInputFile = std::async(std::launch::async, openInputFile, inputFiles[0]);
+  }
+
+  TMap* metaData = nullptr;
+  TMap* parentFiles = nullptr;
+  int totalMergedDFs = 0;
+  int mergedDFs = 0;
+  for (size_t fileIndex = 0; fileIndex < inputFiles.size() && exitCode == 0; ++fileIndex) {
+    line = inputFiles[fileIndex];
 
     printf("Processing input file: %s\n", line.Data());
 
-    auto inputFile = TFile::Open(line);
+    TFile* inputFile = nullptr;
+    if (nextInputFile.valid()) {
+      inputFile = nextInputFile.get();
+      if (fileIndex + 1 < inputFiles.size()) {
+        nextInputFile = std::async(std::launch::async, openInputFile, inputFiles[fileIndex + 1]);
+      }
+    } else {
+      inputFile = openInputFile(line);
+    }
     if (!inputFile) {
       printf("Error: Could not open input file %s.\n", line.Data());
       if (skipNonExistingFiles) {
@@ -226,7 +294,12 @@ int main(int argc, char* argv[])
         foundTrees.push_back(treeName);
 
         auto inputTree = (TTree*)inputFile->Get(Form("%s/%s", dfName, treeName));
-        bool fastCopy = (inputTree->GetTotBytes() > 10000000); // Only do this for large enough trees to avoid that baskets are too small
+        if (readCacheSize > 0) {
+          inputTree->SetCacheSize(readCacheSize);
+        }
+        // The compressed baskets are copied as they are (TTreeCloner) when the tree has the same branches as the output tree.
+        // This is done for the first dataframe of a folder, and for the following ones when no index needs to be rewritten.
+        bool fastCopy = allowFastCopy && (trees.count(treeName) == 0 || (!hasIndexColumns(inputTree) && hasSameBranches(inputTree, trees[treeName])));
         if (verbosity > 1) {
           printf("    Processing tree %s with %lld entries with total size %lld (fast copy: %d)\n", treeName, inputTree->GetEntries(), inputTree->GetTotBytes(), fastCopy);
         }
@@ -252,6 +325,10 @@ int main(int argc, char* argv[])
           currentDirSize += inputTree->GetTotBytes(); // NOTE outputTree->GetTotBytes() is 0, so we use the inputTree here
           alreadyCopied = true;
           outputTree->SetAutoFlush(0);
+          if (outputBasketsMemory > 0) {
+            // the baskets of all the trees of the folder are kept in memory until they are full
+            outputTree->OptimizeBaskets(outputBasketsMemory / treeList->GetEntries(), 1.1, "");
+          }
           trees[treeName] = outputTree;
         } else {
           // adjust addresses tree
@@ -261,8 +338,16 @@ int main(int argc, char* argv[])
         auto outputTree = trees[treeName];
         // register index and connect VLA columns
         std::vector<std::pair<int*, int>> indexList;
+        // index columns written as the difference to the previous entry, see TableToTree
+        struct DeltaIndex {
+          int* buffer;
+          uint32_t input;
+          uint32_t* output;
+        };
+        std::vector<DeltaIndex> deltaIndices;
         std::vector<char*> vlaPointers;
         std::vector<int*> indexPointers;
+        std::vector<std::string> indexBranches;
         TObjArray* branches = inputTree->GetListOfBranches();
         for (int i = 0; i < branches->GetEntriesFast(); ++i) {
           TBranch* br = (TBranch*)branches->UncheckedAt(i);
@@ -288,6 +373,8 @@ int main(int argc, char* argv[])
             outputTree->SetBranchAddress(br->GetName(), buffer);
 
             if (branchName.BeginsWith("fIndexArray")) {
+              indexBranches.push_back(br->GetName());
+              indexBranches.push_back(((TLeaf*)br->GetListOfLeaves()->First())->GetLeafCount()->GetBranch()->GetName());
               for (int i = 0; i < maximum; i++) {
                 indexList.push_back({reinterpret_cast<int*>(buffer + i * typeSize), offsets[getTableName(branchName, treeName)]});
               }
@@ -299,6 +386,7 @@ int main(int argc, char* argv[])
 
             inputTree->SetBranchAddress(br->GetName(), buffer);
             outputTree->SetBranchAddress(br->GetName(), buffer);
+            indexBranches.push_back(br->GetName());
 
             indexList.push_back({buffer, offsets[getTableName(branchName, treeName)]});
             indexList.push_back({buffer + 1, offsets[getTableName(branchName, treeName)]});
@@ -309,20 +397,44 @@ int main(int argc, char* argv[])
 
             inputTree->SetBranchAddress(br->GetName(), buffer);
             outputTree->SetBranchAddress(br->GetName(), buffer);
+            indexBranches.push_back(br->GetName());
 
             indexList.push_back({buffer, offsets[getTableName(branchName, treeName)]});
+            if (isDeltaEncoded(inputTree, br->GetName())) {
+              deltaIndices.push_back({buffer, 0, &deltaOutputs[std::string(treeName) + "/" + br->GetName()]});
+            }
+          } else if (isDeltaEncoded(inputTree, br->GetName())) {
+            printf("    *** FATAL ***: The branch %s of tree %s is delta encoded, which is only supported for the index columns\n", br->GetName(), treeName);
+            exitCode = 6;
           }
         }
 
         if (indexList.size() > 0) {
           auto entries = inputTree->GetEntries();
           int minIndexOffset = unassignedIndexOffset[treeName];
+          // The index branches share their entries with the other branches of the tree, so the baskets
+          // cannot be copied once the indices are shifted, i.e. for all but the first dataframe of a folder.
+          // Those trees are rewritten entry by entry, with the (de)compression spread over the IMT threads.
+          if (alreadyCopied) {
+            // we only need to read the index columns to find the unassigned indices
+            inputTree->SetBranchStatus("*", false);
+            for (auto const& name : indexBranches) {
+              inputTree->SetBranchStatus(name.c_str(), true);
+            }
+          }
           auto newMinIndexOffset = minIndexOffset;
           for (int i = 0; i < entries; i++) {
             for (auto& index : indexList) {
               *(index.first) = 0; // Any positive number will do, in any case it will not be filled in the output. Otherwise the previous entry is used and manipulated in the following.
             }
             inputTree->GetEntry(i);
+            for (auto& delta : deltaIndices) {
+              delta.input += (uint32_t)*delta.buffer;
+              *delta.buffer = (int)delta.input;
+              if (alreadyCopied) {
+                *delta.output = delta.input;
+              }
+            }
             // shift index columns by offset
             for (const auto& idx : indexList) {
               // if negative, the index is unassigned. In this case, the different unassigned blocks have to get unique negative IDs
@@ -334,6 +446,11 @@ int main(int argc, char* argv[])
               }
             }
             if (!alreadyCopied) {
+              for (auto& delta : deltaIndices) {
+                auto value = (uint32_t)*delta.buffer;
+                *delta.buffer = (int)(value - *delta.output);
+                *delta.output = value;
+              }
               int nbytes = outputTree->Fill();
               if (nbytes > 0) {
                 currentDirSize += nbytes;
@@ -400,6 +517,7 @@ int main(int argc, char* argv[])
         for (auto const& tree : trees) {
           // printf("Writing %s\n", tree.first.c_str());
           outputDir->cd();
+          storeDeltaOutputs(tree.first, tree.second);
           tree.second->Write();
 
           // stats
@@ -411,6 +529,7 @@ int main(int argc, char* argv[])
         outputDir = nullptr;
         trees.clear();
         offsets.clear();
+        deltaOutputs.clear();
         mergedDFs = 0;
       }
     }
@@ -424,6 +543,7 @@ int main(int argc, char* argv[])
 
   for (auto const& tree : trees) {
     outputDir->cd();
+    storeDeltaOutputs(tree.first, tree.second);
     tree.second->Write();
 
     // stats
@@ -10,6 +10,9 @@
 // or submit itself to any jurisdiction.
 
 #include <TString.h>
+#include <TTree.h>
+#include <TList.h>
+#include <cstring>
 
 const char* removeVersionSuffix(const char* treeName)
 {
@@ -49,3 +52,40 @@ const char* getTableName(const char* branchName, const char* treeName)
   // printf("%s --> %s\n", branchName, tableName.Data());
   return tableName;
 }
+
+bool isDeltaEncoded(TTree* tree, const char* branchName)
+{
+  // columns written as the difference to the previous entry (see TableToTree) are stored
+  // in a branch named <column>_delta, with the codec and the last value in the user info
+  return tree->GetUserInfo()->FindObject(Form("columnCodec_%s", branchName)) != nullptr;
+}
+
+bool hasIndexColumns(TTree* tree)
+{
+  // index columns need to be rewritten when merging, see getTableName for their names
+  auto branches = tree->GetListOfBranches();
+  for (int i = 0; i < branches->GetEntriesFast(); ++i) {
+    if (TString(branches->UncheckedAt(i)->GetName()).BeginsWith("fIndex")) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool hasSameBranches(TTree* tree, TTree* other)
+{
+  // the baskets of a tree can only be copied as they are to a tree with the same branches,
+  // the title of a branch holding the types and sizes of its leaves
+  auto branches = tree->GetListOfBranches();
+  if (branches->GetEntriesFast() != other->GetListOfBranches()->GetEntriesFast()) {
+    return false;
+  }
+  for (int i = 0; i < branches->GetEntriesFast(); ++i) {
+    auto branch = (TBranch*)branches->UncheckedAt(i);
+    auto otherBranch = other->GetBranch(branch->GetName());
+    if (otherBranch == nullptr || strcmp(branch->GetTitle(), otherBranch->GetTitle()) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
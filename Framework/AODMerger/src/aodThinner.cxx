@@ -10,6 +10,7 @@
 // or submit itself to any jurisdiction.
 
 #include <unordered_map>
+#include <string>
 #include <getopt.h>
 
 #include "TSystem.h"
@@ -26,6 +27,7 @@
 #include "TGrid.h"
 #include "TMap.h"
 #include "TLeaf.h"
+#include "TNamed.h"
 
 #include "aodMerger.h"
 
@@ -283,7 +285,10 @@ int main(int argc, char* argv[])
     }
 
     int fIndexCollisions = 0;
-    track_iu->SetBranchAddress("fIndexCollisions", &fIndexCollisions);
+    // the collision index may be written as the difference to the previous track
+    bool collisionsDelta = isDeltaEncoded(track_iu, "fIndexCollisions_delta");
+    uint32_t collisionIndex = 0;
+    track_iu->SetBranchAddress(collisionsDelta ? "fIndexCollisions_delta" : "fIndexCollisions", &fIndexCollisions);
 
     // loop over all tracks
     auto entries = trackExtraTree->GetEntries();
@@ -291,6 +296,10 @@ int main(int argc, char* argv[])
     for (int i = 0; i < entries; i++) {
       trackExtraTree->GetEntry(i);
       track_iu->GetEntry(i);
+      if (collisionsDelta) {
+        collisionIndex += (uint32_t)fIndexCollisions;
+        fIndexCollisions = (int)collisionIndex;
+      }
 
       // Flag collisions
       hasCollision[i] = (fIndexCollisions >= 0);
@@ -324,6 +333,15 @@ int main(int argc, char* argv[])
       outputTree->SetAutoFlush(0);
 
       std::vector<int*> indexList;
+      // index columns written as the difference to the previous entry, see TableToTree.
+      // They are decoded when read and encoded again for the entries which are kept.
+      struct DeltaIndex {
+        std::string branchName;
+        int* buffer;
+        uint32_t input;
+        uint32_t output;
+      };
+      std::vector<DeltaIndex> deltaIndices;
       std::vector<char*> vlaPointers;
       std::vector<int*> indexPointers;
       TObjArray* branches = inputTree->GetListOfBranches();
@@ -331,8 +349,14 @@ int main(int argc, char* argv[])
         TBranch* br = (TBranch*)branches->UncheckedAt(i);
         TString branchName(br->GetName());
         TString tableName(getTableName(branchName, treeName.Data()));
-        // register index of track index ONLY
-        if (!tableName.EqualTo("O2track")) {
+        bool deltaEncoded = isDeltaEncoded(inputTree, br->GetName());
+        if (deltaEncoded && (!branchName.BeginsWith("fIndex") || branchName.BeginsWith("fIndexSlice") || branchName.BeginsWith("fIndexArray"))) {
+          printf("  *** FATAL ***: The branch %s of tree %s is delta encoded, which is only supported for the index columns\n", br->GetName(), treeName.Data());
+          exitCode = 11;
+          continue;
+        }
+        // register index of track index ONLY, and the delta encoded indices
+        if (!tableName.EqualTo("O2track") && !deltaEncoded) {
           continue;
         }
         // detect VLA
@@ -356,9 +380,17 @@ int main(int argc, char* argv[])
           inputTree->SetBranchAddress(br->GetName(), buffer);
           outputTree->SetBranchAddress(br->GetName(), buffer);
 
-          indexList.push_back(buffer);
+          if (tableName.EqualTo("O2track")) {
+            indexList.push_back(buffer);
+          }
+          if (deltaEncoded) {
+            deltaIndices.push_back({br->GetName(), buffer, 0, 0});
+          }
         }
       }
+      if (exitCode > 0) {
+        break;
+      }
 
       const bool processingTracked = treeName.BeginsWith("O2tracked");
       const bool processingTrackQA = treeName.BeginsWith("O2trackqa");
@@ -368,6 +400,10 @@ int main(int argc, char* argv[])
       auto entries = inputTree->GetEntries();
       for (int i = 0; i < entries; i++) {
         inputTree->GetEntry(i);
+        for (auto& delta : deltaIndices) {
+          delta.input += (uint32_t)*delta.buffer;
+          *delta.buffer = (int)delta.input;
+        }
         bool fillThisEntry = true;
         // Special case for Tracks, TracksExtra, TracksCov
         if (processingTracks) {
@@ -398,9 +434,21 @@ int main(int argc, char* argv[])
         }
 
         if (fillThisEntry) {
+          for (auto& delta : deltaIndices) {
+            auto value = (uint32_t)*delta.buffer;
+            *delta.buffer = (int)(value - delta.output);
+            delta.output = value;
+          }
           outputTree->Fill();
         }
       }
+      // the chains of the delta encoded columns stop at the last entry kept
+      for (auto const& delta : deltaIndices) {
+        auto* entry = (TNamed*)outputTree->GetUserInfo()->FindObject(Form("columnCodec_%s", delta.branchName.c_str()));
+        if (entry != nullptr) {
+          entry->SetTitle(Form("delta %u", delta.output));
+        }
+      }
 
       if (entries != outputTree->GetEntries()) {
         printf("      Reduced from %lld to %lld entries\n", entries, outputTree->GetEntries());
@@ -0,0 +1,16 @@
+#!/bin/sh -e
+# The output of the merger must not depend on the threads, the memory budget and the fast copy of the baskets.
+# Usage: test_aodMerger.sh <directory of the test macros>
+MACROS=$1
+for i in 1 2 3; do
+  root.exe -b -q -l "${MACROS}/createAODMergerInput.C(\"input_${i}.root\", 2, $((10 * i)), ${i})" > /dev/null
+  echo input_${i}.root
+done > input.txt
+
+o2-aod-merger --input input.txt --output reference.root --max-size 30000000 --verbosity 0 --no-fast-copy
+for options in "" "--threads 4" "--max-memory 20000000" "--threads 4 --max-memory 20000000" "--threads 4 --max-memory 1000000"; do
+  printf "Testing %s..." "$options"
+  o2-aod-merger --input input.txt --output merged.root --max-size 30000000 --verbosity 0 $options > merger.log || { cat merger.log; exit 1; }
+  root.exe -b -q -l "${MACROS}/compareAODMergerOutput.C(\"reference.root\", \"merged.root\")" | grep -q "^0 differences" || { printf "output differs\n"; exit 1; }
+  printf "ok\n"
+done
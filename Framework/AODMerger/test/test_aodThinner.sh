@@ -0,0 +1,9 @@
+#!/bin/sh -e
+# Thinning the same data with and without delta encoded indices must give the same values.
+# Usage: test_aodThinner.sh <directory of the test macros>
+MACROS=$1
+root.exe -b -q -l "${MACROS}/createAODThinnerInput.C(\"plain.root\", false)" > /dev/null
+root.exe -b -q -l "${MACROS}/createAODThinnerInput.C(\"delta.root\", true)" > /dev/null
+o2-aod-thinner --input plain.root --output plain_thinned.root --overwrite
+o2-aod-thinner --input delta.root --output delta_thinned.root --overwrite
+root.exe -b -q -l "${MACROS}/checkAODThinnerDelta.C(\"plain_thinned.root\", \"delta_thinned.root\")" | grep -q "^0 differences" || { printf "thinned outputs differ\n"; exit 1; }
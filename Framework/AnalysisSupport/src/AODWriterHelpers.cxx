@@ -59,7 +59,19 @@ AlgorithmSpec AODWriterHelpers::getOutputTTreeWriter(ConfigContext const& ctx)
   if (ctx.options().hasOption("aod-writer-compression")) {
     compressionLevel = ctx.options().get<int>("aod-writer-compression");
   }
-  return AlgorithmSpec{[dod, outputInputs = ac.outputsInputsAOD, compressionLevel](InitContext& ic) -> std::function<void(ProcessingContext&)> {
+  bool sliceIndices = false;
+  if (ctx.options().hasOption("aod-writer-slice-index")) {
+    sliceIndices = ctx.options().get<bool>("aod-writer-slice-index");
+  }
+  bool columnRanges = false;
+  if (ctx.options().hasOption("aod-writer-column-ranges")) {
+    columnRanges = ctx.options().get<bool>("aod-writer-column-ranges");
+  }
+  bool columnCodecs = false;
+  if (ctx.options().hasOption("aod-writer-column-codecs")) {
+    columnCodecs = ctx.options().get<bool>("aod-writer-column-codecs");
+  }
+  return AlgorithmSpec{[dod, outputInputs = ac.outputsInputsAOD, compressionLevel, sliceIndices, columnRanges, columnCodecs](InitContext& ic) -> std::function<void(ProcessingContext&)> {
     LOGP(debug, "======== getGlobalAODSink::Init ==========");
 
     // find out if any table needs to be saved
@@ -101,7 +113,7 @@ AlgorithmSpec AODWriterHelpers::getOutputTTreeWriter(ConfigContext const& ctx)
     std::vector<TString> aodMetaDataVals;
 
     // this functor is called once per time frame
-    return [dod, tfNumbers, tfFilenames, aodMetaDataKeys, aodMetaDataVals, compressionLevel](ProcessingContext& pc) mutable -> void {
+    return [dod, tfNumbers, tfFilenames, aodMetaDataKeys, aodMetaDataVals, compressionLevel, sliceIndices, columnRanges, columnCodecs](ProcessingContext& pc) mutable -> void {
       LOGP(debug, "======== getGlobalAODSink::processing ==========");
       LOGP(debug, " processing data set with {} entries", pc.inputs().size());
 
@@ -200,6 +212,15 @@ AlgorithmSpec AODWriterHelpers::getOutputTTreeWriter(ConfigContext const& ctx)
           TableToTree ta2tr(table,
                             fileAndFolder.file,
                             treename.c_str());
+          if (sliceIndices) {
+            ta2tr.enableSliceIndices();
+          }
+          if (columnRanges) {
+            ta2tr.enableColumnRanges();
+          }
+          if (columnCodecs) {
+            ta2tr.enableColumnCodecs();
+          }
 
           // update metadata
           if (fileAndFolder.file->FindObjectAny("metaData")) {
@@ -13,6 +13,7 @@
 #include "Framework/Plugins.h"
 #include "Framework/Signpost.h"
 #include "Framework/Endian.h"
+#include "Framework/TableTreeHelpers.h"
 #include <arrow/dataset/file_base.h>
 #include <arrow/util/key_value_metadata.h>
 #include <arrow/array/array_nested.h>
@@ -271,7 +272,7 @@ arrow::Result<arrow::RecordBatchGenerator> TTreeFileFormat::ScanBatchesAsync(
     for (auto& field : fields) {
       // The field actually on disk
       auto physicalField = physical_schema->GetFieldByName(field->name());
-      TBranch* branch = tree->GetBranch(physicalField->name().c_str());
+      TBranch* branch = columnBranch(tree.get(), physicalField->name());
       assert(branch);
       buffer.Reset();
       auto totalEntries = branch->GetEntries();
@@ -412,6 +413,9 @@ arrow::Result<arrow::RecordBatchGenerator> TTreeFileFormat::ScanBatchesAsync(
         if (listSize >= 1) {
           totalSize = readEntries * listSize;
         }
+        if (listSize == 1) {
+          decodeColumn(tree.get(), branch->GetName(), arrowValuesBuffer->mutable_data(), readEntries, typeSize);
+        }
         std::shared_ptr<arrow::PrimitiveArray> varray;
         switch (listSize) {
           case -1:
@@ -557,6 +561,7 @@ arrow::Result<std::shared_ptr<arrow::Schema>> TTreeFileFormat::Inspect(const arr
       name.erase(pos);
       branchInfos.emplace_back(BranchInfo{name, (TBranch*)nullptr, true});
     } else {
+      name = columnName(branch);
       auto lookup = std::find_if(branchInfos.begin(), branchInfos.end(), [&](BranchInfo const& bi) {
         return bi.name == name;
       });
@@ -578,7 +583,7 @@ arrow::Result<std::shared_ptr<arrow::Schema>> TTreeFileFormat::Inspect(const arr
     if (!bi.mVLA) {
       listSize = static_cast<TLeaf*>(bi.ptr->GetListOfLeaves()->At(0))->GetLenStatic();
     }
-    auto field = std::make_shared<arrow::Field>(bi.ptr->GetName(), arrowTypeFromROOT(type, listSize));
+    auto field = std::make_shared<arrow::Field>(bi.name, arrowTypeFromROOT(type, listSize));
     fields.push_back(field);
 
     tree->AddBranchToCache(bi.ptr);
@@ -26,6 +26,7 @@
 #include <arrow/table.h>
 #include <arrow/array.h>
 #include <arrow/util/config.h>
+#include <arrow/util/key_value_metadata.h>
 #include <gandiva/selection_vector.h>
 #include <array>
 #include <cassert>
@@ -642,6 +643,35 @@ class ColumnIterator : ChunkingPolicy
   }
 };
 
+/// Encoding applied to the values of a column when it is written to file,
+/// on top of the compression of the file itself. Columns are annotated
+/// with DECLARE_SOA_COLUMN_CODEC, and the annotation is passed along to the
+/// writer in the metadata of the arrow field, under columnCodecKey.
+enum class ColumnCodec : uint8_t {
+  None,
+  /// Difference to the value of the previous row, for integral columns
+  /// whose values increase slowly, like the sorted index columns.
+  Delta
+};
+
+static constexpr char const* columnCodecKey = "codec";
+
+constexpr char const* columnCodecName(ColumnCodec codec)
+{
+  switch (codec) {
+    case ColumnCodec::Delta:
+      return "delta";
+    default:
+      return "none";
+  }
+}
+
+/// Fallback for the columns without a DECLARE_SOA_COLUMN_CODEC annotation
+constexpr ColumnCodec columnCodec(void const*)
+{
+  return ColumnCodec::None;
+}
+
 template <typename T, typename INHERIT>
 struct Column {
   using inherited_t = INHERIT;
@@ -659,6 +689,7 @@ struct Column {
 
   using type = T;
   static constexpr const char* const& columnLabel() { return INHERIT::mLabel; }
+  static constexpr ColumnCodec codec() { return columnCodec(static_cast<INHERIT const*>(nullptr)); }
   ColumnIterator<T> const& getIterator() const
   {
     return mColumnIterator;
@@ -666,7 +697,12 @@ struct Column {
 
   static auto asArrowField()
   {
-    return std::make_shared<arrow::Field>(inherited_t::mLabel, framework::expressions::concreteArrowType(framework::expressions::selectArrowType<type>()));
+    auto field = std::make_shared<arrow::Field>(inherited_t::mLabel, framework::expressions::concreteArrowType(framework::expressions::selectArrowType<type>()));
+    if constexpr (codec() != ColumnCodec::None) {
+      return field->WithMetadata(arrow::key_value_metadata({columnCodecKey}, {columnCodecName(codec())}));
+    } else {
+      return field;
+    }
   }
 
   /// FIXME: rather than keeping this public we should have a protected
@@ -1668,6 +1704,116 @@ consteval auto computeOriginals()
   return o2::soa::mergeOriginals<Ts...>();
 }
 
+/// Columns which can be accessed in batches, i.e. the persistent ones
+/// holding plain arithmetic values. Booleans are bit packed, so they are
+/// excluded.
+template <typename C>
+concept is_batchable_column = is_persistent_column<C> && std::is_arithmetic_v<typename C::type> && !std::same_as<typename C::type, bool>;
+
+/// The values of the columns Cs... for a range of consecutive rows which
+/// lie in a single Arrow chunk of each of them, so that they can be
+/// accessed as plain contiguous spans.
+template <is_batchable_column... Cs>
+struct ColumnBatch {
+  /// Position in the table of the first row of the batch
+  int64_t offset = 0;
+  int64_t size = 0;
+  std::tuple<gsl::span<typename Cs::type const>...> values;
+
+  template <typename C>
+  [[nodiscard]] auto get() const
+  {
+    static_assert(framework::has_type<C>(framework::pack<Cs...>{}), "Column not requested for this batch");
+    return std::get<framework::has_type_at_v<C>(framework::pack<Cs...>{})>(values);
+  }
+};
+
+/// Range of the ColumnBatch covering a table, one per stretch of rows
+/// which do not cross a chunk boundary of any of the columns.
+template <is_batchable_column... Cs>
+class ColumnBatches
+{
+ public:
+  static constexpr size_t N = sizeof...(Cs);
+  struct Sentinel {
+  };
+
+  class Iterator
+  {
+   public:
+    using value_type = ColumnBatch<Cs...>;
+    using difference_type = std::ptrdiff_t;
+
+    Iterator(std::array<arrow::ChunkedArray const*, N> const& columns, int64_t rows)
+      : mColumns{columns},
+        mRows{rows}
+    {
+      next();
+    }
+
+    ColumnBatch<Cs...> const& operator*() const { return mBatch; }
+    ColumnBatch<Cs...> const* operator->() const { return &mBatch; }
+    Iterator& operator++()
+    {
+      next();
+      return *this;
+    }
+    void operator++(int) { next(); }
+    bool operator==(Sentinel) const { return mDone; }
+
+   private:
+    void next()
+    {
+      int64_t start = mBatch.offset + mBatch.size;
+      if (start >= mRows) {
+        mDone = true;
+        return;
+      }
+      int64_t size = mRows - start;
+      for (size_t ci = 0; ci < N; ++ci) {
+        // Skip to the chunk holding start, then stop at its end.
+        while (start - mChunkStart[ci] >= mColumns[ci]->chunk(mChunk[ci])->length()) {
+          mChunkStart[ci] += mColumns[ci]->chunk(mChunk[ci])->length();
+          mChunk[ci]++;
+        }
+        size = std::min(size, mChunkStart[ci] + mColumns[ci]->chunk(mChunk[ci])->length() - start);
+      }
+      mBatch.offset = start;
+      mBatch.size = size;
+      mBatch.values = [this]<size_t... Is>(std::index_sequence<Is...>) {
+        return std::make_tuple(valuesOf<Cs, Is>()...);
+      }(std::make_index_sequence<N>{});
+    }
+
+    template <typename C, size_t I>
+    gsl::span<typename C::type const> valuesOf() const
+    {
+      auto array = std::static_pointer_cast<arrow_array_for_t<typename C::type>>(mColumns[I]->chunk(mChunk[I]));
+      return {array->raw_values() + (mBatch.offset - mChunkStart[I]), static_cast<size_t>(mBatch.size)};
+    }
+
+    std::array<arrow::ChunkedArray const*, N> mColumns;
+    int64_t mRows;
+    std::array<int, N> mChunk = {};
+    std::array<int64_t, N> mChunkStart = {};
+    ColumnBatch<Cs...> mBatch;
+    bool mDone = false;
+  };
+
+  ColumnBatches(std::array<arrow::ChunkedArray const*, N> const& columns, int64_t rows)
+    : mColumns{columns},
+      mRows{rows}
+  {
+  }
+
+  Iterator begin() const { return {mColumns, mRows}; }
+  Sentinel end() const { return {}; }
+
+ private:
+  std::array<arrow::ChunkedArray const*, N> mColumns;
+  int64_t mRows;
+};
+
 /// A Table class which observes an arrow::Table and provides
 /// It is templated on a set of Column / DynamicColumn types.
 template <aod::is_aod_hash L, aod::is_aod_hash D, aod::is_origin_hash O, typename... Ts>
@@ -2099,6 +2245,28 @@ class Table
     return self_t{mTable->Slice(start, end - start + 1), start};
   }
 
+  /// Iterate on the values of the columns Cs... in batches of rows which
+  /// are contiguous in memory, so that the inner loops can be vectorised,
+  /// e.g.:
+  ///
+  ///   for (auto& batch : tracks.batches<aod::track::Pt, aod::track::Eta>()) {
+  ///     auto pt = batch.get<aod::track::Pt>();
+  ///     auto eta = batch.get<aod::track::Eta>();
+  ///     for (int64_t i = 0; i < batch.size; ++i) { ... }
+  ///   }
+  ///
+  /// Any selection of a Filtered table is ignored, hence batches are not
+  /// available for those.
+  template <is_batchable_column... Cs>
+    requires(sizeof...(Cs) > 0 && (framework::has_type<Cs>(columns_t{}) && ...))
+  auto batches() const
+  {
+    if (mTable->num_rows() == 0) {
+      return ColumnBatches<Cs...>{{}, 0};
+    }
+    return ColumnBatches<Cs...>{{getIndexFromLabel(mTable.get(), Cs::columnLabel())...}, mTable->num_rows()};
+  }
+
   auto emptySlice() const
   {
     return self_t{mTable->Slice(0, 0), 0};
@@ -2315,6 +2483,16 @@ O2HASH("TEST/0");
 #define DECLARE_SOA_COLUMN(_Name_, _Getter_, _Type_) \
   DECLARE_SOA_COLUMN_FULL(_Name_, _Getter_, _Type_, "f" #_Name_)
 
+/// Annotate the column _Name_ with the codec used to write it to file, e.g.
+/// DECLARE_SOA_COLUMN_CODEC(CollisionId, Delta) next to the declaration of
+/// an index column. It is found by argument dependent lookup, so it must be
+/// in the same namespace as the column.
+#define DECLARE_SOA_COLUMN_CODEC(_Name_, _Codec_)                            \
+  [[maybe_unused]] constexpr o2::soa::ColumnCodec columnCodec(_Name_ const*) \
+  {                                                                          \
+    return o2::soa::ColumnCodec::_Codec_;                                    \
+  }
+
 /// A 'bitmap' column, i.e. a int-based column with custom accessors to check
 /// individual bits
 #define MAKEINT(_Size_) uint##_Size_##_t
@@ -3290,6 +3468,10 @@ class FilteredBase : public T
   using unfiltered_iterator = T::template iterator_template_o<DefaultIndexPolicy, self_t>;
   using const_iterator = iterator;
 
+  /// Batches would ignore the selection.
+  template <typename... Cs>
+  auto batches() const = delete;
+
   FilteredBase(std::vector<std::shared_ptr<arrow::Table>>&& tables, gandiva::Selection const& selection, uint64_t offset = 0)
     : T{std::move(tables), offset},
       mSelectedRows{getSpan(selection)}
@@ -73,6 +73,7 @@ namespace aod
 namespace collision
 {
 DECLARE_SOA_INDEX_COLUMN(BC, bc);                              //! Most probably BC to where this collision has occured
+DECLARE_SOA_COLUMN_CODEC(BCId, Delta);
 DECLARE_SOA_COLUMN(PosX, posX, float);                         //! X Vertex position in cm
 DECLARE_SOA_COLUMN(PosY, posY, float);                         //! Y Vertex position in cm
 DECLARE_SOA_COLUMN(PosZ, posZ, float);                         //! Z Vertex position in cm
@@ -115,6 +116,7 @@ namespace track
 {
 // TRACKPAR TABLE definition
 DECLARE_SOA_INDEX_COLUMN(Collision, collision);    //! Collision to which this track belongs
+DECLARE_SOA_COLUMN_CODEC(CollisionId, Delta);
 DECLARE_SOA_COLUMN(TrackType, trackType, uint8_t); //! Type of track. See enum TrackTypeEnum. This cannot be used to decide which detector has contributed to this track. Use hasITS, hasTPC, etc.
 DECLARE_SOA_COLUMN(X, x, float);                   //!
 DECLARE_SOA_COLUMN(Alpha, alpha, float);           //!
@@ -728,6 +730,7 @@ namespace fwdtrack
 {
 // FwdTracks and MFTTracks Columns definitions
 DECLARE_SOA_INDEX_COLUMN(Collision, collision);                                              //!
+DECLARE_SOA_COLUMN_CODEC(CollisionId, Delta);
 DECLARE_SOA_COLUMN(TrackType, trackType, uint8_t);                                           //! Type of track. See enum ForwardTrackTypeEnum
 DECLARE_SOA_COLUMN(X, x, float);                                                             //! TrackParFwd parameter x
 DECLARE_SOA_COLUMN(Y, y, float);                                                             //! TrackParFwd parameter y
@@ -1730,6 +1733,7 @@ using Run2OTFV0 = Run2OTFV0s::iterator;
 namespace mccollision
 {
 DECLARE_SOA_INDEX_COLUMN(BC, bc);                            //! BC index
+DECLARE_SOA_COLUMN_CODEC(BCId, Delta);
 DECLARE_SOA_COLUMN(GeneratorsID, generatorsID, short);       //! disentangled generator IDs should be accessed using getGeneratorId, getSubGeneratorId and getSourceId
 DECLARE_SOA_COLUMN(PosX, posX, float);                       //! X vertex position in cm
 DECLARE_SOA_COLUMN(PosY, posY, float);                       //! Y vertex position in cm
@@ -1773,6 +1777,7 @@ using McCollision = McCollisions::iterator;
 namespace mcparticle
 {
 DECLARE_SOA_INDEX_COLUMN(McCollision, mcCollision);                                     //! MC collision of this particle
+DECLARE_SOA_COLUMN_CODEC(McCollisionId, Delta);
 DECLARE_SOA_COLUMN(PdgCode, pdgCode, int);                                              //! PDG code
 DECLARE_SOA_COLUMN(StatusCode, statusCode, int);                                        //! Generators status code or physics process. Do not use directly. Use dynamic columns getGenStatusCode() or getProcess()
 DECLARE_SOA_COLUMN(Flags, flags, uint8_t);                                              //! ALICE specific flags, see MCParticleFlags. Do not use directly. Use the dynamic columns, e.g. producedByGenerator()
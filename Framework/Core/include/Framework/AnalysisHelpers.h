@@ -20,12 +20,16 @@
 #include "Framework/OutputObjHeader.h"
 #include "Framework/OutputRef.h"
 #include "Framework/OutputSpec.h"
+#include "Framework/ParallelProcessing.h"
 #include "Framework/Plugins.h"
 #include "Framework/StringHelpers.h"
 #include "Framework/TableBuilder.h"
 #include "Framework/Traits.h"
 
+#include <algorithm>
 #include <string>
+#include <tuple>
+#include <vector>
 namespace o2::soa
 {
 template <TableRef R>
@@ -86,16 +90,41 @@ class TableConsumer;
 template <typename T>
 concept is_producable = soa::has_metadata<aod::MetadataTrait<T>> || soa::has_metadata<aod::MetadataTrait<typename T::parent_t>>;
 
+/// How the value of a column of type T is kept while the rows filled in a
+/// partition of processParallel() wait to be added to the table. Fixed size
+/// arrays are passed to the cursor as pointers, so their values are copied.
+template <typename T>
+struct BufferedValue {
+  using type = T;
+};
+
+template <typename T, size_t N>
+struct BufferedValue<T[N]> {
+  using type = std::array<T, N>;
+};
+
+template <typename T, size_t N>
+struct BufferedValue<std::array<T, N>> {
+  using type = std::array<T, N>;
+};
+
 template <is_producable T>
 struct WritingCursor {
  public:
   using persistent_table_t = decltype([]() { if constexpr (soa::is_iterator<T>) { return typename T::parent_t{nullptr}; } else { return T{nullptr}; } }());
   using cursor_t = decltype(std::declval<TableBuilder>().cursor<persistent_table_t>());
+  using buffered_row_t = decltype([]<typename... Cs>(framework::pack<Cs...>) -> std::tuple<typename BufferedValue<Cs>::type...> {}(typename persistent_table_t::column_types{}));
 
   template <typename... Ts>
   void operator()(Ts... args)
   {
     static_assert(sizeof...(Ts) == framework::pack_size(typename persistent_table_t::persistent_columns_t{}), "Argument number mismatch");
+    if (!mPartitionRows.empty()) {
+      if (auto partition = ParallelProcessing::currentPartition(); partition >= 0) {
+        mPartitionRows[partition].emplace_back(buffer(typename persistent_table_t::column_types{}, extract(args)...));
+        return;
+      }
+    }
     ++mCount;
     cursor(0, extract(args)...);
   }
@@ -103,9 +132,36 @@ struct WritingCursor {
   /// Last index inserted in the table
   int64_t lastIndex()
   {
+    if (!mPartitionRows.empty() && ParallelProcessing::currentPartition() >= 0) {
+      throw runtime_error("lastIndex() is not available in processParallel()");
+    }
     return mCount;
   }
 
+  /// Keep the rows filled while processing each of @a partitions partitions
+  /// aside, rather than adding them to the table straight away.
+  void beginPartitions(size_t partitions)
+  {
+    mPartitionRows.assign(partitions, {});
+  }
+
+  /// Add the rows kept by beginPartitions() to the table, in the order of the
+  /// partitions they were filled in.
+  void endPartitions()
+  {
+    auto partitionRows = std::move(mPartitionRows);
+    mPartitionRows.clear();
+    for (auto& rows : partitionRows) {
+      for (auto& row : rows) {
+        std::apply([this](auto&... values) {
+          ++mCount;
+          cursor(0, replay(values)...);
+        },
+                   row);
+      }
+    }
+  }
+
   bool resetCursor(LifetimeHolder<TableBuilder> builder)
   {
     mBuilder = std::move(builder);
@@ -147,11 +203,43 @@ struct WritingCursor {
     return arg;
   }
 
+  template <typename... Cs, typename... Ts>
+  static buffered_row_t buffer(framework::pack<Cs...>, Ts const&... args)
+  {
+    return buffered_row_t{bufferValue<Cs>(args)...};
+  }
+
+  template <typename C, typename A>
+  static typename BufferedValue<C>::type bufferValue(A const& arg)
+  {
+    if constexpr (std::is_pointer_v<A>) {
+      typename BufferedValue<C>::type values;
+      std::copy_n(arg, values.size(), values.begin());
+      return values;
+    } else {
+      return arg;
+    }
+  }
+
+  template <typename V>
+  static V& replay(V& value)
+  {
+    return value;
+  }
+
+  template <typename V, size_t N>
+  static V* replay(std::array<V, N>& values)
+  {
+    return values.data();
+  }
+
   /// The table builder which actually performs the
   /// construction of the table. We keep it around to be
   /// able to do all-columns methods like reserve.
   LifetimeHolder<TableBuilder> mBuilder = nullptr;
   int64_t mCount = -1;
+  /// Rows filled in each partition of processParallel(), see beginPartitions()
+  std::vector<std::vector<buffered_row_t>> mPartitionRows;
 };
 
 /// Helper to define output for a Table
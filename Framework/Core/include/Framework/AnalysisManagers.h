@@ -416,6 +416,59 @@ struct OutputManager<Builds<T>> {
   }
 };
 
+/// Prepares the outputs of a task for processParallel(), and adds what was
+/// filled in the partitions to them at the end.
+template <typename T>
+struct PartitionedOutputManager {
+  template <typename ANY>
+  static bool begin(ANY& what, size_t partitions)
+  {
+    if constexpr (std::derived_from<ANY, ProducesGroup>) {
+      homogeneous_apply_refs<true>([partitions](auto& p) { return PartitionedOutputManager<std::decay_t<decltype(p)>>::begin(p, partitions); }, what);
+      return true;
+    }
+    return false;
+  }
+
+  template <typename ANY>
+  static bool end(ANY& what)
+  {
+    if constexpr (std::derived_from<ANY, ProducesGroup>) {
+      homogeneous_apply_refs<true>([](auto& p) { return PartitionedOutputManager<std::decay_t<decltype(p)>>::end(p); }, what);
+      return true;
+    }
+    return false;
+  }
+};
+
+template <is_producable T>
+struct PartitionedOutputManager<Produces<T>> {
+  static bool begin(Produces<T>& what, size_t partitions)
+  {
+    what.beginPartitions(partitions);
+    return true;
+  }
+  static bool end(Produces<T>& what)
+  {
+    what.endPartitions();
+    return true;
+  }
+};
+
+template <>
+struct PartitionedOutputManager<HistogramRegistry> {
+  static bool begin(HistogramRegistry& what, size_t)
+  {
+    what.setThreadLocalFills(true);
+    return true;
+  }
+  static bool end(HistogramRegistry& what)
+  {
+    what.mergeThreadLocalFills();
+    return true;
+  }
+};
+
 template <typename T>
 struct ServiceManager {
   template <typename ANY>
@@ -21,6 +21,7 @@
 #include "Framework/Expressions.h"
 #include "Framework/EndOfStreamContext.h"
 #include "Framework/GroupSlicer.h"
+#include "Framework/ParallelProcessing.h"
 #include "Framework/StructToTuple.h"
 #include "Framework/Traits.h"
 #include "Framework/TypeIdHelpers.h"
@@ -30,6 +31,7 @@
 #include <arrow/compute/kernel.h>
 #include <arrow/table.h>
 #include <gandiva/node.h>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <memory>
@@ -383,6 +385,64 @@ struct AnalysisDataProcessorBuilder {
     }
   }
 
+  /// Variant of invokeProcess() for processParallel(): the rows of the grouping
+  /// table are split in partitions, which are processed concurrently by at most
+  /// @a threads threads of @a pool. The rows filled in the Produces<> outputs are added to
+  /// the tables in the order of the grouping table. The Partition<> and
+  /// GroupedCombinations<> members of the task are not bound, as they cannot
+  /// be shared between the threads. OutputObj<> members, and any other state of
+  /// the task which is not a HistogramRegistry or a Produces<>, are not
+  /// protected and must not be modified from processParallel().
+  template <typename Task, typename R, typename C, typename Grouping, typename... Associated>
+  static void invokeProcessParallel(Task& task, InputRecord& inputs, R (C::*processingFunction)(Grouping, Associated...), std::vector<ExpressionInfo>& infos, ArrowTableSlicingCache& slices, WorkerPool& pool, int threads)
+  {
+    using G = std::decay_t<Grouping>;
+    static_assert(soa::is_iterator<G>,
+                  "First argument of processParallel() should be an iterator");
+    static_assert(((soa::is_iterator<std::decay_t<Associated>> == false) && ...),
+                  "Associated arguments of processParallel() should not be iterators");
+    auto groupingTable = AnalysisDataProcessorBuilder::bindGroupingTable(inputs, processingFunction, infos);
+    auto partitions = ParallelProcessing::partition(groupingTable.size(), threads);
+    homogeneous_apply_refs([&partitions](auto& x) { return PartitionedOutputManager<std::decay_t<decltype(x)>>::begin(x, partitions.size()); }, task);
+
+    if constexpr (sizeof...(Associated) == 0) {
+      ParallelProcessing::run(pool, partitions.size(), threads, [&](size_t partition) {
+        auto [row, end] = partitions[partition];
+        for (auto element = groupingTable.begin() + row; row < end; ++element, ++row) {
+          std::invoke(processingFunction, task, *element);
+        }
+      });
+    } else {
+      auto associatedTables = AnalysisDataProcessorBuilder::bindAssociatedTables(inputs, processingFunction, infos);
+      auto binder = [&groupingTable, &associatedTables](auto& x) mutable {
+        x.bindExternalIndices(&groupingTable, &std::get<std::decay_t<Associated>>(associatedTables)...);
+      };
+      groupingTable.bindExternalIndices(&std::get<std::decay_t<Associated>>(associatedTables)...);
+      std::apply(
+        [&binder](auto&... x) mutable {
+          (binder(x), ...);
+        },
+        associatedTables);
+      overwriteInternalIndices(associatedTables, associatedTables);
+
+      auto slicer = GroupSlicer(groupingTable, associatedTables, slices);
+      ParallelProcessing::run(pool, partitions.size(), threads, [&](size_t partition) {
+        auto [row, end] = partitions[partition];
+        for (auto slice = slicer.begin() + row; row < end; ++slice, ++row) {
+          auto associatedSlices = slice.associatedTables();
+          overwriteInternalIndices(associatedSlices, associatedTables);
+          std::apply(
+            [&binder](auto&... x) mutable {
+              (binder(x), ...);
+            },
+            associatedSlices);
+          invokeProcessWithArgs(task, processingFunction, slice.groupingElement(), associatedSlices);
+        }
+      });
+    }
+    homogeneous_apply_refs([](auto& x) { return PartitionedOutputManager<std::decay_t<decltype(x)>>::end(x); }, task);
+  }
+
   template <typename C, typename T, typename G, typename... A>
   static void invokeProcessWithArgs(C& task, T processingFunction, G g, std::tuple<A...>& at)
   {
@@ -501,6 +561,10 @@ DataProcessorSpec adaptAnalysisTask(ConfigContext const& ctx, Args&&... args)
   if constexpr (requires { AnalysisDataProcessorBuilder::inputsFromArgs(&T::process, "default", true, inputs, expressionInfos, bindingsKeys, bindingsKeysUnsorted); }) {
     AnalysisDataProcessorBuilder::inputsFromArgs(&T::process, "default", true, inputs, expressionInfos, bindingsKeys, bindingsKeysUnsorted);
   }
+  if constexpr (requires { AnalysisDataProcessorBuilder::inputsFromArgs(&T::processParallel, "parallel", true, inputs, expressionInfos, bindingsKeys, bindingsKeysUnsorted); }) {
+    AnalysisDataProcessorBuilder::inputsFromArgs(&T::processParallel, "parallel", true, inputs, expressionInfos, bindingsKeys, bindingsKeysUnsorted);
+    options.emplace_back(ConfigParamSpec{"process-threads", VariantType::Int, 1, {"Number of threads running processParallel(), 0 to use all the cores"}});
+  }
   homogeneous_apply_refs(
     [name = name_str, &expressionInfos, &inputs, &bindingsKeys, &bindingsKeysUnsorted](auto& x) {
       using D = std::decay_t<decltype(x)>;
@@ -575,6 +639,16 @@ DataProcessorSpec adaptAnalysisTask(ConfigContext const& ctx, Args&&... args)
       task->init(ic);
     }
 
+    int processThreads = 1;
+    // kept for the lifetime of the task, rather than creating threads at every dataframe
+    auto processPool = std::make_shared<WorkerPool>();
+    if constexpr (requires { &T::processParallel; }) {
+      processThreads = ic.options().get<int>("process-threads");
+      if (processThreads <= 0) {
+        processThreads = std::max(1u, std::thread::hardware_concurrency());
+      }
+    }
+
     ic.services().get<ArrowTableSlicingCacheDef>().setCaches(std::move(bindingsKeys));
     ic.services().get<ArrowTableSlicingCacheDef>().setCachesUnsorted(std::move(bindingsKeysUnsorted));
     // initialize global caches
@@ -583,7 +657,7 @@ DataProcessorSpec adaptAnalysisTask(ConfigContext const& ctx, Args&&... args)
     },
                            *(task.get()));
 
-    return [task, expressionInfos](ProcessingContext& pc) mutable {
+    return [task, expressionInfos, processThreads, processPool](ProcessingContext& pc) mutable {
       // load the ccdb object from their cache
       homogeneous_apply_refs([&pc](auto&& x) { return ConditionManager<std::decay_t<decltype(x)>>::newDataframe(pc.inputs(), x); }, *task.get());
       // reset partitions once per dataframe
@@ -613,6 +687,10 @@ DataProcessorSpec adaptAnalysisTask(ConfigContext const& ctx, Args&&... args)
       if constexpr (requires { AnalysisDataProcessorBuilder::invokeProcess(*(task.get()), pc.inputs(), &T::process, expressionInfos, slices); }) {
         AnalysisDataProcessorBuilder::invokeProcess(*(task.get()), pc.inputs(), &T::process, expressionInfos, slices);
       }
+      // execute processParallel()
+      if constexpr (requires { AnalysisDataProcessorBuilder::invokeProcessParallel(*(task.get()), pc.inputs(), &T::processParallel, expressionInfos, slices, *processPool, processThreads); }) {
+        AnalysisDataProcessorBuilder::invokeProcessParallel(*(task.get()), pc.inputs(), &T::processParallel, expressionInfos, slices, *processPool, processThreads);
+      }
       // execute optional process()
       homogeneous_apply_refs(
         [&pc, &expressionInfos, &task, &slices](auto& x) mutable {
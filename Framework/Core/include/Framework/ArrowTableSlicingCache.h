@@ -79,6 +79,13 @@ struct ArrowTableSlicingCache {
   SliceInfoUnsortedPtr getCacheUnsortedForPos(int pos) const;
 
   static void validateOrder(StringPair const& bindingKey, std::shared_ptr<arrow::Table> const& input);
+
+  // schema metadata keys holding the precomputed values and counts of an
+  // index column, e.g. when stored by the AOD writer
+  static std::string precomputedValuesKey(std::string const& key);
+  static std::string precomputedCountsKey(std::string const& key);
+  // use the precomputed slices attached to the table, if they are consistent with it
+  bool usePrecomputed(int pos, std::shared_ptr<arrow::Table> const& table);
 };
 } // namespace o2::framework
 
@@ -73,6 +73,7 @@ struct CompletionPolicy {
   using InputSetElement = DataRef;
   using CallbackFull = std::function<CompletionOp(InputSpan const&, std::vector<InputSpec> const&, ServiceRegistryRef&)>;
   using CallbackConfigureRelayer = std::function<void(DataRelayer&)>;
+  using CallbackMinimumInputs = std::function<size_t(std::vector<InputSpec> const&)>;
 
   /// Constructor
   CompletionPolicy()
@@ -91,6 +92,12 @@ struct CompletionPolicy {
   /// A callback which allows you to configure the behavior of the data relayer associated
   /// to the matching device.
   CallbackConfigureRelayer configureRelayer = nullptr;
+  /// Optional callback returning how many inputs need to be present in a
+  /// slot before callbackFull can return something different from Wait.
+  /// The DataRelayer keeps track of how many inputs are present in each slot
+  /// as parts arrive, so that slots which cannot be complete yet are skipped
+  /// without scanning them. Invoked once, when the DataRelayer is created.
+  CallbackMinimumInputs minimumInputs = nullptr;
   /// Wether or not the policy requires queues to be balanced
   /// Set to false if the policy does not require that the upstream
   /// producers are more or less balanced. Most notably, this is
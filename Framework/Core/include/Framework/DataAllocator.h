@@ -23,6 +23,7 @@
 #include "Framework/TypeTraits.h"
 #include "Framework/Traits.h"
 #include "Framework/SerializationMethods.h"
+#include "Framework/FlatVector.h"
 #include "Framework/ServiceRegistry.h"
 #include "Framework/RuntimeError.h"
 #include "Framework/RouteState.h"
@@ -57,6 +58,7 @@ class RecordBatchWriter;
 namespace o2::framework
 {
 struct ServiceRegistry;
+class MessageArena;
 
 /// Helper to allow framework managed objecs to have a callback
 /// when they go out of scope. For example, this could
@@ -148,6 +150,7 @@ class DataAllocator
   };
 
   DataAllocator(ServiceRegistryRef ref);
+  ~DataAllocator();
 
   DataChunk& newChunk(const Output&, size_t);
 
@@ -312,6 +315,8 @@ class DataAllocator
   /// - messageable types (trivially copyable, non-polymorphic
   /// - std::vector of messageable types
   /// - std::vector of pointers of messageable type
+  /// - std::vector of std::vector of messageable type wrapped in FlatVectorSerialized,
+  ///   flattened without ROOT (see FlatVector.h)
   /// - types with ROOT dictionary and implementing the ROOT ClassDef interface
   ///
   /// Note: for many use cases, especially for the messageable types, the `make` interface
@@ -330,10 +335,16 @@ class DataAllocator
     RouteIndex routeIndex = matchDataHeader(spec, mRegistry.get<TimingInfo>().timeslice);
     if constexpr (is_messageable<T>::value == true) {
       // Serialize a snapshot of a trivially copyable, non-polymorphic object,
-      payloadMessage = proxy.createOutputMessage(routeIndex, sizeof(T));
+      payloadMessage = createOutputMessage(routeIndex, sizeof(T));
       memcpy(payloadMessage->GetData(), &object, sizeof(T));
 
       serializationType = o2::header::gSerializationMethodNone;
+    } else if constexpr (is_specialization_v<T, FlatVectorSerialized> == true) {
+      // Nested vectors of messageable elements explicitly flattened to offsets
+      // and data, so that they can be accessed in place on the other side.
+      payloadMessage = createOutputMessage(routeIndex, FlatVectorHelpers::serializedSize(object()));
+      FlatVectorHelpers::serialize(object(), static_cast<char*>(payloadMessage->GetData()));
+      serializationType = o2::header::gSerializationMethodFlatVector;
     } else if constexpr (is_specialization_v<T, std::vector> == true ||
                          (gsl::details::is_span<T>::value && has_messageable_value_type<T>::value)) {
       using ElementType = typename std::remove_pointer<typename T::value_type>::type;
@@ -343,7 +354,7 @@ class DataAllocator
         // reference object
         constexpr auto elementSizeInBytes = sizeof(ElementType);
         auto sizeInBytes = elementSizeInBytes * object.size();
-        payloadMessage = proxy.createOutputMessage(routeIndex, sizeInBytes);
+        payloadMessage = createOutputMessage(routeIndex, sizeInBytes);
 
         if constexpr (std::is_pointer<typename T::value_type>::value == false) {
           // vector of elements
@@ -375,7 +386,7 @@ class DataAllocator
       // reference object
       constexpr auto elementSizeInBytes = sizeof(typename T::value_type);
       auto sizeInBytes = elementSizeInBytes * object.size();
-      payloadMessage = proxy.createOutputMessage(routeIndex, sizeInBytes);
+      payloadMessage = createOutputMessage(routeIndex, sizeInBytes);
 
       // serialize vector of pointers to elements
       auto target = reinterpret_cast<unsigned char*>(payloadMessage->GetData());
@@ -551,6 +562,8 @@ class DataAllocator
 
  private:
   ServiceRegistryRef mRegistry;
+  /// Arenas for small outputs, one per output transport.
+  std::vector<std::unique_ptr<MessageArena>> mArenas;
 
   RouteIndex matchDataHeader(const Output& spec, size_t timeframeId);
   fair::mq::MessagePtr headerMessageFromOutput(Output const& spec,                                  //
@@ -559,6 +572,9 @@ class DataAllocator
                                                size_t payloadSize);                                 //
 
   Output getOutputByBind(OutputRef&& ref);
+  /// Create the payload message for a snapshot, sub-allocating it from
+  /// the arena when small enough and DPL_OUTPUT_ARENA_SIZE is set.
+  fair::mq::MessagePtr createOutputMessage(RouteIndex routeIndex, size_t size);
   void addPartToContext(RouteIndex routeIndex, fair::mq::MessagePtr&& payload,
                         const Output& spec,
                         o2::header::SerializationMethod serializationMethod);
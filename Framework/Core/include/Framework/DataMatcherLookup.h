@@ -0,0 +1,76 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_DATAMATCHERLOOKUP_H_
+#define O2_FRAMEWORK_DATAMATCHERLOOKUP_H_
+
+#include "Framework/RuntimeError.h"
+#include "Framework/DataDescriptorMatcher.h"
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace o2::framework::data_matcher
+{
+
+/// A compiled version of a list of DataDescriptorMatcher, which can be used to
+/// find the first one matching a given header without evaluating all of them.
+///
+/// Matchers are indexed by the constant origin, description and subspecification
+/// they require. Those which require a constant origin and description, but
+/// accept any subspecification are indexed by the former only, while anything
+/// else (e.g. Or clauses, variable origins) is always a candidate. Candidates
+/// are then evaluated in their original order, so that the variables bound by
+/// the first matching one in the VariableContext are the same as if all the
+/// matchers were evaluated one by one.
+class DataMatcherLookup
+{
+ public:
+  constexpr static size_t INVALID = -1;
+
+  DataMatcherLookup() = default;
+  /// Compile the matchers at the positions @a index of @a matchers, in
+  /// that order.
+  DataMatcherLookup(std::vector<DataDescriptorMatcher> const& matchers, std::vector<size_t> const& index);
+
+  /// @return the position in the index of the first matcher matching the
+  /// header stack @a data, INVALID if none does. The context is committed
+  /// on success and discarded on failure, like for a plain match.
+  size_t match(char const* data, VariableContext& context) const;
+
+  /// Number of matchers which are evaluated for any header.
+  [[nodiscard]] size_t fallbackSize() const { return mFallback.size(); }
+
+ private:
+  struct Key {
+    uint32_t origin = 0;
+    uint32_t subSpec = 0;
+    std::array<uint64_t, 2> description = {};
+    bool operator==(Key const& other) const = default;
+  };
+  struct KeyHash {
+    size_t operator()(Key const& key) const;
+  };
+
+  std::vector<DataDescriptorMatcher> mMatchers;
+  /// Matchers with constant origin, description and subspecification.
+  std::unordered_map<Key, std::vector<uint32_t>, KeyHash> mExact;
+  /// Matchers with constant origin and description, the subSpec of
+  /// the key is always 0.
+  std::unordered_map<Key, std::vector<uint32_t>, KeyHash> mByType;
+  /// Matchers which need to be evaluated in any case.
+  std::vector<uint32_t> mFallback;
+};
+
+} // namespace o2::framework::data_matcher
+
+#endif // O2_FRAMEWORK_DATAMATCHERLOOKUP_H_
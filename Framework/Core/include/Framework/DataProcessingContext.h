@@ -13,7 +13,9 @@
 
 #include "Framework/DataRelayer.h"
 #include "Framework/AlgorithmSpec.h"
+#include <condition_variable>
 #include <functional>
+#include <mutex>
 
 namespace o2::framework
 {
@@ -126,6 +128,19 @@ struct DataProcessorContext {
   bool isSink = false;
   bool balancingInputs = true;
 
+  /// Number of streams which can process timeslices concurrently for this
+  /// DataProcessor. Anything bigger than one makes the device dispatch
+  /// the computations on a worker pool, see the "streams" metadata.
+  size_t streams = 1;
+  /// When running multiple streams, everything but the user processing
+  /// callback is serialised by this mutex.
+  std::mutex streamsMutex;
+  /// Timeslices currently being processed by one of the streams. Used
+  /// to release outputs in order when the CompletionPolicy asks for it.
+  std::vector<size_t> timeslicesInFlight;
+  /// Notified whenever a timeslice is removed from timeslicesInFlight.
+  std::condition_variable timesliceReleased;
+
   std::function<void(o2::framework::RuntimeErrorRef e, InputRecord& record)> errorHandling;
   std::function<void(o2::framework::RuntimeErrorRef e)> initErrorHandling;
 };
@@ -13,6 +13,7 @@
 
 #include "DeviceState.h"
 #include "Framework/ServiceSpec.h"
+#include "Framework/LatencyHistogram.h"
 #include <atomic>
 #include <cstdint>
 #include <array>
@@ -65,6 +66,9 @@ enum struct ProcessingStatsId : short {
   RESOURCES_MISSING,
   RESOURCES_INSUFFICIENT,
   RESOURCES_SATISFACTORY,
+  RELAYER_COMPLETION_CHECKS,
+  RELAYER_COMPLETION_SKIPPED,
+  RELAYER_INPUTS_SCANNED,
   AVAILABLE_MANAGED_SHM_BASE = 512,
 };
 
@@ -179,6 +183,13 @@ struct DataProcessingStats {
 
   void flushChangedMetrics(std::function<void(MetricSpec const&, int64_t, int64_t)> const& callback);
 
+  /// Record @a ns nanoseconds spent in the given @a stage. Can be
+  /// invoked from any thread.
+  void recordLatency(LatencyStage stage, uint64_t ns)
+  {
+    latencies[(int)stage].record(ns / 1000);
+  }
+
   std::atomic<size_t> statesSize = 0;
 
   std::array<Command, MAX_CMDS> cmds = {};
@@ -189,6 +200,11 @@ struct DataProcessingStats {
   std::array<MetricSpec, MAX_METRICS> metricSpecs = {};
   std::array<int64_t, MAX_METRICS> lastPublishedMetrics = {};
   std::vector<int> availableMetrics;
+  // Per stage latency histograms, sent to the driver as string metrics.
+  std::array<LatencyHistogram, (int)LatencyStage::COUNT> latencies = {};
+  // The total number of entries of each histogram when last sent.
+  std::array<uint64_t, (int)LatencyStage::COUNT> lastSentLatencies = {};
+  int64_t lastLatenciesSent = 0;
   // How many commands have been committed to the queue.
   std::atomic<int> insertedCmds = 0;
   // The insertion point for the next command.
@@ -61,7 +61,8 @@ struct DataProcessorSpec {
   std::vector<DataProcessorLabel> labels = {};
 
   /// Extra key, value pairs which can be used to describe extra information
-  /// about a given data processor.
+  /// about a given data processor. E.g. {"streams", "4"} allows four
+  /// timeslices to be processed concurrently by the same device.
   std::vector<DataProcessorMetadata> metadata = {};
 
   // FIXME: for the moment I put them here, but it's a hack
@@ -18,6 +18,9 @@ namespace o2::framework
 {
 struct DataProcessorSpecHelpers {
   static bool hasLabel(DataProcessorSpec const& spec, char const* name);
+  /// Number of processing streams requested via the "streams" metadata.
+  /// Defaults to one, also when the value is not a positive integer.
+  static size_t getRequestedStreams(std::vector<DataProcessorMetadata> const& metadata);
 };
 } // namespace o2::framework
 #endif
@@ -14,6 +14,7 @@
 #include "Framework/RootSerializationSupport.h"
 #include "Framework/InputRoute.h"
 #include "Framework/DataDescriptorMatcher.h"
+#include "Framework/DataMatcherLookup.h"
 #include "Framework/ForwardRoute.h"
 #include "Framework/CompletionPolicy.h"
 #include "Framework/MessageSet.h"
@@ -22,7 +23,10 @@
 #include "Framework/TimesliceSlot.h"
 #include "Framework/ServiceRegistryRef.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <limits>
 #include <mutex>
 #include <vector>
 #include <functional>
@@ -49,7 +53,9 @@ class DataRelayer
  public:
   /// DataRelayer is thread safe because we have a lock around
   /// each method and there is no particular order in which
-  /// methods need to be called.
+  /// methods need to be called. When sharding is enabled (see setShards)
+  /// relay() only locks the shard of the incoming timeslice, so that
+  /// multiple threads can relay data at the same time.
   constexpr static ServiceKind service_kind = ServiceKind::Global;
   /// This represents what the DataRelayer did when
   /// inserting a set of messages in the cache.
@@ -71,6 +77,20 @@ class DataRelayer
     int expiredSlots = 0;
   };
 
+  /// Cumulative cost of finding out which slots are ready to be processed.
+  /// Updated by all the shards and read by the metrics callbacks without
+  /// holding the relayer lock, hence the atomics.
+  struct ScanStats {
+    /// Number of times the completion policy callback was invoked on a slot
+    std::atomic<uint64_t> completionChecks = 0;
+    /// Number of dirty slots which were skipped because not enough inputs
+    /// were present for the completion policy to do anything but wait.
+    std::atomic<uint64_t> completionSkipped = 0;
+    /// Number of cache entries inspected to build the InputSpans passed to
+    /// the completion policy.
+    std::atomic<uint64_t> inputsScanned = 0;
+  };
+
   struct PruneOp {
     TimesliceSlot slot = {-1ULL};
   };
@@ -128,7 +148,9 @@ class DataRelayer
   ///              which is the standard header-payload message pair, in this
   ///              case nMessages / 2 pairs will be inserted and considered
   ///              separate parts
-  /// @a onDrop function to be called if an message is dropped
+  /// @a onDrop function to be called if an message is dropped. In sharded
+  ///           mode it is invoked with the shard locked, so it must not
+  ///           call back into the DataRelayer.
   /// Notice that we expect that the header is an O2 Header Stack
   RelayChoice relay(void const* rawHeader,
                     std::unique_ptr<fair::mq::Message>* messages,
@@ -145,8 +167,10 @@ class DataRelayer
   /// possibly have in output.
   [[nodiscard]] TimesliceIndex::OldestOutputInfo getOldestPossibleOutput() const;
 
-  /// @returns the actions ready to be performed.
-  void getReadyToProcess(std::vector<RecordAction>& completed);
+  /// @returns the actions ready to be performed. At most @a maxActions
+  /// are returned, the oldest timeslices first. The others are left for
+  /// the next invocation, so that multiple streams can share the work.
+  void getReadyToProcess(std::vector<RecordAction>& completed, size_t maxActions = std::numeric_limits<size_t>::max());
 
   /// Returns an input registry associated to the given timeslice and gives
   /// ownership to the caller. This is because once the inputs are out of the
@@ -160,6 +184,13 @@ class DataRelayer
   /// Tune the maximum number of in flight timeslices this can handle.
   void setPipelineLength(size_t s);
 
+  /// Partition the cache in @a shards groups of slots, each one with its
+  /// own lock. A timeslice t can only end up in the shard t % shards,
+  /// so relay() calls for different shards do not contend.
+  /// Must be invoked before any data is relayed. 1 (the default) means no sharding.
+  void setShards(size_t shards);
+  [[nodiscard]] size_t getShards() const { return std::max<size_t>(mShardMutexes.size(), 1); }
+
   /// Send metrics with the VariableContext information
   void sendContextState();
   void publishMetrics();
@@ -190,6 +221,10 @@ class DataRelayer
   [[nodiscard]] size_t getCacheSize() const { return mCache.size(); }
   [[nodiscard]] size_t getNumberOfTimeslices() const { return mTimesliceIndex.size(); }
   [[nodiscard]] size_t getNumberOfUniqueInputs() const { return mDistinctRoutesIndex.size(); }
+  /// @return how many inputs have data in the given @a slot. This is updated
+  /// on every arrival, so it does not require scanning the slot.
+  [[nodiscard]] size_t getInputsPresentForSlot(TimesliceSlot slot) const { return mInputsPresent[slot.index]; }
+  [[nodiscard]] ScanStats const& getScanStats() const { return mScanStats; }
 
  private:
   ServiceRegistryRef mContext;
@@ -207,13 +242,24 @@ class DataRelayer
   CompletionPolicy mCompletionPolicy;
   std::vector<size_t> mDistinctRoutesIndex;
   std::vector<InputSpec> mInputs;
-  std::vector<data_matcher::DataDescriptorMatcher> mInputMatchers;
+  /// Compiled version of the matchers of the distinct routes.
+  data_matcher::DataMatcherLookup mInputLookup;
   std::vector<data_matcher::VariableContext> mVariableContextes;
   std::vector<CacheEntryStatus> mCachedStateMetrics;
+  /// Number of non empty cache entries for each slot.
+  std::vector<size_t> mInputsPresent;
+  /// Minimum number of inputs needed for the completion policy to be invoked.
+  size_t mMinimumInputs = 0;
+  ScanStats mScanStats;
   std::vector<PruneOp> mPruneOps;
   size_t mMaxLanes;
 
   O2_LOCKABLE_NAMED(std::recursive_mutex, mMutex, "data relayer mutex");
+  /// One mutex per shard. Empty when sharding is disabled. Methods other than
+  /// relay() acquire all of them, always in the same order, after mMutex.
+  std::vector<std::recursive_mutex> mShardMutexes;
+  /// Protects mPruneOps, which can be modified by concurrent relay() calls.
+  std::mutex mPruneOpsMutex;
 };
 
 } // namespace o2::framework
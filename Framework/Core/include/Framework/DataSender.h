@@ -16,12 +16,12 @@
 #include "Framework/ServiceRegistryRef.h"
 #include "Framework/Tracing.h"
 #include "Framework/OutputSpec.h"
+#include "Framework/SendQueue.h"
 #include <fairmq/Message.h>
 #include <fairmq/Parts.h>
 #include <string>
 
-#include <cstddef>
-#include <mutex>
+#include <memory>
 
 namespace o2::framework
 {
@@ -34,7 +34,17 @@ class DataSender
 {
  public:
   DataSender(ServiceRegistryRef registry);
+  ~DataSender();
+  /// Send @a parts on the channel @a index. When a sender thread is
+  /// used, the parts are moved to its queue and this returns as soon as
+  /// there is space in the queue. Failures of earlier asynchronous sends
+  /// are rethrown here.
   void send(fair::mq::Parts&, ChannelIndex index);
+  /// Wait until everything which was queued has been sent. Anything
+  /// which must not overtake the data (e.g. the oldest possible
+  /// timeframe or the end of stream) needs to flush first. Rethrows
+  /// the failure of an asynchronous send, if any.
+  void flush();
   std::unique_ptr<fair::mq::Message> create(RouteIndex index);
   /// Reset the datasender to a clean state
   /// so that we can track what whill be sent in the next
@@ -62,6 +72,9 @@ class DataSender
   std::vector<bool> mPresentDefaults;
 
   O2_LOCKABLE_NAMED(std::recursive_mutex, mMutex, "data relayer mutex");
+
+  /// Used to send from a separate thread, null when sending synchronously.
+  std::unique_ptr<SendQueue> mSendQueue;
 };
 
 } // namespace o2::framework
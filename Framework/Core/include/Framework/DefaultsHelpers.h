@@ -12,6 +12,8 @@
 #ifndef O2_FRAMEWORK_DEFAULTHELPERS_H_
 #define O2_FRAMEWORK_DEFAULTHELPERS_H_
 
+#include <cstddef>
+
 namespace o2::framework
 {
 enum struct DeploymentMode;
@@ -22,6 +24,16 @@ struct DefaultsHelpers {
   static bool onlineDeploymentMode();
   /// get max number of timeslices in the queue
   static unsigned int pipelineLength();
+  /// get the number of independently locked shards of the DataRelayer cache
+  static unsigned int relayerShards();
+  /// get the size in bytes of the arena used for small outputs, 0 to disable it
+  static size_t outputArenaSize();
+  /// get the number of messages which can be queued for the sender thread, 0 to send synchronously
+  static size_t asyncSendQueueSize();
+  /// @true if flat condition objects should be shared between the devices on a node
+  static bool shareConditionObjects();
+  /// get the number of spawned record batches kept for reuse, 0 to disable the cache
+  static size_t spawnCacheSize();
 };
 } // namespace o2::framework
 
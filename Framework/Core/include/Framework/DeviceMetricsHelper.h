@@ -13,6 +13,7 @@
 #define O2_FRAMEWORK_DEVICEMETRICSHELPERS_H_
 
 #include "Framework/DeviceMetricsInfo.h"
+#include "Framework/LatencyHistogram.h"
 #include "Framework/RuntimeError.h"
 #include <array>
 #include <cstddef>
@@ -46,6 +47,14 @@ struct DeviceMetricsHelper {
   static size_t metricIdxByName(const std::string& name,
                                 const DeviceMetricsInfo& info);
 
+  /// Merge into @a result the latest latency histogram posted as the
+  /// metric @a name. Histograms are cumulative, so merging the latest one
+  /// of each device gives the workflow wide distribution.
+  /// @return false if no valid histogram was posted.
+  static bool mergeLatencyHistogram(const std::string& name,
+                                    const DeviceMetricsInfo& info,
+                                    LatencyHistogramSnapshot& result);
+
   /// Typesafe way to get the actual store
   template <typename T>
   static auto& getMetricsStore(DeviceMetricsInfo& metrics)
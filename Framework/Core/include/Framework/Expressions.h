@@ -41,12 +41,19 @@ class Projector;
 #include <string>
 #include <memory>
 #include <set>
+#include <vector>
 namespace gandiva
 {
 using Selection = std::shared_ptr<gandiva::SelectionVector>;
 using FilterPtr = std::shared_ptr<gandiva::Filter>;
 } // namespace gandiva
 
+namespace o2::framework::expressions
+{
+struct ColumnOperationSpec;
+using Operations = std::vector<ColumnOperationSpec>;
+} // namespace o2::framework::expressions
+
 using atype = arrow::Type;
 struct ExpressionInfo {
   ExpressionInfo(int ai, size_t hash, std::set<uint32_t>&& hs, gandiva::SchemaPtr sc)
@@ -64,6 +71,9 @@ struct ExpressionInfo {
   gandiva::FilterPtr filter = nullptr;
   gandiva::Selection selection = nullptr;
   bool resetSelection = false;
+  /// the filters combined in the tree, to check them against the range of
+  /// values of the columns, when known
+  std::vector<std::shared_ptr<o2::framework::expressions::Operations const>> operations;
 };
 
 namespace o2::framework::expressions
@@ -425,9 +435,6 @@ gandiva::Selection createSelection(std::shared_ptr<arrow::Table> const& table, F
 /// Function for creating gandiva selection from prepared gandiva expressions tree
 gandiva::Selection createSelection(std::shared_ptr<arrow::Table> const& table, std::shared_ptr<gandiva::Filter> const& gfilter);
 
-struct ColumnOperationSpec;
-using Operations = std::vector<ColumnOperationSpec>;
-
 /// Function to create an internal operation sequence from a filter tree
 Operations createOperations(Filter const& expression);
 
@@ -452,6 +459,24 @@ std::shared_ptr<gandiva::Projector> createProjector(gandiva::SchemaPtr const& Sc
                                                     gandiva::FieldPtr result);
 /// Function for attaching gandiva filters to to compatible task inputs
 void updateExpressionInfos(expressions::Filter const& filter, std::vector<ExpressionInfo>& eInfos);
+
+/// Keys of the field metadata holding the range of values of a column, as
+/// stored by the AOD writer. The range is only valid for a table with the
+/// given number of rows.
+constexpr char const* columnRangeMinKey = "range-min";
+constexpr char const* columnRangeMaxKey = "range-max";
+constexpr char const* columnRangeRowsKey = "range-rows";
+
+/// What can be told about the result of a filter on all the rows of a table
+/// from the range of values of its columns
+enum struct RangeOutcome : int {
+  Unknown,
+  AllPass,
+  NonePass
+};
+/// Function to check an operation sequence against the range of values of the columns of a table.
+/// This only allows to skip evaluating the filter, the table has already been read at this point.
+RangeOutcome checkRanges(Operations const& opSpecs, arrow::Table const& table);
 /// Function to create gandiva condition expression from generic gandiva expression tree
 gandiva::ConditionPtr makeCondition(gandiva::NodePtr node);
 /// Function to create gandiva projecting expression from generic gandiva expression tree
@@ -0,0 +1,192 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_FLATVECTOR_H_
+#define O2_FRAMEWORK_FLATVECTOR_H_
+
+/// @file FlatVector.h
+/// @brief ROOT-free serialization of std::vector<std::vector<T>> of messageable T
+///
+/// The payload is laid out as:
+/// - a FlatVectorHeader
+/// - nEntries + 1 offsets (in number of elements) of each inner vector
+/// - the elements of all the inner vectors, back to back, aligned to
+///   FlatVectorHeader::alignment
+///
+/// and it is sent with gSerializationMethodFlatVector, so that it can be
+/// accessed in place via FlatVectorView<T>. Flattening is opt-in: snapshot()
+/// of a plain std::vector<std::vector<T>> is still ROOT serialised, wrap it in
+/// FlatVectorSerialized to use this format.
+
+#include "Framework/TypeTraits.h"
+#include "Framework/RuntimeError.h"
+#include <gsl/span>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace o2::framework
+{
+
+struct FlatVectorHeader {
+  constexpr static uint32_t alignment = 16;
+  /// sizeof of the element type, used to detect mismatches on the reading side
+  uint32_t elementSize = 0;
+  uint32_t reserved = 0;
+  /// Number of inner vectors
+  uint64_t nEntries = 0;
+};
+
+template <typename T>
+concept FlatVectorSerializable = is_specialization_v<T, std::vector> &&
+                                 is_specialization_v<typename T::value_type, std::vector> &&
+                                 is_messageable<typename T::value_type::value_type>::value;
+
+/// @class FlatVectorSerialized
+/// Request the flat serialization for a std::vector<std::vector<T>>
+///
+/// Usage: (with 'output' being the DataAllocator of the ProcessingContext)
+///   std::vector<std::vector<int>> object;
+///   output.snapshot(Output{}, FlatVectorSerialized<decltype(object)>(object));
+///
+/// Only consumers reading it via InputRecord::get (as FlatVectorView<T> or
+/// as std::vector<std::vector<T>>) understand the payload.
+template <typename T>
+class FlatVectorSerialized
+{
+ public:
+  using non_messageable = o2::framework::MarkAsNonMessageable;
+  using wrapped_type = T;
+
+  static_assert(FlatVectorSerializable<T>, "FlatVectorSerialized requires std::vector<std::vector<T>> of messageable T");
+
+  FlatVectorSerialized() = delete;
+  FlatVectorSerialized(wrapped_type const& ref) : mRef(ref) {}
+
+  T const& operator()() const { return mRef; }
+
+ private:
+  wrapped_type const& mRef;
+};
+
+/// Read only view over a flattened std::vector<std::vector<T>>. Each
+/// entry is a gsl::span pointing directly into the message payload.
+template <typename T>
+class FlatVectorView
+{
+ public:
+  using value_type = gsl::span<T const>;
+
+  FlatVectorView() = default;
+  FlatVectorView(uint64_t const* offsets, T const* data, size_t size)
+    : mOffsets{offsets}, mData{data}, mSize{size}
+  {
+  }
+
+  [[nodiscard]] size_t size() const { return mSize; }
+  [[nodiscard]] bool empty() const { return mSize == 0; }
+  value_type operator[](size_t i) const { return {mData + mOffsets[i], mData + mOffsets[i + 1]}; }
+  /// All the elements of all the entries
+  [[nodiscard]] gsl::span<T const> elements() const { return {mData, mData + (mSize ? mOffsets[mSize] : 0)}; }
+
+  struct iterator {
+    FlatVectorView const* view;
+    size_t pos;
+    value_type operator*() const { return (*view)[pos]; }
+    iterator& operator++()
+    {
+      ++pos;
+      return *this;
+    }
+    bool operator==(iterator const& other) const { return pos == other.pos; }
+  };
+  [[nodiscard]] iterator begin() const { return {this, 0}; }
+  [[nodiscard]] iterator end() const { return {this, mSize}; }
+
+ private:
+  uint64_t const* mOffsets = nullptr;
+  T const* mData = nullptr;
+  size_t mSize = 0;
+};
+
+struct FlatVectorHelpers {
+  static constexpr size_t dataOffset(size_t nEntries)
+  {
+    size_t offset = sizeof(FlatVectorHeader) + (nEntries + 1) * sizeof(uint64_t);
+    return (offset + FlatVectorHeader::alignment - 1) & ~size_t(FlatVectorHeader::alignment - 1);
+  }
+
+  template <FlatVectorSerializable V>
+  static size_t serializedSize(V const& v)
+  {
+    size_t elements = 0;
+    for (auto& inner : v) {
+      elements += inner.size();
+    }
+    return dataOffset(v.size()) + elements * sizeof(typename V::value_type::value_type);
+  }
+
+  /// Serialise @a v into @a buffer, which must be at least serializedSize(v) bytes.
+  template <FlatVectorSerializable V>
+  static void serialize(V const& v, char* buffer)
+  {
+    using T = typename V::value_type::value_type;
+    FlatVectorHeader header{.elementSize = sizeof(T), .nEntries = v.size()};
+    memcpy(buffer, &header, sizeof(header));
+    auto* offsets = reinterpret_cast<uint64_t*>(buffer + sizeof(header));
+    auto* data = buffer + dataOffset(v.size());
+    uint64_t offset = 0;
+    for (size_t i = 0; i < v.size(); ++i) {
+      offsets[i] = offset;
+      if (v[i].empty() == false) {
+        memcpy(data + offset * sizeof(T), v[i].data(), v[i].size() * sizeof(T));
+      }
+      offset += v[i].size();
+    }
+    offsets[v.size()] = offset;
+  }
+
+  /// Create a view on a payload created by serialize. Throws if the payload
+  /// is inconsistent with the requested type.
+  template <typename T>
+  static FlatVectorView<T> view(char const* payload, size_t payloadSize)
+  {
+    if (payloadSize < sizeof(FlatVectorHeader)) {
+      throw runtime_error_f("Payload of %zu bytes too small for a flat vector", payloadSize);
+    }
+    auto const* header = reinterpret_cast<FlatVectorHeader const*>(payload);
+    if (header->elementSize != sizeof(T)) {
+      throw runtime_error_f("Flat vector element size %u does not match requested type size %zu", header->elementSize, sizeof(T));
+    }
+    auto const* offsets = reinterpret_cast<uint64_t const*>(payload + sizeof(FlatVectorHeader));
+    if (payloadSize < dataOffset(header->nEntries) || payloadSize - dataOffset(header->nEntries) < offsets[header->nEntries] * sizeof(T)) {
+      throw runtime_error_f("Flat vector payload of %zu bytes is truncated", payloadSize);
+    }
+    return {offsets, reinterpret_cast<T const*>(payload + dataOffset(header->nEntries)), header->nEntries};
+  }
+
+  /// Materialise a std::vector<std::vector<T>> from a flat payload.
+  template <FlatVectorSerializable V>
+  static V deserialize(char const* payload, size_t payloadSize)
+  {
+    auto flat = view<typename V::value_type::value_type>(payload, payloadSize);
+    V result;
+    result.reserve(flat.size());
+    for (auto entry : flat) {
+      result.emplace_back(entry.begin(), entry.end());
+    }
+    return result;
+  }
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_FLATVECTOR_H_
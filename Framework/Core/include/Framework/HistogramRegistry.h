@@ -28,6 +28,7 @@
 #include <TArrayL.h>
 
 #include <deque>
+#include <mutex>
 
 class TList;
 
@@ -49,6 +50,11 @@ struct HistFiller {
   static void fillHistAny(std::shared_ptr<T> hist, Ts... positionAndWeight)
     requires(FillValue<Ts> && ...);
 
+  // fill any type of histogram with spans of values of the same size, e.g. the columns of a table batch (if weight was requested it must be the last argument)
+  template <typename T, typename... Ts>
+  static void fillHistAny(std::shared_ptr<T> hist, gsl::span<Ts const>... positionAndWeight)
+    requires(FillValue<Ts> && ...);
+
   // fill any type of histogram with columns (Cs) of a filtered table (if weight is requested it must reside the last specified column)
   template <typename... Cs, typename R, typename T>
   static void fillHistAny(std::shared_ptr<R> hist, const T& table, const o2::framework::expressions::Filter& filter);
@@ -132,11 +138,27 @@ class HistogramRegistry
   /// deletes all the histograms from the registry
   void clean();
 
+  /// fill thread local copies of the histograms instead of the ROOT objects, so that
+  /// multiple threads can fill the registry at the same time. TH1, TH2, TH3, THn and
+  /// StepTHn are kept in flat arrays, while the other histogram types are filled
+  /// under a lock.
+  void setThreadLocalFills(bool enable);
+
+  /// add the content of the thread local copies to the ROOT objects and zero them.
+  /// The copies of threads which have exited are dropped.
+  /// Must not be called while other threads are filling.
+  void mergeThreadLocalFills();
+
   // fill hist with values
   template <typename... Ts>
   void fill(const HistName& histName, Ts... positionAndWeight)
     requires(FillValue<Ts> && ...);
 
+  // fill hist with spans of values, e.g. the columns of a table batch
+  template <typename... Ts>
+  void fill(const HistName& histName, gsl::span<Ts const>... positionAndWeight)
+    requires(FillValue<Ts> && ...);
+
   // fill hist with content of (filtered) table columns
   template <typename... Cs, typename T>
   void fill(const HistName& histName, const T& table, const o2::framework::expressions::Filter& filter);
@@ -168,6 +190,15 @@ class HistogramRegistry
   template <typename T>
   uint32_t getHistIndex(const T& histName);
 
+  // fill the thread local copy of the histogram at position idx, returns false if it has none
+  bool fillThreadLocal(uint32_t idx, double const* positionAndWeight, int nArgs);
+
+  // lock for the histograms without thread local copies
+  std::mutex& getFillMutex(uint32_t idx);
+
+  template <typename... Ts>
+  void fillThreadSafe(uint32_t idx, Ts... positionAndWeight);
+
   constexpr uint32_t imask(uint32_t i) const
   {
     return i & REGISTRY_BITMASK;
@@ -196,6 +227,10 @@ class HistogramRegistry
   static constexpr uint32_t MAX_REGISTRY_SIZE{REGISTRY_BITMASK + 1};
   std::array<uint32_t, MAX_REGISTRY_SIZE> mRegistryKey{};
   std::array<HistPtr, MAX_REGISTRY_SIZE> mRegistryValue{};
+
+  // thread local copies of the histograms, if enabled
+  struct ThreadLocalFills;
+  std::shared_ptr<ThreadLocalFills> mThreadLocalFills{};
 };
 
 //--------------------------------------------------------------------------------------------------
@@ -241,6 +276,49 @@ void HistFiller::fillHistAny(std::shared_ptr<T> hist, Ts... positionAndWeight)
   }
 }
 
+template <typename T, typename... Ts>
+void HistFiller::fillHistAny(std::shared_ptr<T> hist, gsl::span<Ts const>... positionAndWeight)
+  requires(FillValue<Ts> && ...)
+{
+  constexpr int nArgs = sizeof...(Ts);
+  const size_t sizes[] = {positionAndWeight.size()...};
+  const size_t size = sizes[0];
+  for (auto s : sizes) {
+    if (s != size) {
+      LOGF(fatal, "The spans passed to the fill function called for histogram %s have different sizes.", hist->GetName());
+    }
+  }
+
+  constexpr bool validTH2 = (std::is_same_v<TH2, T> && (nArgs == 2 || nArgs == 3));
+  constexpr bool validTH1 = (std::is_same_v<TH1, T> && (nArgs == 1 || nArgs == 2));
+
+  if constexpr (validTH1 || validTH2) {
+    // convert blocks of values to double, which the compiler can vectorise, and let ROOT fill them in one go
+    constexpr size_t blockSize = 1024;
+    double buffers[nArgs][blockSize];
+    for (size_t start = 0; start < size; start += blockSize) {
+      const size_t n = std::min(blockSize, size - start);
+      int arg = 0;
+      ([&](auto const& values) {
+        double* out = buffers[arg++];
+        for (size_t i = 0; i < n; ++i) {
+          out[i] = static_cast<double>(values[start + i]);
+        }
+      }(positionAndWeight),
+       ...);
+      if constexpr (validTH1) {
+        hist->FillN(n, buffers[0], nArgs == 2 ? buffers[nArgs - 1] : nullptr);
+      } else {
+        hist->FillN(n, buffers[0], buffers[1], nArgs == 3 ? buffers[nArgs - 1] : nullptr);
+      }
+    }
+  } else {
+    for (size_t i = 0; i < size; ++i) {
+      fillHistAny(hist, positionAndWeight[i]...);
+    }
+  }
+}
+
 template <typename... Cs, typename R, typename T>
 void HistFiller::fillHistAny(std::shared_ptr<R> hist, const T& table, const o2::framework::expressions::Filter& filter)
 {
@@ -426,10 +504,25 @@ uint32_t HistogramRegistry::getHistIndex(const T& histName)
   throw runtime_error_f(R"(Could not find histogram "%s" in HistogramRegistry "%s"!)", histName.str, mName.data());
 }
 
+template <typename... Ts>
+void HistogramRegistry::fillThreadSafe(uint32_t idx, Ts... positionAndWeight)
+{
+  double values[] = {static_cast<double>(positionAndWeight)...};
+  if (fillThreadLocal(idx, values, sizeof...(Ts))) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(getFillMutex(idx));
+  std::visit([positionAndWeight...](auto&& hist) { HistFiller::fillHistAny(hist, positionAndWeight...); }, mRegistryValue[idx]);
+}
+
 template <typename... Ts>
 void HistogramRegistry::fill(const HistName& histName, Ts... positionAndWeight)
   requires(FillValue<Ts> && ...)
 {
+  if (mThreadLocalFills) {
+    fillThreadSafe(getHistIndex(histName), positionAndWeight...);
+    return;
+  }
   std::visit([positionAndWeight...](auto&& hist) { HistFiller::fillHistAny(hist, positionAndWeight...); }, mRegistryValue[getHistIndex(histName)]);
 }
 
@@ -437,10 +530,35 @@ extern template void HistogramRegistry::fill(const HistName& histName, double);
 extern template void HistogramRegistry::fill(const HistName& histName, float);
 extern template void HistogramRegistry::fill(const HistName& histName, int);
 
+template <typename... Ts>
+void HistogramRegistry::fill(const HistName& histName, gsl::span<Ts const>... positionAndWeight)
+  requires(FillValue<Ts> && ...)
+{
+  if (mThreadLocalFills) {
+    const size_t sizes[] = {positionAndWeight.size()...};
+    for (auto s : sizes) {
+      if (s != sizes[0]) {
+        LOGF(fatal, "The spans passed to the fill function called for histogram %s have different sizes.", histName.str);
+      }
+    }
+    auto idx = getHistIndex(histName);
+    for (size_t i = 0; i < sizes[0]; ++i) {
+      fillThreadSafe(idx, positionAndWeight[i]...);
+    }
+    return;
+  }
+  std::visit([&positionAndWeight...](auto&& hist) { HistFiller::fillHistAny(hist, positionAndWeight...); }, mRegistryValue[getHistIndex(histName)]);
+}
+
 template <typename... Cs, typename T>
 void HistogramRegistry::fill(const HistName& histName, const T& table, const o2::framework::expressions::Filter& filter)
 {
-  std::visit([&table, &filter](auto&& hist) { HistFiller::fillHistAny<Cs...>(hist, table, filter); }, mRegistryValue[getHistIndex(histName)]);
+  auto idx = getHistIndex(histName);
+  std::unique_lock<std::mutex> lock;
+  if (mThreadLocalFills) {
+    lock = std::unique_lock<std::mutex>(getFillMutex(idx));
+  }
+  std::visit([&table, &filter](auto&& hist) { HistFiller::fillHistAny<Cs...>(hist, table, filter); }, mRegistryValue[idx]);
 }
 
 } // namespace o2::framework
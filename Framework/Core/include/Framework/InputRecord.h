@@ -20,7 +20,10 @@
 #include "Framework/RuntimeError.h"
 #include "Framework/Logger.h"
 #include "Framework/ObjectCache.h"
+#include "Framework/SharedConditionObject.h"
+#include "Framework/DefaultsHelpers.h"
 #include "Framework/CallbackService.h"
+#include "Framework/FlatVector.h"
 
 #include "Headers/DataHeader.h"
 
@@ -33,6 +36,7 @@
 #include <cassert>
 #include <memory>
 #include <type_traits>
+#include <typeinfo>
 #include <concepts>
 
 #include <fairmq/FwdDecls.h>
@@ -64,6 +68,7 @@ class CallbackService;
 ///       information
 /// - (d) @ref TableConsumer
 /// - (f) span over messageable type T
+/// - (f') FlatVectorView over a flattened std::vector<std::vector<T>>
 /// - (g) std::vector of messageable type or type with ROOT dictionary
 /// - (h) messageable type T
 /// - (i) pointer type T* for types with ROOT dictionary or messageable types
@@ -75,6 +80,7 @@ class CallbackService;
 /// - (d) unique_ptr of TableConsumer
 /// - (e) object by move
 /// - (f) span object over original payload
+/// - (f') view of spans over original payload
 /// - (g) vector by move
 /// - (h) reference to object
 /// - (i) object with pointer-like behavior (unique_ptr)
@@ -299,6 +305,15 @@ class InputRecord
       }
       return gsl::span<ValueT const>(reinterpret_cast<ValueT const*>(ref.payload), payloadSize / sizeof(ValueT));
 
+      // implementation (f')
+    } else if constexpr (is_specialization_v<T, FlatVectorView>) {
+      auto header = DataRefUtils::getHeader<header::DataHeader*>(ref);
+      assert(header);
+      if (header->payloadSerializationMethod != o2::header::gSerializationMethodFlatVector) {
+        throw runtime_error("Inconsistent serialization method for extracting flat vector view");
+      }
+      return FlatVectorHelpers::view<typename T::value_type::value_type>(ref.payload, DataRefUtils::getPayloadSize(ref));
+
       // implementation (g)
     } else if constexpr (is_container<T>::value) {
       // currently implemented only for vectors
@@ -313,6 +328,13 @@ class InputRecord
           auto* end = start + payloadSize / sizeof(typename T::value_type);
           T result(start, end);
           return result;
+        } else if (method == o2::header::gSerializationMethodFlatVector) {
+          if constexpr (FlatVectorSerializable<std::remove_const_t<T>>) {
+            T result = FlatVectorHelpers::deserialize<std::remove_const_t<T>>(ref.payload, payloadSize);
+            return result;
+          } else {
+            throw runtime_error("Flat vector payload can only be extracted as std::vector<std::vector<T>>");
+          }
         } else if (method == o2::header::gSerializationMethodROOT) {
           /// substitution for container of non-messageable objects with ROOT dictionary
           /// Notice that this will return a copy of the actual contents of the buffer, because
@@ -360,6 +382,7 @@ class InputRecord
                          (is_messageable<PointerLessValueT>::value ||
                           has_root_dictionary<PointerLessValueT>::value ||
                           (is_specialization_v<PointerLessValueT, std::vector> && has_messageable_value_type<PointerLessValueT>::value) ||
+                          FlatVectorSerializable<PointerLessValueT> ||
                           (has_root_dictionary_mapped_type<PointerLessValueT>::value))) {
       // extract a messageable type or object with ROOT dictionary by pointer
       // return unique_ptr to message content with custom deleter
@@ -384,6 +407,13 @@ class InputRecord
           return result;
         }
         throw runtime_error("unsupported code path");
+      } else if (method == o2::header::gSerializationMethodFlatVector) {
+        if constexpr (FlatVectorSerializable<ValueT>) {
+          auto container = std::make_unique<ValueT>(FlatVectorHelpers::deserialize<ValueT>(ref.payload, payloadSize));
+          std::unique_ptr<ValueT const, Deleter<ValueT const>> result(container.release(), Deleter<ValueT const>(true));
+          return result;
+        }
+        throw runtime_error("Flat vector payload can only be extracted as std::vector<std::vector<T>>");
       } else if (method == o2::header::gSerializationMethodROOT) {
         // This supports the common case of retrieving a root object and getting pointer.
         // Notice that this will return a copy of the actual contents of the buffer, because
@@ -409,10 +439,26 @@ class InputRecord
         LOGP(debug, "{}", path);
         auto& cache = mRegistry.get<ObjectCache>();
         auto& callbacks = mRegistry.get<CallbackService>();
+        auto deserialise = [&ref, &cache, &id]() -> ValueT* {
+          if constexpr (ShareableFlatObject<ValueT>) {
+            // Flat objects can be mapped from a region shared by all the
+            // devices of the node, rather than having a copy each.
+            auto etag = DefaultsHelpers::shareConditionObjects() ? DataRefUtils::extractCCDBHeaders(ref)["ETag"] : std::string{};
+            if (!etag.empty()) {
+              auto name = SharedConditionRegion::nameFor(etag, typeid(ValueT).name());
+              auto* shared = SharedConditionObject::get<ValueT>(name, [&ref]() { return DataRefUtils::as<CCDBSerialized<ValueT>>(ref).release(); }, cache.idToRelease[id]);
+              if (shared) {
+                return shared;
+              }
+              cache.idToRelease.erase(id);
+            }
+          }
+          return DataRefUtils::as<CCDBSerialized<ValueT>>(ref).release();
+        };
         auto cacheEntry = cache.matcherToId.find(path);
         if (cacheEntry == cache.matcherToId.end()) {
           cache.matcherToId.insert(std::make_pair(path, id));
-          std::unique_ptr<ValueT const, Deleter<ValueT const>> result(DataRefUtils::as<CCDBSerialized<ValueT>>(ref).release(), false);
+          std::unique_ptr<ValueT const, Deleter<ValueT const>> result(deserialise(), false);
           void* obj = (void*)result.get();
           callbacks.call<CallbackService::Id::CCDBDeserialised>((ConcreteDataMatcher&)matcher, (void*)obj);
           cache.idToObject[id] = obj;
@@ -428,8 +474,13 @@ class InputRecord
         }
         // The id in the cache is different. Let's destroy the old cached entry
         // and create a new one.
-        delete reinterpret_cast<ValueT*>(cache.idToObject[oldId]);
-        std::unique_ptr<ValueT const, Deleter<ValueT const>> result(DataRefUtils::as<CCDBSerialized<ValueT>>(ref).release(), false);
+        if (auto release = cache.idToRelease.find(oldId); release != cache.idToRelease.end()) {
+          release->second();
+          cache.idToRelease.erase(release);
+        } else {
+          delete reinterpret_cast<ValueT*>(cache.idToObject[oldId]);
+        }
+        std::unique_ptr<ValueT const, Deleter<ValueT const>> result(deserialise(), false);
         void* obj = (void*)result.get();
         callbacks.call<CallbackService::Id::CCDBDeserialised>((ConcreteDataMatcher&)matcher, (void*)obj);
         cache.idToObject[id] = obj;
@@ -0,0 +1,107 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_LATENCYHISTOGRAM_H_
+#define O2_FRAMEWORK_LATENCYHISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace o2::framework
+{
+
+/// The stages of the processing for which we keep a latency histogram.
+enum struct LatencyStage : int {
+  INPUT_WAIT,  /// Time between the creation of the oldest input and the processing
+  PROCESSING,  /// Time spent in the user processing callback
+  OUTPUT_SEND, /// Time spent sending the outputs of a computation
+  RELAY,       /// Time spent relaying an incoming message
+  COUNT
+};
+
+/// Names of the metrics used to send the histogram of each stage to the driver.
+constexpr std::array<char const*, (int)LatencyStage::COUNT> latencyStageMetricNames = {
+  "latency_histogram_input_wait_us",
+  "latency_histogram_processing_us",
+  "latency_histogram_output_send_us",
+  "latency_histogram_relay_us"};
+
+/// HDR-like histogram of latencies, in microseconds. Buckets are
+/// log-linear: each power of two is split in SUB_BUCKETS buckets, so that
+/// the relative error is bounded to 1 / SUB_BUCKETS regardless of the
+/// magnitude. Recording is lock free and can happen from any thread.
+///
+/// Histograms are sent to the driver as string metrics, encoded as a
+/// sparse list of <bucket>:<count> pairs, in hexadecimal, separated by ';'.
+struct LatencyHistogram {
+  constexpr static int SUB_BUCKET_BITS = 2;
+  constexpr static int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+  /// Up to 2^36 us, i.e. ~19 hours, anything above ends up in the last bucket.
+  constexpr static int MAX_EXPONENT = 36;
+  constexpr static int BUCKETS = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+  static constexpr int bucketFor(uint64_t us)
+  {
+    if (us < SUB_BUCKETS) {
+      return (int)us;
+    }
+    int exponent = 63 - __builtin_clzll(us);
+    if (exponent > MAX_EXPONENT) {
+      return BUCKETS - 1;
+    }
+    int sub = (int)(us >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+  }
+
+  /// Smallest value which ends up in @a bucket.
+  static constexpr uint64_t lowerBound(int bucket)
+  {
+    if (bucket < SUB_BUCKETS) {
+      return bucket;
+    }
+    int exponent = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    uint64_t sub = bucket % SUB_BUCKETS;
+    return (SUB_BUCKETS + sub) << (exponent - SUB_BUCKET_BITS);
+  }
+
+  void record(uint64_t us)
+  {
+    counts[bucketFor(us)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  std::array<std::atomic<uint64_t>, BUCKETS> counts = {};
+  std::atomic<uint64_t> total = 0;
+};
+
+/// Plain snapshot of a LatencyHistogram, which can be merged, encoded
+/// and decoded, e.g. to aggregate the histograms of all the devices.
+struct LatencyHistogramSnapshot {
+  std::array<uint64_t, LatencyHistogram::BUCKETS> counts = {};
+  uint64_t total = 0;
+
+  static LatencyHistogramSnapshot from(LatencyHistogram const& histogram);
+  void merge(LatencyHistogramSnapshot const& other);
+  /// @return the lower bound, in microseconds, of the bucket where the
+  /// @a q quantile lies. 0 if the histogram is empty.
+  [[nodiscard]] uint64_t quantile(double q) const;
+  /// Encode the non empty buckets. If the result is larger than @a maxSize,
+  /// adjacent sub-buckets are folded together, trading resolution for space.
+  [[nodiscard]] std::string encode(size_t maxSize) const;
+  /// @return false if @a encoded is malformed.
+  static bool decode(std::string_view encoded, LatencyHistogramSnapshot& result);
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_LATENCYHISTOGRAM_H_
@@ -0,0 +1,82 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_MESSAGEARENA_H_
+#define O2_FRAMEWORK_MESSAGEARENA_H_
+
+#include <fairmq/FwdDecls.h>
+#include <fairmq/UnmanagedRegion.h>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace o2::framework
+{
+
+/// An arena from which small output messages can be sub-allocated,
+/// rather than going through the transport for each one of them.
+///
+/// The arena is a single unmanaged region, split in a number of blocks.
+/// Each block is bump allocated for a single timeslice and it's returned
+/// to the pool once the timeslice moved on and all the messages which were
+/// created from it have been released by every consumer, as notified by the
+/// region callback.
+///
+/// The arena is not thread safe with respect to create, i.e. it is
+/// meant to be owned by a stream, however the release notifications
+/// can happen from any thread.
+class MessageArena
+{
+ public:
+  /// Alignment of each message created in the arena.
+  constexpr static size_t alignment = 64;
+
+  MessageArena(fair::mq::TransportFactory* transport, size_t size, size_t blocks);
+  ~MessageArena();
+
+  /// Create a message of @a size bytes for @a timeslice, sub-allocated from
+  /// the arena. Returns nullptr if there is not enough space, so that the
+  /// caller can fall back to the transport.
+  std::unique_ptr<fair::mq::Message> create(size_t timeslice, size_t size);
+
+  /// Largest message which can be sub-allocated from the arena.
+  [[nodiscard]] size_t maxMessageSize() const { return mBlockSize / 16; }
+  [[nodiscard]] fair::mq::TransportFactory* transport() const { return mTransport; }
+  /// Number of blocks not associated to any timeslice.
+  [[nodiscard]] size_t freeBlocks() const;
+
+ private:
+  struct Block {
+    size_t timeslice = -1;
+    size_t offset = 0;
+    /// Messages created from this block and not yet released.
+    size_t pending = 0;
+    bool inUse = false;
+  };
+
+  /// Stop allocating from the current block. It will be returned to the
+  /// pool once all of its messages have been released.
+  void retireCurrent();
+  void released(std::vector<fair::mq::RegionBlock> const& blocks);
+
+  fair::mq::TransportFactory* mTransport = nullptr;
+  std::unique_ptr<fair::mq::UnmanagedRegion> mRegion;
+  size_t mBlockSize = 0;
+  std::vector<Block> mBlocks;
+  /// Block currently used for allocation, -1 if none.
+  int mCurrent = -1;
+  mutable std::mutex mMutex;
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_MESSAGEARENA_H_
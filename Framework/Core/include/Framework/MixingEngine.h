@@ -0,0 +1,132 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_MIXINGENGINE_H_
+#define O2_FRAMEWORK_MIXINGENGINE_H_
+
+#include "Framework/ASoAHelpers.h"
+#include "Framework/GroupedCombinations.h"
+#include "Framework/WorkerPool.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace o2::framework
+{
+
+/// Pairs of rows of the associated table, the first from @a collision1 and
+/// the second from @a collision2, as two parallel arrays. The rows are
+/// positions in the unfiltered table, i.e. they can be used with
+/// rawIteratorAt() or to index the arrow columns directly. The pairs of a
+/// collision pair are split over as many consecutive batches as needed.
+struct MixedPairsBatch {
+  int bin = -1;
+  int64_t collision1 = -1;
+  int64_t collision2 = -1;
+  std::vector<int64_t> first;
+  std::vector<int64_t> second;
+
+  [[nodiscard]] size_t size() const { return first.size(); }
+};
+
+struct MixingEngineOptions {
+  /// Number of threads processing the bins.
+  int threads = 1;
+  /// Assign the bins to the threads only based on the data and the number
+  /// of threads, and process the bins of a thread in ascending order, so
+  /// that each thread gets the same batches in the same order on every run.
+  /// Otherwise the bins are handed to whichever thread is free, largest first.
+  bool deterministic = false;
+  /// Maximum number of pairs in a batch.
+  size_t batchSize = 4096;
+};
+
+/// Non template parts of the MixingEngine.
+struct MixingEngineHelpers {
+  /// Group the rows of @a table by the value of the index column @a indexColumn,
+  /// which points to a table of @a groups rows. The rows pointing to group g are
+  /// rows[offsets[g]..offsets[g + 1]), in ascending order. If @a filtered, only
+  /// the rows in @a selection are considered.
+  static void groupRows(arrow::Table const& table, char const* indexColumn, gsl::span<int64_t const> selection, bool filtered,
+                        int64_t groups, std::vector<int64_t>& offsets, std::vector<int64_t>& rows);
+  /// Pair the collisions of each bin of @a grouped, whose indices are rows of
+  /// the unfiltered grouping table, with their @a catNeighbours following ones,
+  /// like CombinationsBlockStrictlyUpperSameIndexPolicy does, and invoke @a f
+  /// with the batches of the pairs of their associated rows. With multiple
+  /// threads, the bins are processed on the threads of @a pool.
+  static void mix(std::vector<soa::BinningIndex> const& grouped, std::vector<int64_t> const& offsets, std::vector<int64_t> const& rows,
+                  int catNeighbours, MixingEngineOptions const& options, WorkerPool* pool, std::function<void(int, MixedPairsBatch const&)> const& f);
+};
+
+/// Parallel version of SameKindPair<G, A, BP>, with all the pairs of rows of
+/// the associated table coming from each pair of mixed collisions. The bins
+/// are processed concurrently, on threads which are kept by the engine
+/// between the invocations of process(), and @a f(thread, batch) is invoked with the
+/// index of the thread doing the work, so that the callback can accumulate
+/// into per-thread outputs without locking. Batches of a given collision pair
+/// are always delivered by the same thread, and collision pairs without any
+/// associated pair are skipped. With a single thread, the pairs come in the
+/// same order as when looping over the combinations of the slices returned by
+/// SameKindPair with CombinationsFullIndexPolicy.
+template <typename BP, typename T1, typename G, typename A>
+class MixingEngine
+{
+ public:
+  MixingEngine(BP const& binningPolicy, int catNeighbours, T1 const& outsider, MixingEngineOptions options = {})
+    : mBP{binningPolicy}, mCatNeighbours{catNeighbours}, mOutsider{outsider}, mOptions{options}
+  {
+    if (mOptions.threads > 1) {
+      mPool = std::make_shared<WorkerPool>();
+    }
+  }
+
+  template <typename F>
+  void process(G const& grouping, A const& associated, F&& f)
+  {
+    if (mCatNeighbours < 1) {
+      return;
+    }
+    auto grouped = soa::groupTable(grouping, mBP, 2, mOutsider);
+    if (grouped.empty()) {
+      return;
+    }
+    // The grouping policies use positions in the filtered table, while the
+    // index column points to the unfiltered one.
+    if constexpr (soa::is_filtered_table<G>) {
+      auto selected = grouping.getSelectedRows();
+      for (auto& entry : grouped) {
+        entry.index = selected[entry.index];
+      }
+    }
+    gsl::span<int64_t const> selection;
+    if constexpr (soa::is_filtered_table<A>) {
+      selection = associated.getSelectedRows();
+    }
+    std::vector<int64_t> offsets;
+    std::vector<int64_t> rows;
+    auto index = getMatchingIndexNode<G, A>();
+    MixingEngineHelpers::groupRows(*associated.asArrowTable(), index.name, selection, soa::is_filtered_table<A>,
+                                   grouping.asArrowTable()->num_rows(), offsets, rows);
+    MixingEngineHelpers::mix(grouped, offsets, rows, mCatNeighbours, mOptions, mPool.get(), std::forward<F>(f));
+  }
+
+ private:
+  BP mBP;
+  int mCatNeighbours;
+  T1 mOutsider;
+  MixingEngineOptions mOptions;
+  std::shared_ptr<WorkerPool> mPool; // threads kept between the invocations of process(), when mOptions.threads > 1
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_MIXINGENGINE_H_
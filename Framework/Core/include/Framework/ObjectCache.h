@@ -12,6 +12,7 @@
 #define O2_FRAMEWORK_OBJECTCACHE_H_
 
 #include "Framework/DataRef.h"
+#include <functional>
 #include <unordered_map>
 #include <map>
 
@@ -47,6 +48,9 @@ struct ObjectCache {
   /// A map from a CacheId (which is the void* ptr of the previous map).
   /// to an actual (type erased) pointer to the deserialised object.
   std::unordered_map<Id, void*, Id::hash_fn> idToObject;
+  /// How to dispose the objects which were not simply allocated
+  /// with new, e.g. the ones mapped from shared memory.
+  std::unordered_map<Id, std::function<void()>, Id::hash_fn> idToRelease;
 
   /// A cache to the deserialised metadata
   /// We keep it separate because we want to avoid that looking up
@@ -0,0 +1,44 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_PARALLELPROCESSING_H_
+#define O2_FRAMEWORK_PARALLELPROCESSING_H_
+
+#include "Framework/WorkerPool.h"
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace o2::framework
+{
+
+/// Support for the processParallel() variant of the process functions of
+/// the analysis tasks. The rows of the grouping table are split into
+/// contiguous ranges, the partitions, which are processed concurrently.
+/// The outputs filled while processing a partition are kept aside, and
+/// added in the order of the partitions at the end, so that they do not
+/// depend on the number of threads.
+struct ParallelProcessing {
+  /// Split @a rows rows in contiguous [begin, end) ranges, enough of them
+  /// to keep @a threads threads busy even if their sizes are uneven.
+  static std::vector<std::pair<int64_t, int64_t>> partition(int64_t rows, int threads);
+  /// Invoke @a work(partition) for all the partitions, on at most @a threads
+  /// threads of @a pool. The first exception thrown is rethrown once all the
+  /// threads are done.
+  static void run(WorkerPool& pool, size_t partitions, int threads, std::function<void(size_t)> const& work);
+  /// @return the partition being processed by the calling thread, -1 if none
+  static int currentPartition();
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_PARALLELPROCESSING_H_
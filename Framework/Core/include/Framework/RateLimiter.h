@@ -20,12 +20,33 @@
 
 namespace o2::framework
 {
+/// Closed loop controller for the number of timeframes in flight.
+/// The limit is halved (at most once per round trip) whenever the
+/// shared memory occupancy goes above the target and it grows by one
+/// timeframe per round trip while the occupancy is below it and the
+/// limit is actually what is holding back the source.
+struct AdaptiveRateLimit {
+  /// Occupancy of the shared memory segment we aim for, between 0 and 1.
+  float targetOccupancy = 0.8f;
+  /// Current limit, kept as a float so that it can grow of a fraction
+  /// of timeframe for each one which got consumed.
+  float limit = 0.f;
+  /// Timeframes sent when we last reduced the limit. We do not
+  /// reduce it again until those have been consumed.
+  int64_t lastDecreaseSent = -1;
+
+  /// @return the number of timeframes which can be in flight, given
+  /// the current @a occupancy and the counters of sent and consumed timeframes.
+  int update(int maxInFlight, int64_t sent, int64_t consumed, float occupancy);
+};
+
 class RateLimiter
 {
  public:
   int check(ProcessingContext& ctx, int maxInFlight, size_t minSHM);
 
  private:
+  AdaptiveRateLimit mAdaptive;
   int64_t mConsumedTimeframes = 0;
   int64_t mSentTimeframes = 0;
 
@@ -0,0 +1,75 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_SENDQUEUE_H_
+#define O2_FRAMEWORK_SENDQUEUE_H_
+
+#include "Framework/RoutingIndices.h"
+#include <fairmq/Parts.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace o2::framework
+{
+
+/// Bounded FIFO of outputs, drained by a dedicated thread which invokes
+/// the send callback. A single FIFO keeps the ordering of the sends,
+/// also across channels.
+///
+/// If the send callback throws, the exception is kept and rethrown by the
+/// next push() or flush() on the calling thread, so that it reaches the
+/// processing loop like it would when sending synchronously. Whatever was
+/// queued after the failure is dropped.
+class SendQueue
+{
+ public:
+  using SendCallback = std::function<void(fair::mq::Parts&, ChannelIndex)>;
+
+  SendQueue(size_t maxQueued, SendCallback send);
+  /// Sends whatever is still queued before returning.
+  ~SendQueue();
+  SendQueue(SendQueue const&) = delete;
+  SendQueue& operator=(SendQueue const&) = delete;
+
+  /// Move @a parts to the queue, blocking while it holds maxQueued entries.
+  void push(fair::mq::Parts& parts, ChannelIndex index);
+  /// Wait until everything which was queued has been sent.
+  void flush();
+
+ private:
+  struct PendingSend {
+    fair::mq::Parts parts;
+    ChannelIndex index;
+  };
+  void run();
+  /// Rethrow a failure of the sender thread. Needs mMutex to be held.
+  void rethrowError();
+
+  size_t mMaxQueued;
+  SendCallback mSend;
+  /// Sends queued or in progress, used to flush.
+  size_t mPending = 0;
+  bool mStopping = false;
+  std::exception_ptr mError;
+  std::deque<PendingSend> mQueue;
+  std::mutex mMutex;
+  std::condition_variable mChanged;
+  std::thread mThread;
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_SENDQUEUE_H_
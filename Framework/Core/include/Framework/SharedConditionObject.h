@@ -0,0 +1,132 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_SHAREDCONDITIONOBJECT_H_
+#define O2_FRAMEWORK_SHAREDCONDITIONOBJECT_H_
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace o2::framework
+{
+
+/// Objects which keep all their variable sized data in a single flat
+/// buffer, which can be relocated, like the ones deriving from FlatObject.
+template <typename T>
+concept ShareableFlatObject = std::is_default_constructible_v<T> && requires(T& object, T const& other, char* buffer) {
+  object.cloneFromObject(other, buffer);
+  object.setActualBufferAddress(buffer);
+  { other.getFlatBufferSize() } -> std::convertible_to<size_t>;
+};
+
+/// A named region of shared memory holding a deserialised condition object,
+/// so that the devices on a node which need the same object do not keep
+/// a private copy each.
+///
+/// The first device to claim a name fills the region and publishes it.
+/// Every device, including the creator, then attaches to it with a private
+/// copy-on-write mapping: relocating the pointers of the object only copies
+/// the pages they live in, while the bulk of the data stays shared. The
+/// region is removed when the last device detaches from it. Names are
+/// scoped to the DPL session, so that the driver can remove whatever is
+/// left behind by devices which crashed or were killed.
+class SharedConditionRegion
+{
+ public:
+  ~SharedConditionRegion();
+
+  /// Set the DPL session the regions created by this process belong to.
+  static void setSession(std::string_view session);
+  /// Name of the region for the object of type @a type with the given
+  /// CCDB @a etag, in the current session. Objects are immutable for a
+  /// given etag, so they can be shared by all the devices of the session.
+  static std::string nameFor(std::string_view etag, std::string_view type);
+  /// Remove all the regions of @a session, regardless of their users.
+  /// Meant to be called by the driver once the devices are gone.
+  static void cleanup(std::string_view session);
+  /// @return a region to be filled, nullptr if someone else already
+  /// claimed @a name.
+  static std::unique_ptr<SharedConditionRegion> claim(std::string const& name);
+  /// Attach to the region @a name, waiting for it to be published.
+  /// @return nullptr if it does not exist or its creator gave up.
+  static std::unique_ptr<SharedConditionRegion> attach(std::string const& name);
+
+  /// Allocate @a size bytes for the payload of a claimed region.
+  char* allocate(size_t size);
+  /// Make a claimed region available to the others.
+  void publish();
+
+  [[nodiscard]] char* payload() const { return mPayload; }
+  [[nodiscard]] size_t size() const { return mSize; }
+
+ private:
+  struct Header;
+  SharedConditionRegion(std::string name, int fd, Header* header);
+
+  std::string mName;
+  int mFd = -1;
+  Header* mHeader = nullptr;
+  char* mPayload = nullptr;
+  size_t mSize = 0;
+};
+
+struct SharedConditionObject {
+  /// Offset of the flat buffer after the object, in the payload of the region.
+  template <typename T>
+  static constexpr size_t bufferOffset()
+  {
+    return (sizeof(T) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+  }
+
+  /// @return the object stored in the region @a name, creating the
+  /// region with the result of @a deserialise if needed. @a release is set
+  /// to what needs to be called to dispose the object. nullptr if the
+  /// object could not be shared, in which case the caller should
+  /// deserialise its own copy.
+  template <ShareableFlatObject T, typename F>
+  static T* get(std::string const& name, F&& deserialise, std::function<void()>& release)
+  {
+    // The creator keeps the region alive until we are attached to it.
+    auto creator = SharedConditionRegion::claim(name);
+    if (creator) {
+      std::unique_ptr<T> object(deserialise());
+      char* payload = creator->allocate(bufferOffset<T>() + object->getFlatBufferSize());
+      if (payload == nullptr) {
+        return nullptr;
+      }
+      auto* shared = new (payload) T();
+      shared->cloneFromObject(*object, payload + bufferOffset<T>());
+      creator->publish();
+    }
+    std::shared_ptr<SharedConditionRegion> region = SharedConditionRegion::attach(name);
+    creator.reset();
+    if (!region || region->size() < bufferOffset<T>()) {
+      return nullptr;
+    }
+    // The flat buffer was filled at the address of the creator, relocate it.
+    auto* object = reinterpret_cast<T*>(region->payload());
+    object->setActualBufferAddress(region->payload() + bufferOffset<T>());
+    release = [object, region]() mutable {
+      object->~T();
+      region.reset();
+    };
+    return object;
+  }
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_SHAREDCONDITIONOBJECT_H_
@@ -37,6 +37,8 @@ class StepTHn : public TNamed
   template <typename... Ts>
   void Fill(int iStep, const Ts&... valuesAndWeight);
   void Fill(int iStep, int nParams, double positionAndWeight[]);
+  // add the content of mNBins bins, in the same order as the internal containers, to step iStep
+  void addContents(int iStep, const double* values, const double* sumw2, bool weighted);
 
   THnBase* getTHn(Int_t step, Bool_t sparse = kFALSE)
   {
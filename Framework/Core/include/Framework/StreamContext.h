@@ -15,6 +15,7 @@
 #include "ProcessingContext.h"
 #include "ServiceSpec.h"
 #include <functional>
+#include <mutex>
 
 namespace o2::framework
 {
@@ -43,6 +44,10 @@ struct StreamContext {
   void finaliseOutputsCallbacks(ProcessingContext&);
   void postProcessingCallbacks(ProcessingContext& pcx);
 
+  /// The lock on DataProcessorContext::streamsMutex this stream holds
+  /// while running, nullptr when there is a single stream.
+  std::unique_lock<std::mutex>* streamsLock = nullptr;
+
   /// Invoke callbacks to be executed before every EOS user callback invokation
   void preEOSCallbacks(EndOfStreamContext& eosContext);
   /// Invoke callbacks to be executed after every EOS user callback invokation
@@ -660,6 +660,8 @@ class TableBuilder
   }
 
   void validate() const;
+  /// Annotate the fields of the schema with the codecs of the columns
+  void setColumnCodecs(std::vector<soa::ColumnCodec> const& codecs);
 
   template <typename... ARGS, size_t I = sizeof...(ARGS)>
   auto makeBuilders(std::array<char const*, I> const& columnNames, size_t nRows)
@@ -774,21 +776,27 @@ class TableBuilder
   auto cursor()
   {
     return [this]<typename... Cs>(pack<Cs...>) {
-      return this->template persist<typename Cs::type...>({Cs::columnLabel()...});
+      auto result = this->template persist<typename Cs::type...>({Cs::columnLabel()...});
+      setColumnCodecs({Cs::codec()...});
+      return result;
     }(typename T::table_t::persistent_columns_t{});
   }
 
   template <typename... Cs>
   auto cursor(framework::pack<Cs...>)
   {
-    return this->template persist<typename Cs::type...>({Cs::columnLabel()...});
+    auto result = this->template persist<typename Cs::type...>({Cs::columnLabel()...});
+    setColumnCodecs({Cs::codec()...});
+    return result;
   }
 
   template <typename T, typename E>
   auto cursor()
   {
     return [this]<typename... Cs>(pack<Cs...>) {
-      return this->template persist<E>({Cs::columnLabel()...});
+      auto result = this->template persist<E>({Cs::columnLabel()...});
+      setColumnCodecs({Cs::codec()...});
+      return result;
     }(typename T::table_t::persistent_columns_t{});
   }
 
@@ -887,6 +895,11 @@ auto makeEmptyTable(const char* name, framework::pack<Cs...> p)
 std::shared_ptr<arrow::Table> spawnerHelper(std::shared_ptr<arrow::Table> const& fullTable, std::shared_ptr<arrow::Schema> newSchema, size_t nColumns,
                                             expressions::Projector* projectors, std::vector<std::shared_ptr<arrow::Field>> const& fields, const char* name);
 
+/// Drop the columns spawned from data which is gone, so that the cache of
+/// spawnerHelper does not keep them alive once a dataframe is processed.
+/// @return the number of record batches left in the cache
+size_t pruneSpawnedBatches();
+
 /// Expression-based column generator to materialize columns
 template <aod::is_aod_hash D>
 auto spawner(std::vector<std::shared_ptr<arrow::Table>>&& tables, const char* name)
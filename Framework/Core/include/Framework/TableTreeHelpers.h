@@ -34,6 +34,18 @@ namespace o2::framework
 //    OR t2t.addBranch(column.get(), field.get()), ...;
 //  . t2t.process();
 //
+// Calling t2t.enableSliceIndices() before adding the branches also stores
+// the groups of the sorted index columns in the user info of the tree, so
+// that they do not need to be recomputed when the tree is read back.
+// Likewise, t2t.enableColumnRanges() stores the range of values of the
+// numeric columns, which allows to skip the evaluation of filters which
+// select all or none of the rows.
+// t2t.enableColumnCodecs() encodes the integral columns whose field carries
+// a codec (see DECLARE_SOA_COLUMN_CODEC) and records it in the user info of
+// the tree, so that TreeToTable can decode them. The encoded branches get
+// the codec as suffix, so that readers unaware of it fail loudly. Rows
+// appended to a tree with encoded columns are always encoded the same way.
+//
 // .............................................................................
 // -----------------------------------------------------------------------------
 // TreeToTable allows to fill the contents of a given TTree to an arrow::Table
@@ -56,6 +68,19 @@ struct ROOTTypeInfo {
 auto arrowTypeFromROOT(EDataType type, int size);
 auto basicROOTTypeFromArrow(arrow::Type::type id);
 
+/// Undo in place the codec applied by TableToTree to the @a length values
+/// of @a size bytes of the scalar branch @a name of @a tree.
+/// @return the codec which was undone, ColumnCodec::None if the branch is
+/// not encoded
+soa::ColumnCodec decodeColumn(TTree* tree, char const* name, uint8_t* values, int64_t length, int size);
+
+/// The encoded columns are stored in a branch named after the column and
+/// the codec, e.g. fIndexCollisions_delta.
+/// @return the branch of @a tree holding the column @a name, nullptr if none
+TBranch* columnBranch(TTree* tree, std::string const& name);
+/// @return the name of the column stored in @a branch
+std::string columnName(TBranch* branch);
+
 class BranchToColumn
 {
  public:
@@ -89,10 +114,15 @@ class ColumnToBranch
   [[nodiscard]] int fieldSize() const { return mFieldSize; }
   [[nodiscard]] int columnEntries() const { return mColumn->length(); }
   [[nodiscard]] char const* branchName() const { return mBranchName.c_str(); }
+  /// Write the difference to the previous value, starting from @a previous
+  void enableDelta(uint64_t previous);
+  [[nodiscard]] bool delta() const { return mDelta; }
+  [[nodiscard]] uint64_t lastValue() const { return mPrevious; }
 
  private:
   void accessChunk();
   void nextChunk();
+  uint8_t const* encodeDelta(uint8_t const* value);
 
   std::string mBranchName;
   TBranch* mBranch = nullptr;
@@ -107,6 +137,9 @@ class ColumnToBranch
   std::shared_ptr<arrow::Array> mCurrentArray = nullptr;
   int64_t mChunkLength = 0;
   int mFieldSize = 0;
+  bool mDelta = false;
+  uint64_t mPrevious = 0;
+  uint64_t mDeltaValue = 0;
 };
 
 class TableToTree
@@ -117,12 +150,24 @@ class TableToTree
   std::shared_ptr<TTree> process();
   void addBranch(std::shared_ptr<arrow::ChunkedArray> const& column, std::shared_ptr<arrow::Field> const& field);
   void addAllBranches();
+  void enableSliceIndices();
+  void enableColumnRanges();
+  void enableColumnCodecs();
 
  private:
+  void storeSliceIndices(int64_t previousEntries);
+  void storeColumnRanges(int64_t previousEntries);
+  void storeColumnCodecs();
+
   arrow::Table* mTable;
   int64_t mRows = 0;
   std::shared_ptr<TTree> mTree;
   std::vector<std::unique_ptr<ColumnToBranch>> mColumnReaders;
+  bool mSliceIndices = false;
+  std::vector<std::pair<std::string, std::shared_ptr<arrow::ChunkedArray>>> mIndexColumns;
+  bool mColumnRanges = false;
+  std::vector<std::pair<std::string, std::shared_ptr<arrow::ChunkedArray>>> mRangeColumns;
+  bool mColumnCodecs = false;
 };
 
 class TreeToTable
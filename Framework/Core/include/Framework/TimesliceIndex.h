@@ -19,6 +19,7 @@
 #include "Framework/TimesliceSlot.h"
 #include "Framework/ChannelInfo.h"
 
+#include <atomic>
 #include <cstdint>
 #include <vector>
 #include <algorithm>
@@ -82,6 +83,11 @@ class TimesliceIndex
 
   TimesliceIndex(size_t maxLanes, std::vector<InputChannelInfo>& channels);
   void resize(size_t s);
+  /// Partition the slots in @a shards groups, so that a given timeslice
+  /// can only be associated to a slot of the group timeslice % shards.
+  /// This is on top of the partitioning already done for the lanes.
+  void setShards(size_t shards);
+  [[nodiscard]] size_t getShards() const { return mShards; }
   [[nodiscard]] inline size_t size() const;
   [[nodiscard]] inline bool isValid(TimesliceSlot const& slot) const;
   [[nodiscard]] inline bool isDirty(TimesliceSlot const& slot) const;
@@ -147,8 +153,10 @@ class TimesliceIndex
   std::vector<data_matcher::VariableContext> mPublishedVariables;
 
   /// This keeps track whether or not something was relayed
-  /// since last time we called getReadyToProcess()
-  std::vector<bool> mDirty;
+  /// since last time we called getReadyToProcess(). Each slot
+  /// has its own atomic flag so that different slots can be
+  /// updated concurrently by a sharded DataRelayer.
+  std::vector<std::atomic<bool>> mDirty;
 
   /// This is the oldest possible timeslice for any given channel
   /// The cardinality of this vector is the number of input channels
@@ -162,6 +170,8 @@ class TimesliceIndex
   BackpressureOp mBackpressurePolicy = BackpressureOp::Wait;
   /// The maximum number of lanes for this timeslice index
   size_t mMaxLanes;
+  /// The number of shards the slots are partitioned into
+  size_t mShards = 1;
 };
 
 } // namespace o2::framework
@@ -0,0 +1,102 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_TIMESLICESINFLIGHT_H_
+#define O2_FRAMEWORK_TIMESLICESINFLIGHT_H_
+
+#include "Framework/DataProcessingContext.h"
+#include "Framework/DataRelayer.h"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace o2::framework
+{
+
+/// Registers the timeslices a stream is about to process, so that the
+/// outputs of all the streams of a DataProcessor can be released in
+/// timeslice order. Only does something when running with multiple
+/// streams and expects the streamsMutex to be held when invoked.
+struct TimeslicesInFlight {
+  DataProcessorContext& context;
+  std::vector<size_t> owned;
+
+  TimeslicesInFlight(DataProcessorContext& context_, std::vector<DataRelayer::RecordAction> const& actions)
+    : context{context_}
+  {
+    if (context.streams <= 1) {
+      return;
+    }
+    for (auto& action : actions) {
+      if (action.op == CompletionPolicy::CompletionOp::Wait) {
+        continue;
+      }
+      owned.push_back(action.timeslice.value);
+      context.timeslicesInFlight.push_back(action.timeslice.value);
+    }
+  }
+
+  /// Wait until all the timeslices older than @a timeslice have been released.
+  /// @a lock is the one the stream holds on the streamsMutex, nullptr with
+  /// a single stream.
+  void waitForOlder(size_t timeslice, std::unique_lock<std::mutex>* lock)
+  {
+    if (context.streams <= 1 || lock == nullptr) {
+      return;
+    }
+    context.timesliceReleased.wait(*lock, [this, timeslice]() {
+      return *std::min_element(context.timeslicesInFlight.begin(), context.timeslicesInFlight.end()) >= timeslice;
+    });
+  }
+
+  void release(size_t timeslice)
+  {
+    auto pos = std::find(owned.begin(), owned.end(), timeslice);
+    if (pos == owned.end()) {
+      return;
+    }
+    owned.erase(pos);
+    auto& inFlight = context.timeslicesInFlight;
+    inFlight.erase(std::find(inFlight.begin(), inFlight.end(), timeslice));
+    context.timesliceReleased.notify_all();
+  }
+
+  ~TimeslicesInFlight()
+  {
+    while (owned.empty() == false) {
+      release(owned.back());
+    }
+  }
+};
+
+/// Releases the streamsMutex while the user code runs, so that
+/// multiple streams can actually process in parallel. @a lock is
+/// the one the stream holds, nullptr with a single stream.
+struct StreamsUnlock {
+  std::unique_lock<std::mutex>* lock;
+
+  explicit StreamsUnlock(std::unique_lock<std::mutex>* lock_) : lock{lock_}
+  {
+    if (lock) {
+      lock->unlock();
+    }
+  }
+
+  ~StreamsUnlock()
+  {
+    if (lock) {
+      lock->lock();
+    }
+  }
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_TIMESLICESINFLIGHT_H_
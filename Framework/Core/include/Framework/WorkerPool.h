@@ -0,0 +1,68 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_WORKERPOOL_H_
+#define O2_FRAMEWORK_WORKERPOOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace o2::framework
+{
+
+/// A set of threads which are kept alive between the invocations of run(),
+/// so that running a few jobs at every timeframe does not create and
+/// destroy threads each time. Workers are only started when a run() needs
+/// them and are joined by the destructor.
+class WorkerPool
+{
+ public:
+  WorkerPool() = default;
+  ~WorkerPool();
+  WorkerPool(WorkerPool const&) = delete;
+  WorkerPool& operator=(WorkerPool const&) = delete;
+
+  /// Invoke @a job(i) for all i in [0, @a nJobs), on at most @a threads
+  /// threads including the calling one, which also picks jobs. Jobs are
+  /// picked in the order of their indices. The first exception thrown is
+  /// rethrown once all the threads are done, and no new job is started
+  /// after it. If the pool is already running jobs, e.g. when called from
+  /// within a job, the jobs run sequentially in the calling thread.
+  void run(size_t nJobs, size_t threads, std::function<void(size_t)> const& job);
+
+  /// Number of worker threads started so far.
+  [[nodiscard]] size_t workers() const;
+
+ private:
+  struct Batch;
+  void work();
+
+  std::mutex mRunMutex;
+  mutable std::mutex mMutex;
+  std::condition_variable mChanged;
+  std::vector<std::thread> mWorkers;
+  Batch* mBatch = nullptr;
+  /// Incremented for every batch, so that a worker joins each one at most once.
+  uint64_t mGeneration = 0;
+  /// Workers which may still join the current batch.
+  size_t mWanted = 0;
+  /// Workers currently running jobs of the current batch.
+  size_t mBusy = 0;
+  bool mStopping = false;
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_WORKERPOOL_H_
@@ -14,6 +14,7 @@
 #include "Framework/ArrowContext.h"
 #include "Framework/ArrowTableSlicingCache.h"
 #include "Framework/SliceCache.h"
+#include "Framework/TableBuilder.h"
 #include "Framework/DataProcessor.h"
 #include "Framework/DataProcessingStats.h"
 #include "Framework/ServiceRegistry.h"
@@ -393,7 +394,10 @@ o2::framework::ServiceSpec ArrowSupport::arrowBackendSpec()
                        auto& stats = ctx.services().get<DataProcessingStats>();
                        stats.updateStats({static_cast<short>(ProcessingStatsId::ARROW_BYTES_DESTROYED), DataProcessingStats::Op::Set, static_cast<int64_t>(arrow->bytesDestroyed())});
                        stats.updateStats({static_cast<short>(ProcessingStatsId::ARROW_MESSAGES_DESTROYED), DataProcessingStats::Op::Set, static_cast<int64_t>(arrow->messagesDestroyed())});
-                       stats.processCommandQueue(); },
+                       stats.processCommandQueue();
+                       // The tables of the dataframe are gone, so are the
+                       // columns which were spawned from them.
+                       pruneSpawnedBatches(); },
     .driverInit = [](ServiceRegistryRef registry, DeviceConfig const& dc) {
                        auto config = new RateLimitConfig{};
                        int readers = std::stoll(dc.options["readers"].as<std::string>());
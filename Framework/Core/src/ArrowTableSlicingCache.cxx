@@ -12,9 +12,13 @@
 #include "Framework/ArrowTableSlicingCache.h"
 #include "Framework/RuntimeError.h"
 
+#include <arrow/builder.h>
 #include <arrow/compute/api_aggregate.h>
 #include <arrow/compute/kernel.h>
 #include <arrow/table.h>
+#include <arrow/util/key_value_metadata.h>
+
+#include <cstring>
 
 namespace o2::framework
 {
@@ -107,6 +111,9 @@ arrow::Status ArrowTableSlicingCache::updateCacheEntry(int pos, std::shared_ptr<
     counts[pos].reset();
     return arrow::Status::OK();
   }
+  if (usePrecomputed(pos, table)) {
+    return arrow::Status::OK();
+  }
   validateOrder(bindingsKeys[pos], table);
   arrow::Datum value_counts;
   auto options = arrow::compute::ScalarAggregateOptions::Defaults();
@@ -121,6 +128,82 @@ arrow::Status ArrowTableSlicingCache::updateCacheEntry(int pos, std::shared_ptr<
   return arrow::Status::OK();
 }
 
+std::string ArrowTableSlicingCache::precomputedValuesKey(std::string const& key)
+{
+  return "slice-values:" + key;
+}
+
+std::string ArrowTableSlicingCache::precomputedCountsKey(std::string const& key)
+{
+  return "slice-counts:" + key;
+}
+
+bool ArrowTableSlicingCache::usePrecomputed(int pos, std::shared_ptr<arrow::Table> const& table)
+{
+  auto const& metadata = table->schema()->metadata();
+  if (!metadata) {
+    return false;
+  }
+  auto const& key = bindingsKeys[pos].second;
+  auto valuesPos = metadata->FindKey(precomputedValuesKey(key));
+  auto countsPos = metadata->FindKey(precomputedCountsKey(key));
+  if (valuesPos == -1 || countsPos == -1) {
+    return false;
+  }
+  // Arrays are stored as raw bytes, in native byte order
+  auto const& rawValues = metadata->value(valuesPos);
+  auto const& rawCounts = metadata->value(countsPos);
+  auto size = rawValues.size() / sizeof(int32_t);
+  if (rawValues.size() % sizeof(int32_t) != 0 || rawCounts.size() != size * sizeof(int64_t)) {
+    return false;
+  }
+  std::vector<int32_t> groupValues(size);
+  std::vector<int64_t> groupCounts(size);
+  std::memcpy(groupValues.data(), rawValues.data(), rawValues.size());
+  std::memcpy(groupCounts.data(), rawCounts.data(), rawCounts.size());
+
+  // Make sure they still describe this table, e.g. in case it was merged
+  // with another one after being written: the groups must cover all the
+  // rows and each one must start with its value. This only looks at one
+  // row per group.
+  auto column = table->GetColumnByName(key);
+  if (column == nullptr) {
+    return false;
+  }
+  int64_t offset = 0;
+  int64_t chunkStart = 0;
+  int chunk = 0;
+  for (size_t gi = 0; gi < size; ++gi) {
+    if (groupCounts[gi] <= 0 || offset >= table->num_rows()) {
+      return false;
+    }
+    while (offset - chunkStart >= column->chunk(chunk)->length()) {
+      chunkStart += column->chunk(chunk)->length();
+      ++chunk;
+    }
+    auto array = static_cast<arrow::NumericArray<arrow::Int32Type>>(column->chunk(chunk)->data());
+    if (array.Value(offset - chunkStart) != groupValues[gi]) {
+      return false;
+    }
+    offset += groupCounts[gi];
+  }
+  if (offset != table->num_rows()) {
+    return false;
+  }
+
+  arrow::Int32Builder valuesBuilder;
+  arrow::Int64Builder countsBuilder;
+  std::shared_ptr<arrow::Array> valuesArray;
+  std::shared_ptr<arrow::Array> countsArray;
+  if (!valuesBuilder.AppendValues(groupValues).ok() || !valuesBuilder.Finish(&valuesArray).ok() ||
+      !countsBuilder.AppendValues(groupCounts).ok() || !countsBuilder.Finish(&countsArray).ok()) {
+    return false;
+  }
+  values[pos] = std::static_pointer_cast<arrow::NumericArray<arrow::Int32Type>>(valuesArray);
+  counts[pos] = std::static_pointer_cast<arrow::NumericArray<arrow::Int64Type>>(countsArray);
+  return true;
+}
+
 arrow::Status ArrowTableSlicingCache::updateCacheEntryUnsorted(int pos, const std::shared_ptr<arrow::Table>& table)
 {
   valuesUnsorted[pos].clear();
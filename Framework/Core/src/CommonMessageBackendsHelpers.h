@@ -14,6 +14,7 @@
 #include "Framework/RawDeviceService.h"
 #include "Framework/DataProcessor.h"
 #include "Framework/DataSender.h"
+#include "Framework/DataProcessingStats.h"
 #include "Framework/ProcessingContext.h"
 #include "Framework/EndOfStreamContext.h"
 #include "Framework/FairMQDeviceProxy.h"
@@ -21,6 +22,7 @@
 #include "Framework/Tracing.h"
 
 #include <fairmq/ProgOptions.h>
+#include <uv.h>
 
 namespace o2::framework
 {
@@ -39,7 +41,9 @@ struct CommonMessageBackendsHelpers {
   {
     return [](ProcessingContext& ctx, void* service) {
       T* context = reinterpret_cast<T*>(service);
+      uint64_t tStart = uv_hrtime();
       DataProcessor::doSend(ctx.services().get<DataSender>(), *context, ctx.services());
+      ctx.services().get<DataProcessingStats>().recordLatency(LatencyStage::OUTPUT_SEND, uv_hrtime() - tStart);
     };
   }
 
@@ -24,11 +24,13 @@
 #include "Framework/DataRelayer.h"
 #include "Framework/Signpost.h"
 #include "Framework/DataProcessingStats.h"
+#include "Framework/DeviceMetricsInfo.h"
 #include "Framework/DataProcessingStates.h"
 #include "Framework/TimingHelpers.h"
 #include "Framework/CommonMessageBackends.h"
 #include "Framework/DanglingContext.h"
 #include "Framework/DataProcessingHelpers.h"
+#include "Framework/DataProcessorSpecHelpers.h"
 #include "InputRouteHelpers.h"
 #include "Framework/EndOfStreamContext.h"
 #include "Framework/RawDeviceService.h"
@@ -741,6 +743,12 @@ o2::framework::ServiceSpec CommonServices::threadPool(int numWorkers)
       auto* pool = new ThreadPool();
       // FIXME: this will require some extra argument for the configuration context of a service
       pool->poolSize = 1;
+      // Multiple streams are executed on the libuv worker pool, which is
+      // sized from the environment when the first work is queued.
+      auto streams = DataProcessorSpecHelpers::getRequestedStreams(services.get<DeviceSpec const>().metadata);
+      if (streams > 1) {
+        setenv("UV_THREADPOOL_SIZE", std::to_string(streams).c_str(), 1);
+      }
       return ServiceHandle{TypeIdHelpers::uniqueId<ThreadPool>(), pool};
     },
     .configure = [](InitContext&, void* service) -> void* {
@@ -803,6 +811,12 @@ auto sendRelayerMetrics(ServiceRegistryRef registry, DataProcessingStats& stats)
 
   stats.updateStats({static_cast<short>(ProcessingStatsId::TOTAL_RATE_IN_MB_S), DataProcessingStats::Op::InstantaneousRate, totalBytesIn / 1000000});
   stats.updateStats({static_cast<short>(ProcessingStatsId::TOTAL_RATE_OUT_MB_S), DataProcessingStats::Op::InstantaneousRate, totalBytesOut / 1000000});
+
+  // Cost of the completion checks in the relayer
+  auto& scanStats = registry.get<DataRelayer>().getScanStats();
+  stats.updateStats({static_cast<short>(ProcessingStatsId::RELAYER_COMPLETION_CHECKS), DataProcessingStats::Op::Set, (int64_t)scanStats.completionChecks});
+  stats.updateStats({static_cast<short>(ProcessingStatsId::RELAYER_COMPLETION_SKIPPED), DataProcessingStats::Op::Set, (int64_t)scanStats.completionSkipped});
+  stats.updateStats({static_cast<short>(ProcessingStatsId::RELAYER_INPUTS_SCANNED), DataProcessingStats::Op::Set, (int64_t)scanStats.inputsScanned});
 };
 
 auto flushStates(ServiceRegistryRef registry, DataProcessingStates& states) -> void
@@ -859,6 +873,29 @@ auto flushMetrics(ServiceRegistryRef registry, DataProcessingStats& stats) -> vo
   monitoring.flushBuffer();
   O2_SIGNPOST_END(monitoring_service, sid, "flush", "done flushing metrics");
 };
+
+/// Send the latency histograms which changed to the driver, at most
+/// once every 5 seconds unless @a force is true.
+auto sendLatencyHistograms(ServiceRegistryRef registry, DataProcessingStats& stats, bool force) -> void
+{
+  auto now = (int64_t)uv_now(registry.get<DeviceState>().loop);
+  if (force == false && now - stats.lastLatenciesSent < 5000) {
+    return;
+  }
+  stats.lastLatenciesSent = now;
+  auto& monitoring = registry.get<Monitoring>();
+  for (size_t si = 0; si < stats.latencies.size(); ++si) {
+    auto snapshot = LatencyHistogramSnapshot::from(stats.latencies[si]);
+    if (snapshot.total == stats.lastSentLatencies[si]) {
+      continue;
+    }
+    stats.lastSentLatencies[si] = snapshot.total;
+    // The histogram is cumulative, so the driver only needs the last one.
+    auto metric = o2::monitoring::Metric{snapshot.encode(StringMetric::MAX_SIZE - 1), latencyStageMetricNames[si]};
+    metric.addTag(o2::monitoring::tags::Key::Subsystem, o2::monitoring::tags::Value::DPL);
+    monitoring.send(std::move(metric));
+  }
+};
 } // namespace
 
 o2::framework::ServiceSpec CommonServices::dataProcessingStats()
@@ -1026,6 +1063,9 @@ o2::framework::ServiceSpec CommonServices::dataProcessingStats()
         MetricSpec{.name = "dropped_computations", .metricId = static_cast<short>(ProcessingStatsId::DROPPED_COMPUTATIONS), .kind = Kind::UInt64, .minPublishInterval = quickUpdateInterval},
         MetricSpec{.name = "dropped_incoming_messages", .metricId = static_cast<short>(ProcessingStatsId::DROPPED_INCOMING_MESSAGES), .kind = Kind::UInt64, .minPublishInterval = quickUpdateInterval},
         MetricSpec{.name = "relayed_messages", .metricId = static_cast<short>(ProcessingStatsId::RELAYED_MESSAGES), .kind = Kind::UInt64, .minPublishInterval = quickUpdateInterval},
+        MetricSpec{.name = "relayer/completion_checks", .metricId = static_cast<short>(ProcessingStatsId::RELAYER_COMPLETION_CHECKS), .kind = Kind::UInt64, .minPublishInterval = 1000},
+        MetricSpec{.name = "relayer/completion_skipped", .metricId = static_cast<short>(ProcessingStatsId::RELAYER_COMPLETION_SKIPPED), .kind = Kind::UInt64, .minPublishInterval = 1000},
+        MetricSpec{.name = "relayer/inputs_scanned", .metricId = static_cast<short>(ProcessingStatsId::RELAYER_INPUTS_SCANNED), .kind = Kind::UInt64, .minPublishInterval = 1000},
         MetricSpec{.name = "arrow-bytes-destroyed",
                    .enabled = arrowAndResourceLimitingMetrics,
                    .metricId = static_cast<short>(ProcessingStatsId::ARROW_BYTES_DESTROYED),
@@ -1123,14 +1163,17 @@ o2::framework::ServiceSpec CommonServices::dataProcessingStats()
     .preDangling = [](DanglingContext& context, void* service) {
        auto* stats = (DataProcessingStats*)service;
        sendRelayerMetrics(context.services(), *stats);
+       sendLatencyHistograms(context.services(), *stats, false);
        flushMetrics(context.services(), *stats); },
     .postDangling = [](DanglingContext& context, void* service) {
        auto* stats = (DataProcessingStats*)service;
        sendRelayerMetrics(context.services(), *stats);
+       sendLatencyHistograms(context.services(), *stats, false);
        flushMetrics(context.services(), *stats); },
     .preEOS = [](EndOfStreamContext& context, void* service) {
       auto* stats = (DataProcessingStats*)service;
       sendRelayerMetrics(context.services(), *stats);
+      sendLatencyHistograms(context.services(), *stats, true);
       flushMetrics(context.services(), *stats); },
     .preLoop = [](ServiceRegistryRef ref, void* service) {
       auto* stats = (DataProcessingStats*)service;
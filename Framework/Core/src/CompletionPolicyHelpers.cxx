@@ -20,6 +20,7 @@
 #include "DecongestionService.h"
 #include "Framework/Signpost.h"
 
+#include <algorithm>
 #include <cassert>
 #include <regex>
 
@@ -168,7 +169,12 @@ CompletionPolicy CompletionPolicyHelpers::consumeWhenAll(const char* name, Compl
     O2_SIGNPOST_END(completion, sid, "consumeWhenAll", "Completion policy returned %{public}s for timeslice %lu", consumes ? "Consume" : "Discard", currentTimeslice);
     return consumes ? CompletionPolicy::CompletionOp::Consume : CompletionPolicy::CompletionOp::Discard;
   };
-  return CompletionPolicy{name, matcher, callback};
+  CompletionPolicy policy{name, matcher, callback};
+  // We wait as long as any non sporadic input is missing.
+  policy.minimumInputs = [](std::vector<InputSpec> const& specs) -> size_t {
+    return std::count_if(specs.begin(), specs.end(), [](InputSpec const& spec) { return spec.lifetime != Lifetime::Sporadic; });
+  };
+  return policy;
 }
 
 CompletionPolicy CompletionPolicyHelpers::consumeWhenAllOrdered(const char* name, CompletionPolicy::Matcher matcher)
@@ -259,7 +265,9 @@ CompletionPolicy CompletionPolicyHelpers::consumeWhenAny(const char* name, Compl
     }
     return CompletionPolicy::CompletionOp::Wait;
   };
-  return CompletionPolicy{name, matcher, callback, false};
+  CompletionPolicy policy{name, matcher, callback, false};
+  policy.minimumInputs = [](std::vector<InputSpec> const&) -> size_t { return 1; };
+  return policy;
 }
 
 CompletionPolicy CompletionPolicyHelpers::consumeWhenAny(std::string matchName)
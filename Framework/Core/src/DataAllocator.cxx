@@ -21,6 +21,8 @@
 #include "Framework/DeviceSpec.h"
 #include "Framework/StreamContext.h"
 #include "Framework/Signpost.h"
+#include "Framework/MessageArena.h"
+#include "Framework/DefaultsHelpers.h"
 #include "Headers/DataHeader.h"
 #include "Headers/DataHeaderHelpers.h"
 #include "Headers/Stack.h"
@@ -34,6 +36,7 @@
 
 #include <TClonesArray.h>
 
+#include <algorithm>
 #include <utility>
 
 O2_DECLARE_DYNAMIC_LOG(stream_context);
@@ -51,6 +54,8 @@ DataAllocator::DataAllocator(ServiceRegistryRef contextRegistry)
 {
 }
 
+DataAllocator::~DataAllocator() = default;
+
 RouteIndex DataAllocator::matchDataHeader(const Output& spec, size_t timeslice)
 {
   auto& allowedOutputRoutes = mRegistry.get<DeviceSpec const>().outputs;
@@ -129,6 +134,29 @@ fair::mq::MessagePtr DataAllocator::headerMessageFromOutput(Output const& spec,
   return o2::pmr::getMessage(o2::header::Stack{channelAlloc, dh, dph, spec.metaHeader});
 }
 
+fair::mq::MessagePtr DataAllocator::createOutputMessage(RouteIndex routeIndex, size_t size)
+{
+  // Number of blocks the arena is split into. Each one holds the
+  // small outputs of a single timeslice.
+  constexpr size_t arenaBlocks = 16;
+  static size_t arenaSize = DefaultsHelpers::outputArenaSize();
+  auto& proxy = mRegistry.get<FairMQDeviceProxy>();
+  if (arenaSize == 0 || size == 0) {
+    return proxy.createOutputMessage(routeIndex, size);
+  }
+  auto* transport = proxy.getOutputTransport(routeIndex);
+  auto arena = std::find_if(mArenas.begin(), mArenas.end(), [transport](auto const& arena) { return arena->transport() == transport; });
+  if (arena == mArenas.end()) {
+    arena = mArenas.insert(mArenas.end(), std::make_unique<MessageArena>(transport, arenaSize, arenaBlocks));
+  }
+  auto message = (*arena)->create(mRegistry.get<TimingInfo>().timeslice, size);
+  // Too big or no space left in the arena.
+  if (message.get() == nullptr) {
+    return proxy.createOutputMessage(routeIndex, size);
+  }
+  return message;
+}
+
 void DataAllocator::addPartToContext(RouteIndex routeIndex, fair::mq::MessagePtr&& payloadMessage, const Output& spec,
                                      o2::header::SerializationMethod serializationMethod)
 {
@@ -355,11 +383,10 @@ void DataAllocator::adopt(const Output& spec, std::shared_ptr<arrow::Table> ptr)
 void DataAllocator::snapshot(const Output& spec, const char* payload, size_t payloadSize,
                              o2::header::SerializationMethod serializationMethod)
 {
-  auto& proxy = mRegistry.get<FairMQDeviceProxy>();
   auto& timingInfo = mRegistry.get<TimingInfo>();
 
   RouteIndex routeIndex = matchDataHeader(spec, timingInfo.timeslice);
-  fair::mq::MessagePtr payloadMessage(proxy.createOutputMessage(routeIndex, payloadSize));
+  fair::mq::MessagePtr payloadMessage(createOutputMessage(routeIndex, payloadSize));
   memcpy(payloadMessage->GetData(), payload, payloadSize);
 
   addPartToContext(routeIndex, std::move(payloadMessage), spec, serializationMethod);
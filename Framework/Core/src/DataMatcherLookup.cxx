@@ -0,0 +1,170 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include "Framework/DataMatcherLookup.h"
+#include "Headers/DataHeader.h"
+
+#include <cstring>
+#include <optional>
+#include <string>
+
+namespace o2::framework::data_matcher
+{
+
+namespace
+{
+/// The constants a matcher requires, if any.
+struct Constants {
+  std::optional<std::string> origin;
+  std::optional<std::string> description;
+  std::optional<header::DataHeader::SubSpecificationType> subSpec;
+};
+
+void collectConstants(DataDescriptorMatcher const& matcher, Constants& constants);
+
+void collectConstants(Node const& node, Constants& constants)
+{
+  if (auto origin = std::get_if<OriginValueMatcher>(&node)) {
+    origin->visit([&constants](auto const& value) {
+      if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::string>) {
+        constants.origin = constants.origin.value_or(value);
+      }
+    });
+  } else if (auto description = std::get_if<DescriptionValueMatcher>(&node)) {
+    description->visit([&constants](auto const& value) {
+      if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::string>) {
+        constants.description = constants.description.value_or(value);
+      }
+    });
+  } else if (auto subSpec = std::get_if<SubSpecificationTypeValueMatcher>(&node)) {
+    subSpec->visit([&constants](auto const& value) {
+      if constexpr (std::is_same_v<std::decay_t<decltype(value)>, header::DataHeader::SubSpecificationType>) {
+        constants.subSpec = constants.subSpec.value_or(value);
+      }
+    });
+  } else if (auto child = std::get_if<std::unique_ptr<DataDescriptorMatcher>>(&node)) {
+    collectConstants(**child, constants);
+  }
+}
+
+/// Only the terms of a conjunction are necessary conditions for
+/// the matcher to succeed, so we do not look inside Or, Xor and Not.
+void collectConstants(DataDescriptorMatcher const& matcher, Constants& constants)
+{
+  switch (matcher.getOp()) {
+    case DataDescriptorMatcher::Op::And:
+      collectConstants(matcher.getLeft(), constants);
+      collectConstants(matcher.getRight(), constants);
+      break;
+    case DataDescriptorMatcher::Op::Just:
+      collectConstants(matcher.getLeft(), constants);
+      break;
+    default:
+      break;
+  }
+}
+
+/// Copy at most @a size characters of @a s to @a dest, zero padding
+/// the rest, so that keys compare like strncmp would.
+void copyPadded(void* dest, char const* s, size_t size)
+{
+  char buffer[16] = {0};
+  memcpy(buffer, s, strnlen(s, size));
+  memcpy(dest, buffer, size);
+}
+} // namespace
+
+size_t DataMatcherLookup::KeyHash::operator()(Key const& key) const
+{
+  size_t result = key.origin;
+  result = result * 0x9e3779b97f4a7c15ull ^ key.subSpec;
+  result = result * 0x9e3779b97f4a7c15ull ^ key.description[0];
+  result = result * 0x9e3779b97f4a7c15ull ^ key.description[1];
+  return result;
+}
+
+DataMatcherLookup::DataMatcherLookup(std::vector<DataDescriptorMatcher> const& matchers, std::vector<size_t> const& index)
+{
+  mMatchers.reserve(index.size());
+  for (size_t pos = 0; pos < index.size(); ++pos) {
+    auto const& matcher = matchers[index[pos]];
+    mMatchers.push_back(matcher);
+    Constants constants;
+    collectConstants(matcher, constants);
+    if (!constants.origin || !constants.description) {
+      mFallback.push_back(pos);
+      continue;
+    }
+    Key key;
+    copyPadded(&key.origin, constants.origin->c_str(), sizeof(key.origin));
+    copyPadded(key.description.data(), constants.description->c_str(), sizeof(key.description));
+    if (constants.subSpec) {
+      key.subSpec = *constants.subSpec;
+      mExact[key].push_back(pos);
+    } else {
+      mByType[key].push_back(pos);
+    }
+  }
+}
+
+size_t DataMatcherLookup::match(char const* data, VariableContext& context) const
+{
+  auto tryMatch = [this, data, &context](uint32_t pos) -> bool {
+    if (mMatchers[pos].match(data, context)) {
+      context.commit();
+      return true;
+    }
+    context.discard();
+    return false;
+  };
+
+  auto const* dh = o2::header::get<header::DataHeader*>(data);
+  if (dh == nullptr) {
+    for (size_t pos = 0; pos < mMatchers.size(); ++pos) {
+      if (tryMatch(pos)) {
+        return pos;
+      }
+    }
+    return INVALID;
+  }
+
+  static const std::vector<uint32_t> none;
+  Key key;
+  copyPadded(&key.origin, dh->dataOrigin.str, sizeof(key.origin));
+  copyPadded(key.description.data(), dh->dataDescription.str, sizeof(key.description));
+  auto byType = mByType.find(key);
+  key.subSpec = dh->subSpecification;
+  auto exact = mExact.find(key);
+
+  // Merge the candidates, which are sorted, so that we try them in
+  // the same order as the original list.
+  std::array<std::vector<uint32_t> const*, 3> lists = {
+    exact != mExact.end() ? &exact->second : &none,
+    byType != mByType.end() ? &byType->second : &none,
+    &mFallback};
+  std::array<size_t, 3> cursors = {0, 0, 0};
+  while (true) {
+    int next = -1;
+    for (int li = 0; li < 3; ++li) {
+      if (cursors[li] < lists[li]->size() && (next == -1 || (*lists[li])[cursors[li]] < (*lists[next])[cursors[next]])) {
+        next = li;
+      }
+    }
+    if (next == -1) {
+      return INVALID;
+    }
+    auto pos = (*lists[next])[cursors[next]++];
+    if (tryMatch(pos)) {
+      return pos;
+    }
+  }
+}
+
+} // namespace o2::framework::data_matcher
@@ -15,6 +15,7 @@
 #include "Framework/DataProcessingHeader.h"
 #include "Framework/DataProcessingStates.h"
 #include "Framework/DataProcessor.h"
+#include "Framework/DataSender.h"
 #include "Framework/DataSpecUtils.h"
 #include "Framework/DeviceState.h"
 #include "Framework/DispatchPolicy.h"
@@ -35,8 +36,10 @@
 #include "Framework/Signpost.h"
 #include "Framework/TimingHelpers.h"
 #include "Framework/SourceInfoHeader.h"
+#include "Framework/SharedConditionObject.h"
 #include "Framework/DriverClient.h"
 #include "Framework/TimesliceIndex.h"
+#include "Framework/TimeslicesInFlight.h"
 #include "Framework/VariableContextHelpers.h"
 #include "Framework/DataProcessingContext.h"
 #include "Framework/DataProcessingHeader.h"
@@ -48,6 +51,7 @@
 
 #include "DecongestionService.h"
 #include "Framework/DataProcessingHelpers.h"
+#include "Framework/DataProcessorSpecHelpers.h"
 #include "DataRelayerHelpers.h"
 #include "Headers/DataHeader.h"
 #include "Headers/DataHeaderHelpers.h"
@@ -258,8 +262,18 @@ void run_callback(uv_work_t* handle)
   auto& dataProcessorContext = ref.get<DataProcessorContext>();
   O2_SIGNPOST_ID_FROM_POINTER(sid, device, &dataProcessorContext);
   O2_SIGNPOST_START(device, sid, "run_callback", "Starting run callback on stream %d", task->id.index);
-  DataProcessingDevice::doPrepare(ref);
-  DataProcessingDevice::doRun(ref);
+  if (dataProcessorContext.streams > 1) {
+    // Inputs are read on the main thread, the streams only dispatch
+    // the computations. See DataProcessingDevice::Run.
+    auto& streamContext = ref.get<StreamContext>();
+    std::unique_lock<std::mutex> lock(dataProcessorContext.streamsMutex);
+    streamContext.streamsLock = &lock;
+    DataProcessingDevice::doRun(ref);
+    streamContext.streamsLock = nullptr;
+  } else {
+    DataProcessingDevice::doPrepare(ref);
+    DataProcessingDevice::doRun(ref);
+  }
   O2_SIGNPOST_END(device, sid, "run_callback", "Done processing data for stream %d", task->id.index);
 }
 
@@ -412,6 +426,9 @@ void DataProcessingDevice::Init()
   context.statefulProcess = nullptr;
   context.error = spec.algorithm.onError;
   context.initError = spec.algorithm.onInitError;
+  // Scope the shared condition objects to this workflow, so that the
+  // driver can clean them up.
+  SharedConditionRegion::setSession(GetConfig()->GetProperty<std::string>("session", "default"));
 
   auto configStore = DeviceConfigurationHelpers::getConfiguration(mServiceRegistry, spec.name.c_str(), spec.options);
   if (configStore == nullptr) {
@@ -525,6 +542,11 @@ void DataProcessingDevice::Init()
     spec.callbacksPolicy.policy(mServiceRegistry.get<CallbackService>(ServiceRegistry::globalDeviceSalt()), initContext);
   }
 
+  // Create as many streams as requested by the DataProcessorSpec.
+  context.streams = DataProcessorSpecHelpers::getRequestedStreams(spec.metadata);
+  mStreams.resize(context.streams);
+  mHandles.resize(context.streams);
+
   // Services which are stream should be initialised now
   auto* options = GetConfig();
   for (size_t si = 0; si < mStreams.size(); ++si) {
@@ -750,6 +772,9 @@ static auto forwardInputs = [](ServiceRegistryRef registry, TimesliceSlot slot,
     }
   }
   O2_SIGNPOST_EVENT_EMIT(forwarding, sid, "forwardInputs", "Forwarding %zu messages", forwardedParts.size());
+  // Forwarded inputs can share the channels of the outputs, make sure the
+  // ones queued for sending are out first.
+  registry.get<DataSender>().flush();
   for (int fi = 0; fi < proxy.getNumForwardChannels(); fi++) {
     if (forwardedParts[fi].Size() == 0) {
       continue;
@@ -1318,7 +1343,9 @@ void DataProcessingDevice::Run()
   O2_SIGNPOST_ID_FROM_POINTER(lid, device, state.loop);
   O2_SIGNPOST_START(device, lid, "device_state", "First iteration of the device loop");
 
-  bool dplEnableMultithreding = getenv("DPL_THREADPOOL_SIZE") != nullptr;
+  // The libuv worker pool for multiple streams is sized by the threadpool service.
+  auto& dpContext = ref.get<DataProcessorContext>();
+  bool dplEnableMultithreding = getenv("DPL_THREADPOOL_SIZE") != nullptr && dpContext.streams <= 1;
   if (dplEnableMultithreding) {
     setenv("UV_THREADPOOL_SIZE", "1", 1);
   }
@@ -1446,7 +1473,6 @@ void DataProcessingDevice::Run()
       auto oldestPossibleTimeslice = relayer.getOldestPossibleOutput();
       AsyncQueueHelpers::run(queue, {oldestPossibleTimeslice.timeslice.value});
       if (shouldNotWait == false) {
-        auto& dpContext = ref.get<DataProcessorContext>();
         dpContext.preLoopCallbacks(ref);
       }
       O2_SIGNPOST_END(device, lid, "run_loop", "Run loop completed. %{}s", shouldNotWait ? "Will immediately schedule a new one" : "Waiting for next event.");
@@ -1483,24 +1509,27 @@ void DataProcessingDevice::Run()
       handleRegionCallbacks(mServiceRegistry, mPendingRegionInfos);
     }
 
-    assert(mStreams.size() == mHandles.size());
-    /// Decide which task to use
-    TaskStreamRef streamRef{-1};
-    for (size_t ti = 0; ti < mStreams.size(); ti++) {
-      auto& taskInfo = mStreams[ti];
-      if (taskInfo.running) {
-        continue;
-      }
-      // Stream 0 is for when we run in
-      streamRef.index = ti;
+    // With multiple streams the inputs are read and relayed only on the
+    // main thread, while the streams take care of the dispatching.
+    if (dpContext.streams > 1) {
+      std::lock_guard<std::mutex> lock(dpContext.streamsMutex);
+      DataProcessingDevice::doPrepare(ServiceRegistryRef{mServiceRegistry, ServiceRegistry::globalStreamSalt(1)});
     }
+
+    assert(mStreams.size() == mHandles.size());
+    /// Decide which task to use. With multiple streams all the free ones
+    /// are started, each of them picking the oldest timeslice which is ready.
     using o2::monitoring::Metric;
     using o2::monitoring::Monitoring;
     using o2::monitoring::tags::Key;
     using o2::monitoring::tags::Value;
-    // We have an empty stream, let's check if we have enough
-    // resources for it to run something
-    if (streamRef.index != -1) {
+    for (size_t ti = mStreams.size(); ti-- > 0;) {
+      if (mStreams[ti].running) {
+        continue;
+      }
+      // We have an empty stream, let's check if we have enough
+      // resources for it to run something
+      TaskStreamRef streamRef{(int)ti};
       // Synchronous execution of the callbacks. This will be moved in the
       // moved in the on_socket_polled once we have threading in place.
       uv_work_t& handle = mHandles[streamRef.index];
@@ -1536,6 +1565,10 @@ void DataProcessingDevice::Run()
       } else {
         auto ref = ServiceRegistryRef{mServiceRegistry};
         ref.get<ComputingQuotaEvaluator>().handleExpired(reportExpiredOffer);
+        break;
+      }
+      if (dpContext.streams <= 1) {
+        break;
       }
     }
   }
@@ -1746,9 +1779,13 @@ void DataProcessingDevice::doRun(ServiceRegistryRef ref)
     return;
   }
 
-  context.completed.clear();
-  context.completed.reserve(16);
-  if (DataProcessingDevice::tryDispatchComputation(ref, context.completed)) {
+  // Each stream needs its own list of actions, because the user code is
+  // invoked without holding the streamsMutex.
+  std::vector<DataRelayer::RecordAction> streamCompleted;
+  auto& completed = context.streams > 1 ? streamCompleted : context.completed;
+  completed.clear();
+  completed.reserve(16);
+  if (DataProcessingDevice::tryDispatchComputation(ref, completed)) {
     state.lastActiveDataProcessor.store(&context);
   }
   DanglingContext danglingContext{*context.registry};
@@ -1762,8 +1799,8 @@ void DataProcessingDevice::doRun(ServiceRegistryRef ref)
     state.lastActiveDataProcessor = &context;
   }
 
-  context.completed.clear();
-  if (DataProcessingDevice::tryDispatchComputation(ref, context.completed)) {
+  completed.clear();
+  if (DataProcessingDevice::tryDispatchComputation(ref, completed)) {
     state.lastActiveDataProcessor = &context;
   }
 
@@ -1787,9 +1824,15 @@ void DataProcessingDevice::doRun(ServiceRegistryRef ref)
     /// timers as they do not need to be further processed.
     auto& relayer = ref.get<DataRelayer>();
 
+    // Let the other streams complete what they are processing
+    // before we drain the queues and send the end of stream.
+    if (auto* streamsLock = ref.get<StreamContext>().streamsLock) {
+      context.timesliceReleased.wait(*streamsLock, [&context]() { return context.timeslicesInFlight.empty(); });
+    }
+
     bool shouldProcess = hasOnlyGenerated(spec) == false;
 
-    while (DataProcessingDevice::tryDispatchComputation(ref, context.completed) && shouldProcess) {
+    while (DataProcessingDevice::tryDispatchComputation(ref, completed) && shouldProcess) {
       relayer.processDanglingInputs(context.expirationHandlers, *context.registry, false);
     }
 
@@ -1984,6 +2027,7 @@ void DataProcessingDevice::handleData(ServiceRegistryRef ref, InputChannelInfo&
 
   auto handleValidMessages = [&info, ref, &reportError](std::vector<InputInfo> const& inputInfos) {
     auto& relayer = ref.get<DataRelayer>();
+    auto& stats = ref.get<DataProcessingStats>();
     auto& state = ref.get<DeviceState>();
     static WaitBackpressurePolicy policy;
     auto& parts = info.parts;
@@ -2037,12 +2081,14 @@ void DataProcessingDevice::handleData(ServiceRegistryRef ref, InputChannelInfo&
             VariableContextHelpers::getTimeslice(variables);
             forwardInputs(ref, slot, dropped, oldestOutputInfo, false, true);
           };
+          uint64_t tRelay = uv_hrtime();
           auto relayed = relayer.relay(parts.At(headerIndex)->GetData(),
                                        &parts.At(headerIndex),
                                        input,
                                        nMessages,
                                        nPayloadsPerHeader,
                                        onDrop);
+          stats.recordLatency(LatencyStage::RELAY, uv_hrtime() - tRelay);
           switch (relayed.type) {
             case DataRelayer::RelayChoice::Type::Backpressured:
               if (info.normalOpsNotified == true && info.backpressureNotified == false) {
@@ -2337,7 +2383,9 @@ bool DataProcessingDevice::tryDispatchComputation(ServiceRegistryRef ref, std::v
     control.notifyStreamingState(state.streaming);
   };
 
-  ref.get<DataRelayer>().getReadyToProcess(completed);
+  // With multiple streams each of them only takes the oldest ready
+  // timeslice, leaving the others to the streams which are still free.
+  ref.get<DataRelayer>().getReadyToProcess(completed, context.streams > 1 ? 1 : std::numeric_limits<size_t>::max());
   if (completed.empty() == true) {
     LOGP(debug, "No computations available for dispatching.");
     return false;
@@ -2370,6 +2418,10 @@ bool DataProcessingDevice::tryDispatchComputation(ServiceRegistryRef ref, std::v
     auto latency = calculateInputRecordLatency(record, tStartMilli);
     stats.updateStats({(int)ProcessingStatsId::LAST_MIN_LATENCY, DataProcessingStats::Op::Set, (int)latency.minLatency});
     stats.updateStats({(int)ProcessingStatsId::LAST_MAX_LATENCY, DataProcessingStats::Op::Set, (int)latency.maxLatency});
+    // The oldest input is the one which waited the most.
+    if (latency.minLatency != std::numeric_limits<uint64_t>::max()) {
+      stats.recordLatency(LatencyStage::INPUT_WAIT, latency.maxLatency * 1000000);
+    }
     static int count = 0;
     stats.updateStats({(int)ProcessingStatsId::PROCESSING_RATE_HZ, DataProcessingStats::Op::CumulativeRate, 1});
     count++;
@@ -2414,6 +2466,7 @@ bool DataProcessingDevice::tryDispatchComputation(ServiceRegistryRef ref, std::v
       break;
   }
 
+  TimeslicesInFlight inFlight{dpContext, completed};
   for (auto action : completed) {
     O2_SIGNPOST_ID_GENERATE(aid, device);
     O2_SIGNPOST_START(device, aid, "device", "Processing action on slot %lu for action %{public}s", action.slot.index, fmt::format("{}", action.op).c_str());
@@ -2447,6 +2500,7 @@ bool DataProcessingDevice::tryDispatchComputation(ServiceRegistryRef ref, std::v
       if (spec.forwards.empty() == false) {
         auto& timesliceIndex = ref.get<TimesliceIndex>();
         forwardInputs(ref, action.slot, currentSetOfInputs, timesliceIndex.getOldestPossibleOutput(), false);
+        inFlight.release(action.timeslice.value);
         O2_SIGNPOST_END(device, aid, "device", "Forwarding inputs consume: %d.", false);
         continue;
       }
@@ -2471,7 +2525,7 @@ bool DataProcessingDevice::tryDispatchComputation(ServiceRegistryRef ref, std::v
 
     static bool noCatch = getenv("O2_NO_CATCHALL_EXCEPTIONS") && strcmp(getenv("O2_NO_CATCHALL_EXCEPTIONS"), "0");
 
-    auto runNoCatch = [&context, ref, &processContext](DataRelayer::RecordAction& action) mutable {
+    auto runNoCatch = [&context, ref, &processContext, &inFlight](DataRelayer::RecordAction& action) mutable {
       auto& state = ref.get<DeviceState>();
       auto& spec = ref.get<DeviceSpec const>();
       auto& streamContext = ref.get<StreamContext>();
@@ -2498,16 +2552,23 @@ bool DataProcessingDevice::tryDispatchComputation(ServiceRegistryRef ref, std::v
           ref.get<CallbackService>().call<CallbackService::Id::PreProcessing>(o2::framework::ServiceRegistryRef{ref}, (int)action.op);
         }
         O2_SIGNPOST_ID_FROM_POINTER(pcid, device, &processContext);
+        uint64_t tProcess = uv_hrtime();
+        uint64_t tProcessEnd = tProcess;
         if (context.statefulProcess && shouldProcess(action)) {
           // This way, usercode can use the the same processing context to identify
           // its signposts and we can map user code to device iterations.
+          // Only the user code runs concurrently when we have multiple streams.
+          StreamsUnlock unlock{streamContext.streamsLock};
           O2_SIGNPOST_START(device, pcid, "device", "Stateful process");
           (context.statefulProcess)(processContext);
           O2_SIGNPOST_END(device, pcid, "device", "Stateful process");
+          tProcessEnd = uv_hrtime();
         } else if (context.statelessProcess && shouldProcess(action)) {
+          StreamsUnlock unlock{streamContext.streamsLock};
           O2_SIGNPOST_START(device, pcid, "device", "Stateful process");
           (context.statelessProcess)(processContext);
           O2_SIGNPOST_END(device, pcid, "device", "Stateful process");
+          tProcessEnd = uv_hrtime();
         } else if (context.statelessProcess || context.statefulProcess) {
           O2_SIGNPOST_EVENT_EMIT(device, pcid, "device", "Skipping processing because we are discarding.");
         } else {
@@ -2515,6 +2576,7 @@ bool DataProcessingDevice::tryDispatchComputation(ServiceRegistryRef ref, std::v
           state.streaming = StreamingState::Idle;
         }
         if (shouldProcess(action)) {
+          ref.get<DataProcessingStats>().recordLatency(LatencyStage::PROCESSING, tProcessEnd - tProcess);
           auto& timingInfo = ref.get<TimingInfo>();
           if (timingInfo.globalRunNumberChanged) {
             context.lastRunNumberProcessed = timingInfo.runNumber;
@@ -2537,6 +2599,12 @@ bool DataProcessingDevice::tryDispatchComputation(ServiceRegistryRef ref, std::v
           streamContext.finaliseOutputsCallbacks(processContext);
         }
 
+        // The postProcessing callbacks are the ones sending the outputs, so
+        // this is the point where the streams have to be put back in order.
+        if (spec.completionPolicy.order == CompletionPolicy::CompletionOrder::Timeslice) {
+          inFlight.waitForOlder(action.timeslice.value, streamContext.streamsLock);
+        }
+
         {
           ref.get<CallbackService>().call<CallbackService::Id::PostProcessing>(o2::framework::ServiceRegistryRef{ref}, (int)action.op);
           dpContext.postProcessingCallbacks(processContext);
@@ -2590,6 +2658,7 @@ bool DataProcessingDevice::tryDispatchComputation(ServiceRegistryRef ref, std::v
     if (action.op == CompletionPolicy::CompletionOp::Process) {
       cleanTimers(action.slot, record);
     }
+    inFlight.release(action.timeslice.value);
     O2_SIGNPOST_END(device, aid, "device", "Done processing action on slot %lu for action %{public}s", action.slot.index, fmt::format("{}", action.op).c_str());
   }
   O2_SIGNPOST_END(device, sid, "device", "Start processing ready actions");
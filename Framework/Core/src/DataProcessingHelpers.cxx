@@ -20,6 +20,7 @@
 #include "Framework/Logger.h"
 #include "Framework/SendingPolicy.h"
 #include "Framework/RawDeviceService.h"
+#include "Framework/DataSender.h"
 
 #include <fairmq/Device.h>
 #include <fairmq/Channel.h>
@@ -28,6 +29,8 @@ namespace o2::framework
 {
 void DataProcessingHelpers::sendEndOfStream(ServiceRegistryRef const& ref, OutputChannelSpec const& channel)
 {
+  // The end of stream must not overtake outputs queued for sending.
+  ref.get<DataSender>().flush();
   fair::mq::Device* device = ref.get<RawDeviceService>().device();
   fair::mq::Parts parts;
   fair::mq::MessagePtr payload(device->NewMessage());
@@ -45,6 +48,9 @@ void DataProcessingHelpers::sendEndOfStream(ServiceRegistryRef const& ref, Outpu
 
 void doSendOldestPossibleTimeframe(ServiceRegistryRef ref, fair::mq::TransportFactory* transport, ChannelIndex index, SendingPolicy::SendingCallback const& callback, size_t timeslice)
 {
+  // Same for the oldest possible timeframe, otherwise the receiver
+  // could consider the timeframes still in the queue as dropped.
+  ref.get<DataSender>().flush();
   fair::mq::Parts parts;
   fair::mq::MessagePtr payload(transport->CreateMessage());
   o2::framework::DomainInfoHeader dih;
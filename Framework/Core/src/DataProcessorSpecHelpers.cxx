@@ -10,8 +10,10 @@
 // or submit itself to any jurisdiction.
 
 #include "Framework/DataProcessorSpecHelpers.h"
+#include "Framework/Logger.h"
 #include <string>
 #include <algorithm>
+#include <charconv>
 
 namespace o2::framework
 {
@@ -20,4 +22,22 @@ bool DataProcessorSpecHelpers::hasLabel(DataProcessorSpec const& spec, char cons
   auto sameLabel = [other = DataProcessorLabel{{label}}](DataProcessorLabel const& label) { return label == other; };
   return std::find_if(spec.labels.begin(), spec.labels.end(), sameLabel) != spec.labels.end();
 }
+
+size_t DataProcessorSpecHelpers::getRequestedStreams(std::vector<DataProcessorMetadata> const& metadata)
+{
+  for (auto& meta : metadata) {
+    if (meta.key != "streams") {
+      continue;
+    }
+    size_t streams = 0;
+    auto const* end = meta.value.data() + meta.value.size();
+    auto [ptr, ec] = std::from_chars(meta.value.data(), end, streams);
+    if (ec != std::errc{} || ptr != end || streams == 0) {
+      LOGP(warning, "Invalid value \"{}\" for the streams metadata. Using a single stream.", meta.value);
+      return 1;
+    }
+    return streams;
+  }
+  return 1;
+}
 } // namespace o2::framework
@@ -61,6 +61,43 @@ namespace o2::framework
 
 constexpr int INVALID_INPUT = -1;
 
+/// Acquire the shards of a sharded DataRelayer, always in the same
+/// order, so that no relay() can run concurrently on them.
+/// Noop if there are no shards.
+struct ShardsLock {
+  /// Lock all the shards
+  explicit ShardsLock(std::vector<std::recursive_mutex>& shards)
+    : mShards{shards}, mBegin{0}, mEnd{shards.size()}
+  {
+    lock();
+  }
+  /// Lock only the shard which holds @a slot
+  ShardsLock(std::vector<std::recursive_mutex>& shards, TimesliceSlot slot)
+    : mShards{shards},
+      mBegin{shards.empty() ? 0 : slot.index % shards.size()},
+      mEnd{shards.empty() ? 0 : mBegin + 1}
+  {
+    lock();
+  }
+  ~ShardsLock()
+  {
+    for (size_t i = mEnd; i > mBegin; --i) {
+      mShards[i - 1].unlock();
+    }
+  }
+
+ private:
+  void lock()
+  {
+    for (size_t i = mBegin; i < mEnd; ++i) {
+      mShards[i].lock();
+    }
+  }
+  std::vector<std::recursive_mutex>& mShards;
+  size_t mBegin;
+  size_t mEnd;
+};
+
 DataRelayer::DataRelayer(const CompletionPolicy& policy,
                          std::vector<InputRoute> const& routes,
                          TimesliceIndex& index,
@@ -69,7 +106,7 @@ DataRelayer::DataRelayer(const CompletionPolicy& policy,
     mTimesliceIndex{index},
     mCompletionPolicy{policy},
     mDistinctRoutesIndex{DataRelayerHelpers::createDistinctRouteIndex(routes)},
-    mInputMatchers{DataRelayerHelpers::createInputMatchers(routes)},
+    mInputLookup{DataRelayerHelpers::createInputMatchers(routes), mDistinctRoutesIndex},
     mMaxLanes{InputRouteHelpers::maxLanes(routes)}
 {
   std::scoped_lock<O2_LOCKABLE(std::recursive_mutex)> lock(mMutex);
@@ -77,6 +114,8 @@ DataRelayer::DataRelayer(const CompletionPolicy& policy,
   if (policy.configureRelayer == nullptr) {
     static int pipelineLength = DefaultsHelpers::pipelineLength();
     setPipelineLength(pipelineLength);
+    static int shards = DefaultsHelpers::relayerShards();
+    setShards(shards);
   } else {
     policy.configureRelayer(*this);
   }
@@ -94,6 +133,9 @@ DataRelayer::DataRelayer(const CompletionPolicy& policy,
     queries += std::string_view(buffer, strlen(buffer));
     queries += ";";
   }
+  if (policy.minimumInputs) {
+    mMinimumInputs = policy.minimumInputs(mInputs);
+  }
   auto stateId = (short)ProcessingStateId::DATA_QUERIES;
   states.registerState({.name = "data_queries", .stateId = stateId, .sendInitialValue = true, .defaultEnabled = true});
   states.updateState(DataProcessingStates::CommandSpec{.id = stateId, .size = (int)queries.size(), .data = queries.data()});
@@ -103,6 +145,7 @@ DataRelayer::DataRelayer(const CompletionPolicy& policy,
 TimesliceId DataRelayer::getTimesliceForSlot(TimesliceSlot slot)
 {
   std::scoped_lock<O2_LOCKABLE(std::recursive_mutex)> lock(mMutex);
+  ShardsLock shardsLock{mShardMutexes, slot};
   auto& variables = mTimesliceIndex.getVariablesForSlot(slot);
   return VariableContextHelpers::getTimeslice(variables);
 }
@@ -112,6 +155,7 @@ DataRelayer::ActivityStats DataRelayer::processDanglingInputs(std::vector<Expira
 {
   LOGP(debug, "DataRelayer::processDanglingInputs");
   std::scoped_lock<O2_LOCKABLE(std::recursive_mutex)> lock(mMutex);
+  ShardsLock shardsLock{mShardMutexes};
   auto& deviceProxy = services.get<FairMQDeviceProxy>();
 
   ActivityStats activity;
@@ -219,6 +263,9 @@ DataRelayer::ActivityStats DataRelayer::processDanglingInputs(std::vector<Expira
       assert(expirator.handler);
       PartRef newRef;
       expirator.handler(services, newRef, variables);
+      if (part.size() == 0) {
+        mInputsPresent[ti]++;
+      }
       part.reset(std::move(newRef));
       activity.expiredSlots++;
 
@@ -232,26 +279,6 @@ DataRelayer::ActivityStats DataRelayer::processDanglingInputs(std::vector<Expira
   return activity;
 }
 
-/// This does the mapping between a route and a InputSpec. The
-/// reason why these might diffent is that when you have timepipelining
-/// you have one route per timeslice, even if the type is the same.
-size_t matchToContext(void const* data,
-                      std::vector<DataDescriptorMatcher> const& matchers,
-                      std::vector<size_t> const& index,
-                      VariableContext& context)
-{
-  for (size_t ri = 0, re = index.size(); ri < re; ++ri) {
-    auto& matcher = matchers[index[ri]];
-
-    if (matcher.match(reinterpret_cast<char const*>(data), context)) {
-      context.commit();
-      return ri;
-    }
-    context.discard();
-  }
-  return INVALID_INPUT;
-}
-
 /// Send the contents of a context as metrics, so that we can examine them in
 /// the GUI.
 void sendVariableContextMetrics(VariableContext& context, TimesliceSlot slot, DataProcessingStates& states)
@@ -283,6 +310,8 @@ void sendVariableContextMetrics(VariableContext& context, TimesliceSlot slot, Da
 
 void DataRelayer::setOldestPossibleInput(TimesliceId proposed, ChannelIndex channel)
 {
+  std::scoped_lock<O2_LOCKABLE(std::recursive_mutex)> lock(mMutex);
+  ShardsLock shardsLock{mShardMutexes};
   auto newOldest = mTimesliceIndex.setOldestPossibleInput(proposed, channel);
   LOGP(debug, "DataRelayer::setOldestPossibleInput {} from channel {}", newOldest.timeslice.value, newOldest.channel.value);
   static bool dontDrop = getenv("DPL_DONT_DROP_OLD_TIMESLICE") && atoi(getenv("DPL_DONT_DROP_OLD_TIMESLICE"));
@@ -350,6 +379,8 @@ TimesliceIndex::OldestOutputInfo DataRelayer::getOldestPossibleOutput() const
 
 void DataRelayer::prunePending(OnDropCallback onDrop)
 {
+  std::scoped_lock<O2_LOCKABLE(std::recursive_mutex)> lock(mMutex);
+  ShardsLock shardsLock{mShardMutexes};
   for (auto& op : mPruneOps) {
     this->pruneCache(op.slot, onDrop);
   }
@@ -364,6 +395,7 @@ void DataRelayer::pruneCache(TimesliceSlot slot, OnDropCallback onDrop)
   auto pruneCache = [&onDrop,
                      &cache = mCache,
                      &cachedStateMetrics = mCachedStateMetrics,
+                     &inputsPresent = mInputsPresent,
                      numInputTypes = mDistinctRoutesIndex.size(),
                      &index = mTimesliceIndex,
                      ref = mContext](TimesliceSlot slot) {
@@ -397,6 +429,7 @@ void DataRelayer::pruneCache(TimesliceSlot slot, OnDropCallback onDrop)
       cache[ai].clear();
       cachedStateMetrics[ai] = CacheEntryStatus::EMPTY;
     }
+    inputsPresent[slot.index] = 0;
   };
 
   pruneCache(slot);
@@ -416,25 +449,32 @@ DataRelayer::RelayChoice
                      size_t nPayloads,
                      std::function<void(TimesliceSlot, std::vector<MessageSet>&, TimesliceIndex::OldestOutputInfo)> onDrop)
 {
-  std::scoped_lock<O2_LOCKABLE(std::recursive_mutex)> lock(mMutex);
   DataProcessingHeader const* dph = o2::header::get<DataProcessingHeader*>(rawHeader);
+  // In sharded mode the incoming timeslice can only end up in the slots of
+  // its own shard, so we only lock that one and let relay() calls for the
+  // other shards proceed in parallel. Everything else locks all the shards.
+  std::unique_lock<O2_LOCKABLE(std::recursive_mutex)> lock;
+  if (mShardMutexes.empty()) {
+    lock = std::unique_lock<O2_LOCKABLE(std::recursive_mutex)>(mMutex);
+  } else {
+    lock = std::unique_lock<std::recursive_mutex>(mShardMutexes[dph->startTime % mShardMutexes.size()]);
+  }
   // IMPLEMENTATION DETAILS
   //
   // This returns true if a given slot is available for the current number of lanes
-  auto isSlotInLane = [currentLane = dph->startTime, maxLanes = mMaxLanes](TimesliceSlot slot) {
+  auto isSlotInLane = [currentLane = dph->startTime, maxLanes = mMaxLanes * getShards()](TimesliceSlot slot) {
     return (slot.index % maxLanes) == (currentLane % maxLanes);
   };
   // This returns the identifier for the given input. We use a separate
   // function because while it's trivial now, the actual matchmaking will
   // become more complicated when we will start supporting ranges.
-  auto getInputTimeslice = [&matchers = mInputMatchers,
-                            &distinctRoutes = mDistinctRoutesIndex,
+  auto getInputTimeslice = [&lookup = mInputLookup,
                             &rawHeader,
                             &index = mTimesliceIndex](VariableContext& context)
     -> std::tuple<int, TimesliceId> {
     /// FIXME: for the moment we only use the first context and reset
     /// between one invokation and the other.
-    auto input = matchToContext(rawHeader, matchers, distinctRoutes, context);
+    auto input = lookup.match(reinterpret_cast<char const*>(rawHeader), context);
 
     if (input == INVALID_INPUT) {
       return {
@@ -457,6 +497,7 @@ DataRelayer::RelayChoice
 
   // Actually save the header / payload in the slot
   auto saveInSlot = [&cachedStateMetrics = mCachedStateMetrics,
+                     &inputsPresent = mInputsPresent,
                      &messages,
                      &nMessages,
                      &nPayloads,
@@ -474,6 +515,7 @@ DataRelayer::RelayChoice
     // TODO: make sure that multiple parts can only be added within the same call of
     // DataRelayer::relay
     assert(nPayloads > 0);
+    bool wasEmpty = target.size() == 0;
     size_t saved = 0;
     for (size_t mi = 0; mi < nMessages; ++mi) {
       assert(mi + nPayloads < nMessages);
@@ -487,6 +529,9 @@ DataRelayer::RelayChoice
       mi += nPayloads;
       saved += nPayloads;
     }
+    if (wasEmpty && target.size() > 0) {
+      inputsPresent[slot.index]++;
+    }
     return saved;
   };
 
@@ -545,10 +590,12 @@ DataRelayer::RelayChoice
   if (input == INVALID_INPUT) {
     for (size_t ci = 0; ci < index.size(); ++ci) {
       slot = TimesliceSlot{ci};
-      if (index.isValid(slot) == true) {
+      // Check the lane first, slots of other shards are not protected
+      // by the lock we are holding.
+      if (!isSlotInLane(slot)) {
         continue;
       }
-      if (!isSlotInLane(slot)) {
+      if (index.isValid(slot) == true) {
         continue;
       }
       std::tie(input, timeslice) = getInputTimeslice(index.getVariablesForSlot(slot));
@@ -564,6 +611,7 @@ DataRelayer::RelayChoice
   if (input != INVALID_INPUT && TimesliceId::isValid(timeslice) && TimesliceSlot::isValid(slot)) {
     if (needsCleaning) {
       this->pruneCache(slot, onDrop);
+      std::scoped_lock<std::mutex> pruneLock(mPruneOpsMutex);
       mPruneOps.erase(std::remove_if(mPruneOps.begin(), mPruneOps.end(), [slot](const auto& x) { return x.slot == slot; }), mPruneOps.end());
     }
     size_t saved = saveInSlot(timeslice, input, slot, info);
@@ -650,7 +698,10 @@ DataRelayer::RelayChoice
       // At this point the variables match the new input but the
       // cache still holds the old data, so we prune it.
       this->pruneCache(slot, onDrop);
-      mPruneOps.erase(std::remove_if(mPruneOps.begin(), mPruneOps.end(), [slot](const auto& x) { return x.slot == slot; }), mPruneOps.end());
+      {
+        std::scoped_lock<std::mutex> pruneLock(mPruneOpsMutex);
+        mPruneOps.erase(std::remove_if(mPruneOps.begin(), mPruneOps.end(), [slot](const auto& x) { return x.slot == slot; }), mPruneOps.end());
+      }
       size_t saved = saveInSlot(timeslice, input, slot, info);
       if (saved == 0) {
         return RelayChoice{.type = RelayChoice::Type::Dropped, .timeslice = timeslice};
@@ -662,10 +713,11 @@ DataRelayer::RelayChoice
   O2_BUILTIN_UNREACHABLE();
 }
 
-void DataRelayer::getReadyToProcess(std::vector<DataRelayer::RecordAction>& completed)
+void DataRelayer::getReadyToProcess(std::vector<DataRelayer::RecordAction>& completed, size_t maxActions)
 {
   LOGP(debug, "DataRelayer::getReadyToProcess");
   std::scoped_lock<O2_LOCKABLE(std::recursive_mutex)> lock(mMutex);
+  ShardsLock shardsLock{mShardMutexes};
 
   // THE STATE
   const auto& cache = mCache;
@@ -717,9 +769,27 @@ void DataRelayer::getReadyToProcess(std::vector<DataRelayer::RecordAction>& comp
   int countProcess = 0;
   int countDiscard = 0;
   int countWait = 0;
+  int countSkipped = 0;
   int notDirty = 0;
 
-  for (int li = cacheLines - 1; li >= 0; --li) {
+  std::vector<int> slotsOrder(cacheLines);
+  std::iota(slotsOrder.rbegin(), slotsOrder.rend(), 0);
+  if (maxActions < cacheLines) {
+    // With a limit on the actions, the oldest timeslices are checked first
+    // and we stop as soon as the limit is reached. The completion policy
+    // must not be asked about the slots we do not act upon: stateful ones,
+    // like consumeWhenAllOrdered, would not give the same answer again.
+    auto timesliceOf = [this](int li) {
+      auto timeslice = std::get_if<uint64_t>(&mTimesliceIndex.getVariablesForSlot(TimesliceSlot{(size_t)li}).get(0));
+      return timeslice ? *timeslice : std::numeric_limits<uint64_t>::max();
+    };
+    std::stable_sort(slotsOrder.begin(), slotsOrder.end(), [&timesliceOf](int a, int b) { return timesliceOf(a) < timesliceOf(b); });
+  }
+
+  for (auto li : slotsOrder) {
+    if (completed.size() >= maxActions) {
+      break;
+    }
     TimesliceSlot slot{(size_t)li};
     // We only check the cachelines which have been updated by an incoming
     // message.
@@ -730,6 +800,17 @@ void DataRelayer::getReadyToProcess(std::vector<DataRelayer::RecordAction>& comp
     if (!mCompletionPolicy.callbackFull) {
       throw runtime_error_f("Completion police %s has no callback set", mCompletionPolicy.name.c_str());
     }
+    // The number of inputs present is updated on arrival, so we know
+    // upfront if the policy could only tell us to wait, without having
+    // to build and scan the InputSpan.
+    if (mInputsPresent[li] < mMinimumInputs) {
+      countSkipped++;
+      countWait++;
+      mTimesliceIndex.markAsDirty(slot, false);
+      continue;
+    }
+    mScanStats.completionChecks.fetch_add(1, std::memory_order_relaxed);
+    mScanStats.inputsScanned.fetch_add(numInputTypes, std::memory_order_relaxed);
     auto partial = getPartialRecord(li);
     // TODO: get the data ref from message model
     auto getter = [&partial](size_t idx, size_t part) {
@@ -791,14 +872,16 @@ void DataRelayer::getReadyToProcess(std::vector<DataRelayer::RecordAction>& comp
     }
   }
   mTimesliceIndex.updateOldestPossibleOutput(false);
-  LOGP(debug, "DataRelayer::getReadyToProcess results notDirty:{}, consume:{}, consumeExisting:{}, process:{}, discard:{}, wait:{}",
+  mScanStats.completionSkipped.fetch_add(countSkipped, std::memory_order_relaxed);
+  LOGP(debug, "DataRelayer::getReadyToProcess results notDirty:{}, consume:{}, consumeExisting:{}, process:{}, discard:{}, wait:{} (skipped:{})",
        notDirty, countConsume, countConsumeExisting, countProcess,
-       countDiscard, countWait);
+       countDiscard, countWait, countSkipped);
 }
 
 void DataRelayer::updateCacheStatus(TimesliceSlot slot, CacheEntryStatus oldStatus, CacheEntryStatus newStatus)
 {
   std::scoped_lock<O2_LOCKABLE(std::recursive_mutex)> lock(mMutex);
+  ShardsLock shardsLock{mShardMutexes, slot};
   const auto numInputTypes = mDistinctRoutesIndex.size();
 
   auto markInputDone = [&cachedStateMetrics = mCachedStateMetrics,
@@ -817,6 +900,7 @@ void DataRelayer::updateCacheStatus(TimesliceSlot slot, CacheEntryStatus oldStat
 std::vector<o2::framework::MessageSet> DataRelayer::consumeAllInputsForTimeslice(TimesliceSlot slot)
 {
   std::scoped_lock<O2_LOCKABLE(std::recursive_mutex)> lock(mMutex);
+  ShardsLock shardsLock{mShardMutexes, slot};
 
   const auto numInputTypes = mDistinctRoutesIndex.size();
   // State of the computation
@@ -864,6 +948,7 @@ std::vector<o2::framework::MessageSet> DataRelayer::consumeAllInputsForTimeslice
     moveHeaderPayloadToOutput(slot, ai);
   }
   invalidateCacheFor(slot);
+  mInputsPresent[slot.index] = 0;
 
   return messages;
 }
@@ -871,6 +956,7 @@ std::vector<o2::framework::MessageSet> DataRelayer::consumeAllInputsForTimeslice
 std::vector<o2::framework::MessageSet> DataRelayer::consumeExistingInputsForTimeslice(TimesliceSlot slot)
 {
   std::scoped_lock<O2_LOCKABLE(std::recursive_mutex)> lock(mMutex);
+  ShardsLock shardsLock{mShardMutexes, slot};
 
   const auto numInputTypes = mDistinctRoutesIndex.size();
   // State of the computation
@@ -914,10 +1000,12 @@ std::vector<o2::framework::MessageSet> DataRelayer::consumeExistingInputsForTime
 void DataRelayer::clear()
 {
   std::scoped_lock<O2_LOCKABLE(std::recursive_mutex)> lock(mMutex);
+  ShardsLock shardsLock{mShardMutexes};
 
   for (auto& cache : mCache) {
     cache.clear();
   }
+  std::fill(mInputsPresent.begin(), mInputsPresent.end(), 0);
   for (size_t s = 0; s < mTimesliceIndex.size(); ++s) {
     mTimesliceIndex.markAsInvalid(TimesliceSlot{s});
   }
@@ -940,11 +1028,30 @@ void DataRelayer::setPipelineLength(size_t s)
   mTimesliceIndex.resize(s);
   mVariableContextes.resize(s);
   publishMetrics();
+  // Make sure each shard still has at least one slot per lane.
+  if (mShardMutexes.empty() == false) {
+    setShards(mShardMutexes.size());
+  }
+}
+
+void DataRelayer::setShards(size_t shards)
+{
+  std::scoped_lock<O2_LOCKABLE(std::recursive_mutex)> lock(mMutex);
+  // We need at least one slot per lane in each shard.
+  auto maxShards = std::max<size_t>(mTimesliceIndex.size() / std::max<size_t>(mMaxLanes, 1), 1);
+  if (shards > maxShards) {
+    LOGP(warning, "Requested {} relayer shards, but only {} slots are available for {} lanes. Using {} shards.",
+         shards, mTimesliceIndex.size(), mMaxLanes, maxShards);
+    shards = maxShards;
+  }
+  mShardMutexes = shards > 1 ? std::vector<std::recursive_mutex>(shards) : std::vector<std::recursive_mutex>{};
+  mTimesliceIndex.setShards(shards);
 }
 
 void DataRelayer::publishMetrics()
 {
   std::scoped_lock<O2_LOCKABLE(std::recursive_mutex)> lock(mMutex);
+  ShardsLock shardsLock{mShardMutexes};
 
   auto numInputTypes = mDistinctRoutesIndex.size();
   // FIXME: many of the DataRelayer function rely on allocated cache, so its
@@ -954,6 +1061,7 @@ void DataRelayer::publishMetrics()
   auto& states = mContext.get<DataProcessingStates>();
 
   mCachedStateMetrics.resize(mCache.size());
+  mInputsPresent.resize(mTimesliceIndex.size(), 0);
 
   // There is maximum 16 variables available. We keep them row-wise so that
   // that we can take mod 16 of the index to understand which variable we
@@ -982,30 +1090,35 @@ void DataRelayer::publishMetrics()
 uint32_t DataRelayer::getFirstTFOrbitForSlot(TimesliceSlot slot)
 {
   std::scoped_lock<O2_LOCKABLE(std::recursive_mutex)> lock(mMutex);
+  ShardsLock shardsLock{mShardMutexes, slot};
   return VariableContextHelpers::getFirstTFOrbit(mTimesliceIndex.getVariablesForSlot(slot));
 }
 
 uint32_t DataRelayer::getFirstTFCounterForSlot(TimesliceSlot slot)
 {
   std::scoped_lock<O2_LOCKABLE(std::recursive_mutex)> lock(mMutex);
+  ShardsLock shardsLock{mShardMutexes, slot};
   return VariableContextHelpers::getFirstTFCounter(mTimesliceIndex.getVariablesForSlot(slot));
 }
 
 uint32_t DataRelayer::getRunNumberForSlot(TimesliceSlot slot)
 {
   std::scoped_lock<O2_LOCKABLE(std::recursive_mutex)> lock(mMutex);
+  ShardsLock shardsLock{mShardMutexes, slot};
   return VariableContextHelpers::getRunNumber(mTimesliceIndex.getVariablesForSlot(slot));
 }
 
 uint64_t DataRelayer::getCreationTimeForSlot(TimesliceSlot slot)
 {
   std::scoped_lock<O2_LOCKABLE(std::recursive_mutex)> lock(mMutex);
+  ShardsLock shardsLock{mShardMutexes, slot};
   return VariableContextHelpers::getCreationTime(mTimesliceIndex.getVariablesForSlot(slot));
 }
 
 void DataRelayer::sendContextState()
 {
   std::scoped_lock<O2_LOCKABLE(std::recursive_mutex)> lock(mMutex);
+  ShardsLock shardsLock{mShardMutexes};
   auto& states = mContext.get<DataProcessingStates>();
   for (size_t ci = 0; ci < mTimesliceIndex.size(); ++ci) {
     auto slot = TimesliceSlot{ci};
@@ -23,6 +23,7 @@
 #include "Framework/DataProcessingContext.h"
 #include "Framework/O2DataModelHelpers.h"
 #include "Framework/DataProcessingStates.h"
+#include "Framework/DefaultsHelpers.h"
 
 using namespace o2::monitoring;
 
@@ -90,6 +91,24 @@ DataSender::DataSender(ServiceRegistryRef registry)
     LOGP(detail, "Disabling the Lifetime::timeframe check because the completion policy is not the default one");
     mPresentDefaults.resize(0);
   }
+
+  auto maxQueued = DefaultsHelpers::asyncSendQueueSize();
+  if (maxQueued) {
+    LOGP(detail, "Sending outputs from a separate thread, with up to {} messages queued", maxQueued);
+    mSendQueue = std::make_unique<SendQueue>(maxQueued, [this](fair::mq::Parts& parts, ChannelIndex channelIndex) {
+      auto& info = mProxy.getOutputChannelInfo(channelIndex);
+      info.policy->send(parts, channelIndex, mRegistry);
+    });
+  }
+}
+
+DataSender::~DataSender() = default;
+
+void DataSender::flush()
+{
+  if (mSendQueue) {
+    mSendQueue->flush();
+  }
 }
 
 std::unique_ptr<fair::mq::Message> DataSender::create(RouteIndex routeIndex)
@@ -106,6 +125,10 @@ void DataSender::send(fair::mq::Parts& parts, ChannelIndex channelIndex)
   }
   auto& dataProcessorContext = mRegistry.get<DataProcessorContext>();
   dataProcessorContext.preSendingMessagesCallbacks(mRegistry, parts, channelIndex);
+  if (mSendQueue) {
+    mSendQueue->push(parts, channelIndex);
+    return;
+  }
   auto& info = mProxy.getOutputChannelInfo(channelIndex);
   info.policy->send(parts, channelIndex, mRegistry);
 }
@@ -35,6 +35,52 @@ unsigned int DefaultsHelpers::pipelineLength()
   }
 }
 
+unsigned int DefaultsHelpers::relayerShards()
+{
+  static bool override = getenv("DPL_RELAYER_SHARDS");
+  if (override) {
+    static unsigned int retval = atoi(getenv("DPL_RELAYER_SHARDS"));
+    return retval;
+  }
+  return 1;
+}
+
+size_t DefaultsHelpers::outputArenaSize()
+{
+  static bool override = getenv("DPL_OUTPUT_ARENA_SIZE");
+  if (override) {
+    static size_t retval = strtoull(getenv("DPL_OUTPUT_ARENA_SIZE"), nullptr, 10);
+    return retval;
+  }
+  return 0;
+}
+
+size_t DefaultsHelpers::asyncSendQueueSize()
+{
+  static bool override = getenv("DPL_ASYNC_SEND_QUEUE");
+  if (override) {
+    static size_t retval = strtoull(getenv("DPL_ASYNC_SEND_QUEUE"), nullptr, 10);
+    return retval;
+  }
+  return 0;
+}
+
+bool DefaultsHelpers::shareConditionObjects()
+{
+  static bool retval = getenv("DPL_SHARED_CONDITIONS") && atoi(getenv("DPL_SHARED_CONDITIONS"));
+  return retval;
+}
+
+size_t DefaultsHelpers::spawnCacheSize()
+{
+  static bool override = getenv("DPL_SPAWN_CACHE_SIZE");
+  if (override) {
+    static size_t retval = strtoull(getenv("DPL_SPAWN_CACHE_SIZE"), nullptr, 10);
+    return retval;
+  }
+  return 4096;
+}
+
 static DeploymentMode getDeploymentMode_internal()
 {
   char* explicitMode = getenv("O2_DPL_DEPLOYMENT_MODE");
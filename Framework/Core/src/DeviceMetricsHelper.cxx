@@ -553,4 +553,20 @@ size_t DeviceMetricsHelper::metricIdxByName(const std::string& name, const Devic
   return i;
 }
 
+bool DeviceMetricsHelper::mergeLatencyHistogram(const std::string& name, const DeviceMetricsInfo& info, LatencyHistogramSnapshot& result)
+{
+  auto mi = metricIdxByName(name, info);
+  if (mi == info.metricLabels.size()) {
+    return false;
+  }
+  auto const& metric = info.metrics[mi];
+  if (metric.type != MetricType::String || metric.filledMetrics == 0) {
+    return false;
+  }
+  auto const& store = info.stringMetrics[metric.storeIdx];
+  // pos is where the next value will go.
+  auto const& last = store[(metric.pos + store.size() - 1) % store.size()];
+  return LatencyHistogramSnapshot::decode(std::string_view{last.data, strnlen(last.data, StringMetric::MAX_SIZE)}, result);
+}
+
 } // namespace o2::framework
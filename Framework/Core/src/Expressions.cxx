@@ -14,8 +14,14 @@
 #include "Framework/VariantHelpers.h"
 #include "arrow/table.h"
 #include "gandiva/tree_expr_builder.h"
+#include <fmt/format.h>
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <limits>
+#include <mutex>
+#include <optional>
 #include <set>
 #include <stack>
 #include <unordered_map>
@@ -440,17 +446,98 @@ gandiva::ExpressionPtr makeExpression(gandiva::NodePtr node, gandiva::FieldPtr r
   return gandiva::TreeExprBuilder::MakeExpression(std::move(node), std::move(result));
 }
 
+namespace
+{
+/// Process-wide cache of the compiled filters and projectors, so that the
+/// same expressions on the same schema are compiled only once, whichever
+/// task asks for them and however many times.
+template <typename T>
+struct CompiledCache {
+  std::mutex mutex;
+  std::unordered_map<std::string, std::shared_ptr<T>> compiled;
+
+  template <typename F>
+  std::shared_ptr<T> get(std::string const& key, F&& make)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto cached = compiled.find(key);
+      if (cached != compiled.end()) {
+        return cached->second;
+      }
+    }
+    // Compile outside of the lock, worst case two threads compile the
+    // same expression and one of the results is dropped.
+    auto result = make();
+    std::lock_guard<std::mutex> lock(mutex);
+    return compiled.emplace(key, result).first->second;
+  }
+};
+
+CompiledCache<gandiva::Filter>& filterCache()
+{
+  static CompiledCache<gandiva::Filter> cache;
+  return cache;
+}
+
+CompiledCache<gandiva::Projector>& projectorCache()
+{
+  static CompiledCache<gandiva::Projector> cache;
+  return cache;
+}
+
+void appendKey(std::string& key, DatumSpec const& spec)
+{
+  auto out = std::back_inserter(key);
+  switch (spec.datum.index()) {
+    case 1:
+      fmt::format_to(out, "#{}", std::get<size_t>(spec.datum));
+      break;
+    case 2:
+      // Literals are printed with all their digits, so that different
+      // values always give different keys
+      std::visit([&out, &spec](auto value) { fmt::format_to(out, "L{}:{}", (int)spec.type, value); }, std::get<LiteralNode::var_t>(spec.datum));
+      break;
+    case 3:
+      fmt::format_to(out, "B{}", std::get<std::string>(spec.datum));
+      break;
+    default:
+      key += '_';
+  }
+  key += ',';
+}
+
+/// Canonical representation of an operation sequence, which does not
+/// require to build the gandiva tree
+void appendKey(std::string& key, Operations const& opSpecs)
+{
+  for (auto const& spec : opSpecs) {
+    fmt::format_to(std::back_inserter(key), "{}:{}(", (int)spec.op, (int)spec.type);
+    appendKey(key, spec.left);
+    appendKey(key, spec.right);
+    appendKey(key, spec.condition);
+    appendKey(key, spec.result);
+    key += ')';
+  }
+  key += ';';
+}
+} // namespace
+
 std::shared_ptr<gandiva::Filter>
   createFilter(gandiva::SchemaPtr const& Schema, Operations const& opSpecs)
 {
-  std::shared_ptr<gandiva::Filter> filter;
-  auto s = gandiva::Filter::Make(Schema,
-                                 makeCondition(createExpressionTree(opSpecs, Schema)),
-                                 &filter);
-  if (!s.ok()) {
-    throw runtime_error_f("Failed to create filter: %s", s.ToString().c_str());
-  }
-  return filter;
+  std::string key = Schema->ToString();
+  appendKey(key, opSpecs);
+  return filterCache().get(key, [&]() {
+    std::shared_ptr<gandiva::Filter> filter;
+    auto s = gandiva::Filter::Make(Schema,
+                                   makeCondition(createExpressionTree(opSpecs, Schema)),
+                                   &filter);
+    if (!s.ok()) {
+      throw runtime_error_f("Failed to create filter: %s", s.ToString().c_str());
+    }
+    return filter;
+  });
 }
 
 std::shared_ptr<gandiva::Filter>
@@ -469,14 +556,19 @@ std::shared_ptr<gandiva::Filter>
 std::shared_ptr<gandiva::Projector>
   createProjector(gandiva::SchemaPtr const& Schema, Operations const& opSpecs, gandiva::FieldPtr result)
 {
-  std::shared_ptr<gandiva::Projector> projector;
-  auto s = gandiva::Projector::Make(Schema,
-                                    {makeExpression(createExpressionTree(opSpecs, Schema), std::move(result))},
-                                    &projector);
-  if (!s.ok()) {
-    throw runtime_error_f("Failed to create projector: %s", s.ToString().c_str());
-  }
-  return projector;
+  std::string key = Schema->ToString();
+  appendKey(key, opSpecs);
+  key += result->ToString();
+  return projectorCache().get(key, [&]() {
+    std::shared_ptr<gandiva::Projector> projector;
+    auto s = gandiva::Projector::Make(Schema,
+                                      {makeExpression(createExpressionTree(opSpecs, Schema), std::move(result))},
+                                      &projector);
+    if (!s.ok()) {
+      throw runtime_error_f("Failed to create projector: %s", s.ToString().c_str());
+    }
+    return projector;
+  });
 }
 
 std::shared_ptr<gandiva::Projector>
@@ -489,26 +581,33 @@ std::shared_ptr<gandiva::Projector> createProjectorHelper(size_t nColumns, expre
                                                           std::shared_ptr<arrow::Schema> schema,
                                                           std::vector<std::shared_ptr<arrow::Field>> const& fields)
 {
-  std::vector<gandiva::ExpressionPtr> expressions;
-
+  std::vector<Operations> operations;
+  std::string key = schema->ToString();
   for (size_t ci = 0; ci < nColumns; ++ci) {
-    expressions.push_back(
-      makeExpression(
-        framework::expressions::createExpressionTree(
-          framework::expressions::createOperations(projectors[ci]),
-          schema),
-        fields[ci]));
-  }
-
-  std::shared_ptr<gandiva::Projector> projector;
-  auto s = gandiva::Projector::Make(
-    schema,
-    expressions,
-    &projector);
-  if (s.ok()) {
-    return projector;
+    operations.push_back(framework::expressions::createOperations(projectors[ci]));
+    appendKey(key, operations.back());
+    key += fields[ci]->ToString();
   }
-  throw o2::framework::runtime_error_f("Failed to create projector: %s", s.ToString().c_str());
+
+  return projectorCache().get(key, [&]() {
+    std::vector<gandiva::ExpressionPtr> expressions;
+    for (size_t ci = 0; ci < nColumns; ++ci) {
+      expressions.push_back(
+        makeExpression(
+          framework::expressions::createExpressionTree(operations[ci], schema),
+          fields[ci]));
+    }
+
+    std::shared_ptr<gandiva::Projector> projector;
+    auto s = gandiva::Projector::Make(
+      schema,
+      expressions,
+      &projector);
+    if (!s.ok()) {
+      throw o2::framework::runtime_error_f("Failed to create projector: %s", s.ToString().c_str());
+    }
+    return projector;
+  });
 }
 
 gandiva::Selection createSelection(std::shared_ptr<arrow::Table> const& table, std::shared_ptr<gandiva::Filter> const& gfilter)
@@ -731,17 +830,252 @@ void updateExpressionInfos(expressions::Filter const& filter, std::vector<Expres
       } else {
         info.tree = tree;
       }
+      info.operations.push_back(std::make_shared<Operations const>(ops));
+    }
+  }
+}
+
+namespace
+{
+/// Range of values of an operand, in the type it has in the operation
+struct ValueRange {
+  double min;
+  double max;
+  atype::type type;
+};
+
+using RangeResult = std::variant<std::monostate, RangeOutcome, ValueRange>;
+
+std::optional<ValueRange> columnRange(arrow::Table const& table, std::string const& name, atype::type type)
+{
+  auto field = table.schema()->GetFieldByName(name);
+  if (field == nullptr || !field->HasMetadata()) {
+    return std::nullopt;
+  }
+  auto const& metadata = field->metadata();
+  auto rows = metadata->Get(columnRangeRowsKey);
+  auto min = metadata->Get(columnRangeMinKey);
+  auto max = metadata->Get(columnRangeMaxKey);
+  // The range is not valid anymore if rows were added to the table
+  if (!rows.ok() || !min.ok() || !max.ok() || std::strtoll(rows->c_str(), nullptr, 10) != table.num_rows()) {
+    return std::nullopt;
+  }
+  return ValueRange{std::strtod(min->c_str(), nullptr), std::strtod(max->c_str(), nullptr), type};
+}
+
+/// Convert a value to the type gandiva will use for the operation. This is
+/// monotonic, so that the converted range still bounds the converted values.
+std::optional<double> castTo(double value, atype::type type)
+{
+  auto inRange = [value]<typename T>(T) -> std::optional<double> {
+    if (value < (double)std::numeric_limits<T>::lowest() || value > (double)std::numeric_limits<T>::max()) {
+      return std::nullopt;
+    }
+    return value;
+  };
+  switch (type) {
+    case atype::FLOAT:
+      return (double)(float)value;
+    case atype::DOUBLE:
+      return value;
+    case atype::UINT8:
+      return inRange(uint8_t{});
+    case atype::INT8:
+      return inRange(int8_t{});
+    case atype::UINT16:
+      return inRange(uint16_t{});
+    case atype::INT16:
+      return inRange(int16_t{});
+    case atype::UINT32:
+      return inRange(uint32_t{});
+    case atype::INT32:
+      return inRange(int32_t{});
+    default:
+      // 64 bit integers cannot be represented exactly
+      return std::nullopt;
+  }
+}
+
+std::optional<ValueRange> castTo(ValueRange const& range, atype::type type)
+{
+  auto min = castTo(range.min, type);
+  auto max = castTo(range.max, type);
+  if (!min || !max) {
+    return std::nullopt;
+  }
+  return ValueRange{*min, *max, type};
+}
+
+/// Common type of the operands of a comparison, like in the expression tree
+atype::type commonType(atype::type t1, atype::type t2)
+{
+  if (t1 == atype::DOUBLE || t2 == atype::DOUBLE) {
+    return atype::DOUBLE;
+  }
+  if (t1 == atype::FLOAT || t2 == atype::FLOAT) {
+    return atype::FLOAT;
+  }
+  return std::max(t1, t2);
+}
+
+RangeOutcome compareRanges(BasicOp op, ValueRange const& a, ValueRange const& b)
+{
+  auto outcome = [](bool all, bool none) {
+    return all ? RangeOutcome::AllPass : (none ? RangeOutcome::NonePass : RangeOutcome::Unknown);
+  };
+  switch (op) {
+    case BasicOp::LessThan:
+      return outcome(a.max < b.min, a.min >= b.max);
+    case BasicOp::LessThanOrEqual:
+      return outcome(a.max <= b.min, a.min > b.max);
+    case BasicOp::GreaterThan:
+      return outcome(a.min > b.max, a.max <= b.min);
+    case BasicOp::GreaterThanOrEqual:
+      return outcome(a.min >= b.max, a.max < b.min);
+    case BasicOp::Equal:
+      return outcome(a.min == a.max && b.min == b.max && a.min == b.min, a.max < b.min || b.max < a.min);
+    case BasicOp::NotEqual:
+      return outcome(a.max < b.min || b.max < a.min, a.min == a.max && b.min == b.max && a.min == b.min);
+    default:
+      return RangeOutcome::Unknown;
+  }
+}
+} // namespace
+
+// Only an evaluation shortcut: the table was read in full by the time we get
+// here, the reader does not know the filters and cannot skip any dataframe
+// or column.
+RangeOutcome checkRanges(Operations const& opSpecs, arrow::Table const& table)
+{
+  std::vector<RangeResult> results(opSpecs.size());
+
+  auto datumResult = [&table, &results](DatumSpec const& spec) -> RangeResult {
+    switch (spec.datum.index()) {
+      case 1:
+        return results[std::get<size_t>(spec.datum)];
+      case 2:
+        return std::visit(
+          [&spec](auto value) -> RangeResult {
+            if constexpr (std::is_arithmetic_v<decltype(value)> && !std::is_same_v<decltype(value), bool>) {
+              return ValueRange{(double)value, (double)value, spec.type};
+            } else {
+              return std::monostate{};
+            }
+          },
+          std::get<LiteralNode::var_t>(spec.datum));
+      case 3:
+        if (auto range = columnRange(table, std::get<std::string>(spec.datum), spec.type)) {
+          return *range;
+        }
+        return std::monostate{};
+      default:
+        return std::monostate{};
+    }
+  };
+
+  for (auto it = opSpecs.rbegin(); it != opSpecs.rend(); ++it) {
+    auto left = datumResult(it->left);
+    auto right = datumResult(it->right);
+    RangeResult result;
+    switch (it->op) {
+      case BasicOp::LogicalAnd:
+      case BasicOp::LogicalOr: {
+        auto* l = std::get_if<RangeOutcome>(&left);
+        auto* r = std::get_if<RangeOutcome>(&right);
+        auto lo = l ? *l : RangeOutcome::Unknown;
+        auto ro = r ? *r : RangeOutcome::Unknown;
+        auto dominant = it->op == BasicOp::LogicalAnd ? RangeOutcome::NonePass : RangeOutcome::AllPass;
+        if (lo == dominant || ro == dominant) {
+          result = dominant;
+        } else if (lo == ro) {
+          result = lo;
+        } else {
+          result = RangeOutcome::Unknown;
+        }
+        break;
+      }
+      case BasicOp::LessThan:
+      case BasicOp::LessThanOrEqual:
+      case BasicOp::GreaterThan:
+      case BasicOp::GreaterThanOrEqual:
+      case BasicOp::Equal:
+      case BasicOp::NotEqual: {
+        auto* l = std::get_if<ValueRange>(&left);
+        auto* r = std::get_if<ValueRange>(&right);
+        if (l && r) {
+          auto type = commonType(l->type, r->type);
+          auto lc = castTo(*l, type);
+          auto rc = castTo(*r, type);
+          result = (lc && rc) ? compareRanges(it->op, *lc, *rc) : RangeOutcome::Unknown;
+        } else {
+          result = RangeOutcome::Unknown;
+        }
+        break;
+      }
+      case BasicOp::Abs: {
+        auto* l = std::get_if<ValueRange>(&left);
+        auto lc = l ? castTo(*l, it->type) : std::nullopt;
+        if (lc) {
+          auto low = (lc->min <= 0 && lc->max >= 0) ? 0. : std::min(std::abs(lc->min), std::abs(lc->max));
+          result = ValueRange{low, std::max(std::abs(lc->min), std::abs(lc->max)), it->type};
+        }
+        break;
+      }
+      default:
+        break;
     }
+    results[std::get<size_t>(it->result.datum)] = result;
+  }
+  if (auto* outcome = std::get_if<RangeOutcome>(&results[0])) {
+    return *outcome;
   }
+  return RangeOutcome::Unknown;
 }
 
 void updateFilterInfo(ExpressionInfo& info, std::shared_ptr<arrow::Table>& table)
 {
   if (info.tree != nullptr && info.filter == nullptr) {
-    info.filter = framework::expressions::createFilter(table->schema(), framework::expressions::makeCondition(info.tree));
+    if (info.operations.empty()) {
+      info.filter = framework::expressions::createFilter(table->schema(), framework::expressions::makeCondition(info.tree));
+    } else {
+      // The same filters are often declared by multiple tasks of a workflow.
+      std::string key = table->schema()->ToString();
+      for (auto const& ops : info.operations) {
+        appendKey(key, *ops);
+      }
+      info.filter = filterCache().get(key, [&]() { return framework::expressions::createFilter(table->schema(), framework::expressions::makeCondition(info.tree)); });
+    }
   }
   if (info.tree != nullptr && info.filter != nullptr && info.resetSelection == true) {
-    info.selection = framework::expressions::createSelection(table, info.filter);
+    // If the range of values of the columns already tells the result for all
+    // the rows, e.g. when the whole dataframe is outside of a cut, there
+    // is no need to evaluate the filter. This saves the Gandiva evaluation
+    // only, not the reading of the table.
+    auto outcome = info.operations.empty() ? RangeOutcome::Unknown : RangeOutcome::AllPass;
+    for (auto const& ops : info.operations) {
+      auto current = checkRanges(*ops, *table);
+      if (current == RangeOutcome::NonePass) {
+        outcome = current;
+        break;
+      }
+      if (current == RangeOutcome::Unknown) {
+        outcome = current;
+      }
+    }
+    if (outcome == RangeOutcome::Unknown) {
+      info.selection = framework::expressions::createSelection(table, info.filter);
+    } else {
+      auto s = gandiva::SelectionVector::MakeInt64(table->num_rows(), arrow::default_memory_pool(), &info.selection);
+      if (!s.ok()) {
+        throw runtime_error_f("Cannot allocate selection vector %s", s.ToString().c_str());
+      }
+      if (outcome == RangeOutcome::AllPass) {
+        for (int64_t i = 0; i < table->num_rows(); ++i) {
+          info.selection->SetIndex(i, i);
+        }
+        info.selection->SetNumSlots(table->num_rows());
+      }
+    }
     info.resetSelection = false;
   }
 }
@@ -10,6 +10,8 @@
 // or submit itself to any jurisdiction.
 
 #include "Framework/HistogramRegistry.h"
+#include <algorithm>
+#include <atomic>
 #include <regex>
 #include <TList.h>
 #include <TClass.h>
@@ -187,8 +189,357 @@ double HistogramRegistry::getSize(double fillFraction)
   return size;
 }
 
+namespace
+{
+// copy of a TAxis which finds bins like TAxis::FindFixBin, without touching the ROOT object
+struct FlatAxis {
+  explicit FlatAxis(TAxis const& axis)
+    : nBins(axis.GetNbins()), min(axis.GetXmin()), max(axis.GetXmax())
+  {
+    if (axis.GetXbins()->fN) {
+      edges.assign(axis.GetXbins()->fArray, axis.GetXbins()->fArray + axis.GetXbins()->fN);
+    }
+  }
+
+  int findBin(double x) const
+  {
+    if (x < min) {
+      return 0;
+    }
+    if (!(x < max)) {
+      return nBins + 1;
+    }
+    if (edges.empty()) {
+      return 1 + int(nBins * (x - min) / (max - min));
+    }
+    return std::upper_bound(edges.begin(), edges.end(), x) - edges.begin();
+  }
+
+  int nBins;
+  double min;
+  double max;
+  std::vector<double> edges;
+};
+
+// content of a histogram in flat arrays, together with what is needed to update its statistics
+struct FlatHist {
+  enum struct Kind {
+    None, // filled under a lock
+    TH,
+    THn,
+    Step
+  };
+
+  template <typename T>
+  static std::unique_ptr<FlatHist> create(T& hist);
+
+  // same semantics as the Fill of the corresponding ROOT object
+  void fill(double const* positionAndWeight, int nArgs);
+  // zero the content, keeping the arrays for the next fills
+  void reset();
+
+  Kind kind = Kind::None;
+  std::string name;
+  std::vector<FlatAxis> axes;
+  std::vector<int64_t> strides;
+  int64_t nCells = 1;
+  int nSteps = 1;
+  bool statOverflows = false;
+  std::vector<double> sumw;
+  std::vector<double> sumw2;
+  std::array<double, TH1::kNstat> stats{};
+  double entries = 0.;
+  bool weighted = false;
+};
+
+template <typename T>
+std::unique_ptr<FlatHist> FlatHist::create(T& hist)
+{
+  auto flat = std::make_unique<FlatHist>();
+  flat->name = hist.GetName();
+  if constexpr (std::is_same_v<T, TH1> || std::is_same_v<T, TH2> || std::is_same_v<T, TH3>) {
+    TAxis const* histAxes[] = {hist.GetXaxis(), hist.GetYaxis(), hist.GetZaxis()};
+    for (int d = 0; d < hist.GetDimension(); ++d) {
+      if (histAxes[d]->CanExtend() || histAxes[d]->GetLabels()) {
+        return flat;
+      }
+      flat->axes.emplace_back(*histAxes[d]);
+    }
+    flat->kind = Kind::TH;
+    flat->statOverflows = hist.GetStatOverflowsBehaviour();
+  } else if constexpr (std::is_same_v<T, THn>) {
+    for (int d = 0; d < hist.GetNdimensions(); ++d) {
+      flat->axes.emplace_back(*hist.GetAxis(d));
+    }
+    flat->kind = Kind::THn;
+  } else if constexpr (std::is_same_v<T, StepTHn>) {
+    for (int d = 0; d < hist.getNVar(); ++d) {
+      flat->axes.emplace_back(*hist.GetAxis(d));
+    }
+    flat->kind = Kind::Step;
+    flat->nSteps = hist.getNSteps();
+  } else {
+    return flat;
+  }
+
+  // x runs fastest like in TH1 and THn, while the last axis runs fastest in StepTHn which has no under- and overflow bins
+  int nDims = flat->axes.size();
+  flat->strides.resize(nDims);
+  for (int i = 0; i < nDims; ++i) {
+    int d = flat->kind == Kind::Step ? nDims - 1 - i : i;
+    flat->strides[d] = flat->nCells;
+    flat->nCells *= flat->axes[d].nBins + (flat->kind == Kind::Step ? 0 : 2);
+  }
+  flat->sumw.resize(flat->nSteps * flat->nCells);
+  flat->sumw2.resize(flat->nSteps * flat->nCells);
+  return flat;
+}
+
+void FlatHist::fill(double const* positionAndWeight, int nArgs)
+{
+  int step = 0;
+  if (kind == Kind::Step) {
+    step = static_cast<int>(positionAndWeight[0]);
+    if (step < 0 || step >= nSteps) {
+      LOGF(fatal, "Selected step for filling is not in range of StepTHn.");
+    }
+    ++positionAndWeight;
+    --nArgs;
+  }
+  int nDims = axes.size();
+  double weight = 1.;
+  if (nArgs == nDims + 1) {
+    weight = positionAndWeight[nDims];
+  } else if (nArgs != nDims) {
+    LOGF(fatal, "The number of arguments in fill function called for histogram %s is incompatible with histogram dimensions.", name);
+  }
+
+  int64_t cell = 0;
+  bool inRange = true;
+  for (int d = 0; d < nDims; ++d) {
+    int bin = axes[d].findBin(positionAndWeight[d]);
+    if (bin == 0 || bin > axes[d].nBins) {
+      // under- and overflow are not supported by StepTHn
+      if (kind == Kind::Step) {
+        return;
+      }
+      inRange = false;
+    }
+    cell += (kind == Kind::Step ? bin - 1 : bin) * strides[d];
+  }
+  cell += step * nCells;
+
+  weighted = weighted || weight != 1.;
+  entries += 1.;
+  sumw[cell] += weight;
+  // StepTHn keeps the sum of the weights in its sumw2 containers
+  sumw2[cell] += kind == Kind::Step ? weight : weight * weight;
+
+  if (kind != Kind::TH || (!inRange && !statOverflows)) {
+    return;
+  }
+  // same layout as TH1::GetStats
+  double const* x = positionAndWeight;
+  stats[0] += weight;
+  stats[1] += weight * weight;
+  stats[2] += weight * x[0];
+  stats[3] += weight * x[0] * x[0];
+  if (nDims > 1) {
+    stats[4] += weight * x[1];
+    stats[5] += weight * x[1] * x[1];
+    stats[6] += weight * x[0] * x[1];
+  }
+  if (nDims > 2) {
+    stats[7] += weight * x[2];
+    stats[8] += weight * x[2] * x[2];
+    stats[9] += weight * x[0] * x[2];
+    stats[10] += weight * x[1] * x[2];
+  }
+}
+
+void FlatHist::reset()
+{
+  if (entries == 0.) {
+    return;
+  }
+  std::fill(sumw.begin(), sumw.end(), 0.);
+  std::fill(sumw2.begin(), sumw2.end(), 0.);
+  stats.fill(0.);
+  entries = 0.;
+  weighted = false;
+}
+
+template <typename T>
+void mergeFlatHist(FlatHist const& flat, T& hist)
+{
+  if (flat.entries == 0.) {
+    return;
+  }
+  if constexpr (std::is_same_v<T, TH1> || std::is_same_v<T, TH2> || std::is_same_v<T, TH3>) {
+    double entries = hist.GetEntries();
+    double stats[TH1::kNstat] = {0.};
+    hist.GetStats(stats);
+    // like TH1::Fill with a weight
+    if (flat.weighted && hist.GetSumw2N() == 0 && !hist.TestBit(TH1::kIsNotW)) {
+      hist.Sumw2();
+    }
+    for (int64_t cell = 0; cell < flat.nCells; ++cell) {
+      if (flat.sumw[cell] != 0.) {
+        hist.AddBinContent(cell, flat.sumw[cell]);
+      }
+      if (hist.GetSumw2N() && flat.sumw2[cell] != 0.) {
+        hist.GetSumw2()->fArray[cell] += flat.sumw2[cell];
+      }
+    }
+    for (int i = 0; i < TH1::kNstat; ++i) {
+      stats[i] += flat.stats[i];
+    }
+    hist.PutStats(stats);
+    hist.SetEntries(entries + flat.entries);
+  } else if constexpr (std::is_same_v<T, THn>) {
+    if (flat.weighted && !hist.GetCalculateErrors()) {
+      hist.Sumw2();
+    }
+    std::vector<int> coordinates(flat.axes.size());
+    for (int64_t cell = 0; cell < flat.nCells; ++cell) {
+      if (flat.sumw[cell] == 0. && flat.sumw2[cell] == 0.) {
+        continue;
+      }
+      for (size_t d = 0; d < flat.axes.size(); ++d) {
+        coordinates[d] = (cell / flat.strides[d]) % (flat.axes[d].nBins + 2);
+      }
+      auto bin = hist.GetBin(coordinates.data());
+      hist.AddBinContent(bin, flat.sumw[cell]);
+      if (hist.GetCalculateErrors()) {
+        hist.AddBinError2(bin, flat.sumw2[cell]);
+      }
+    }
+    hist.SetEntries(hist.GetEntries() + flat.entries);
+  } else if constexpr (std::is_same_v<T, StepTHn>) {
+    for (int step = 0; step < flat.nSteps; ++step) {
+      auto begin = flat.sumw.begin() + step * flat.nCells;
+      if (std::all_of(begin, begin + flat.nCells, [](double v) { return v == 0.; })) {
+        continue;
+      }
+      hist.addContents(step, flat.sumw.data() + step * flat.nCells, flat.sumw2.data() + step * flat.nCells, flat.weighted);
+    }
+  }
+}
+
+// the thread local copies of the histograms of a registry for a given thread
+struct ThreadFills {
+  std::vector<std::unique_ptr<FlatHist>> hists;
+  // expires when the thread which fills them exits
+  std::weak_ptr<void> thread;
+};
+
+// alive as long as the calling thread
+std::shared_ptr<void> const& threadToken()
+{
+  thread_local std::shared_ptr<void> token = std::make_shared<char>();
+  return token;
+}
+} // namespace
+
+struct HistogramRegistry::ThreadLocalFills {
+  // used to find the copies of this registry in the thread local cache
+  uint64_t id;
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadFills>> threads;
+  std::array<std::mutex, MAX_REGISTRY_SIZE> fillMutexes;
+};
+
+void HistogramRegistry::setThreadLocalFills(bool enable)
+{
+  static std::atomic<uint64_t> nextId{1};
+  if (!enable) {
+    mergeThreadLocalFills();
+    mThreadLocalFills.reset();
+  } else if (!mThreadLocalFills) {
+    mThreadLocalFills = std::make_shared<ThreadLocalFills>();
+    mThreadLocalFills->id = nextId++;
+  }
+}
+
+bool HistogramRegistry::fillThreadLocal(uint32_t idx, double const* positionAndWeight, int nArgs)
+{
+  struct CacheEntry {
+    uint64_t id;
+    ThreadFills* fills;
+  };
+  // the registries this thread has filled, the last one first
+  thread_local std::vector<CacheEntry> cache;
+
+  auto& threadLocalFills = *mThreadLocalFills;
+  if (cache.empty() || cache.front().id != threadLocalFills.id) {
+    auto it = std::find_if(cache.begin(), cache.end(), [&threadLocalFills](CacheEntry const& entry) { return entry.id == threadLocalFills.id; });
+    if (it == cache.end()) {
+      std::lock_guard<std::mutex> lock(threadLocalFills.mutex);
+      threadLocalFills.threads.emplace_back(std::make_unique<ThreadFills>());
+      threadLocalFills.threads.back()->hists.resize(MAX_REGISTRY_SIZE);
+      threadLocalFills.threads.back()->thread = threadToken();
+      cache.push_back({threadLocalFills.id, threadLocalFills.threads.back().get()});
+      it = cache.end() - 1;
+    }
+    std::iter_swap(cache.begin(), it);
+  }
+
+  auto& flat = cache.front().fills->hists[idx];
+  if (!flat) {
+    // the histograms are not modified while filling, we can safely read their axes
+    std::visit([&flat](auto&& hist) { flat = hist ? FlatHist::create(*hist) : std::make_unique<FlatHist>(); }, mRegistryValue[idx]);
+  }
+  if (flat->kind == FlatHist::Kind::None) {
+    return false;
+  }
+  flat->fill(positionAndWeight, nArgs);
+  return true;
+}
+
+std::mutex& HistogramRegistry::getFillMutex(uint32_t idx)
+{
+  return mThreadLocalFills->fillMutexes[idx];
+}
+
+void HistogramRegistry::mergeThreadLocalFills()
+{
+  if (!mThreadLocalFills) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mThreadLocalFills->mutex);
+  auto& threads = mThreadLocalFills->threads;
+  for (auto& threadFills : threads) {
+    // checked before merging, so that whatever a finished thread filled is merged
+    bool finished = threadFills->thread.expired();
+    for (auto idx = 0u; idx < MAX_REGISTRY_SIZE; ++idx) {
+      auto& flat = threadFills->hists[idx];
+      if (!flat) {
+        continue;
+      }
+      std::visit([&flat](auto&& hist) { if (hist) { mergeFlatHist(*flat, *hist); } }, mRegistryValue[idx]);
+      // keep the arrays, allocating them again at every merge is expensive for large histograms
+      flat->reset();
+    }
+    if (finished) {
+      threadFills.reset();
+    }
+  }
+  threads.erase(std::remove(threads.begin(), threads.end(), nullptr), threads.end());
+}
+
 void HistogramRegistry::clean()
 {
+  if (mThreadLocalFills) {
+    std::lock_guard<std::mutex> lock(mThreadLocalFills->mutex);
+    auto& threads = mThreadLocalFills->threads;
+    // the copies refer to the histograms which are being deleted
+    for (auto& threadFills : threads) {
+      for (auto& flat : threadFills->hists) {
+        flat.reset();
+      }
+    }
+    threads.erase(std::remove_if(threads.begin(), threads.end(), [](auto const& threadFills) { return threadFills->thread.expired(); }), threads.end());
+  }
   for (auto& value : mRegistryValue) {
     std::visit([](auto&& hist) { hist.reset(); }, value);
   }
@@ -285,6 +636,8 @@ void HistogramRegistry::print(bool showAxisDetails)
 // create output structure will be propagated to file-sink
 TList* HistogramRegistry::getListOfHistograms()
 {
+  mergeThreadLocalFills();
+
   TList* list = new TList();
   list->SetName(mName.data());
 
@@ -0,0 +1,104 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include "Framework/LatencyHistogram.h"
+
+#include <charconv>
+#include <cmath>
+
+namespace o2::framework
+{
+
+LatencyHistogramSnapshot LatencyHistogramSnapshot::from(LatencyHistogram const& histogram)
+{
+  LatencyHistogramSnapshot result;
+  for (size_t bi = 0; bi < result.counts.size(); ++bi) {
+    result.counts[bi] = histogram.counts[bi].load(std::memory_order_relaxed);
+    result.total += result.counts[bi];
+  }
+  return result;
+}
+
+void LatencyHistogramSnapshot::merge(LatencyHistogramSnapshot const& other)
+{
+  for (size_t bi = 0; bi < counts.size(); ++bi) {
+    counts[bi] += other.counts[bi];
+  }
+  total += other.total;
+}
+
+uint64_t LatencyHistogramSnapshot::quantile(double q) const
+{
+  if (total == 0) {
+    return 0;
+  }
+  auto rank = (uint64_t)std::ceil(q * (double)total);
+  uint64_t seen = 0;
+  for (size_t bi = 0; bi < counts.size(); ++bi) {
+    seen += counts[bi];
+    if (seen >= rank && counts[bi]) {
+      return LatencyHistogram::lowerBound(bi);
+    }
+  }
+  return LatencyHistogram::lowerBound(LatencyHistogram::BUCKETS - 1);
+}
+
+std::string LatencyHistogramSnapshot::encode(size_t maxSize) const
+{
+  std::string result;
+  for (int level = 0; level <= LatencyHistogram::SUB_BUCKET_BITS; ++level) {
+    // Fold the sub-buckets which differ only in the last level bits.
+    std::array<uint64_t, LatencyHistogram::BUCKETS> folded = {};
+    int mask = (1 << level) - 1;
+    for (int bi = 0; bi < LatencyHistogram::BUCKETS; ++bi) {
+      folded[bi - ((bi % LatencyHistogram::SUB_BUCKETS) & mask)] += counts[bi];
+    }
+    result.clear();
+    char buffer[64];
+    for (int bi = 0; bi < LatencyHistogram::BUCKETS; ++bi) {
+      if (folded[bi] == 0) {
+        continue;
+      }
+      char* end = std::to_chars(buffer, buffer + sizeof(buffer), bi, 16).ptr;
+      *end++ = ':';
+      end = std::to_chars(end, buffer + sizeof(buffer), folded[bi], 16).ptr;
+      *end++ = ';';
+      result.append(buffer, end);
+    }
+    if (result.size() <= maxSize) {
+      break;
+    }
+  }
+  return result;
+}
+
+bool LatencyHistogramSnapshot::decode(std::string_view encoded, LatencyHistogramSnapshot& result)
+{
+  char const* cur = encoded.data();
+  char const* end = encoded.data() + encoded.size();
+  while (cur != end) {
+    int bucket = 0;
+    uint64_t count = 0;
+    auto [bucketEnd, bucketErr] = std::from_chars(cur, end, bucket, 16);
+    if (bucketErr != std::errc{} || bucketEnd == end || *bucketEnd != ':' || bucket < 0 || bucket >= LatencyHistogram::BUCKETS) {
+      return false;
+    }
+    auto [countEnd, countErr] = std::from_chars(bucketEnd + 1, end, count, 16);
+    if (countErr != std::errc{} || countEnd == end || *countEnd != ';') {
+      return false;
+    }
+    result.counts[bucket] += count;
+    result.total += count;
+    cur = countEnd + 1;
+  }
+  return true;
+}
+
+} // namespace o2::framework
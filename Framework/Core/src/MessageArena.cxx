@@ -0,0 +1,102 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include "Framework/MessageArena.h"
+#include "Framework/RuntimeError.h"
+
+#include <fairmq/TransportFactory.h>
+#include <fairmq/Message.h>
+
+namespace o2::framework
+{
+
+MessageArena::MessageArena(fair::mq::TransportFactory* transport, size_t size, size_t blocks)
+  : mTransport{transport},
+    mBlockSize{(size / blocks) & ~(alignment - 1)},
+    mBlocks(blocks)
+{
+  if (mBlockSize == 0) {
+    throw runtime_error_f("Arena of %zu bytes too small for %zu blocks", size, blocks);
+  }
+  mRegion = transport->CreateUnmanagedRegion(mBlockSize * blocks, [this](std::vector<fair::mq::RegionBlock> const& blocks) {
+    this->released(blocks);
+  });
+}
+
+MessageArena::~MessageArena()
+{
+  // Make sure we do not get notified anymore.
+  mRegion.reset();
+}
+
+std::unique_ptr<fair::mq::Message> MessageArena::create(size_t timeslice, size_t size)
+{
+  std::scoped_lock<std::mutex> lock(mMutex);
+  size_t alignedSize = (size + alignment - 1) & ~(alignment - 1);
+  if (alignedSize > maxMessageSize()) {
+    return nullptr;
+  }
+  // A new timeslice or a full block means we need to move on.
+  if (mCurrent != -1 && (mBlocks[mCurrent].timeslice != timeslice || mBlocks[mCurrent].offset + alignedSize > mBlockSize)) {
+    retireCurrent();
+  }
+  if (mCurrent == -1) {
+    for (size_t bi = 0; bi < mBlocks.size(); ++bi) {
+      if (mBlocks[bi].inUse == false) {
+        mCurrent = bi;
+        mBlocks[bi] = Block{.timeslice = timeslice, .offset = 0, .pending = 0, .inUse = true};
+        break;
+      }
+    }
+  }
+  // All the blocks are still referenced by some consumer.
+  if (mCurrent == -1) {
+    return nullptr;
+  }
+  auto& block = mBlocks[mCurrent];
+  char* data = static_cast<char*>(mRegion->GetData()) + mCurrent * mBlockSize + block.offset;
+  block.offset += alignedSize;
+  block.pending++;
+  // The hint is used to find back the block when the message is released.
+  return mTransport->CreateMessage(mRegion, data, size, reinterpret_cast<void*>(mCurrent));
+}
+
+size_t MessageArena::freeBlocks() const
+{
+  std::scoped_lock<std::mutex> lock(mMutex);
+  size_t result = 0;
+  for (auto& block : mBlocks) {
+    result += block.inUse ? 0 : 1;
+  }
+  return result;
+}
+
+void MessageArena::retireCurrent()
+{
+  if (mBlocks[mCurrent].pending == 0) {
+    mBlocks[mCurrent].inUse = false;
+  }
+  mCurrent = -1;
+}
+
+void MessageArena::released(std::vector<fair::mq::RegionBlock> const& blocks)
+{
+  std::scoped_lock<std::mutex> lock(mMutex);
+  for (auto& released : blocks) {
+    auto bi = reinterpret_cast<intptr_t>(released.hint);
+    auto& block = mBlocks[bi];
+    block.pending--;
+    if (block.pending == 0 && bi != mCurrent) {
+      block.inUse = false;
+    }
+  }
+}
+
+} // namespace o2::framework
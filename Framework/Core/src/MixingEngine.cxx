@@ -0,0 +1,198 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include "Framework/MixingEngine.h"
+#include "Framework/RuntimeError.h"
+#include "Framework/WorkerPool.h"
+
+#include <arrow/array.h>
+#include <arrow/table.h>
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+
+namespace o2::framework
+{
+
+namespace
+{
+/// Invoke @a f(row, value) for the (selected) rows of an int32 column.
+template <typename F>
+void forEachIndex(arrow::ChunkedArray const& column, gsl::span<int64_t const> selection, bool filtered, F&& f)
+{
+  int64_t chunkStart = 0;
+  size_t selected = 0;
+  for (auto const& chunk : column.chunks()) {
+    auto const* values = std::static_pointer_cast<arrow::Int32Array>(chunk)->raw_values();
+    int64_t length = chunk->length();
+    if (filtered) {
+      for (; selected < selection.size() && selection[selected] < chunkStart + length; ++selected) {
+        f(selection[selected], values[selection[selected] - chunkStart]);
+      }
+    } else {
+      for (int64_t ri = 0; ri < length; ++ri) {
+        f(chunkStart + ri, values[ri]);
+      }
+    }
+    chunkStart += length;
+  }
+}
+
+/// Run @a work(thread, bin) for all the bins, on at most @a threads threads of @a pool.
+void runBins(WorkerPool* pool, std::vector<uint64_t> const& costs, int threads, bool deterministic, std::function<void(int, size_t)> const& work)
+{
+  if (threads <= 1 || pool == nullptr) {
+    for (size_t bin = 0; bin < costs.size(); ++bin) {
+      work(0, bin);
+    }
+    return;
+  }
+
+  // Largest bins first, so that no thread is left alone with a big one at the end.
+  std::vector<size_t> order(costs.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&costs](size_t a, size_t b) { return costs[a] > costs[b]; });
+
+  // In deterministic mode, each bin goes to the least loaded thread so far.
+  std::vector<std::vector<size_t>> assigned(threads);
+  if (deterministic) {
+    std::vector<uint64_t> load(threads, 0);
+    for (auto bin : order) {
+      auto thread = std::distance(load.begin(), std::min_element(load.begin(), load.end()));
+      assigned[thread].push_back(bin);
+      load[thread] += costs[bin];
+    }
+    for (auto& bins : assigned) {
+      std::sort(bins.begin(), bins.end());
+    }
+  }
+
+  // One job per thread. Should the pool run them sequentially, the first
+  // job processes all the bins which are not explicitly assigned.
+  std::atomic<size_t> next = 0;
+  std::atomic<bool> failed = false;
+  pool->run(threads, threads, [&](size_t thread) {
+    try {
+      if (deterministic) {
+        for (auto bin : assigned[thread]) {
+          if (failed.load(std::memory_order_relaxed)) {
+            return;
+          }
+          work(thread, bin);
+        }
+        return;
+      }
+      for (size_t pos = next++; pos < order.size() && !failed.load(std::memory_order_relaxed); pos = next++) {
+        work(thread, order[pos]);
+      }
+    } catch (...) {
+      failed = true;
+      throw;
+    }
+  });
+}
+} // namespace
+
+void MixingEngineHelpers::groupRows(arrow::Table const& table, char const* indexColumn, gsl::span<int64_t const> selection, bool filtered,
+                                    int64_t groups, std::vector<int64_t>& offsets, std::vector<int64_t>& rows)
+{
+  auto column = table.GetColumnByName(indexColumn);
+  if (!column) {
+    throw runtime_error_f("Index column %s not found in associated table", indexColumn);
+  }
+  if (column->type()->id() != arrow::Type::INT32) {
+    throw runtime_error_f("Index column %s is of type %s, int32 expected", indexColumn, column->type()->ToString().c_str());
+  }
+
+  // Counting sort, rows which do not point to a valid group are ignored.
+  offsets.assign(groups + 1, 0);
+  forEachIndex(*column, selection, filtered, [&offsets, groups](int64_t, int32_t value) {
+    if (value >= 0 && value < groups) {
+      ++offsets[value + 1];
+    }
+  });
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  rows.resize(offsets.back());
+  std::vector<int64_t> cursors(offsets.begin(), offsets.end() - 1);
+  forEachIndex(*column, selection, filtered, [&cursors, &rows, groups](int64_t row, int32_t value) {
+    if (value >= 0 && value < groups) {
+      rows[cursors[value]++] = row;
+    }
+  });
+}
+
+void MixingEngineHelpers::mix(std::vector<soa::BinningIndex> const& grouped, std::vector<int64_t> const& offsets, std::vector<int64_t> const& rows,
+                              int catNeighbours, MixingEngineOptions const& options, WorkerPool* pool, std::function<void(int, MixedPairsBatch const&)> const& f)
+{
+  // Bins are contiguous in grouped, collisions sorted within each of them.
+  std::vector<size_t> binBegins;
+  for (size_t gi = 0; gi < grouped.size(); ++gi) {
+    if (gi == 0 || grouped[gi].bin != grouped[gi - 1].bin) {
+      binBegins.push_back(gi);
+    }
+  }
+  binBegins.push_back(grouped.size());
+  size_t bins = binBegins.size() - 1;
+
+  auto associatedSize = [&offsets, &grouped](size_t gi) {
+    auto collision = grouped[gi].index;
+    return offsets[collision + 1] - offsets[collision];
+  };
+  auto windowEnd = [&binBegins, catNeighbours](size_t bin, size_t gi) {
+    return std::min(binBegins[bin + 1], gi + catNeighbours + 1);
+  };
+
+  std::vector<uint64_t> costs(bins, 0);
+  for (size_t bin = 0; bin < bins; ++bin) {
+    for (size_t gi = binBegins[bin]; gi < binBegins[bin + 1]; ++gi) {
+      for (size_t gj = gi + 1; gj < windowEnd(bin, gi); ++gj) {
+        costs[bin] += 1 + associatedSize(gi) * associatedSize(gj);
+      }
+    }
+  }
+
+  int threads = std::max<int>(1, std::min<size_t>(options.threads, bins));
+  size_t batchSize = std::max<size_t>(1, options.batchSize);
+  std::vector<MixedPairsBatch> batches(threads);
+  for (auto& batch : batches) {
+    batch.first.reserve(batchSize);
+    batch.second.reserve(batchSize);
+  }
+
+  runBins(pool, costs, threads, options.deterministic, [&](int thread, size_t bin) {
+    auto& batch = batches[thread];
+    batch.bin = grouped[binBegins[bin]].bin;
+    for (size_t gi = binBegins[bin]; gi < binBegins[bin + 1]; ++gi) {
+      for (size_t gj = gi + 1; gj < windowEnd(bin, gi); ++gj) {
+        batch.collision1 = grouped[gi].index;
+        batch.collision2 = grouped[gj].index;
+        batch.first.clear();
+        batch.second.clear();
+        for (auto r1 = offsets[batch.collision1]; r1 < offsets[batch.collision1 + 1]; ++r1) {
+          for (auto r2 = offsets[batch.collision2]; r2 < offsets[batch.collision2 + 1]; ++r2) {
+            batch.first.push_back(rows[r1]);
+            batch.second.push_back(rows[r2]);
+            if (batch.size() == batchSize) {
+              f(thread, batch);
+              batch.first.clear();
+              batch.second.clear();
+            }
+          }
+        }
+        if (batch.size() != 0) {
+          f(thread, batch);
+        }
+      }
+    }
+  });
+}
+
+} // namespace o2::framework
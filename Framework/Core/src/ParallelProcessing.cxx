@@ -0,0 +1,56 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include "Framework/ParallelProcessing.h"
+
+#include <algorithm>
+
+namespace o2::framework
+{
+
+namespace
+{
+thread_local int gCurrentPartition = -1;
+
+/// Sets the partition of the calling thread for the duration of the scope
+struct PartitionScope {
+  explicit PartitionScope(size_t partition) { gCurrentPartition = static_cast<int>(partition); }
+  ~PartitionScope() { gCurrentPartition = -1; }
+};
+} // namespace
+
+std::vector<std::pair<int64_t, int64_t>> ParallelProcessing::partition(int64_t rows, int threads)
+{
+  // A few partitions per thread, so that a slow one does not hold the others.
+  int64_t count = std::min<int64_t>(rows, threads <= 1 ? 1 : 4 * (int64_t)threads);
+  std::vector<std::pair<int64_t, int64_t>> result;
+  result.reserve(count);
+  for (int64_t pi = 0; pi < count; ++pi) {
+    result.emplace_back(rows * pi / count, rows * (pi + 1) / count);
+  }
+  return result;
+}
+
+void ParallelProcessing::run(WorkerPool& pool, size_t partitions, int threads, std::function<void(size_t)> const& work)
+{
+  // The threads of the pool are kept between the dataframes, so that the
+  // per thread state, e.g. the thread local histograms, does not pile up.
+  pool.run(partitions, std::max(1, threads), [&work](size_t partition) {
+    PartitionScope scope{partition};
+    work(partition);
+  });
+}
+
+int ParallelProcessing::currentPartition()
+{
+  return gCurrentPartition;
+}
+
+} // namespace o2::framework
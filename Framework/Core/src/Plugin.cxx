@@ -158,6 +158,15 @@ struct DiscoverAODOptionsInCommandLine : o2::framework::ConfigDiscoveryPlugin {
             results.push_back(ConfigParamSpec{"aod-writer-compression", VariantType::Int, numericValue, {"AOD Compression options"}});
             injectOption = false;
           }
+          if (key == "aod-writer-slice-index") {
+            results.push_back(ConfigParamSpec{"aod-writer-slice-index", VariantType::Bool, value == "true" || value == "1", {"Store the groups of the sorted index columns with the AOD tables"}});
+          }
+          if (key == "aod-writer-column-ranges") {
+            results.push_back(ConfigParamSpec{"aod-writer-column-ranges", VariantType::Bool, value == "true" || value == "1", {"Store the range of values of the numeric columns with the AOD tables"}});
+          }
+          if (key == "aod-writer-column-codecs") {
+            results.push_back(ConfigParamSpec{"aod-writer-column-codecs", VariantType::Bool, value == "true" || value == "1", {"Encode the columns with the codec of their declaration"}});
+          }
           if (key == "aod-parent-base-path-replacement") {
             results.push_back(ConfigParamSpec{"aod-parent-base-path-replacement", VariantType::String, value, {R"(Replace base path of parent files. Syntax: FROM;TO. E.g. "alien:///path/in/alien;/local/path". Enclose in "" on the command line.)"}});
           }
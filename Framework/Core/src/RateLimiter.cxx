@@ -20,11 +20,53 @@
 #include <uv.h>
 #include <fairmq/shmem/Monitor.h>
 #include <fairmq/shmem/Common.h>
+#include <algorithm>
 #include <chrono>
 #include <thread>
 
 using namespace o2::framework;
 
+namespace
+{
+/// @return the free memory in the shared memory segment, -1 if unknown.
+long getFreeSharedMemory(fair::mq::Device* device, ServiceRegistryRef services)
+{
+  auto& runningWorkflow = services.get<RunningWorkflowInfo const>();
+  long freeMemory = -1;
+  try {
+    freeMemory = fair::mq::shmem::Monitor::GetFreeMemory(fair::mq::shmem::ShmId{fair::mq::shmem::makeShmIdStr(device->fConfig->GetProperty<uint64_t>("shmid"))}, runningWorkflow.shmSegmentId);
+  } catch (...) {
+  }
+  if (freeMemory == -1) {
+    try {
+      freeMemory = fair::mq::shmem::Monitor::GetFreeMemory(fair::mq::shmem::SessionId{device->fConfig->GetProperty<std::string>("session")}, runningWorkflow.shmSegmentId);
+    } catch (...) {
+    }
+  }
+  return freeMemory;
+}
+} // namespace
+
+int AdaptiveRateLimit::update(int maxInFlight, int64_t sent, int64_t consumed, float occupancy)
+{
+  if (limit == 0.f) {
+    limit = maxInFlight;
+  }
+  if (occupancy > targetOccupancy) {
+    // Multiplicative decrease, but only once the timeframes which were
+    // in flight when we last decreased are gone, otherwise we would
+    // collapse to 1 before the previous decrease had any effect.
+    if (consumed >= lastDecreaseSent) {
+      limit = std::max(1.f, limit / 2.f);
+      lastDecreaseSent = sent;
+    }
+  } else if (sent - consumed >= (int64_t)limit) {
+    // Additive increase, i.e. one more timeframe per round trip.
+    limit = std::min((float)maxInFlight, limit + 1.f / limit);
+  }
+  return std::max(1, (int)limit);
+}
+
 int RateLimiter::check(ProcessingContext& ctx, int maxInFlight, size_t minSHM)
 {
   if (!maxInFlight && !minSHM) {
@@ -33,6 +75,22 @@ int RateLimiter::check(ProcessingContext& ctx, int maxInFlight, size_t minSHM)
   auto device = ctx.services().get<RawDeviceService>().device();
   auto& deviceState = ctx.services().get<DeviceState>();
   if (maxInFlight && device->GetChannels().count("metric-feedback")) {
+    // When requested, the maximum number of timeframes in flight is only
+    // an upper bound and the actual limit follows the shared memory usage.
+    static float adaptiveTarget = getenv("DPL_ADAPTIVE_RATE_LIMITING") ? atof(getenv("DPL_ADAPTIVE_RATE_LIMITING")) / 100.f : 0.f;
+    static size_t segmentSize = strtoull(device->fConfig->GetPropertyAsString("shm-segment-size", "0").c_str(), nullptr, 10);
+    if (adaptiveTarget > 0.f && segmentSize) {
+      long freeMemory = getFreeSharedMemory(device, ctx.services());
+      if (freeMemory != -1) {
+        mAdaptive.targetOccupancy = adaptiveTarget;
+        int previousLimit = mAdaptive.limit;
+        float occupancy = 1.f - (float)freeMemory / (float)segmentSize;
+        maxInFlight = mAdaptive.update(maxInFlight, mSentTimeframes, mConsumedTimeframes, occupancy);
+        if (maxInFlight != previousLimit) {
+          LOG(detail) << "Adaptive rate limiting: shared memory occupancy " << occupancy << ", " << maxInFlight << " TF in flight allowed";
+        }
+      }
+    }
     auto& dtc = ctx.services().get<DataTakingContext>();
     const auto& device = ctx.services().get<RawDeviceService>().device();
     const auto& deviceContext = ctx.services().get<DeviceContext>();
@@ -127,19 +185,8 @@ int RateLimiter::check(ProcessingContext& ctx, int maxInFlight, size_t minSHM)
   }
   if (minSHM) {
     int waitMessage = 0;
-    auto& runningWorkflow = ctx.services().get<RunningWorkflowInfo const>();
     while (true) {
-      long freeMemory = -1;
-      try {
-        freeMemory = fair::mq::shmem::Monitor::GetFreeMemory(fair::mq::shmem::ShmId{fair::mq::shmem::makeShmIdStr(device->fConfig->GetProperty<uint64_t>("shmid"))}, runningWorkflow.shmSegmentId);
-      } catch (...) {
-      }
-      if (freeMemory == -1) {
-        try {
-          freeMemory = fair::mq::shmem::Monitor::GetFreeMemory(fair::mq::shmem::SessionId{device->fConfig->GetProperty<std::string>("session")}, runningWorkflow.shmSegmentId);
-        } catch (...) {
-        }
-      }
+      long freeMemory = getFreeSharedMemory(device, ctx.services());
       if (freeMemory == -1) {
         throw std::runtime_error("Could not obtain free SHM memory");
       }
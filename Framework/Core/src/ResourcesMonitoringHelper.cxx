@@ -11,6 +11,8 @@
 
 #include "ResourcesMonitoringHelper.h"
 #include "Framework/DeviceMetricsInfo.h"
+#include "Framework/DeviceMetricsHelper.h"
+#include "Framework/LatencyHistogram.h"
 #define BOOST_BIND_GLOBAL_PLACEHOLDERS
 #include <boost/property_tree/json_parser.hpp>
 #include <fstream>
@@ -52,6 +54,70 @@ boost::property_tree::ptree fillNodeWithValue(const DeviceMetricsInfo& deviceMet
   return metricNode;
 }
 
+boost::property_tree::ptree fillNodeWithLatencies(LatencyHistogramSnapshot const& histogram)
+{
+  boost::property_tree::ptree node;
+  node.add("count", histogram.total);
+  node.add("p50", histogram.quantile(0.5));
+  node.add("p90", histogram.quantile(0.9));
+  node.add("p99", histogram.quantile(0.99));
+  node.add("p999", histogram.quantile(0.999));
+  node.add("max", histogram.quantile(1.));
+  boost::property_tree::ptree buckets;
+  for (int bi = 0; bi < LatencyHistogram::BUCKETS; ++bi) {
+    if (histogram.counts[bi] == 0) {
+      continue;
+    }
+    boost::property_tree::ptree bucket;
+    bucket.add("min", LatencyHistogram::lowerBound(bi));
+    bucket.add("count", histogram.counts[bi]);
+    buckets.push_back(std::make_pair("", bucket));
+  }
+  node.add_child("buckets", buckets);
+  return node;
+}
+
+bool ResourcesMonitoringHelper::dumpLatenciesToJSON(std::vector<DeviceMetricsInfo> const& metrics,
+                                                    std::vector<DeviceSpec> const& specs) noexcept
+{
+  assert(metrics.size() == specs.size());
+
+  bool found = false;
+  std::array<LatencyHistogramSnapshot, (int)LatencyStage::COUNT> totals;
+  boost::property_tree::ptree root;
+  for (size_t idx = 0; idx < metrics.size(); ++idx) {
+    boost::property_tree::ptree deviceRoot;
+    for (size_t si = 0; si < totals.size(); ++si) {
+      LatencyHistogramSnapshot histogram;
+      if (DeviceMetricsHelper::mergeLatencyHistogram(latencyStageMetricNames[si], metrics[idx], histogram) == false) {
+        continue;
+      }
+      totals[si].merge(histogram);
+      deviceRoot.add_child(latencyStageMetricNames[si], fillNodeWithLatencies(histogram));
+    }
+    if (deviceRoot.empty() == false) {
+      found = true;
+      root.add_child(specs[idx].id, deviceRoot);
+    }
+  }
+  if (found == false) {
+    return false;
+  }
+
+  boost::property_tree::ptree totalRoot;
+  for (size_t si = 0; si < totals.size(); ++si) {
+    totalRoot.add_child(latencyStageMetricNames[si], fillNodeWithLatencies(totals[si]));
+  }
+  root.add_child("workflow", totalRoot);
+
+  std::ofstream file("latencyHistograms.json", std::ios::out);
+  if (file.is_open() == false) {
+    return false;
+  }
+  boost::property_tree::json_parser::write_json(file, root);
+  return true;
+}
+
 bool ResourcesMonitoringHelper::dumpMetricsToJSON(const std::vector<DeviceMetricsInfo>& metrics,
                                                   const DeviceMetricsInfo& driverMetrics,
                                                   const std::vector<DeviceSpec>& specs,
@@ -30,6 +30,11 @@ struct ResourcesMonitoringHelper {
                                 DeviceMetricsInfo const& driverMetrics,
                                 std::vector<DeviceSpec> const& specs,
                                 std::vector<std::regex> const& metricsToDump) noexcept;
+  /// Dump the latency histograms of all the devices, together with
+  /// their workflow wide aggregate, to latencyHistograms.json.
+  /// @return false if no device posted any histogram.
+  static bool dumpLatenciesToJSON(std::vector<DeviceMetricsInfo> const& metrics,
+                                  std::vector<DeviceSpec> const& specs) noexcept;
   static bool isResourcesMonitoringEnabled(unsigned short interval) noexcept { return interval > 0; }
 };
 
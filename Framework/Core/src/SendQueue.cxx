@@ -0,0 +1,103 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Framework/SendQueue.h"
+#include "Framework/Logger.h"
+
+#include <utility>
+
+namespace o2::framework
+{
+
+SendQueue::SendQueue(size_t maxQueued, SendCallback send)
+  : mMaxQueued{maxQueued},
+    mSend{std::move(send)}
+{
+  mThread = std::thread(&SendQueue::run, this);
+}
+
+SendQueue::~SendQueue()
+{
+  {
+    std::scoped_lock<std::mutex> lock(mMutex);
+    mStopping = true;
+  }
+  mChanged.notify_all();
+  mThread.join();
+  if (mError) {
+    LOGP(error, "Last queued send failed and was never reported");
+  }
+}
+
+void SendQueue::run()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  while (true) {
+    mChanged.wait(lock, [this]() { return mStopping || mQueue.empty() == false; });
+    // We drain the queue before stopping, so that nothing is lost.
+    if (mQueue.empty()) {
+      return;
+    }
+    auto pending = std::move(mQueue.front());
+    mQueue.pop_front();
+    // Let the calling thread queue more while we send.
+    mChanged.notify_all();
+    lock.unlock();
+    std::exception_ptr error;
+    try {
+      mSend(pending.parts, pending.index);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    lock.lock();
+    mPending--;
+    if (error) {
+      // Sending anything after a failure could reorder the data, drop it
+      // and let the caller decide what to do.
+      mPending -= mQueue.size();
+      mQueue.clear();
+      if (!mError) {
+        mError = error;
+      }
+    }
+    mChanged.notify_all();
+  }
+}
+
+void SendQueue::rethrowError()
+{
+  if (mError) {
+    auto error = std::exchange(mError, nullptr);
+    std::rethrow_exception(error);
+  }
+}
+
+void SendQueue::push(fair::mq::Parts& parts, ChannelIndex index)
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  rethrowError();
+  // Backpressure: wait for the sender thread if the queue is full.
+  mChanged.wait(lock, [this]() { return mQueue.size() < mMaxQueued || mError; });
+  rethrowError();
+  mQueue.push_back({std::move(parts), index});
+  mPending++;
+  lock.unlock();
+  mChanged.notify_all();
+}
+
+void SendQueue::flush()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  mChanged.wait(lock, [this]() { return mPending == 0; });
+  rethrowError();
+}
+
+} // namespace o2::framework
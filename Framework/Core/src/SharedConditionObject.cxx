@@ -0,0 +1,222 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include "Framework/SharedConditionObject.h"
+#include "Framework/Logger.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <thread>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace o2::framework
+{
+
+/// Lives in the first page of the region, the payload starts after it.
+struct SharedConditionRegion::Header {
+  enum State : int {
+    Claimed = 0,
+    Ready = 1,
+    Failed = 2
+  };
+  std::atomic<int> state;
+  std::atomic<int> users;
+  pid_t creator;
+  size_t size;
+};
+
+namespace
+{
+size_t pageSize()
+{
+  static size_t size = sysconf(_SC_PAGESIZE);
+  return size;
+}
+
+std::string& currentSession()
+{
+  static std::string session;
+  return session;
+}
+
+/// Keep it short, some platforms limit the names to 31 characters.
+std::string prefixFor(std::string_view session)
+{
+  auto key = fmt::format("{}/{}", getuid(), session);
+  return fmt::format("dplc{:08x}-", (uint32_t)std::hash<std::string>{}(key));
+}
+} // namespace
+
+SharedConditionRegion::SharedConditionRegion(std::string name, int fd, Header* header)
+  : mName{std::move(name)},
+    mFd{fd},
+    mHeader{header}
+{
+}
+
+SharedConditionRegion::~SharedConditionRegion()
+{
+  bool creatorGaveUp = mHeader->creator == getpid() && mHeader->state.load() == Header::Claimed;
+  if (creatorGaveUp) {
+    // Let the others fall back to their own copy and whoever comes next retry.
+    mHeader->state.store(Header::Failed);
+  }
+  if (mHeader->users.fetch_sub(1) == 1 || creatorGaveUp) {
+    shm_unlink(mName.c_str());
+  }
+  if (mPayload) {
+    munmap(mPayload, mSize);
+  }
+  munmap(mHeader, pageSize());
+  close(mFd);
+}
+
+void SharedConditionRegion::setSession(std::string_view session)
+{
+  currentSession() = session;
+}
+
+std::string SharedConditionRegion::nameFor(std::string_view etag, std::string_view type)
+{
+  std::string key;
+  key.reserve(etag.size() + type.size() + 1);
+  key.append(etag).append(1, '\0').append(type);
+  return fmt::format("/{}{:016x}", prefixFor(currentSession()), std::hash<std::string>{}(key));
+}
+
+void SharedConditionRegion::cleanup(std::string_view session)
+{
+  // Only Linux exposes the POSIX shared memory objects as files.
+  DIR* dir = opendir("/dev/shm");
+  if (dir == nullptr) {
+    return;
+  }
+  auto prefix = prefixFor(session);
+  while (auto* entry = readdir(dir)) {
+    if (std::string_view(entry->d_name).starts_with(prefix)) {
+      LOGP(detail, "Removing shared condition region {}", entry->d_name);
+      shm_unlink(fmt::format("/{}", entry->d_name).c_str());
+    }
+  }
+  closedir(dir);
+}
+
+std::unique_ptr<SharedConditionRegion> SharedConditionRegion::claim(std::string const& name)
+{
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    if (errno != EEXIST) {
+      LOGP(warn, "Unable to create shared condition region {}: {}", name, strerror(errno));
+    }
+    return nullptr;
+  }
+  void* mapped = MAP_FAILED;
+  if (ftruncate(fd, pageSize()) == 0) {
+    mapped = mmap(nullptr, pageSize(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  if (mapped == MAP_FAILED) {
+    LOGP(warn, "Unable to map shared condition region {}: {}", name, strerror(errno));
+    close(fd);
+    shm_unlink(name.c_str());
+    return nullptr;
+  }
+  // The page is zeroed by ftruncate, i.e. the region is already Claimed.
+  auto* header = reinterpret_cast<Header*>(mapped);
+  header->users.store(1);
+  header->creator = getpid();
+  return std::unique_ptr<SharedConditionRegion>(new SharedConditionRegion(name, fd, header));
+}
+
+char* SharedConditionRegion::allocate(size_t size)
+{
+  if (ftruncate(mFd, pageSize() + size) != 0) {
+    LOGP(warn, "Unable to resize shared condition region {} to {} bytes: {}", mName, size, strerror(errno));
+    return nullptr;
+  }
+  void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, pageSize());
+  if (mapped == MAP_FAILED) {
+    LOGP(warn, "Unable to map {} bytes of shared condition region {}: {}", size, mName, strerror(errno));
+    return nullptr;
+  }
+  mPayload = reinterpret_cast<char*>(mapped);
+  mSize = size;
+  mHeader->size = size;
+  return mPayload;
+}
+
+void SharedConditionRegion::publish()
+{
+  mHeader->state.store(Header::Ready, std::memory_order_release);
+}
+
+std::unique_ptr<SharedConditionRegion> SharedConditionRegion::attach(std::string const& name)
+{
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    return nullptr;
+  }
+  auto giveUp = [fd](void* mapped) -> std::unique_ptr<SharedConditionRegion> {
+    if (mapped) {
+      munmap(mapped, pageSize());
+    }
+    close(fd);
+    return nullptr;
+  };
+  Header* header = nullptr;
+  // Deserialising large objects can take a while, but not forever.
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+  while (true) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      LOGP(warn, "Timeout while waiting for shared condition region {}", name);
+      return giveUp(header);
+    }
+    struct stat st;
+    if (header == nullptr && fstat(fd, &st) == 0 && (size_t)st.st_size >= pageSize()) {
+      void* mapped = mmap(nullptr, pageSize(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (mapped == MAP_FAILED) {
+        return giveUp(nullptr);
+      }
+      header = reinterpret_cast<Header*>(mapped);
+    }
+    if (header) {
+      auto state = header->state.load(std::memory_order_acquire);
+      if (state == Header::Ready) {
+        break;
+      }
+      // The creator died while filling the region.
+      if (state == Header::Failed || (header->creator != 0 && kill(header->creator, 0) != 0 && errno == ESRCH)) {
+        return giveUp(header);
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  header->users.fetch_add(1);
+  std::unique_ptr<SharedConditionRegion> region(new SharedConditionRegion(name, fd, header));
+  // Private mapping, so that relocating the object only copies the pages
+  // which are actually modified.
+  void* mapped = mmap(nullptr, header->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, pageSize());
+  if (mapped == MAP_FAILED) {
+    LOGP(warn, "Unable to map shared condition region {}: {}", name, strerror(errno));
+    return nullptr;
+  }
+  region->mPayload = reinterpret_cast<char*>(mapped);
+  region->mSize = header->size;
+  return region;
+}
+
+} // namespace o2::framework
@@ -453,5 +453,31 @@ void StepTHn::Fill(int iStep, int nParams, double positionAndWeight[])
   }
 }
 
+void StepTHn::addContents(int iStep, const double* values, const double* sumw2, bool weighted)
+{
+  if (iStep >= mNSteps) {
+    LOGF(fatal, "Selected step for adding contents is not in range of StepTHn.");
+  }
+
+  // create the containers like Fill would have done
+  if (!mValues[iStep]) {
+    mValues[iStep] = createArray();
+    LOGF(info, "Created values container for step %d", iStep);
+  }
+  if (weighted && !mSumw2[iStep]) {
+    mSumw2[iStep] = createArray();
+    LOGF(info, "Created sumw2 container for step %d", iStep);
+  }
+
+  for (Long64_t bin = 0; bin < mNBins; bin++) {
+    if (values[bin] != 0) {
+      mValues[iStep]->SetAt(mValues[iStep]->GetAt(bin) + values[bin], bin);
+    }
+    if (mSumw2[iStep] && sumw2[bin] != 0) {
+      mSumw2[iStep]->SetAt(mSumw2[iStep]->GetAt(bin) + sumw2[bin], bin);
+    }
+  }
+}
+
 template class StepTHnT<TArrayF>;
 template class StepTHnT<TArrayD>;
@@ -10,7 +10,12 @@
 // or submit itself to any jurisdiction.
 
 #include "Framework/TableBuilder.h"
+#include "Framework/DefaultsHelpers.h"
+#include <algorithm>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #if defined(__GNUC__)
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wshadow"
@@ -44,6 +49,90 @@ void ArrayFromVector(const std::vector<C_TYPE>& values, std::shared_ptr<arrow::A
   assert(status.ok());
 }
 
+/// Append to @a key the data buffers of @a data and of its children, which
+/// identify the values of a column whatever arrow::Array wraps them.
+void appendBuffers(arrow::ArrayData const& data, std::string& key, std::vector<std::shared_ptr<arrow::Buffer>>& buffers)
+{
+  key.append(reinterpret_cast<char const*>(&data.offset), sizeof(data.offset));
+  key.append(reinterpret_cast<char const*>(&data.length), sizeof(data.length));
+  for (auto const& buffer : data.buffers) {
+    if (buffer == nullptr) {
+      continue;
+    }
+    auto address = buffer->address();
+    key.append(reinterpret_cast<char const*>(&address), sizeof(address));
+    buffers.push_back(buffer);
+  }
+  for (auto const& child : data.child_data) {
+    appendBuffers(*child, key, buffers);
+  }
+}
+
+/// Columns spawned from a record batch. An entry is only valid as long as
+/// all the buffers it was computed from are alive, as their memory cannot be
+/// reused by some other data until then.
+struct SpawnedBatch {
+  std::weak_ptr<gandiva::Projector> projector;
+  std::vector<std::weak_ptr<arrow::Buffer>> buffers;
+  arrow::ArrayVector columns;
+
+  [[nodiscard]] bool valid() const
+  {
+    return !projector.expired() && std::none_of(buffers.begin(), buffers.end(), [](auto const& buffer) { return buffer.expired(); });
+  }
+};
+
+/// Record batches spawned by this process, so that the same expression
+/// columns are not computed twice for the same data, e.g. by several tasks
+/// or by Extend() called at each invocation of process().
+struct SpawnedBatchCache {
+  std::mutex mutex;
+  std::unordered_map<std::string, SpawnedBatch> batches;
+
+  bool find(std::string const& key, arrow::ArrayVector& columns)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto cached = batches.find(key);
+    if (cached == batches.end()) {
+      return false;
+    }
+    if (!cached->second.valid()) {
+      batches.erase(cached);
+      return false;
+    }
+    columns = cached->second.columns;
+    return true;
+  }
+
+  void insert(std::string key, SpawnedBatch&& batch, size_t maxSize)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (batches.size() >= maxSize) {
+      pruneLocked();
+    }
+    if (batches.size() < maxSize) {
+      batches.insert_or_assign(std::move(key), std::move(batch));
+    }
+  }
+
+  size_t prune()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pruneLocked();
+    return batches.size();
+  }
+
+  void pruneLocked()
+  {
+    std::erase_if(batches, [](auto const& entry) { return !entry.second.valid(); });
+  }
+};
+
+SpawnedBatchCache& spawnedBatchCache()
+{
+  static SpawnedBatchCache cache;
+  return cache;
+}
 } // namespace
 
 namespace o2::framework
@@ -79,15 +168,32 @@ void TableBuilder::validate() const
   }
 }
 
+void TableBuilder::setColumnCodecs(std::vector<soa::ColumnCodec> const& codecs)
+{
+  for (auto i = 0u; i < codecs.size(); ++i) {
+    if (codecs[i] == soa::ColumnCodec::None) {
+      continue;
+    }
+    auto field = mSchema->field(i)->WithMetadata(arrow::key_value_metadata({soa::columnCodecKey}, {soa::columnCodecName(codecs[i])}));
+    mSchema = *mSchema->SetField(i, field);
+  }
+}
+
 void TableBuilder::setLabel(const char* label)
 {
   mSchema = mSchema->WithMetadata(std::make_shared<arrow::KeyValueMetadata>(std::vector{std::string{"label"}}, std::vector{std::string{label}}));
 }
 
+size_t pruneSpawnedBatches()
+{
+  return spawnedBatchCache().prune();
+}
+
 std::shared_ptr<arrow::Table> spawnerHelper(std::shared_ptr<arrow::Table> const& fullTable, std::shared_ptr<arrow::Schema> newSchema, size_t nColumns,
                                             expressions::Projector* projectors, std::vector<std::shared_ptr<arrow::Field>> const& fields, const char* name)
 {
   auto mergedProjectors = framework::expressions::createProjectorHelper(nColumns, projectors, fullTable->schema(), fields);
+  static auto cacheSize = DefaultsHelpers::spawnCacheSize();
 
   arrow::TableBatchReader reader(*fullTable);
   std::shared_ptr<arrow::RecordBatch> batch;
@@ -104,13 +210,29 @@ std::shared_ptr<arrow::Table> spawnerHelper(std::shared_ptr<arrow::Table> const&
     if (batch == nullptr) {
       break;
     }
-    try {
-      s = mergedProjectors->Evaluate(*batch, arrow::default_memory_pool(), &v);
-      if (!s.ok()) {
-        throw runtime_error_f("Cannot apply projector to source table of %s: %s", name, s.ToString().c_str());
+    // The projector is shared by all the spawners of the same columns for
+    // the same source schema, so it identifies the computation.
+    std::string key;
+    std::vector<std::shared_ptr<arrow::Buffer>> buffers;
+    if (cacheSize != 0) {
+      auto projector = mergedProjectors.get();
+      key.append(reinterpret_cast<char const*>(&projector), sizeof(projector));
+      for (auto const& column : batch->column_data()) {
+        appendBuffers(*column, key, buffers);
+      }
+    }
+    if (cacheSize == 0 || !spawnedBatchCache().find(key, v)) {
+      try {
+        s = mergedProjectors->Evaluate(*batch, arrow::default_memory_pool(), &v);
+        if (!s.ok()) {
+          throw runtime_error_f("Cannot apply projector to source table of %s: %s", name, s.ToString().c_str());
+        }
+      } catch (std::exception& e) {
+        throw runtime_error_f("Cannot apply projector to source table of %s: exception caught: %s", name, e.what());
+      }
+      if (cacheSize != 0) {
+        spawnedBatchCache().insert(std::move(key), {mergedProjectors, {buffers.begin(), buffers.end()}, v}, cacheSize);
       }
-    } catch (std::exception& e) {
-      throw runtime_error_f("Cannot apply projector to source table of %s: exception caught: %s", name, e.what());
     }
 
     for (auto i = 0U; i < nColumns; ++i) {
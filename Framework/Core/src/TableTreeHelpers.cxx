@@ -9,6 +9,8 @@
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
 #include "Framework/TableTreeHelpers.h"
+#include "Framework/ArrowTableSlicingCache.h"
+#include "Framework/Expressions.h"
 #include "Framework/Logger.h"
 #include "Framework/Endian.h"
 
@@ -18,12 +20,24 @@
 #include <arrow/type.h>
 #include <arrow/util/key_value_metadata.h>
 #include <TBufferFile.h>
-
+#include <TList.h>
+#include <TNamed.h>
+#include <TObjString.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
 #include <memory>
+#include <string_view>
 #include <utility>
 namespace TableTreeHelpers
 {
 static constexpr char const* sizeBranchSuffix = "_size";
+static constexpr char const* sliceIndexPrefix = "sliceIndex_";
+static constexpr char const* columnRangePrefix = "columnRange_";
+static constexpr char const* columnCodecPrefix = "columnCodec_";
+static constexpr char const* deltaBranchSuffix = "_delta";
 } // namespace TableTreeHelpers
 
 namespace o2::framework
@@ -99,6 +113,73 @@ auto basicROOTTypeFromArrow(arrow::Type::type id)
   }
 }
 
+namespace
+{
+template <typename T>
+void prefixSum(uint8_t* values, int64_t length)
+{
+  auto* data = reinterpret_cast<T*>(values);
+  T sum = 0;
+  for (int64_t i = 0; i < length; ++i) {
+    sum = static_cast<T>(sum + data[i]);
+    data[i] = sum;
+  }
+}
+} // namespace
+
+soa::ColumnCodec decodeColumn(TTree* tree, char const* name, uint8_t* values, int64_t length, int size)
+{
+  auto* entry = tree->GetUserInfo()->FindObject((std::string{TableTreeHelpers::columnCodecPrefix} + name).c_str());
+  if (entry == nullptr) {
+    return soa::ColumnCodec::None;
+  }
+  // Only the integral columns are encoded, the sign does not matter
+  // for the wrapping sums.
+  std::string_view codec = entry->GetTitle();
+  if (!codec.starts_with(soa::columnCodecName(soa::ColumnCodec::Delta))) {
+    throw runtime_error_f("Unknown codec \"%s\" for branch %s", entry->GetTitle(), name);
+  }
+  switch (size) {
+    case 1:
+      prefixSum<uint8_t>(values, length);
+      break;
+    case 2:
+      prefixSum<uint16_t>(values, length);
+      break;
+    case 4:
+      prefixSum<uint32_t>(values, length);
+      break;
+    case 8:
+      prefixSum<uint64_t>(values, length);
+      break;
+    default:
+      throw runtime_error_f("Cannot decode branch %s with values of %d bytes", name, size);
+  }
+  return soa::ColumnCodec::Delta;
+}
+
+TBranch* columnBranch(TTree* tree, std::string const& name)
+{
+  auto* branch = tree->GetBranch(name.c_str());
+  if (branch == nullptr) {
+    auto encodedName = name + TableTreeHelpers::deltaBranchSuffix;
+    if (tree->GetUserInfo()->FindObject((TableTreeHelpers::columnCodecPrefix + encodedName).c_str()) != nullptr) {
+      branch = tree->GetBranch(encodedName.c_str());
+    }
+  }
+  return branch;
+}
+
+std::string columnName(TBranch* branch)
+{
+  std::string name = branch->GetName();
+  if (name.ends_with(TableTreeHelpers::deltaBranchSuffix) &&
+      branch->GetTree()->GetUserInfo()->FindObject((TableTreeHelpers::columnCodecPrefix + name).c_str()) != nullptr) {
+    name.erase(name.size() - strlen(TableTreeHelpers::deltaBranchSuffix));
+  }
+  return name;
+}
+
 TBranch* BranchToColumn::branch()
 {
   return mBranch;
@@ -139,6 +220,7 @@ std::pair<std::shared_ptr<arrow::ChunkedArray>, std::shared_ptr<arrow::Field>> B
   int readEntries = 0;
   buffer->Reset();
   std::shared_ptr<arrow::Array> array;
+  auto codec = soa::ColumnCodec::None;
 
   if (mType == EDataType::kBool_t) {
     // boolean array special case: we need to use builder to create the bitmap
@@ -230,6 +312,9 @@ std::pair<std::shared_ptr<arrow::ChunkedArray>, std::shared_ptr<arrow::Field>> B
     if (!mVLA) {
       totalSize = readEntries * mListSize;
     }
+    if (mListSize == 1) {
+      codec = decodeColumn(mBranch->GetTree(), mBranch->GetName(), arrowValuesBuffer->mutable_data(), readEntries, typeSize);
+    }
     std::shared_ptr<arrow::PrimitiveArray> varray;
     switch (mListSize) {
       case -1:
@@ -246,7 +331,11 @@ std::pair<std::shared_ptr<arrow::ChunkedArray>, std::shared_ptr<arrow::Field>> B
   }
 
   auto fullArray = std::make_shared<arrow::ChunkedArray>(array);
-  auto field = std::make_shared<arrow::Field>(mBranch->GetName(), mArrowType);
+  auto field = std::make_shared<arrow::Field>(mColumnName, mArrowType);
+  if (codec != soa::ColumnCodec::None) {
+    // Keep the annotation, for the column to be encoded again when written
+    field = field->WithMetadata(arrow::key_value_metadata({soa::columnCodecKey}, {soa::columnCodecName(codec)}));
+  }
 
   mBranch->SetStatus(false);
   mBranch->DropBaskets("all");
@@ -329,11 +418,48 @@ void ColumnToBranch::at(const int64_t* pos)
     case arrow::Type::FIXED_SIZE_LIST:
     default: {
       buffer = std::static_pointer_cast<arrow::PrimitiveArray>(mCurrentArray)->values()->data() + mCurrentArray->offset() + (*pos - mFirstIndex) * mListSize * mElementType.size;
+      if (mDelta) {
+        buffer = encodeDelta(buffer);
+      }
       mBranch->SetAddress((void*)buffer);
     };
   }
 }
 
+namespace
+{
+template <typename T>
+uint8_t const* deltaOf(uint8_t const* value, uint64_t& previous, uint64_t& delta)
+{
+  T current;
+  std::memcpy(&current, value, sizeof(T));
+  auto difference = static_cast<T>(current - static_cast<T>(previous));
+  previous = current;
+  std::memcpy(&delta, &difference, sizeof(T));
+  return reinterpret_cast<uint8_t const*>(&delta);
+}
+} // namespace
+
+void ColumnToBranch::enableDelta(uint64_t previous)
+{
+  mDelta = true;
+  mPrevious = previous;
+}
+
+uint8_t const* ColumnToBranch::encodeDelta(uint8_t const* value)
+{
+  switch (mElementType.size) {
+    case 1:
+      return deltaOf<uint8_t>(value, mPrevious, mDeltaValue);
+    case 2:
+      return deltaOf<uint16_t>(value, mPrevious, mDeltaValue);
+    case 4:
+      return deltaOf<uint32_t>(value, mPrevious, mDeltaValue);
+    default:
+      return deltaOf<uint64_t>(value, mPrevious, mDeltaValue);
+  }
+}
+
 void ColumnToBranch::accessChunk()
 {
   auto array = mColumn->chunk(mCurrentChunk);
@@ -390,6 +516,22 @@ void TableToTree::addAllBranches()
   }
 }
 
+namespace
+{
+soa::ColumnCodec fieldCodec(arrow::Field const& field)
+{
+  auto const& metadata = field.metadata();
+  if (metadata == nullptr) {
+    return soa::ColumnCodec::None;
+  }
+  auto index = metadata->FindKey(soa::columnCodecKey);
+  if (index != -1 && metadata->value(index) == soa::columnCodecName(soa::ColumnCodec::Delta)) {
+    return soa::ColumnCodec::Delta;
+  }
+  return soa::ColumnCodec::None;
+}
+} // namespace
+
 void TableToTree::addBranch(std::shared_ptr<arrow::ChunkedArray> const& column, std::shared_ptr<arrow::Field> const& field)
 {
   if (mRows == 0) {
@@ -397,12 +539,231 @@ void TableToTree::addBranch(std::shared_ptr<arrow::ChunkedArray> const& column,
   } else if (mRows != column->length()) {
     throw runtime_error_f("Adding incompatible column with size %d (num rows = %d)", column->length(), mRows);
   }
-  mColumnReaders.emplace_back(new ColumnToBranch{mTree.get(), column, field});
+  // The encoded columns are stored under another branch name, so that
+  // readers unaware of the codec fail instead of reading the differences
+  auto encodedName = field->name() + TableTreeHelpers::deltaBranchSuffix;
+  auto* codec = mTree->GetUserInfo()->FindObject((TableTreeHelpers::columnCodecPrefix + encodedName).c_str());
+  unsigned long long previous = 0;
+  if (codec != nullptr) {
+    // Rows appended to an encoded branch carry on from its last value
+    if (sscanf(codec->GetTitle(), "delta %llu", &previous) != 1) {
+      throw runtime_error_f("Unknown codec \"%s\" for branch %s", codec->GetTitle(), encodedName.c_str());
+    }
+  }
+  bool delta = codec != nullptr || (mColumnCodecs && mTree->GetEntries() == 0 && arrow::is_integer(field->type()->id()) && fieldCodec(*field) == soa::ColumnCodec::Delta);
+  auto& reader = mColumnReaders.emplace_back(new ColumnToBranch{mTree.get(), column, delta ? field->WithName(encodedName) : field});
+  if (delta) {
+    reader->enableDelta(previous);
+  }
+  if (mSliceIndices && field->type()->id() == arrow::Type::INT32 && field->name().starts_with("fIndex")) {
+    mIndexColumns.emplace_back(field->name(), column);
+  }
+  if (mColumnRanges) {
+    mRangeColumns.emplace_back(field->name(), column);
+  }
+}
+
+void TableToTree::enableSliceIndices()
+{
+  mSliceIndices = true;
+}
+
+void TableToTree::enableColumnRanges()
+{
+  mColumnRanges = true;
+}
+
+void TableToTree::enableColumnCodecs()
+{
+  mColumnCodecs = true;
+}
+
+namespace
+{
+/// Append the groups of consecutive equal values of @a column to @a values
+/// and @a counts.
+/// @return false if the result does not describe a table sorted like the
+/// slicing cache expects, i.e. if a value appears in more than one group.
+bool appendGroups(arrow::ChunkedArray const& column, std::vector<int32_t>& values, std::vector<int64_t>& counts)
+{
+  for (auto const& chunk : column.chunks()) {
+    auto array = static_cast<arrow::NumericArray<arrow::Int32Type>>(chunk->data());
+    for (int64_t i = 0; i < array.length(); ++i) {
+      auto value = array.Value(i);
+      if (!values.empty() && values.back() == value) {
+        ++counts.back();
+      } else {
+        values.push_back(value);
+        counts.push_back(1);
+      }
+    }
+  }
+  // Positive values must be increasing and negative ones decreasing.
+  int32_t lastPos = -1;
+  int32_t lastNeg = 0;
+  for (auto value : values) {
+    if (value >= 0) {
+      if (value <= lastPos) {
+        return false;
+      }
+      lastPos = value;
+    } else {
+      if (value >= lastNeg) {
+        return false;
+      }
+      lastNeg = value;
+    }
+  }
+  return true;
+}
+
+template <typename T>
+std::vector<T> fromBytes(TString const& bytes)
+{
+  std::vector<T> result(bytes.Length() / sizeof(T));
+  std::memcpy(result.data(), bytes.Data(), result.size() * sizeof(T));
+  return result;
+}
+
+template <typename T>
+TObjString* toBytes(std::vector<T> const& data)
+{
+  auto* result = new TObjString();
+  result->String() = TString(reinterpret_cast<char const*>(data.data()), data.size() * sizeof(T));
+  return result;
+}
+} // namespace
+
+namespace
+{
+template <typename T>
+bool updateRange(arrow::ChunkedArray const& column, double& min, double& max)
+{
+  for (auto const& chunk : column.chunks()) {
+    auto array = static_cast<arrow::NumericArray<T>>(chunk->data());
+    auto const* values = array.raw_values();
+    for (int64_t i = 0; i < array.length(); ++i) {
+      if constexpr (std::is_floating_point_v<typename T::c_type>) {
+        // Comparisons with NaN are always false, a range would not tell
+        // anything about them.
+        if (std::isnan(values[i])) {
+          return false;
+        }
+      }
+      min = std::min(min, (double)values[i]);
+      max = std::max(max, (double)values[i]);
+    }
+  }
+  return true;
+}
+
+/// @return the range of values of @a column, if it has a numeric type whose
+/// values can be represented exactly as doubles
+bool columnRange(arrow::ChunkedArray const& column, double& min, double& max)
+{
+  switch (column.type()->id()) {
+    case arrow::Type::UINT8:
+      return updateRange<arrow::UInt8Type>(column, min, max);
+    case arrow::Type::INT8:
+      return updateRange<arrow::Int8Type>(column, min, max);
+    case arrow::Type::UINT16:
+      return updateRange<arrow::UInt16Type>(column, min, max);
+    case arrow::Type::INT16:
+      return updateRange<arrow::Int16Type>(column, min, max);
+    case arrow::Type::UINT32:
+      return updateRange<arrow::UInt32Type>(column, min, max);
+    case arrow::Type::INT32:
+      return updateRange<arrow::Int32Type>(column, min, max);
+    case arrow::Type::FLOAT:
+      return updateRange<arrow::FloatType>(column, min, max);
+    case arrow::Type::DOUBLE:
+      return updateRange<arrow::DoubleType>(column, min, max);
+    default:
+      return false;
+  }
+}
+} // namespace
+
+void TableToTree::storeColumnRanges(int64_t previousEntries)
+{
+  // Each entry holds the minimum, the maximum and the number of rows, as text
+  auto* userInfo = mTree->GetUserInfo();
+  for (auto const& [name, column] : mRangeColumns) {
+    auto entryName = TableTreeHelpers::columnRangePrefix + name;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    auto* previous = userInfo->FindObject(entryName.c_str());
+    if (previous != nullptr) {
+      bool valid = sscanf(previous->GetTitle(), "%lf %lf", &min, &max) == 2;
+      userInfo->Remove(previous);
+      delete previous;
+      if (!valid) {
+        continue;
+      }
+    } else if (previousEntries != 0) {
+      // The rows already in the tree are not covered
+      continue;
+    }
+    if (!columnRange(*column, min, max)) {
+      continue;
+    }
+    userInfo->Add(new TNamed(entryName.c_str(), fmt::format("{} {} {}", min, max, previousEntries + column->length()).c_str()));
+  }
+}
+
+void TableToTree::storeSliceIndices(int64_t previousEntries)
+{
+  // Each entry holds the raw values and counts of the groups, the same
+  // way they are passed along with the table in its schema metadata.
+  auto* userInfo = mTree->GetUserInfo();
+  for (auto const& [name, column] : mIndexColumns) {
+    auto entryName = TableTreeHelpers::sliceIndexPrefix + name;
+    std::vector<int32_t> values;
+    std::vector<int64_t> counts;
+    auto* previous = static_cast<TList*>(userInfo->FindObject(entryName.c_str()));
+    if (previous != nullptr) {
+      values = fromBytes<int32_t>(static_cast<TObjString*>(previous->At(0))->String());
+      counts = fromBytes<int64_t>(static_cast<TObjString*>(previous->At(1))->String());
+      userInfo->Remove(previous);
+      delete previous;
+    } else if (previousEntries != 0) {
+      // The rows already in the tree are not indexed
+      continue;
+    }
+    if (!appendGroups(*column, values, counts)) {
+      continue;
+    }
+    auto* entry = new TList();
+    entry->SetName(entryName.c_str());
+    entry->SetOwner(true);
+    entry->Add(toBytes(values));
+    entry->Add(toBytes(counts));
+    userInfo->Add(entry);
+  }
+}
+
+void TableToTree::storeColumnCodecs()
+{
+  // Each entry holds the codec and the last value written, as text
+  auto* userInfo = mTree->GetUserInfo();
+  for (auto const& reader : mColumnReaders) {
+    if (!reader->delta()) {
+      continue;
+    }
+    auto entryName = TableTreeHelpers::columnCodecPrefix + std::string{reader->branchName()};
+    auto* previous = userInfo->FindObject(entryName.c_str());
+    if (previous != nullptr) {
+      userInfo->Remove(previous);
+      delete previous;
+    }
+    userInfo->Add(new TNamed(entryName.c_str(), fmt::format("{} {}", soa::columnCodecName(soa::ColumnCodec::Delta), reader->lastValue()).c_str()));
+  }
 }
 
 std::shared_ptr<TTree> TableToTree::process()
 {
   int64_t row = 0;
+  auto previousEntries = mTree->GetEntries();
   if (mTree->GetNbranches() == 0 || mRows == 0) {
     mTree->Write("", TObject::kOverwrite);
     mTree->SetDirectory(nullptr);
@@ -436,6 +797,9 @@ std::shared_ptr<TTree> TableToTree::process()
     mTree->Fill();
     ++row;
   }
+  storeSliceIndices(previousEntries);
+  storeColumnRanges(previousEntries);
+  storeColumnCodecs();
   mTree->Write("", TObject::kOverwrite);
   mTree->SetDirectory(nullptr);
   return mTree;
@@ -472,6 +836,7 @@ void TreeToTable::addAllColumns(TTree* tree, std::vector<std::string>&& names)
       name.erase(pos);
       branchInfos.emplace_back(BranchInfo{name, (TBranch*)nullptr, true});
     } else {
+      name = columnName(branch);
       auto lookup = std::find_if(branchInfos.begin(), branchInfos.end(), [&](BranchInfo const& bi) {
         return bi.name == name;
       });
@@ -526,7 +891,7 @@ void TreeToTable::setLabel(const char* label)
   mTableLabel = label;
 }
 
-void TreeToTable::fill(TTree*)
+void TreeToTable::fill(TTree* tree)
 {
   std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
   std::vector<std::shared_ptr<arrow::Field>> fields;
@@ -538,7 +903,47 @@ void TreeToTable::fill(TTree*)
     fields.push_back(arrayAndField.second);
   }
 
-  auto schema = std::make_shared<arrow::Schema>(fields, std::make_shared<arrow::KeyValueMetadata>(std::vector{std::string{"label"}}, std::vector{mTableLabel}));
+  // Attach the range of values of the columns stored by the writer, if any
+  auto* userInfo = tree->GetUserInfo();
+  for (auto& field : fields) {
+    auto* entry = userInfo->FindObject((TableTreeHelpers::columnRangePrefix + field->name()).c_str());
+    if (entry == nullptr) {
+      continue;
+    }
+    std::string_view range = entry->GetTitle();
+    auto first = range.find(' ');
+    auto second = range.find(' ', first + 1);
+    if (first == std::string_view::npos || second == std::string_view::npos) {
+      continue;
+    }
+    field = field->WithMergedMetadata(std::make_shared<arrow::KeyValueMetadata>(
+      std::vector<std::string>{expressions::columnRangeMinKey, expressions::columnRangeMaxKey, expressions::columnRangeRowsKey},
+      std::vector<std::string>{std::string{range.substr(0, first)}, std::string{range.substr(first + 1, second - first - 1)}, std::string{range.substr(second + 1)}}));
+  }
+
+  std::vector<std::string> keys{"label"};
+  std::vector<std::string> values{mTableLabel};
+  // Pass along the groups of the index columns stored by the writer, if any
+  std::string_view prefix = TableTreeHelpers::sliceIndexPrefix;
+  for (auto* object : *userInfo) {
+    std::string_view entryName = object->GetName();
+    auto* entry = dynamic_cast<TList*>(object);
+    if (entry == nullptr || !entryName.starts_with(prefix) || entry->GetEntries() != 2) {
+      continue;
+    }
+    std::string column{entryName.substr(prefix.size())};
+    if (std::none_of(fields.begin(), fields.end(), [&column](auto const& field) { return field->name() == column; })) {
+      continue;
+    }
+    auto const& groupValues = static_cast<TObjString*>(entry->At(0))->String();
+    auto const& groupCounts = static_cast<TObjString*>(entry->At(1))->String();
+    keys.push_back(ArrowTableSlicingCache::precomputedValuesKey(column));
+    values.emplace_back(groupValues.Data(), groupValues.Length());
+    keys.push_back(ArrowTableSlicingCache::precomputedCountsKey(column));
+    values.emplace_back(groupCounts.Data(), groupCounts.Length());
+  }
+
+  auto schema = std::make_shared<arrow::Schema>(fields, std::make_shared<arrow::KeyValueMetadata>(keys, values));
   mTable = arrow::Table::Make(schema, columns);
 }
 
@@ -27,7 +27,17 @@ void TimesliceIndex::resize(size_t s)
 {
   mVariables.resize(s);
   mPublishedVariables.resize(s);
-  mDirty.resize(s, false);
+  // std::atomic is not movable, so we need to rebuild the flags
+  std::vector<std::atomic<bool>> dirty(s);
+  for (size_t i = 0; i < std::min(s, mDirty.size()); ++i) {
+    dirty[i] = mDirty[i].load();
+  }
+  mDirty.swap(dirty);
+}
+
+void TimesliceIndex::setShards(size_t shards)
+{
+  mShards = std::max<size_t>(shards, 1);
 }
 
 void TimesliceIndex::associate(TimesliceId timestamp, TimesliceSlot slot)
@@ -42,7 +52,8 @@ void TimesliceIndex::associate(TimesliceId timestamp, TimesliceSlot slot)
 
 TimesliceSlot TimesliceIndex::findOldestSlot(TimesliceId timestamp) const
 {
-  size_t lane = timestamp.value % mMaxLanes;
+  size_t stride = mMaxLanes * mShards;
+  size_t lane = timestamp.value % stride;
   TimesliceSlot oldest{lane};
   auto oldPVal = std::get_if<uint64_t>(&mVariables[oldest.index].get(0));
   if (oldPVal == nullptr) {
@@ -50,7 +61,7 @@ TimesliceSlot TimesliceIndex::findOldestSlot(TimesliceId timestamp) const
   }
   uint64_t oldTimestamp = *oldPVal;
 
-  for (size_t i = lane + mMaxLanes; i < mVariables.size(); i += mMaxLanes) {
+  for (size_t i = lane + stride; i < mVariables.size(); i += stride) {
     auto newPVal = std::get_if<uint64_t>(&mVariables[i].get(0));
     if (newPVal == nullptr) {
       return TimesliceSlot{i};
@@ -0,0 +1,118 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include "Framework/WorkerPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace o2::framework
+{
+
+struct WorkerPool::Batch {
+  std::function<void(size_t)> const& job;
+  size_t nJobs;
+  std::atomic<size_t> next = 0;
+  std::atomic<bool> failed = false;
+  std::exception_ptr error;
+  std::mutex errorMutex;
+
+  void work()
+  {
+    try {
+      for (size_t i = next++; i < nJobs && !failed.load(std::memory_order_relaxed); i = next++) {
+        job(i);
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+      failed = true;
+    }
+  }
+};
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStopping = true;
+  }
+  mChanged.notify_all();
+  for (auto& worker : mWorkers) {
+    worker.join();
+  }
+}
+
+size_t WorkerPool::workers() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mWorkers.size();
+}
+
+void WorkerPool::work()
+{
+  uint64_t seen = 0;
+  std::unique_lock<std::mutex> lock(mMutex);
+  while (true) {
+    mChanged.wait(lock, [this, &seen]() { return mStopping || (mGeneration != seen && mWanted > 0); });
+    if (mStopping) {
+      return;
+    }
+    seen = mGeneration;
+    mWanted--;
+    mBusy++;
+    auto* batch = mBatch;
+    lock.unlock();
+    batch->work();
+    lock.lock();
+    mBusy--;
+    mChanged.notify_all();
+  }
+}
+
+void WorkerPool::run(size_t nJobs, size_t threads, std::function<void(size_t)> const& job)
+{
+  threads = std::min(threads, nJobs);
+  std::unique_lock<std::mutex> runLock(mRunMutex, std::defer_lock);
+  if (threads <= 1 || runLock.try_lock() == false) {
+    for (size_t i = 0; i < nJobs; ++i) {
+      job(i);
+    }
+    return;
+  }
+
+  Batch batch{job, nJobs};
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    while (mWorkers.size() < threads - 1) {
+      mWorkers.emplace_back(&WorkerPool::work, this);
+    }
+    mBatch = &batch;
+    mGeneration++;
+    mWanted = threads - 1;
+  }
+  mChanged.notify_all();
+  batch.work();
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+    // Workers which did not join yet would not find anything left to do.
+    mWanted = 0;
+    mChanged.wait(lock, [this]() { return mBusy == 0; });
+    mBatch = nullptr;
+  }
+  if (batch.error) {
+    std::rethrow_exception(batch.error);
+  }
+}
+
+} // namespace o2::framework
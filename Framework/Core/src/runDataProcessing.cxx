@@ -43,6 +43,7 @@
 #include "Framework/RawDeviceService.h"
 #include "Framework/SimpleRawDeviceService.h"
 #include "Framework/Signpost.h"
+#include "Framework/SharedConditionObject.h"
 #include "Framework/ControlService.h"
 #include "Framework/CallbackService.h"
 #include "Framework/WorkflowSpec.h"
@@ -384,6 +385,9 @@ void cleanupSHM(std::string const& uniqueWorkflowId)
 {
   using namespace fair::mq::shmem;
   fair::mq::shmem::Monitor::Cleanup(SessionId{"dpl_" + uniqueWorkflowId}, false);
+  // Shared condition objects are removed by their last user, but not if
+  // a device died while using them.
+  SharedConditionRegion::cleanup("dpl_" + uniqueWorkflowId);
 }
 
 static void handle_sigchld(int) { sigchld_requested = true; }
@@ -2265,6 +2269,9 @@ int runStateMachine(DataProcessorSpecs const& workflow,
           }
           LOG(info) << "Dumping performance metrics to performanceMetrics.json file";
           dumpMetricsCallback(&metricDumpTimer);
+          if (ResourcesMonitoringHelper::dumpLatenciesToJSON(metricsInfos, runningWorkflow.devices)) {
+            LOG(info) << "Dumped latency histograms to latencyHistograms.json file";
+          }
         }
         dumpRunSummary(serverContext, driverInfo, infos, runningWorkflow.devices);
         // This is a clean exit. Before we do so, if required,
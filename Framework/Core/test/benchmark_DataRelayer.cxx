@@ -15,10 +15,19 @@
 #include "Framework/CompletionPolicyHelpers.h"
 #include "Framework/DataRelayer.h"
 #include "Framework/DataProcessingHeader.h"
+#include "Framework/DataProcessingStats.h"
+#include "Framework/DataProcessingStates.h"
+#include "Framework/DeviceState.h"
+#include "Framework/DriverConfig.h"
+#include "Framework/TimingHelpers.h"
+#include "MemoryResources/MemoryResources.h"
 #include <Monitoring/Monitoring.h>
 #include <fairmq/TransportFactory.h>
+#include <array>
 #include <cstring>
+#include <memory>
 #include <vector>
+#include <uv.h>
 
 using Monitoring = o2::monitoring::Monitoring;
 using namespace o2::framework;
@@ -354,4 +363,86 @@ static void BM_RelayMultiplePayloads(benchmark::State& state)
 
 BENCHMARK(BM_RelayMultiplePayloads)->Arg(10)->Arg(100)->Arg(1000);
 
+/// Everything which is needed to have a DataRelayer shared between
+/// the benchmark threads.
+struct SharedRelayer {
+  SharedRelayer(size_t nInputs, size_t nShards)
+    : states(TimingHelpers::defaultRealtimeBaseConfigurator(0, uv_default_loop()),
+             TimingHelpers::defaultCPUTimeConfigurator(uv_default_loop())),
+      stats(TimingHelpers::defaultRealtimeBaseConfigurator(0, uv_default_loop()),
+            TimingHelpers::defaultCPUTimeConfigurator(uv_default_loop()), {}),
+      infos(1),
+      index{1, infos}
+  {
+    ServiceRegistryRef ref{registry};
+    ref.registerService(ServiceRegistryHelpers::handleForService<Monitoring>(&monitoring));
+    ref.registerService(ServiceRegistryHelpers::handleForService<DataProcessingStats>(&stats));
+    ref.registerService(ServiceRegistryHelpers::handleForService<DataProcessingStates>(&states));
+    ref.registerService(ServiceRegistryHelpers::handleForService<DriverConfig const>(&driverConfig));
+    ref.registerService(ServiceRegistryHelpers::handleForService<DeviceState>(&deviceState));
+    ref.registerService(ServiceRegistryHelpers::handleForService<TimesliceIndex>(&index));
+    for (size_t i = 0; i < nInputs; ++i) {
+      InputSpec spec{"in" + std::to_string(i), "TST", "DATA", static_cast<o2::header::DataHeader::SubSpecificationType>(i)};
+      inputs.emplace_back(InputRoute{spec, i, "Fake", 0});
+    }
+    relayer = std::make_unique<DataRelayer>(CompletionPolicyHelpers::consumeWhenAll(), inputs, index, ServiceRegistryRef{registry});
+    relayer->setPipelineLength(64);
+    relayer->setShards(nShards);
+  }
+
+  ServiceRegistry registry;
+  Monitoring monitoring;
+  DriverConfig driverConfig{.batch = false};
+  DeviceState deviceState;
+  DataProcessingStates states;
+  DataProcessingStats stats;
+  std::vector<InputChannelInfo> infos;
+  TimesliceIndex index;
+  std::vector<InputRoute> inputs;
+  std::unique_ptr<DataRelayer> relayer;
+};
+
+static std::unique_ptr<SharedRelayer> gSharedRelayer;
+
+/// Several threads, each one pretending to be a different input channel,
+/// relay all the inputs of their own timeslices in the same DataRelayer.
+/// First argument is the number of inputs, second the number of shards, where
+/// 1 means the unsharded, fully locked, relayer.
+static void BM_RelayConcurrentInputs(benchmark::State& state)
+{
+  const size_t nInputs = state.range(0);
+  const size_t nShards = state.range(1);
+  if (state.thread_index() == 0) {
+    gSharedRelayer = std::make_unique<SharedRelayer>(nInputs, nShards);
+  }
+  auto transport = fair::mq::TransportFactory::CreateTransportFactory("zeromq");
+  auto channelAlloc = o2::pmr::getTransportAllocator(transport.get());
+  size_t timeslice = state.thread_index();
+
+  for (auto _ : state) {
+    auto& relayer = *gSharedRelayer->relayer;
+    for (size_t i = 0; i < nInputs; ++i) {
+      std::array<fair::mq::MessagePtr, 2> messages;
+      DataHeader dh{"DATA", "TST", static_cast<DataHeader::SubSpecificationType>(i)};
+      messages[0] = o2::pmr::getMessage(Stack{channelAlloc, dh, DataProcessingHeader{timeslice, 1}});
+      messages[1] = transport->CreateMessage(100);
+      DataRelayer::InputInfo fakeInfo{0, messages.size(), DataRelayer::InputType::Data, {ChannelIndex::INVALID}};
+      relayer.relay(messages[0]->GetData(), messages.data(), fakeInfo, messages.size());
+    }
+    // Whoever finds a complete timeslice consumes it, so that slots are freed.
+    std::vector<RecordAction> ready;
+    relayer.getReadyToProcess(ready);
+    for (auto& action : ready) {
+      benchmark::DoNotOptimize(relayer.consumeAllInputsForTimeslice(action.slot));
+    }
+    timeslice += state.threads();
+  }
+  state.SetItemsProcessed(state.iterations() * nInputs);
+  if (state.thread_index() == 0) {
+    gSharedRelayer.reset();
+  }
+}
+
+BENCHMARK(BM_RelayConcurrentInputs)->ArgsProduct({{4, 16, 64}, {1, 4}})->Threads(4)->UseRealTime();
+
 BENCHMARK_MAIN();
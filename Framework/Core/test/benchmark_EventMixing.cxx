@@ -11,6 +11,7 @@
 
 #include "Framework/ASoAHelpers.h"
 #include "Framework/GroupedCombinations.h"
+#include "Framework/MixingEngine.h"
 #include "Framework/TableBuilder.h"
 #include "Framework/AnalysisDataModel.h"
 #include <benchmark/benchmark.h>
@@ -198,4 +199,86 @@ static void BM_EventMixingCombinations(benchmark::State& state)
 
 BENCHMARK(BM_EventMixingCombinations)->RangeMultiplier(2)->Range(4, 8 << maxPairsRange);
 
+static void BM_EventMixingParallel(benchmark::State& state)
+{
+  // Seed with a real random value, if available
+  std::default_random_engine e1(1234567891);
+  std::uniform_real_distribution<float> uniform_dist(0.f, 1.f);
+  std::uniform_real_distribution<float> uniform_dist_x(-0.065f, 0.073f);
+  std::uniform_real_distribution<float> uniform_dist_y(-0.320f, 0.360f);
+  std::uniform_int_distribution<int> uniform_dist_int(0, 5);
+
+  std::vector<double> xBins{VARIABLE_WIDTH, -0.064, -0.062, -0.060, 0.066, 0.068, 0.070, 0.072};
+  std::vector<double> yBins{VARIABLE_WIDTH, -0.320, -0.301, -0.300, 0.330, 0.340, 0.350, 0.360};
+  using BinningType = ColumnBinningPolicy<o2::aod::collision::PosX, o2::aod::collision::PosY>;
+  BinningType binningOnPositions{{xBins, yBins}, true}; // true is for 'ignore overflows' (true by default)
+
+  TableBuilder colBuilder, trackBuilder;
+  auto rowWriterCol = colBuilder.cursor<o2::aod::Collisions>();
+  for (auto i = 0; i < state.range(0); ++i) {
+    float x = uniform_dist_x(e1);
+    float y = uniform_dist_y(e1);
+    rowWriterCol(0, uniform_dist_int(e1),
+                 x, y, uniform_dist(e1),
+                 uniform_dist(e1), uniform_dist(e1), uniform_dist(e1),
+                 uniform_dist(e1), uniform_dist(e1), uniform_dist(e1),
+                 uniform_dist_int(e1), uniform_dist(e1),
+                 uniform_dist_int(e1),
+                 uniform_dist(e1), uniform_dist(e1));
+  }
+  auto tableCol = colBuilder.finalize();
+  o2::aod::Collisions collisions{tableCol};
+  std::uniform_int_distribution<int> uniform_dist_col_ind(0, collisions.size());
+
+  auto rowWriterTrack = trackBuilder.cursor<o2::aod::StoredTracks>();
+  for (auto i = 0; i < numTracksPerEvent * state.range(0); ++i) {
+    rowWriterTrack(0, uniform_dist_col_ind(e1), 0,
+                   uniform_dist(e1), uniform_dist(e1), uniform_dist(e1),
+                   uniform_dist(e1), uniform_dist(e1), uniform_dist(e1),
+                   uniform_dist(e1));
+  }
+  auto tableTrack = trackBuilder.finalize();
+  o2::aod::StoredTracks tracks{tableTrack};
+
+  int64_t count = 0;
+  int64_t colCount = 0;
+  int threads = state.range(1);
+  MixingEngine<BinningType, int, o2::aod::Collisions, o2::aod::StoredTracks> engine{binningOnPositions, numEventsToMix - 1, -1, {.threads = threads, .deterministic = true}};
+
+  // One set of counters per thread, aligned to avoid false sharing.
+  struct alignas(64) Counters {
+    int64_t pairs = 0;
+    int64_t collisionPairs = 0;
+    int64_t lastCollision1 = -1;
+    int64_t lastCollision2 = -1;
+  };
+
+  for (auto _ : state) {
+    std::vector<Counters> counters(threads);
+    engine.process(collisions, tracks, [&](int thread, MixedPairsBatch const& batch) {
+      auto& c = counters[thread];
+      c.pairs += batch.size();
+      // The batches of a collision pair are consecutive on the same thread.
+      if (batch.collision1 != c.lastCollision1 || batch.collision2 != c.lastCollision2) {
+        c.collisionPairs++;
+        c.lastCollision1 = batch.collision1;
+        c.lastCollision2 = batch.collision2;
+      }
+    });
+    count = 0;
+    colCount = 0;
+    for (auto& c : counters) {
+      count += c.pairs;
+      colCount += c.collisionPairs;
+    }
+    benchmark::DoNotOptimize(count);
+    benchmark::DoNotOptimize(colCount);
+  }
+  state.counters["Mixed track pairs"] = count;
+  state.counters["Mixed collision pairs"] = colCount;
+  state.SetBytesProcessed(state.iterations() * sizeof(float) * count);
+}
+
+BENCHMARK(BM_EventMixingParallel)->RangeMultiplier(2)->Ranges({{4, 8 << maxPairsRange}, {1, 8}});
+
 BENCHMARK_MAIN();
@@ -1360,3 +1360,53 @@ TEST_CASE("TestCombinedGetter")
     ++count;
   }
 }
+
+TEST_CASE("TestColumnBatches")
+{
+  auto makeTable = [](char const* label, int first, int rows, int factor) {
+    TableBuilder builder;
+    auto rowWriter = builder.persist<int32_t>({label});
+    for (auto i = first; i < first + rows; ++i) {
+      rowWriter(0, factor * i);
+    }
+    return builder.finalize();
+  };
+  // fX is split in chunks of 3, 5 and 2 rows, fY is a single chunk
+  auto xs = ArrowHelpers::concatTables({makeTable("fX", 0, 3, 1), makeTable("fX", 3, 5, 1), makeTable("fX", 8, 2, 1)});
+  auto ys = makeTable("fY", 0, 10, 2);
+  o2::aod::Points points{{xs, ys}};
+
+  std::vector<int64_t> sizes;
+  int64_t row = 0;
+  for (auto& batch : points.batches<o2::aod::test::X, o2::aod::test::Y>()) {
+    REQUIRE(batch.offset == row);
+    auto x = batch.get<o2::aod::test::X>();
+    auto y = batch.get<o2::aod::test::Y>();
+    REQUIRE((int64_t)x.size() == batch.size);
+    REQUIRE((int64_t)y.size() == batch.size);
+    for (int64_t i = 0; i < batch.size; ++i) {
+      REQUIRE(x[i] == row + i);
+      REQUIRE(y[i] == 2 * (row + i));
+    }
+    row += batch.size;
+    sizes.push_back(batch.size);
+  }
+  REQUIRE(row == 10);
+  REQUIRE(sizes == std::vector<int64_t>{3, 5, 2});
+
+  // Slices can start in the middle of a chunk
+  auto slice = points.rawSlice(2, 6);
+  sizes.clear();
+  row = 2;
+  for (auto& batch : slice.batches<o2::aod::test::Y, o2::aod::test::X>()) {
+    auto x = batch.get<o2::aod::test::X>();
+    REQUIRE(x[0] == row);
+    row += batch.size;
+    sizes.push_back(batch.size);
+  }
+  REQUIRE(sizes == std::vector<int64_t>{1, 4});
+
+  auto empty = points.emptySlice();
+  auto batches = empty.batches<o2::aod::test::X>();
+  REQUIRE(batches.begin() == batches.end());
+}
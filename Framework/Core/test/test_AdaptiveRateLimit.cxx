@@ -0,0 +1,50 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include <catch_amalgamated.hpp>
+#include "Framework/RateLimiter.h"
+
+using namespace o2::framework;
+
+TEST_CASE("TestAdaptiveRateLimitDecrease")
+{
+  AdaptiveRateLimit controller{.targetOccupancy = 0.8f};
+  // We start from the configured maximum.
+  REQUIRE(controller.update(16, 0, 0, 0.1f) == 16);
+  // Above target, we halve.
+  REQUIRE(controller.update(16, 16, 0, 0.9f) == 8);
+  // Still above target, but the timeframes which were in flight when we
+  // decreased are not consumed yet, so we wait.
+  REQUIRE(controller.update(16, 16, 10, 0.9f) == 8);
+  REQUIRE(controller.update(16, 17, 16, 0.9f) == 4);
+  REQUIRE(controller.update(16, 20, 16, 0.95f) == 4);
+  REQUIRE(controller.update(16, 20, 17, 0.95f) == 2);
+  REQUIRE(controller.update(16, 21, 19, 0.95f) == 2);
+  REQUIRE(controller.update(16, 21, 20, 0.95f) == 1);
+  // Never below one.
+  REQUIRE(controller.update(16, 22, 22, 0.99f) == 1);
+}
+
+TEST_CASE("TestAdaptiveRateLimitIncrease")
+{
+  AdaptiveRateLimit controller{.targetOccupancy = 0.8f, .limit = 2.f};
+  // Below target, but we are not limited, so nothing changes.
+  REQUIRE(controller.update(8, 1, 0, 0.1f) == 2);
+  // Limited: we grow by one every round trip.
+  REQUIRE(controller.update(8, 2, 0, 0.1f) == 2);
+  REQUIRE(controller.update(8, 3, 1, 0.1f) == 2);
+  REQUIRE(controller.update(8, 4, 2, 0.1f) == 3);
+  for (int i = 0; i < 100; ++i) {
+    controller.update(8, 100 + i + 8, 100 + i, 0.1f);
+  }
+  // Capped at the configured maximum.
+  REQUIRE(controller.update(8, 300, 292, 0.1f) == 8);
+}
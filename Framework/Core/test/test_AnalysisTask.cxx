@@ -30,6 +30,7 @@ DECLARE_SOA_COLUMN(Z, z, float);
 DECLARE_SOA_COLUMN(Foo, foo, float);
 DECLARE_SOA_COLUMN(Bar, bar, float);
 DECLARE_SOA_COLUMN(EventProperty, eventProperty, float);
+DECLARE_SOA_COLUMN(Pair, pair, float[2]);
 DECLARE_SOA_DYNAMIC_COLUMN(Sum, sum, [](float x, float y) { return x + y; });
 DECLARE_SOA_EXPRESSION_COLUMN(Sqfoo, sqfoo, float, nsqrt(test::foo));
 } // namespace test
@@ -46,6 +47,8 @@ DECLARE_SOA_TABLE(XYZ, "AOD", "XYZ",
                   test::X, test::Y, test::Z);
 DECLARE_SOA_TABLE(Events, "AOD", "EVENTS",
                   test::EventProperty);
+DECLARE_SOA_TABLE(Pairs, "AOD", "PAIRS",
+                  test::Foo, test::Pair);
 
 DECLARE_SOA_TABLE(Roots, "AOD", "ROOTS", test::Foo);
 
@@ -185,6 +188,14 @@ struct LTask {
   void process(aod::McCollision const&, soa::SmallGroups<soa::Join<aod::Collisions, aod::McCollisionLabels>> const&) {}
 };
 
+struct MTask {
+  Produces<aod::Foos> foos;
+  void processParallel(aod::Collision const&, aod::Tracks const& tracks)
+  {
+    foos(static_cast<float>(tracks.size()));
+  }
+};
+
 TEST_CASE("AdaptorCompilation")
 {
   auto cfgc = makeEmptyConfigContext();
@@ -258,6 +269,100 @@ TEST_CASE("AdaptorCompilation")
 
   auto task12 = adaptAnalysisTask<LTask>(*cfgc, TaskName{"test12"});
   REQUIRE(task12.inputs.size() == 3);
+
+  auto task13 = adaptAnalysisTask<MTask>(*cfgc, TaskName{"test13"});
+  REQUIRE(task13.inputs.size() == 3);
+  REQUIRE(task13.inputs[0].binding == "Collisions_001");
+  REQUIRE(task13.outputs.size() == 1);
+  REQUIRE(task13.options.size() == 1);
+  REQUIRE(task13.options[0].name == "process-threads");
+  // opt-in, not to oversubscribe the nodes running many tasks
+  REQUIRE(task13.options[0].defaultValue.get<int>() == 1);
+}
+
+TEST_CASE("ParallelProcessing")
+{
+  auto partitions = ParallelProcessing::partition(10, 2);
+  REQUIRE(partitions.size() == 8);
+  REQUIRE(partitions.front().first == 0);
+  REQUIRE(partitions.back().second == 10);
+  for (size_t pi = 1; pi < partitions.size(); ++pi) {
+    REQUIRE(partitions[pi].first == partitions[pi - 1].second);
+  }
+  REQUIRE(ParallelProcessing::partition(3, 4).size() == 3);
+  REQUIRE(ParallelProcessing::partition(10, 1).size() == 1);
+  REQUIRE(ParallelProcessing::partition(0, 4).empty());
+
+  // The rows filled in the partitions end up in the order of the partitions.
+  TableBuilder builder;
+  Produces<aod::Pairs> pairs;
+  pairs.resetCursor(LifetimeHolder<TableBuilder>{&builder});
+  auto rows = ParallelProcessing::partition(1000, 4);
+  pairs.beginPartitions(rows.size());
+  WorkerPool pool;
+  ParallelProcessing::run(pool, rows.size(), 4, [&](size_t partition) {
+    for (auto row = rows[partition].first; row < rows[partition].second; ++row) {
+      float values[2] = {(float)row, -(float)row};
+      pairs((float)row, values);
+    }
+  });
+  REQUIRE(ParallelProcessing::currentPartition() == -1);
+  REQUIRE(pairs.lastIndex() == -1);
+  pairs.endPartitions();
+  REQUIRE(pairs.lastIndex() == 999);
+  aod::Pairs table{builder.finalize()};
+  REQUIRE(table.size() == 1000);
+  int64_t expected = 0;
+  for (auto& row : table) {
+    REQUIRE(row.foo() == expected);
+    REQUIRE(row.pair()[1] == -expected);
+    ++expected;
+  }
+
+  // The first error of a partition is propagated.
+  REQUIRE_THROWS_AS(ParallelProcessing::run(pool, 8, 4, [](size_t partition) {
+                      if (partition == 5) {
+                        throw std::runtime_error("failed");
+                      }
+                    }),
+                    std::runtime_error);
+}
+
+struct NTask {
+  HistogramRegistry registry{"registry", {{"counts", "counts", {HistType::kTH1D, {{10, -0.5, 9.5}}}}}};
+};
+
+TEST_CASE("ParallelProcessingHistograms")
+{
+  // same sequence as invokeProcessParallel() with process-threads = 4
+  NTask task;
+  constexpr int threads = 4;
+  constexpr size_t nRows = 10000;
+  auto partitions = ParallelProcessing::partition(nRows, threads);
+  REQUIRE(partitions.size() > 1);
+  WorkerPool pool;
+  // several dataframes, reusing the same threads
+  for (int df = 0; df < 3; ++df) {
+    homogeneous_apply_refs([&partitions](auto& x) { return PartitionedOutputManager<std::decay_t<decltype(x)>>::begin(x, partitions.size()); }, task);
+    ParallelProcessing::run(pool, partitions.size(), threads, [&](size_t partition) {
+      for (auto row = partitions[partition].first; row < partitions[partition].second; ++row) {
+        task.registry.fill(HIST("counts"), static_cast<double>(row % 10), 1. + row % 3);
+      }
+    });
+    homogeneous_apply_refs([](auto& x) { return PartitionedOutputManager<std::decay_t<decltype(x)>>::end(x); }, task);
+  }
+  REQUIRE(pool.workers() == threads - 1);
+
+  // the per-thread fills are merged at the end of the dataframe, not only at the end of stream
+  auto hist = task.registry.get<TH1>(HIST("counts"));
+  REQUIRE(hist->GetEntries() == 3 * nRows);
+  for (int bin = 0; bin < 10; ++bin) {
+    double expected = 0;
+    for (size_t row = bin; row < nRows; row += 10) {
+      expected += 3 * (1. + row % 3);
+    }
+    REQUIRE(hist->GetBinContent(bin + 1) == Catch::Approx(expected));
+  }
 }
 
 TEST_CASE("TestPartitionIteration")
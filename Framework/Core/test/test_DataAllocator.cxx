@@ -102,6 +102,9 @@ DataProcessorSpec getSourceSpec()
     ASSERT_ERROR(cl != nullptr);
     o2::framework::ROOTSerialized<char, TClass> e(*((char*)&c), cl);
     pc.outputs().snapshot(Output{"TST", "ROOTSERLZDVEC2", 0}, e);
+    // nested vector of messageable type, explicitly flattened
+    std::vector<std::vector<int>> nested{{1, 2, 3}, {}, {4}};
+    pc.outputs().snapshot(Output{"TST", "FLATVECTOR", 0}, o2::framework::FlatVectorSerialized<decltype(nested)>(nested));
     // test the 'make' methods
     pc.outputs().make<o2::test::TriviallyCopyable>(OutputRef{"makesingle", 0}) = a;
     auto& multi = pc.outputs().make<o2::test::TriviallyCopyable>(OutputRef{"makespan", 0}, 3);
@@ -189,6 +192,7 @@ DataProcessorSpec getSourceSpec()
                             OutputSpec{"TST", "DEQUE", 0, Lifetime::Timeframe},
                             OutputSpec{"TST", "ROOTSERLZDVEC", 0, Lifetime::Timeframe},
                             OutputSpec{"TST", "ROOTSERLZDVEC2", 0, Lifetime::Timeframe},
+                            OutputSpec{"TST", "FLATVECTOR", 0, Lifetime::Timeframe},
                             OutputSpec{"TST", "PMRTESTVECTOR", 0, Lifetime::Timeframe},
                             OutputSpec{{"podvector"}, "TST", "PODVECTOR", 0, Lifetime::Timeframe},
                             OutputSpec{{"inputPtrVec"}, "TST", "ROOTSERLZDPTRVEC", 0, Lifetime::Timeframe}},
@@ -280,6 +284,16 @@ DataProcessorSpec getSinkSpec()
     ASSERT_ERROR(object6[0] == o2::test::Polymorphic(0xaffe));
     ASSERT_ERROR(object6[1] == o2::test::Polymorphic(0xd00f));
 
+    LOG(info) << "extracting flattened nested vector from inputFlatVec";
+    auto flatDh = DataRefUtils::getHeader<const o2::header::DataHeader*>(pc.inputs().get("inputFlatVec"));
+    ASSERT_ERROR(flatDh->payloadSerializationMethod == o2::header::gSerializationMethodFlatVector);
+    auto flatView = pc.inputs().get<FlatVectorView<int>>("inputFlatVec");
+    ASSERT_ERROR(flatView.size() == 3);
+    ASSERT_ERROR(flatView[0].size() == 3 && flatView[0][2] == 3);
+    ASSERT_ERROR(flatView[1].empty());
+    auto flatCopy = pc.inputs().get<std::vector<std::vector<int>>>("inputFlatVec");
+    ASSERT_ERROR(flatCopy == (std::vector<std::vector<int>>{{1, 2, 3}, {}, {4}}));
+
     // checking retrieving buffer as raw char*, and checking content by cast
     LOG(info) << "extracting raw char* from input1";
     auto rawchar = pc.inputs().get<const char*>("input1");
@@ -373,6 +387,7 @@ DataProcessorSpec getSinkSpec()
                             InputSpec{"input4", "TST", "ROOTVECTOR", 0, Lifetime::Timeframe},
                             InputSpec{"input5", "TST", "ROOTSERLZDVEC", 0, Lifetime::Timeframe},
                             InputSpec{"input6", "TST", "ROOTSERLZDVEC2", 0, Lifetime::Timeframe},
+                            InputSpec{"inputFlatVec", "TST", "FLATVECTOR", 0, Lifetime::Timeframe},
                             InputSpec{"input7", "TST", "MAKESINGLE", 0, Lifetime::Timeframe},
                             InputSpec{"input8", "TST", "MAKESPAN", 0, Lifetime::Timeframe},
                             InputSpec{"input9", "TST", "ADOPTCHUNK", 0, Lifetime::Timeframe},
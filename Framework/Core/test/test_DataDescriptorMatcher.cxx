@@ -11,6 +11,8 @@
 
 #include "Framework/DataDescriptorMatcher.h"
 #include "Framework/DataDescriptorQueryBuilder.h"
+#include "Framework/DataMatcherLookup.h"
+#include "Framework/DataProcessingHeader.h"
 #include "Framework/InputSpec.h"
 #include "Framework/DataSpecUtils.h"
 #include "Headers/Stack.h"
@@ -720,3 +722,44 @@ TEST_CASE("MatchSubspec")
 
   REQUIRE(matcher.match(header0, context) == false);
 }
+
+TEST_CASE("DataMatcherLookup")
+{
+  std::vector<DataDescriptorMatcher> matchers;
+  // 0: a concrete one
+  matchers.push_back(DataSpecUtils::dataDescriptorMatcherFrom(ConcreteDataMatcher{"TPC", "CLUSTERS", 1}));
+  // 1: any subspec of the same type
+  matchers.push_back(DataSpecUtils::dataDescriptorMatcherFrom(ConcreteDataTypeMatcher{"TPC", "CLUSTERS"}));
+  // 2: an Or, which cannot be indexed
+  matchers.emplace_back(DataDescriptorMatcher::Op::Or,
+                        OriginValueMatcher{"ITS"},
+                        DescriptionValueMatcher{"TRACKS"});
+  // 3: ignored, as it is not in the index
+  matchers.push_back(DataSpecUtils::dataDescriptorMatcherFrom(ConcreteDataMatcher{"TOF", "DIGITS", 0}));
+  // 4: another concrete one
+  matchers.push_back(DataSpecUtils::dataDescriptorMatcherFrom(ConcreteDataMatcher{"TOF", "DIGITS", 0}));
+
+  DataMatcherLookup lookup{matchers, {0, 1, 2, 4}};
+  REQUIRE(lookup.fallbackSize() == 1);
+
+  auto check = [&lookup](char const* origin, char const* description, uint32_t subSpec, size_t expected, bool bindsStartTime = true) {
+    DataHeader dh;
+    dh.dataOrigin = origin;
+    dh.dataDescription = description;
+    dh.subSpecification = subSpec;
+    DataProcessingHeader dph{123, 1};
+    Stack stack{dh, dph};
+    VariableContext context;
+    REQUIRE(lookup.match(reinterpret_cast<char const*>(stack.data()), context) == expected);
+    if (expected != DataMatcherLookup::INVALID && bindsStartTime) {
+      REQUIRE(std::get<uint64_t>(context.get(0)) == 123);
+    }
+  };
+  check("TPC", "CLUSTERS", 1, 0);
+  check("TPC", "CLUSTERS", 2, 1);
+  check("ITS", "CLUSTERS", 2, 2, false);
+  check("ABC", "TRACKS", 2, 2, false);
+  check("TOF", "DIGITS", 0, 3);
+  check("TOF", "DIGITS", 1, DataMatcherLookup::INVALID);
+  check("TOF", "RAWDATA", 0, DataMatcherLookup::INVALID);
+}
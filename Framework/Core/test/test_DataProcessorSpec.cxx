@@ -36,4 +36,16 @@ TEST_CASE("TestDataProcessorSpecHelpers")
   REQUIRE(DataProcessorSpecHelpers::hasLabel(spec, "label3") == true);
 }
 
+TEST_CASE("TestRequestedStreams")
+{
+  using namespace o2::framework;
+  REQUIRE(DataProcessorSpecHelpers::getRequestedStreams({}) == 1);
+  REQUIRE(DataProcessorSpecHelpers::getRequestedStreams({{"foo", "bar"}}) == 1);
+  REQUIRE(DataProcessorSpecHelpers::getRequestedStreams({{"streams", "4"}}) == 4);
+  REQUIRE(DataProcessorSpecHelpers::getRequestedStreams({{"streams", "0"}}) == 1);
+  REQUIRE(DataProcessorSpecHelpers::getRequestedStreams({{"streams", "-2"}}) == 1);
+  REQUIRE(DataProcessorSpecHelpers::getRequestedStreams({{"streams", "4x"}}) == 1);
+  REQUIRE(DataProcessorSpecHelpers::getRequestedStreams({{"streams", ""}}) == 1);
+}
+
 #pragma diagnostic pop
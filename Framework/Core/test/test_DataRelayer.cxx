@@ -21,11 +21,13 @@
 #include "Framework/DriverConfig.h"
 #include "Framework/TimingHelpers.h"
 #include "../src/DataRelayerHelpers.h"
+#include "../src/DecongestionService.h"
 #include "Framework/DataProcessingHeader.h"
 #include "Framework/WorkflowSpec.h"
 #include <Monitoring/Monitoring.h>
 #include <fairmq/TransportFactory.h>
 #include <array>
+#include <thread>
 #include <vector>
 #include <uv.h>
 
@@ -490,6 +492,108 @@ TEST_CASE("DataRelayer")
     REQUIRE(ready3[0].op == CompletionPolicy::CompletionOp::Consume);
   }
 
+  // When running with multiple streams, each of them only takes the oldest
+  // ready timeslice, leaving the others for the next invocation.
+  SECTION("TestMaxActions")
+  {
+    InputSpec spec{"clusters", "TPC", "CLUSTERS"};
+
+    std::vector<InputRoute> inputs = {
+      InputRoute{spec, 0, "Fake", 0}};
+
+    std::vector<InputChannelInfo> infos{1};
+    TimesliceIndex index{1, infos};
+    ref.registerService(ServiceRegistryHelpers::handleForService<TimesliceIndex>(&index));
+
+    auto policy = CompletionPolicyHelpers::consumeWhenAny();
+    DataRelayer relayer(policy, inputs, index, {registry});
+    relayer.setPipelineLength(4);
+
+    DataHeader dh;
+    dh.dataDescription = "CLUSTERS";
+    dh.dataOrigin = "TPC";
+    dh.subSpecification = 0;
+    dh.splitPayloadIndex = 0;
+    dh.splitPayloadParts = 1;
+
+    auto transport = fair::mq::TransportFactory::CreateTransportFactory("zeromq");
+    auto channelAlloc = o2::pmr::getTransportAllocator(transport.get());
+    for (size_t timeslice : {2, 0, 1}) {
+      std::array<fair::mq::MessagePtr, 2> messages;
+      messages[0] = o2::pmr::getMessage(Stack{channelAlloc, dh, DataProcessingHeader{timeslice, 1}});
+      messages[1] = transport->CreateMessage(1000);
+      fair::mq::MessagePtr& header = messages[0];
+      DataRelayer::InputInfo fakeInfo{0, messages.size(), DataRelayer::InputType::Data, {ChannelIndex::INVALID}};
+      relayer.relay(header->GetData(), messages.data(), fakeInfo, messages.size());
+    }
+
+    for (size_t timeslice : {0, 1, 2}) {
+      std::vector<RecordAction> ready;
+      relayer.getReadyToProcess(ready, 1);
+      REQUIRE(ready.size() == 1);
+      REQUIRE(ready[0].timeslice.value == timeslice);
+      REQUIRE(ready[0].op == CompletionPolicy::CompletionOp::Consume);
+      relayer.consumeAllInputsForTimeslice(ready[0].slot);
+    }
+    std::vector<RecordAction> ready;
+    relayer.getReadyToProcess(ready, 1);
+    REQUIRE(ready.empty());
+  }
+
+  // With multiple streams each dispatch takes a single action. The ordered
+  // completion policy advances its next timeslice when it says Consume, so
+  // it must not be asked about the timeslices which are left for later.
+  SECTION("TestMaxActionsOrdered")
+  {
+    InputSpec spec{"clusters", "TPC", "CLUSTERS"};
+
+    std::vector<InputRoute> inputs = {
+      InputRoute{spec, 0, "Fake", 0}};
+
+    std::vector<InputChannelInfo> infos{1};
+    TimesliceIndex index{1, infos};
+    ref.registerService(ServiceRegistryHelpers::handleForService<TimesliceIndex>(&index));
+    DecongestionService decongestion;
+    ref.registerService(ServiceRegistryHelpers::handleForService<DecongestionService>(&decongestion));
+
+    auto policy = CompletionPolicyHelpers::consumeWhenAllOrdered();
+    DataRelayer relayer(policy, inputs, index, {registry});
+    relayer.setPipelineLength(4);
+
+    DataHeader dh;
+    dh.dataDescription = "CLUSTERS";
+    dh.dataOrigin = "TPC";
+    dh.subSpecification = 0;
+    dh.splitPayloadIndex = 0;
+    dh.splitPayloadParts = 1;
+
+    auto transport = fair::mq::TransportFactory::CreateTransportFactory("zeromq");
+    auto channelAlloc = o2::pmr::getTransportAllocator(transport.get());
+    // The newest timeslices get the lowest slots, so that all of them
+    // would be complete in a single scan.
+    for (size_t timeslice : {2, 1, 0}) {
+      std::array<fair::mq::MessagePtr, 2> messages;
+      messages[0] = o2::pmr::getMessage(Stack{channelAlloc, dh, DataProcessingHeader{timeslice, 1}});
+      messages[1] = transport->CreateMessage(1000);
+      fair::mq::MessagePtr& header = messages[0];
+      DataRelayer::InputInfo fakeInfo{0, messages.size(), DataRelayer::InputType::Data, {ChannelIndex::INVALID}};
+      relayer.relay(header->GetData(), messages.data(), fakeInfo, messages.size());
+    }
+
+    for (size_t timeslice : {0, 1, 2}) {
+      std::vector<RecordAction> ready;
+      relayer.getReadyToProcess(ready, 1);
+      REQUIRE(ready.size() == 1);
+      REQUIRE(ready[0].timeslice.value == timeslice);
+      REQUIRE(ready[0].op == CompletionPolicy::CompletionOp::Consume);
+      REQUIRE(decongestion.nextTimeslice == (int64_t)timeslice + 1);
+      relayer.consumeAllInputsForTimeslice(ready[0].slot);
+    }
+    std::vector<RecordAction> ready;
+    relayer.getReadyToProcess(ready, 1);
+    REQUIRE(ready.empty());
+  }
+
   /// Test that the clear method actually works.
   SECTION("TestClear")
   {
@@ -807,4 +911,123 @@ TEST_CASE("DataRelayer")
       }
     }
   }
+
+  // Verifies that with a sharded cache each timeslice ends up in a slot of
+  // its own shard and that relay from multiple threads is possible.
+  SECTION("TestSharded")
+  {
+    Monitoring metrics;
+    InputSpec spec1{"clusters", "TPC", "CLUSTERS"};
+    InputSpec spec2{"clusters_its", "ITS", "CLUSTERS"};
+
+    std::vector<InputRoute> inputs = {
+      InputRoute{spec1, 0, "Fake1", 0},
+      InputRoute{spec2, 1, "Fake2", 0}};
+
+    std::vector<InputChannelInfo> infos{1};
+    TimesliceIndex index{1, infos};
+    ref.registerService(ServiceRegistryHelpers::handleForService<TimesliceIndex>(&index));
+
+    auto policy = CompletionPolicyHelpers::consumeWhenAll();
+    DataRelayer relayer(policy, inputs, index, {registry});
+    relayer.setPipelineLength(4);
+    relayer.setShards(2);
+    REQUIRE(relayer.getShards() == 2);
+    // More shards than slots are clamped
+    relayer.setShards(16);
+    REQUIRE(relayer.getShards() == 4);
+    relayer.setShards(2);
+
+    auto transport = fair::mq::TransportFactory::CreateTransportFactory("zeromq");
+    auto channelAlloc = o2::pmr::getTransportAllocator(transport.get());
+
+    auto createMessage = [&transport, &channelAlloc, &relayer](DataHeader dh, size_t time) {
+      std::array<fair::mq::MessagePtr, 2> messages;
+      messages[0] = o2::pmr::getMessage(Stack{channelAlloc, dh, DataProcessingHeader{time, 1}});
+      messages[1] = transport->CreateMessage(1000);
+      DataRelayer::InputInfo fakeInfo{0, messages.size(), DataRelayer::InputType::Data, {ChannelIndex::INVALID}};
+      return relayer.relay(messages[0]->GetData(), messages.data(), fakeInfo, messages.size());
+    };
+
+    DataHeader dh1{"CLUSTERS", "TPC", 0};
+    DataHeader dh2{"CLUSTERS", "ITS", 0};
+
+    // Each thread fills a different timeslice, hence a different shard.
+    std::vector<std::thread> threads;
+    for (size_t ti = 0; ti < 2; ++ti) {
+      threads.emplace_back([&createMessage, &dh1, &dh2, ti]() {
+        createMessage(dh1, ti);
+        createMessage(dh2, ti);
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    std::vector<RecordAction> ready;
+    relayer.getReadyToProcess(ready);
+    REQUIRE(ready.size() == 2);
+    for (auto& action : ready) {
+      REQUIRE(action.op == CompletionPolicy::CompletionOp::Consume);
+      REQUIRE(action.slot.index % 2 == action.timeslice.value % 2);
+      auto result = relayer.consumeAllInputsForTimeslice(action.slot);
+      REQUIRE(result.size() == 2);
+      REQUIRE(result.at(0).size() == 1);
+      REQUIRE(result.at(1).size() == 1);
+    }
+  }
+
+  // Verifies that slots which cannot be complete are not scanned.
+  SECTION("TestInputsPresent")
+  {
+    Monitoring metrics;
+    InputSpec spec1{"clusters", "TPC", "CLUSTERS"};
+    InputSpec spec2{"clusters_its", "ITS", "CLUSTERS"};
+
+    std::vector<InputRoute> inputs = {
+      InputRoute{spec1, 0, "Fake1", 0},
+      InputRoute{spec2, 1, "Fake2", 0}};
+
+    std::vector<InputChannelInfo> infos{1};
+    TimesliceIndex index{1, infos};
+    ref.registerService(ServiceRegistryHelpers::handleForService<TimesliceIndex>(&index));
+
+    auto policy = CompletionPolicyHelpers::consumeWhenAll();
+    DataRelayer relayer(policy, inputs, index, {registry});
+    relayer.setPipelineLength(4);
+
+    auto transport = fair::mq::TransportFactory::CreateTransportFactory("zeromq");
+    auto channelAlloc = o2::pmr::getTransportAllocator(transport.get());
+
+    auto createMessage = [&transport, &channelAlloc, &relayer](DataHeader dh, size_t time) {
+      std::array<fair::mq::MessagePtr, 2> messages;
+      messages[0] = o2::pmr::getMessage(Stack{channelAlloc, dh, DataProcessingHeader{time, 1}});
+      messages[1] = transport->CreateMessage(1000);
+      DataRelayer::InputInfo fakeInfo{0, messages.size(), DataRelayer::InputType::Data, {ChannelIndex::INVALID}};
+      relayer.relay(messages[0]->GetData(), messages.data(), fakeInfo, messages.size());
+    };
+
+    createMessage(DataHeader{"CLUSTERS", "TPC", 0}, 0);
+    REQUIRE(relayer.getInputsPresentForSlot(TimesliceSlot{0}) == 1);
+    std::vector<RecordAction> ready;
+    relayer.getReadyToProcess(ready);
+    REQUIRE(ready.size() == 0);
+    REQUIRE(relayer.getScanStats().completionSkipped == 1);
+    REQUIRE(relayer.getScanStats().completionChecks == 0);
+
+    // A second part for the same input does not change the count
+    createMessage(DataHeader{"CLUSTERS", "TPC", 0}, 0);
+    REQUIRE(relayer.getInputsPresentForSlot(TimesliceSlot{0}) == 1);
+
+    createMessage(DataHeader{"CLUSTERS", "ITS", 0}, 0);
+    REQUIRE(relayer.getInputsPresentForSlot(TimesliceSlot{0}) == 2);
+    relayer.getReadyToProcess(ready);
+    REQUIRE(ready.size() == 1);
+    REQUIRE(relayer.getScanStats().completionChecks == 1);
+    REQUIRE(relayer.getScanStats().inputsScanned == 2);
+
+    auto result = relayer.consumeAllInputsForTimeslice(ready[0].slot);
+    REQUIRE(result.size() == 2);
+    REQUIRE(relayer.getInputsPresentForSlot(ready[0].slot) == 0);
+  }
 }
@@ -283,3 +283,76 @@ TEST_CASE("TestConditionalExpressions")
   auto gandiva_filter2 = createFilter(schema2, gandiva_condition2);
   REQUIRE(gandiva_tree2->ToString() == "bool greater_than((float) fSigned1Pt, (const float) 0 raw(0)) && if (bool less_than(float absf((float) fEta), (const float) 1 raw(3f800000)) && if (bool less_than((float) fPt, (const float) 1 raw(3f800000))) { bool greater_than((float) fPhi, (const float) 1.5708 raw(3fc90fdb)) } else { bool less_than((float) fPhi, (const float) 1.5708 raw(3fc90fdb)) }) { bool greater_than(float absf((float) fX), (const float) 1 raw(3f800000)) } else { bool greater_than(float absf((float) fY), (const float) 1 raw(3f800000)) }");
 }
+
+TEST_CASE("TestColumnRanges")
+{
+  auto withRange = [](std::string const& name, std::shared_ptr<arrow::DataType> const& type, std::string min, std::string max, std::string rows) {
+    return arrow::field(name, type, true, std::make_shared<arrow::KeyValueMetadata>(std::vector<std::string>{columnRangeMinKey, columnRangeMaxKey, columnRangeRowsKey}, std::vector<std::string>{min, max, rows}));
+  };
+  arrow::FloatBuilder etaBuilder;
+  arrow::Int32Builder intBuilder;
+  std::shared_ptr<arrow::Array> etaArray;
+  std::shared_ptr<arrow::Array> intArray;
+  REQUIRE(etaBuilder.AppendValues(std::vector<float>{-0.5f, 0.25f, 0.75f}).ok());
+  REQUIRE(etaBuilder.Finish(&etaArray).ok());
+  REQUIRE(intBuilder.AppendValues(std::vector<int32_t>{3, 4, 5}).ok());
+  REQUIRE(intBuilder.Finish(&intArray).ok());
+  auto schema = arrow::schema({withRange("eta", arrow::float32(), "-0.5", "0.75", "3"), withRange("testInt", arrow::int32(), "3", "5", "3")});
+  auto table = arrow::Table::Make(schema, {etaArray, intArray});
+
+  auto check = [&table](expressions::Filter const& filter) {
+    return checkRanges(createOperations(filter), *table);
+  };
+  REQUIRE(check(nodes::eta < 1.f) == RangeOutcome::AllPass);
+  REQUIRE(check(nodes::eta > 1) == RangeOutcome::NonePass);
+  REQUIRE(check(nodes::eta > 0.5f) == RangeOutcome::Unknown);
+  REQUIRE(check(nabs(nodes::eta) < 0.8f) == RangeOutcome::AllPass);
+  REQUIRE(check(nabs(nodes::eta) < 0.6f) == RangeOutcome::Unknown);
+  REQUIRE(check(1.f > nodes::eta) == RangeOutcome::AllPass);
+  REQUIRE(check(nodes::testInt == 7) == RangeOutcome::NonePass);
+  REQUIRE(check(nodes::testInt != 7) == RangeOutcome::AllPass);
+  REQUIRE(check((nodes::eta > 0.5f) && (nodes::testInt > 6)) == RangeOutcome::NonePass);
+  REQUIRE(check((nodes::eta > 0.5f) || (nodes::testInt >= 3)) == RangeOutcome::AllPass);
+  REQUIRE(check((nodes::eta > 0.5f) && (nodes::testInt >= 3)) == RangeOutcome::Unknown);
+  // Columns without range
+  REQUIRE(check(nodes::phi > 10) == RangeOutcome::Unknown);
+  // Ranges are not used once rows were added
+  auto longer = arrow::Table::Make(arrow::schema({withRange("eta", arrow::float32(), "-0.5", "0.75", "2")}), {etaArray});
+  REQUIRE(checkRanges(createOperations(nodes::eta > 1), *longer) == RangeOutcome::Unknown);
+
+  // The selection is built without evaluating the filter when possible
+  auto selectionFor = [&table, &schema](expressions::Filter const& filter) {
+    std::vector<ExpressionInfo> infos;
+    infos.emplace_back(0, 0, std::set<uint32_t>{3, 6}, schema);
+    updateExpressionInfos(filter, infos);
+    infos[0].resetSelection = true;
+    updateFilterInfo(infos[0], table);
+    return infos[0].selection;
+  };
+  REQUIRE(selectionFor(nodes::eta > 1)->GetNumSlots() == 0);
+  auto all = selectionFor(nodes::testInt > 2);
+  REQUIRE(all->GetNumSlots() == 3);
+  REQUIRE(all->GetIndex(2) == 2);
+  auto some = selectionFor(nodes::eta > 0.1f);
+  REQUIRE(some->GetNumSlots() == 2);
+  REQUIRE(some->GetIndex(0) == 1);
+}
+
+TEST_CASE("TestCompiledExpressionsCache")
+{
+  auto schema = std::make_shared<arrow::Schema>(std::vector{arrow::field("eta", arrow::float32()), arrow::field("phi", arrow::float32())});
+  auto first = createFilter(schema, createOperations((nodes::eta < 1.f) && (nodes::phi > 0.5f)));
+  auto second = createFilter(schema, createOperations((nodes::eta < 1.f) && (nodes::phi > 0.5f)));
+  REQUIRE(first == second);
+  // Literals are compared with all their digits
+  auto close = createFilter(schema, createOperations((nodes::eta < 1.0000001f) && (nodes::phi > 0.5f)));
+  REQUIRE(close != first);
+  // The schema is part of the key
+  auto other = std::make_shared<arrow::Schema>(std::vector{arrow::field("eta", arrow::float32()), arrow::field("phi", arrow::float32()), arrow::field("pt", arrow::float32())});
+  REQUIRE(createFilter(other, createOperations((nodes::eta < 1.f) && (nodes::phi > 0.5f))) != first);
+
+  auto result = arrow::field("result", arrow::float32());
+  auto projector = createProjector(schema, createOperations(nodes::eta * 2.f), result);
+  REQUIRE(createProjector(schema, createOperations(nodes::eta * 2.f), result) == projector);
+  REQUIRE(createProjector(schema, createOperations(nodes::eta * 3.f), result) != projector);
+}
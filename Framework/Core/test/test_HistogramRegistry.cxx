@@ -11,6 +11,8 @@
 
 #include "Framework/HistogramRegistry.h"
 #include <catch_amalgamated.hpp>
+#include <cmath>
+#include <thread>
 
 using namespace o2;
 using namespace o2::framework;
@@ -125,3 +127,92 @@ TEST_CASE("HistogramRegistryStepTHn")
 
   registry.print();
 }
+
+TEST_CASE("HistogramRegistryThreadLocalFills")
+{
+  auto makeRegistry = [](char const* name) {
+    return HistogramRegistry{
+      name, {
+              {"h1", "h1", {HistType::kTH1F, {{20, -1.0, 1.0}}}},                                    //
+              {"h2", "h2", {HistType::kTH2D, {{{-1.0, -0.5, 0.0, 0.1, 1.0}}, {10, -1.0, 1.0}}}},     //
+              {"hn", "hn", {HistType::kTHnD, {{5, -1.0, 1.0}, {5, -1.0, 1.0}, {5, -1.0, 1.0}}}},     //
+              {"step", "step", {HistType::kStepTHnD, {{10, -1.0, 1.0}, {10, -1.0, 1.0}}, 2}},        //
+              {"profile", "profile", {HistType::kTProfile, {{10, -1.0, 1.0}}}}                       //
+            }                                                                                        //
+    };
+  };
+  auto fillAll = [](HistogramRegistry& registry, int offset, int stride) {
+    for (int i = offset; i < 4000; i += stride) {
+      double x = std::sin(i * 0.7) * 1.2;
+      double y = std::cos(i * 1.3);
+      double w = 0.5 + (i % 3);
+      registry.fill(HIST("h1"), x);
+      registry.fill(HIST("h2"), x, y, w);
+      registry.fill(HIST("hn"), x, y, x * y);
+      registry.fill(HIST("step"), i % 2, x, y);
+      registry.fill(HIST("profile"), x, y);
+    }
+  };
+
+  auto reference = makeRegistry("reference");
+  fillAll(reference, 0, 1);
+
+  auto registry = makeRegistry("registry");
+  registry.setThreadLocalFills(true);
+  constexpr int nThreads = 4;
+  std::vector<std::thread> threads;
+  for (int ti = 0; ti < nThreads; ++ti) {
+    threads.emplace_back(fillAll, std::ref(registry), ti, nThreads);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // nothing reaches the ROOT objects before merging
+  REQUIRE(registry.get<TH1>(HIST("h1"))->GetEntries() == 0);
+  REQUIRE(registry.get<TProfile>(HIST("profile"))->GetEntries() == 4000);
+  registry.mergeThreadLocalFills();
+
+  // the sums are not done in the same order
+  auto approx = [](double value) { return Catch::Approx(value).margin(1e-9); };
+  auto compareTH1 = [&approx](TH1* hist, TH1* ref) {
+    REQUIRE(hist->GetEntries() == ref->GetEntries());
+    REQUIRE(hist->GetMean() == approx(ref->GetMean()));
+    REQUIRE(hist->GetStdDev() == approx(ref->GetStdDev()));
+    for (int cell = 0; cell < ref->GetNcells(); ++cell) {
+      REQUIRE(hist->GetBinContent(cell) == approx(ref->GetBinContent(cell)));
+      REQUIRE(hist->GetBinError(cell) == approx(ref->GetBinError(cell)));
+    }
+  };
+  compareTH1(registry.get<TH1>(HIST("h1")).get(), reference.get<TH1>(HIST("h1")).get());
+  compareTH1(registry.get<TH2>(HIST("h2")).get(), reference.get<TH2>(HIST("h2")).get());
+  REQUIRE(registry.get<TH2>(HIST("h2"))->GetMean(2) == approx(reference.get<TH2>(HIST("h2"))->GetMean(2)));
+  REQUIRE(registry.get<TH2>(HIST("h2"))->GetCovariance() == approx(reference.get<TH2>(HIST("h2"))->GetCovariance()));
+  compareTH1(registry.get<TProfile>(HIST("profile")).get(), reference.get<TProfile>(HIST("profile")).get());
+
+  auto hn = registry.get<THn>(HIST("hn"));
+  auto refHn = reference.get<THn>(HIST("hn"));
+  REQUIRE(hn->GetEntries() == refHn->GetEntries());
+  for (Long64_t bin = 0; bin < refHn->GetNbins(); ++bin) {
+    REQUIRE(hn->GetBinContent(bin) == approx(refHn->GetBinContent(bin)));
+  }
+
+  auto step = registry.get<StepTHn>(HIST("step"));
+  auto refStep = reference.get<StepTHn>(HIST("step"));
+  for (int s = 0; s < 2; ++s) {
+    for (int bin = 0; bin < 100; ++bin) {
+      REQUIRE(step->getValues(s)->GetAt(bin) == approx(refStep->getValues(s)->GetAt(bin)));
+    }
+  }
+
+  // merging again does not add anything
+  registry.mergeThreadLocalFills();
+  REQUIRE(registry.get<TH1>(HIST("h1"))->GetEntries() == 4000);
+
+  // the copies are zeroed, not dropped, by the merge and reused by the next fills
+  fillAll(reference, 0, 1);
+  fillAll(registry, 0, 1);
+  registry.mergeThreadLocalFills();
+  compareTH1(registry.get<TH1>(HIST("h1")).get(), reference.get<TH1>(HIST("h1")).get());
+  compareTH1(registry.get<TH2>(HIST("h2")).get(), reference.get<TH2>(HIST("h2")).get());
+  REQUIRE(registry.get<THn>(HIST("hn"))->GetEntries() == refHn->GetEntries());
+}
@@ -159,6 +159,52 @@ TEST_CASE("TestInputRecord")
   REQUIRE(record.end().begin() == record.end().end());
 }
 
+TEST_CASE("TestFlatVector")
+{
+  InputSpec spec{"x", "TPC", "TRACKS", 0, Lifetime::Timeframe};
+  std::vector<InputRoute> schema = {InputRoute{spec, 0, "x_source", 0, std::nullopt}};
+
+  std::vector<std::vector<int>> tracks{{1, 2, 3}, {}, {4}, {5, 6}};
+  auto payloadSize = FlatVectorHelpers::serializedSize(tracks);
+  std::vector<char> payload(payloadSize);
+  FlatVectorHelpers::serialize(tracks, payload.data());
+
+  DataHeader dh;
+  dh.dataDescription = "TRACKS";
+  dh.dataOrigin = "TPC";
+  dh.subSpecification = 0;
+  dh.payloadSize = payloadSize;
+  dh.payloadSerializationMethod = o2::header::gSerializationMethodFlatVector;
+  Stack stack{dh, DataProcessingHeader{0, 1}};
+
+  InputSpan span{[&stack, &payload](size_t) { return DataRef{nullptr, reinterpret_cast<char const*>(stack.data()), payload.data()}; }, 1};
+  ServiceRegistry registry;
+  InputRecord record{schema, span, registry};
+
+  // The view points directly into the payload.
+  auto view = record.get<FlatVectorView<int>>("x");
+  REQUIRE(view.size() == 4);
+  REQUIRE(view[0].size() == 3);
+  REQUIRE(view[0][2] == 3);
+  REQUIRE(view[1].empty());
+  REQUIRE(view[3][1] == 6);
+  REQUIRE(view.elements().size() == 6);
+  REQUIRE((char const*)view.elements().data() >= payload.data());
+  REQUIRE((char const*)view.elements().data() < payload.data() + payload.size());
+  size_t entries = 0;
+  for (auto entry : view) {
+    REQUIRE(entry.size() == tracks[entries++].size());
+  }
+  REQUIRE(entries == 4);
+
+  // Materialising it gives back the original vector.
+  REQUIRE(record.get<std::vector<std::vector<int>>>("x") == tracks);
+  REQUIRE(*record.get<std::vector<std::vector<int>>*>("x") == tracks);
+
+  // Mismatching element types are detected.
+  REQUIRE_THROWS_AS(record.get<FlatVectorView<double>>("x"), RuntimeErrorRef);
+}
+
 // TODO:
 // - test all `get` implementations
 // - create a list of supported types and check that the API compiles
@@ -0,0 +1,91 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include <catch_amalgamated.hpp>
+#include "Framework/LatencyHistogram.h"
+
+using namespace o2::framework;
+
+TEST_CASE("TestLatencyHistogramBuckets")
+{
+  for (uint64_t us : {0ull, 1ull, 3ull, 4ull, 7ull, 8ull, 1000ull, 123456ull, 1ull << 36}) {
+    auto bucket = LatencyHistogram::bucketFor(us);
+    REQUIRE(bucket < LatencyHistogram::BUCKETS);
+    REQUIRE(LatencyHistogram::lowerBound(bucket) <= us);
+    REQUIRE(LatencyHistogram::lowerBound(bucket + 1) > us);
+  }
+  // Buckets are contiguous
+  for (int bi = 1; bi < LatencyHistogram::BUCKETS; ++bi) {
+    REQUIRE(LatencyHistogram::bucketFor(LatencyHistogram::lowerBound(bi)) == bi);
+    REQUIRE(LatencyHistogram::bucketFor(LatencyHistogram::lowerBound(bi) - 1) == bi - 1);
+  }
+  // Anything too large ends up in the overflow bucket.
+  REQUIRE(LatencyHistogram::bucketFor(-1) == LatencyHistogram::BUCKETS - 1);
+}
+
+TEST_CASE("TestLatencyHistogramQuantiles")
+{
+  LatencyHistogram histogram;
+  for (int i = 0; i < 990; ++i) {
+    histogram.record(10);
+  }
+  for (int i = 0; i < 10; ++i) {
+    histogram.record(10000);
+  }
+  auto snapshot = LatencyHistogramSnapshot::from(histogram);
+  REQUIRE(snapshot.total == 1000);
+  REQUIRE(snapshot.quantile(0.5) == LatencyHistogram::lowerBound(LatencyHistogram::bucketFor(10)));
+  REQUIRE(snapshot.quantile(0.99) == LatencyHistogram::lowerBound(LatencyHistogram::bucketFor(10)));
+  REQUIRE(snapshot.quantile(0.999) == LatencyHistogram::lowerBound(LatencyHistogram::bucketFor(10000)));
+  REQUIRE(LatencyHistogramSnapshot{}.quantile(0.5) == 0);
+}
+
+TEST_CASE("TestLatencyHistogramEncoding")
+{
+  LatencyHistogram histogram;
+  histogram.record(1);
+  histogram.record(5);
+  histogram.record(5);
+  histogram.record(100000);
+  auto snapshot = LatencyHistogramSnapshot::from(histogram);
+  auto encoded = snapshot.encode(512);
+  REQUIRE(encoded == "1:1;5:2;3e:1;");
+
+  LatencyHistogramSnapshot decoded;
+  REQUIRE(LatencyHistogramSnapshot::decode(encoded, decoded));
+  REQUIRE(decoded.counts == snapshot.counts);
+  REQUIRE(decoded.total == 4);
+
+  // Decoding merges, so that we can aggregate multiple devices.
+  REQUIRE(LatencyHistogramSnapshot::decode(encoded, decoded));
+  REQUIRE(decoded.total == 8);
+  REQUIRE(decoded.counts[5] == 4);
+
+  LatencyHistogramSnapshot broken;
+  REQUIRE(LatencyHistogramSnapshot::decode("1:1;5", broken) == false);
+  REQUIRE(LatencyHistogramSnapshot::decode("fff:1;", broken) == false);
+}
+
+TEST_CASE("TestLatencyHistogramEncodingFolding")
+{
+  LatencyHistogram histogram;
+  for (uint64_t us = 1; us < (1ull << 30); us += us / 3 + 1) {
+    histogram.record(us);
+  }
+  auto snapshot = LatencyHistogramSnapshot::from(histogram);
+  auto full = snapshot.encode(100000);
+  auto folded = snapshot.encode(full.size() / 2);
+  REQUIRE(folded.size() < full.size());
+  LatencyHistogramSnapshot decoded;
+  REQUIRE(LatencyHistogramSnapshot::decode(folded, decoded));
+  // No entry is lost, we only lose resolution.
+  REQUIRE(decoded.total == snapshot.total);
+}
@@ -0,0 +1,85 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include <catch_amalgamated.hpp>
+#include "Framework/MessageArena.h"
+#include <fairmq/TransportFactory.h>
+#include <fairmq/Message.h>
+#include <chrono>
+#include <thread>
+
+using namespace o2::framework;
+
+namespace
+{
+// Region callbacks might be delivered asynchronously.
+bool waitForFreeBlocks(MessageArena& arena, size_t expected)
+{
+  for (int i = 0; i < 100; ++i) {
+    if (arena.freeBlocks() == expected) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return false;
+}
+} // namespace
+
+TEST_CASE("TestMessageArena")
+{
+  auto transport = fair::mq::TransportFactory::CreateTransportFactory("zeromq");
+  MessageArena arena{transport.get(), 4 * 65536, 4};
+  REQUIRE(arena.freeBlocks() == 4);
+  REQUIRE(arena.maxMessageSize() == 4096);
+
+  // Messages of the same timeslice are contiguous in the same block.
+  auto m1 = arena.create(1, 10);
+  auto m2 = arena.create(1, 100);
+  REQUIRE(m1.get() != nullptr);
+  REQUIRE(m2.get() != nullptr);
+  REQUIRE(m1->GetSize() == 10);
+  REQUIRE(m2->GetSize() == 100);
+  REQUIRE((char*)m2->GetData() - (char*)m1->GetData() == MessageArena::alignment);
+  REQUIRE(arena.freeBlocks() == 3);
+
+  // Too big for the arena
+  REQUIRE(arena.create(1, 5000).get() == nullptr);
+
+  // A new timeslice gets a new block.
+  auto m3 = arena.create(2, 10);
+  REQUIRE(m3.get() != nullptr);
+  REQUIRE(arena.freeBlocks() == 2);
+
+  // Once all the messages of the first timeslice are gone, its block
+  // can be reused.
+  m1.reset();
+  m2.reset();
+  REQUIRE(waitForFreeBlocks(arena, 3));
+  m3.reset();
+  // The current block is never returned to the pool.
+  REQUIRE(waitForFreeBlocks(arena, 3));
+  auto m4 = arena.create(3, 10);
+  REQUIRE(waitForFreeBlocks(arena, 3));
+}
+
+TEST_CASE("TestMessageArenaExhausted")
+{
+  auto transport = fair::mq::TransportFactory::CreateTransportFactory("zeromq");
+  MessageArena arena{transport.get(), 2 * 65536, 2};
+  std::vector<std::unique_ptr<fair::mq::Message>> messages;
+  for (size_t ts = 0; ts < 2; ++ts) {
+    messages.emplace_back(arena.create(ts, 10));
+    REQUIRE(messages.back().get() != nullptr);
+  }
+  // All the blocks are referenced, so we need to fall back.
+  REQUIRE(arena.create(2, 10).get() == nullptr);
+  REQUIRE(arena.freeBlocks() == 0);
+}
@@ -0,0 +1,113 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Framework/MixingEngine.h"
+#include "Framework/TableBuilder.h"
+#include "Framework/AnalysisDataModel.h"
+#include "Framework/ArrowTableSlicingCache.h"
+#include <catch_amalgamated.hpp>
+#include <algorithm>
+#include <array>
+#include <random>
+
+using namespace o2::framework;
+using namespace o2::soa;
+
+using MixedRows = std::array<int64_t, 4>;
+using BinningType = ColumnBinningPolicy<o2::aod::collision::PosX>;
+
+TEST_CASE("MixingEngine")
+{
+  std::default_random_engine e1(1234567891);
+  std::uniform_real_distribution<float> uniform_dist(0.f, 1.f);
+  std::uniform_int_distribution<int> uniform_dist_tracks(0, 6);
+
+  TableBuilder colBuilder, trackBuilder;
+  auto rowWriterCol = colBuilder.cursor<o2::aod::Collisions>();
+  auto rowWriterTrack = trackBuilder.cursor<o2::aod::StoredTracks>();
+  constexpr int nCollisions = 50;
+  for (auto i = 0; i < nCollisions; ++i) {
+    rowWriterCol(0, 0, uniform_dist(e1), 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0, 0.f, 0, 0.f, 0.f);
+    for (auto ti = uniform_dist_tracks(e1); ti > 0; --ti) {
+      rowWriterTrack(0, i, 0, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+    }
+  }
+  auto tableCol = colBuilder.finalize();
+  auto tableTrack = trackBuilder.finalize();
+  o2::aod::Collisions collisions{tableCol};
+  o2::aod::StoredTracks tracks{tableTrack};
+
+  std::vector<double> xBins{VARIABLE_WIDTH, 0., 0.25, 0.5, 0.75, 1.};
+  BinningType binning{{xBins}, true};
+  constexpr int catNeighbours = 3;
+
+  ArrowTableSlicingCache atscache{{{getLabelFromType<o2::aod::StoredTracks>(), "fIndex" + getLabelFromType<o2::aod::Collisions>()}}};
+  auto s = atscache.updateCacheEntry(0, tableTrack);
+  SliceCache cache{&atscache};
+
+  std::vector<MixedRows> expected;
+  auto tracksTuple = std::make_tuple(tracks);
+  SameKindPair<o2::aod::Collisions, o2::aod::StoredTracks, BinningType> pair{binning, catNeighbours, -1, collisions, tracksTuple, &cache};
+  for (auto& [c1, tracks1, c2, tracks2] : pair) {
+    for (auto& [t1, t2] : combinations(CombinationsFullIndexPolicy(tracks1, tracks2))) {
+      expected.push_back({c1.globalIndex(), c2.globalIndex(), t1.globalIndex(), t2.globalIndex()});
+    }
+  }
+  REQUIRE(expected.size() > 0);
+
+  using Engine = MixingEngine<BinningType, int, o2::aod::Collisions, o2::aod::StoredTracks>;
+  auto runWith = [&](Engine& engine, MixingEngineOptions options) {
+    // Catch2 assertions are not thread safe, check the batches afterwards.
+    std::vector<std::vector<MixedRows>> result(options.threads);
+    std::vector<int> invalid(options.threads, 0);
+    engine.process(collisions, tracks, [&](int thread, MixedPairsBatch const& batch) {
+      if (batch.size() > options.batchSize || batch.bin != binning.getBin({collisions.rawIteratorAt(batch.collision1).posX()})) {
+        invalid[thread]++;
+      }
+      for (size_t pi = 0; pi < batch.size(); ++pi) {
+        result[thread].push_back({batch.collision1, batch.collision2, batch.first[pi], batch.second[pi]});
+      }
+    });
+    REQUIRE(std::count(invalid.begin(), invalid.end(), 0) == options.threads);
+    return result;
+  };
+  auto run = [&](MixingEngineOptions options) {
+    Engine engine{binning, catNeighbours, -1, options};
+    return runWith(engine, options);
+  };
+
+  // A single thread gives the same pairs, in the same order.
+  auto single = run({.threads = 1, .deterministic = false, .batchSize = 7});
+  REQUIRE(single[0] == expected);
+
+  // Multiple threads give the same pairs, each of them once.
+  auto parallel = run({.threads = 4, .deterministic = false, .batchSize = 7});
+  std::vector<MixedRows> merged;
+  for (auto& rows : parallel) {
+    merged.insert(merged.end(), rows.begin(), rows.end());
+  }
+  std::sort(merged.begin(), merged.end());
+  std::sort(expected.begin(), expected.end());
+  REQUIRE(merged == expected);
+
+  // The deterministic mode always gives the same pairs to the same thread,
+  // also when the threads of the engine are reused.
+  MixingEngineOptions options{.threads = 3, .deterministic = true, .batchSize = 5};
+  auto deterministic = run(options);
+  Engine engine{binning, catNeighbours, -1, options};
+  for (int i = 0; i < 5; ++i) {
+    REQUIRE(run(options) == deterministic);
+    REQUIRE(runWith(engine, options) == deterministic);
+  }
+
+  // A single thread is the default.
+  REQUIRE(run({.batchSize = 7}) == single);
+}
@@ -0,0 +1,162 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include <catch_amalgamated.hpp>
+#include "Framework/SendQueue.h"
+#include <fairmq/TransportFactory.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace o2::framework;
+
+namespace
+{
+fair::mq::Parts makeParts(fair::mq::TransportFactory& transport, int value)
+{
+  fair::mq::Parts parts;
+  auto message = transport.CreateMessage(sizeof(int));
+  memcpy(message->GetData(), &value, sizeof(int));
+  parts.AddPart(std::move(message));
+  return parts;
+}
+
+int partValue(fair::mq::Parts& parts)
+{
+  int value;
+  memcpy(&value, parts.At(0)->GetData(), sizeof(int));
+  return value;
+}
+} // namespace
+
+TEST_CASE("TestSendQueueOrdering")
+{
+  auto transport = fair::mq::TransportFactory::CreateTransportFactory("zeromq");
+  std::vector<std::pair<int, int>> sent;
+  SendQueue queue(4, [&sent](fair::mq::Parts& parts, ChannelIndex index) {
+    sent.emplace_back(partValue(parts), index.value);
+  });
+  for (int i = 0; i < 100; ++i) {
+    auto parts = makeParts(*transport, i);
+    queue.push(parts, ChannelIndex{i % 3});
+  }
+  queue.flush();
+  // A single FIFO keeps the order also across channels.
+  REQUIRE(sent.size() == 100);
+  for (int i = 0; i < 100; ++i) {
+    REQUIRE(sent[i].first == i);
+    REQUIRE(sent[i].second == i % 3);
+  }
+}
+
+TEST_CASE("TestSendQueueBackpressure")
+{
+  auto transport = fair::mq::TransportFactory::CreateTransportFactory("zeromq");
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  std::atomic<int> started = 0;
+  SendQueue queue(2, [&started, released](fair::mq::Parts&, ChannelIndex) {
+    started++;
+    released.wait();
+  });
+  // The first one is taken by the sender thread, which then blocks.
+  auto first = makeParts(*transport, 0);
+  queue.push(first, ChannelIndex{0});
+  while (started == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  // Two more fill the queue.
+  for (int i = 1; i < 3; ++i) {
+    auto parts = makeParts(*transport, i);
+    queue.push(parts, ChannelIndex{0});
+  }
+  // The next one must wait for the sender thread.
+  auto blocked = std::async(std::launch::async, [&queue, &transport]() {
+    auto parts = makeParts(*transport, 3);
+    queue.push(parts, ChannelIndex{0});
+  });
+  REQUIRE(blocked.wait_for(std::chrono::milliseconds(100)) == std::future_status::timeout);
+  release.set_value();
+  REQUIRE(blocked.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+  queue.flush();
+  REQUIRE(started == 4);
+}
+
+TEST_CASE("TestSendQueueFlush")
+{
+  auto transport = fair::mq::TransportFactory::CreateTransportFactory("zeromq");
+  std::atomic<int> sent = 0;
+  SendQueue queue(8, [&sent](fair::mq::Parts&, ChannelIndex) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    sent++;
+  });
+  for (int i = 0; i < 5; ++i) {
+    auto parts = makeParts(*transport, i);
+    queue.push(parts, ChannelIndex{0});
+  }
+  // What comes after a flush (e.g. the end of stream) cannot overtake the data.
+  queue.flush();
+  REQUIRE(sent == 5);
+  // Flushing an empty queue does not block.
+  queue.flush();
+}
+
+TEST_CASE("TestSendQueueDrainOnDestruction")
+{
+  auto transport = fair::mq::TransportFactory::CreateTransportFactory("zeromq");
+  std::atomic<int> sent = 0;
+  {
+    SendQueue queue(16, [&sent](fair::mq::Parts&, ChannelIndex) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      sent++;
+    });
+    for (int i = 0; i < 10; ++i) {
+      auto parts = makeParts(*transport, i);
+      queue.push(parts, ChannelIndex{0});
+    }
+  }
+  REQUIRE(sent == 10);
+}
+
+TEST_CASE("TestSendQueueError")
+{
+  auto transport = fair::mq::TransportFactory::CreateTransportFactory("zeromq");
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  std::vector<int> sent;
+  SendQueue queue(4, [&sent, released](fair::mq::Parts& parts, ChannelIndex) {
+    auto value = partValue(parts);
+    released.wait();
+    if (value == 1) {
+      throw std::runtime_error("channel error");
+    }
+    sent.push_back(value);
+  });
+  for (int i = 0; i < 3; ++i) {
+    auto parts = makeParts(*transport, i);
+    queue.push(parts, ChannelIndex{0});
+  }
+  release.set_value();
+  // The failure is reported on the calling thread, only once.
+  REQUIRE_THROWS_AS(queue.flush(), std::runtime_error);
+  queue.flush();
+  // The parts queued after the failure are dropped, not sent out of order.
+  REQUIRE(sent == std::vector<int>{0});
+  // Sending works again afterwards.
+  auto parts = makeParts(*transport, 3);
+  queue.push(parts, ChannelIndex{0});
+  queue.flush();
+  REQUIRE(sent == std::vector<int>{0, 3});
+}
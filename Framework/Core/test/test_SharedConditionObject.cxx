@@ -0,0 +1,102 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include <catch_amalgamated.hpp>
+#include "Framework/SharedConditionObject.h"
+#include <cstring>
+#include <unistd.h>
+
+using namespace o2::framework;
+
+namespace
+{
+/// Minimal object with the same relocation interface as a FlatObject
+struct ToyFlatObject {
+  int value = 0;
+  size_t size = 0;
+  char* buffer = nullptr;
+
+  void cloneFromObject(ToyFlatObject const& other, char* newBuffer)
+  {
+    value = other.value;
+    size = other.size;
+    buffer = newBuffer;
+    memcpy(buffer, other.buffer, size);
+  }
+  void setActualBufferAddress(char* actual) { buffer = actual; }
+  [[nodiscard]] size_t getFlatBufferSize() const { return size; }
+};
+
+char payload[] = "shared payload";
+} // namespace
+
+static_assert(ShareableFlatObject<ToyFlatObject>);
+static_assert(ShareableFlatObject<int> == false);
+
+TEST_CASE("SharedConditionObject")
+{
+  auto name = SharedConditionRegion::nameFor(fmt::format("etag-{}", getpid()), "ToyFlatObject");
+  REQUIRE(name.size() <= 31);
+  REQUIRE(name != SharedConditionRegion::nameFor(fmt::format("etag-{}", getpid()), "OtherType"));
+
+  int deserialised = 0;
+  auto deserialise = [&deserialised]() -> ToyFlatObject* {
+    deserialised++;
+    return new ToyFlatObject{42, sizeof(payload), payload};
+  };
+  std::function<void()> release1;
+  std::function<void()> release2;
+  auto* first = SharedConditionObject::get<ToyFlatObject>(name, deserialise, release1);
+  auto* second = SharedConditionObject::get<ToyFlatObject>(name, deserialise, release2);
+  REQUIRE(first != nullptr);
+  REQUIRE(second != nullptr);
+  // Only the first one actually deserialises the object.
+  REQUIRE(deserialised == 1);
+  REQUIRE(first != second);
+  REQUIRE(first->value == 42);
+  REQUIRE(second->value == 42);
+  REQUIRE(std::string_view(first->buffer) == "shared payload");
+  REQUIRE(std::string_view(second->buffer) == "shared payload");
+  // Mappings are private, modifying one does not affect the other.
+  first->buffer[0] = 'S';
+  REQUIRE(second->buffer[0] == 's');
+
+  release1();
+  REQUIRE(SharedConditionRegion::attach(name) != nullptr);
+  release2();
+  // The last user removes the region.
+  REQUIRE(SharedConditionRegion::attach(name) == nullptr);
+}
+
+TEST_CASE("SharedConditionObjectCleanup")
+{
+  auto session = fmt::format("test_{}", getpid());
+  SharedConditionRegion::setSession(session);
+  auto name = SharedConditionRegion::nameFor("etag", "ToyFlatObject");
+  SharedConditionRegion::setSession(fmt::format("other_{}", getpid()));
+  REQUIRE(name != SharedConditionRegion::nameFor("etag", "ToyFlatObject"));
+  REQUIRE(name.size() <= 31);
+
+  // A device which dies while using the region never releases it.
+  auto region = SharedConditionRegion::claim(name);
+  REQUIRE(region != nullptr);
+  REQUIRE(region->allocate(sizeof(payload)) != nullptr);
+  region->publish();
+  region.release();
+  REQUIRE(SharedConditionRegion::attach(name) != nullptr);
+
+  // Cleaning up another session does not touch it.
+  SharedConditionRegion::cleanup(fmt::format("other_{}", getpid()));
+  REQUIRE(SharedConditionRegion::attach(name) != nullptr);
+  SharedConditionRegion::cleanup(session);
+  REQUIRE(SharedConditionRegion::attach(name) == nullptr);
+  SharedConditionRegion::setSession("");
+}
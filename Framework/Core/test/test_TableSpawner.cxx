@@ -72,3 +72,51 @@ TEST_CASE("TestTableSpawner")
     ++rexp_a;
   }
 }
+
+TEST_CASE("TestTableSpawnerCache")
+{
+  auto makePoints = [](float scale) {
+    TableBuilder b;
+    auto w = b.cursor<Points>();
+    for (auto i = 1; i < 10; ++i) {
+      w(0, i * scale, i * 3., i * 4.);
+    }
+    return b.finalize();
+  };
+  auto spawn = [](std::shared_ptr<arrow::Table> const& table) {
+    return o2::framework::spawner<o2::aod::Hash<"EXPTSNG/0"_h>>(table, o2::aod::Hash<"ExPoints"_h>::str);
+  };
+
+  // Spawning again from the same data reuses the columns.
+  auto t1 = makePoints(2.);
+  auto first = spawn(t1);
+  auto second = spawn(t1);
+  REQUIRE(first->column(0)->chunk(0) == second->column(0)->chunk(0));
+  REQUIRE(first->column(1)->chunk(0) == second->column(1)->chunk(0));
+
+  // A slice of the same data is a different batch.
+  auto sliced = spawn(t1->Slice(2, 5));
+  REQUIRE(sliced->num_rows() == 5);
+  REQUIRE(sliced->column(0)->chunk(0) != first->column(0)->chunk(0));
+  ExPointsExtension slicedExtension{sliced};
+  auto i = 3;
+  for (auto& row : slicedExtension) {
+    REQUIRE(row.rsq() == (float)(i * i * 4 + i * i * 9 + i * i * 16));
+    ++i;
+  }
+
+  // Other data is spawned again, even if the previous one is gone.
+  t1.reset();
+  first.reset();
+  second.reset();
+  sliced.reset();
+  REQUIRE(pruneSpawnedBatches() == 0);
+  auto t2 = makePoints(5.);
+  ExPointsExtension extension{spawn(t2)};
+  i = 1;
+  for (auto& row : extension) {
+    REQUIRE(row.rsq() == (float)(i * i * 25 + i * i * 9 + i * i * 16));
+    ++i;
+  }
+  REQUIRE(i == 10);
+}
@@ -0,0 +1,72 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include <catch_amalgamated.hpp>
+#include "Framework/TimeslicesInFlight.h"
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace o2::framework;
+using RecordAction = o2::framework::DataRelayer::RecordAction;
+
+TEST_CASE("TestTimeslicesInFlight")
+{
+  DataProcessorContext context;
+  context.streams = 3;
+
+  // Each stream got one timeslice, in the same way tryDispatchComputation
+  // registers them while holding the streamsMutex.
+  std::vector<std::unique_ptr<TimeslicesInFlight>> streams;
+  {
+    std::lock_guard<std::mutex> lock(context.streamsMutex);
+    for (size_t timeslice : {2, 0, 1}) {
+      std::vector<RecordAction> actions{RecordAction{TimesliceSlot{timeslice}, TimesliceId{timeslice}, CompletionPolicy::CompletionOp::Consume}};
+      streams.push_back(std::make_unique<TimeslicesInFlight>(context, actions));
+    }
+    REQUIRE(context.timeslicesInFlight.size() == 3);
+  }
+
+  // The older the timeslice, the longer the processing, so that without
+  // waiting the outputs would be sent in the reverse order.
+  std::vector<size_t> sent;
+  std::vector<std::thread> threads;
+  for (auto& stream : streams) {
+    threads.emplace_back([&context, &sent, &stream]() {
+      size_t timeslice = stream->owned.front();
+      std::unique_lock<std::mutex> lock(context.streamsMutex);
+      {
+        StreamsUnlock unlock{&lock};
+        std::this_thread::sleep_for(std::chrono::milliseconds(20 * (3 - timeslice)));
+      }
+      stream->waitForOlder(timeslice, &lock);
+      sent.push_back(timeslice);
+      stream->release(timeslice);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  REQUIRE(sent == std::vector<size_t>{0, 1, 2});
+  REQUIRE(context.timeslicesInFlight.empty());
+}
+
+TEST_CASE("TestTimeslicesInFlightSingleStream")
+{
+  // With a single stream nothing is tracked and nothing waits.
+  DataProcessorContext context;
+  std::vector<RecordAction> actions{RecordAction{TimesliceSlot{0}, TimesliceId{1}, CompletionPolicy::CompletionOp::Consume}};
+  TimeslicesInFlight inFlight{context, actions};
+  REQUIRE(context.timeslicesInFlight.empty());
+  inFlight.waitForOlder(1, nullptr);
+  inFlight.release(1);
+}
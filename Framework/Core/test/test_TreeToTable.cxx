@@ -11,6 +11,8 @@
 
 #include <catch_amalgamated.hpp>
 
+#include "Framework/AnalysisDataModel.h"
+#include "Framework/ArrowTableSlicingCache.h"
 #include "Framework/CommonDataProcessors.h"
 #include "Framework/TableTreeHelpers.h"
 #include "Framework/Logger.h"
@@ -235,3 +237,137 @@ TEST_CASE("VariableLists")
     ++i;
   }
 }
+
+TEST_CASE("SliceIndexRoundTrip")
+{
+  std::vector<int32_t> indices{0, 0, 0, 2, 2, -1, -1, 5};
+  arrow::Int32Builder indexBuilder;
+  arrow::FloatBuilder xBuilder;
+  std::shared_ptr<arrow::Array> indexArray;
+  std::shared_ptr<arrow::Array> xArray;
+  REQUIRE(indexBuilder.AppendValues(indices).ok());
+  REQUIRE(indexBuilder.Finish(&indexArray).ok());
+  REQUIRE(xBuilder.AppendValues(std::vector<float>(indices.size(), 1.f)).ok());
+  REQUIRE(xBuilder.Finish(&xArray).ok());
+  auto schema = arrow::schema({arrow::field("fIndexEvents", arrow::int32()), arrow::field("fX", arrow::float32())});
+  auto table = arrow::Table::Make(schema, {indexArray, xArray});
+
+  TFile* f = TFile::Open("sliceindex.root", "RECREATE");
+  TableToTree ta2tr(table, f, "tracks");
+  ta2tr.enableSliceIndices();
+  ta2tr.addAllBranches();
+  ta2tr.process();
+  f->Close();
+
+  f = TFile::Open("sliceindex.root");
+  auto* tree = static_cast<TTree*>(f->Get("tracks"));
+  TreeToTable tr2ta;
+  tr2ta.setLabel("tracks");
+  tr2ta.addAllColumns(tree);
+  tr2ta.fill(tree);
+  auto read = tr2ta.finalize();
+  f->Close();
+
+  auto const& metadata = read->schema()->metadata();
+  REQUIRE(metadata->Get("label").ValueOrDie() == "tracks");
+  REQUIRE(metadata->FindKey(ArrowTableSlicingCache::precomputedValuesKey("fIndexEvents")) != -1);
+  REQUIRE(metadata->FindKey(ArrowTableSlicingCache::precomputedValuesKey("fX")) == -1);
+
+  ArrowTableSlicingCache cache({{"tracks", "fIndexEvents"}});
+  REQUIRE(cache.usePrecomputed(0, read));
+  REQUIRE(cache.updateCacheEntry(0, read).ok());
+  auto slices = cache.getCacheForPos(0);
+  REQUIRE(std::vector<int>(slices.values.begin(), slices.values.end()) == std::vector<int>{0, 2, -1, 5});
+  REQUIRE(std::vector<int64_t>(slices.counts.begin(), slices.counts.end()) == std::vector<int64_t>{3, 2, 2, 1});
+  REQUIRE(slices.getSliceFor(2) == std::make_pair<int64_t, int64_t>(3, 2));
+
+  // Groups which do not describe the table are ignored
+  std::shared_ptr<arrow::Array> otherArray;
+  REQUIRE(indexBuilder.AppendValues(std::vector<int32_t>{0, 0, 1, 2, 2, -1, -1, 5}).ok());
+  REQUIRE(indexBuilder.Finish(&otherArray).ok());
+  auto other = arrow::Table::Make(read->schema(), {otherArray, xArray});
+  REQUIRE(cache.usePrecomputed(0, other) == false);
+  REQUIRE(cache.updateCacheEntry(0, other).ok());
+  REQUIRE(cache.getCacheForPos(0).getSliceFor(1) == std::make_pair<int64_t, int64_t>(2, 1));
+
+  // Unsorted columns are not indexed
+  std::shared_ptr<arrow::Array> unsortedArray;
+  REQUIRE(indexBuilder.AppendValues(std::vector<int32_t>{0, 0, 1, 0, 2, -1, -1, 5}).ok());
+  REQUIRE(indexBuilder.Finish(&unsortedArray).ok());
+  f = TFile::Open("sliceindex.root", "RECREATE");
+  auto unsortedTable = arrow::Table::Make(schema, {unsortedArray, xArray});
+  TableToTree unsorted(unsortedTable, f, "tracks");
+  unsorted.enableSliceIndices();
+  unsorted.addAllBranches();
+  auto unsortedTree = unsorted.process();
+  REQUIRE(unsortedTree->GetUserInfo()->GetEntries() == 0);
+  f->Close();
+}
+
+TEST_CASE("ColumnCodecRoundTrip")
+{
+  // The codec of the data model is passed along with the table
+  TableBuilder builder;
+  auto cursor = builder.cursor<o2::aod::StoredTracks>();
+  std::vector<int32_t> collisions{0, 0, 0, 1, 3, 3, -1, -1};
+  for (auto collision : collisions) {
+    cursor(0, collision, 0, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  }
+  auto table = builder.finalize();
+  auto const& metadata = table->schema()->GetFieldByName("fIndexCollisions")->metadata();
+  REQUIRE(metadata != nullptr);
+  REQUIRE(metadata->Get(o2::soa::columnCodecKey).ValueOrDie() == "delta");
+  REQUIRE(table->schema()->GetFieldByName("fX")->metadata() == nullptr);
+
+  TFile* f = TFile::Open("columncodec.root", "RECREATE");
+  TableToTree plain(table, f, "plain");
+  plain.addAllBranches();
+  REQUIRE(plain.process()->GetUserInfo()->GetEntries() == 0);
+  TableToTree ta2tr(table, f, "tracks");
+  ta2tr.enableColumnCodecs();
+  ta2tr.addAllBranches();
+  ta2tr.process();
+  f->Close();
+
+  // Rows appended to the tree carry on from the last value
+  f = TFile::Open("columncodec.root", "UPDATE");
+  TableToTree appended(table, f, "tracks");
+  appended.addAllBranches();
+  appended.process();
+  f->Close();
+
+  f = TFile::Open("columncodec.root");
+  auto* tree = static_cast<TTree*>(f->Get("tracks"));
+  REQUIRE(tree->GetEntries() == (int64_t)(2 * collisions.size()));
+  REQUIRE(tree->GetUserInfo()->FindObject("columnCodec_fIndexCollisions_delta") != nullptr);
+  // Readers unaware of the codec do not find the column
+  REQUIRE(tree->GetBranch("fIndexCollisions") == nullptr);
+  REQUIRE(columnBranch(tree, "fIndexCollisions") == tree->GetBranch("fIndexCollisions_delta"));
+  REQUIRE(columnName(tree->GetBranch("fIndexCollisions_delta")) == "fIndexCollisions");
+  REQUIRE(columnName(tree->GetBranch("fX")) == "fX");
+  int32_t stored = 0;
+  tree->SetBranchAddress("fIndexCollisions_delta", &stored);
+  std::vector<int32_t> deltas;
+  for (auto i = 0; i < tree->GetEntries(); ++i) {
+    tree->GetEntry(i);
+    deltas.push_back(stored);
+  }
+  REQUIRE(deltas == std::vector<int32_t>{0, 0, 0, 1, 2, 0, -4, 0, 1, 0, 0, 1, 2, 0, -4, 0});
+  f->Close();
+
+  f = TFile::Open("columncodec.root");
+  tree = static_cast<TTree*>(f->Get("tracks"));
+  TreeToTable tr2ta;
+  tr2ta.setLabel("tracks");
+  tr2ta.addAllColumns(tree);
+  tr2ta.fill(tree);
+  auto read = tr2ta.finalize();
+  f->Close();
+
+  auto column = std::static_pointer_cast<arrow::Int32Array>(read->GetColumnByName("fIndexCollisions")->chunk(0));
+  std::vector<int32_t> values(column->raw_values(), column->raw_values() + column->length());
+  auto expected = collisions;
+  expected.insert(expected.end(), collisions.begin(), collisions.end());
+  REQUIRE(values == expected);
+  REQUIRE(read->schema()->GetFieldByName("fIndexCollisions")->metadata()->Get(o2::soa::columnCodecKey).ValueOrDie() == "delta");
+}
@@ -0,0 +1,79 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include <catch_amalgamated.hpp>
+#include "Framework/WorkerPool.h"
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace o2::framework;
+
+TEST_CASE("WorkerPoolRun")
+{
+  WorkerPool pool;
+  std::mutex mutex;
+  std::set<std::thread::id> threadIds;
+  for (int round = 0; round < 20; ++round) {
+    std::vector<int> done(100, 0);
+    pool.run(done.size(), 4, [&](size_t i) {
+      done[i]++;
+      std::lock_guard<std::mutex> lock(mutex);
+      threadIds.insert(std::this_thread::get_id());
+    });
+    for (auto d : done) {
+      REQUIRE(d == 1);
+    }
+  }
+  // The same threads are used for all the rounds.
+  REQUIRE(pool.workers() == 3);
+  REQUIRE(threadIds.size() <= 4);
+
+  // A single thread, or a single job, runs in the caller.
+  pool.run(10, 1, [](size_t) { REQUIRE(true); });
+  std::thread::id caller;
+  pool.run(1, 4, [&caller](size_t) { caller = std::this_thread::get_id(); });
+  REQUIRE(caller == std::this_thread::get_id());
+  REQUIRE(pool.workers() == 3);
+}
+
+TEST_CASE("WorkerPoolErrors")
+{
+  WorkerPool pool;
+  std::atomic<int> started = 0;
+  REQUIRE_THROWS_AS(pool.run(1000, 4, [&started](size_t i) {
+                      started++;
+                      if (i == 5) {
+                        throw std::runtime_error("failed");
+                      }
+                    }),
+                    std::runtime_error);
+  // No new job is started after the failure is noticed.
+  REQUIRE(started < 1000);
+  // The pool can be used again.
+  std::atomic<int> count = 0;
+  pool.run(100, 4, [&count](size_t) { count++; });
+  REQUIRE(count == 100);
+}
+
+TEST_CASE("WorkerPoolNested")
+{
+  WorkerPool pool;
+  std::atomic<int> count = 0;
+  // A run from within a job does not wait for the pool, it runs sequentially.
+  pool.run(4, 4, [&pool, &count](size_t) {
+    pool.run(10, 4, [&count](size_t) { count++; });
+  });
+  REQUIRE(count == 40);
+}
@@ -108,6 +108,7 @@ void ransDecodeBenchmark(benchmark::State& st, Args&&... args)
   auto args_tuple = std::make_tuple(std::move(args)...);
 
   const auto& inputData = std::get<0>(args_tuple).get();
+  const DecoderKernel kernel = std::get<1>(args_tuple);
 
   using input_data_type = std::remove_cv_t<std::remove_reference_t<decltype(inputData)>>;
   using source_type = typename input_data_type::value_type;
@@ -123,6 +124,7 @@ void ransDecodeBenchmark(benchmark::State& st, Args&&... args)
   encodeBuffer.encodeBufferEnd = encoder.process(inputData.data(), inputData.data() + inputData.size(), encodeBuffer.buffer.data());
 
   auto decoder = makeDecoder<>::fromRenormed(renormedHistogram);
+  decoder.setKernel(kernel);
 #ifdef ENABLE_VTUNE_PROFILER
   __itt_resume();
 #endif
@@ -140,6 +142,7 @@ void ransDecodeBenchmark(benchmark::State& st, Args&&... args)
   const auto& datasetProperties = metrics.getDatasetProperties();
   st.SetItemsProcessed(static_cast<int64_t>(inputData.size()) * static_cast<int64_t>(st.iterations()));
   st.SetBytesProcessed(static_cast<int64_t>(inputData.size()) * sizeof(source_type) * static_cast<int64_t>(st.iterations()));
+  st.counters["Kernel"] = static_cast<double>(internal::simd::selectDecoderKernel(kernel, encoder.getNStreams()));
   st.counters["AlphabetRangeBits"] = datasetProperties.alphabetRangeBits;
   st.counters["nUsedAlphabetSymbols"] = datasetProperties.nUsedAlphabetSymbols;
   st.counters["SymbolTablePrecision"] = renormedHistogram.getRenormingBits();
@@ -156,8 +159,16 @@ void ransDecodeBenchmark(benchmark::State& st, Args&&... args)
 // BENCHMARK_CAPTURE(ransDecodeBenchmark, decode_binomial_16, sourceMessageBinomial16);
 // BENCHMARK_CAPTURE(ransDecodeBenchmark, decode_binomial_32, sourceMessageBinomial32);
 
-BENCHMARK_CAPTURE(ransDecodeBenchmark, decode_uniform_8, sourceMessageUniform8);
-BENCHMARK_CAPTURE(ransDecodeBenchmark, decode_uniform_16, sourceMessageUniform16);
-BENCHMARK_CAPTURE(ransDecodeBenchmark, decode_uniform_32, sourceMessageUniform32);
+BENCHMARK_CAPTURE(ransDecodeBenchmark, decode_uniform_8_scalar, sourceMessageUniform8, DecoderKernel::Scalar);
+BENCHMARK_CAPTURE(ransDecodeBenchmark, decode_uniform_16_scalar, sourceMessageUniform16, DecoderKernel::Scalar);
+BENCHMARK_CAPTURE(ransDecodeBenchmark, decode_uniform_32_scalar, sourceMessageUniform32, DecoderKernel::Scalar);
+
+BENCHMARK_CAPTURE(ransDecodeBenchmark, decode_uniform_8_avx2, sourceMessageUniform8, DecoderKernel::AVX2);
+BENCHMARK_CAPTURE(ransDecodeBenchmark, decode_uniform_16_avx2, sourceMessageUniform16, DecoderKernel::AVX2);
+BENCHMARK_CAPTURE(ransDecodeBenchmark, decode_uniform_32_avx2, sourceMessageUniform32, DecoderKernel::AVX2);
+
+BENCHMARK_CAPTURE(ransDecodeBenchmark, decode_uniform_8_avx512, sourceMessageUniform8, DecoderKernel::AVX512);
+BENCHMARK_CAPTURE(ransDecodeBenchmark, decode_uniform_16_avx512, sourceMessageUniform16, DecoderKernel::AVX512);
+BENCHMARK_CAPTURE(ransDecodeBenchmark, decode_uniform_32_avx512, sourceMessageUniform32, DecoderKernel::AVX512);
 
 BENCHMARK_MAIN();
\ No newline at end of file
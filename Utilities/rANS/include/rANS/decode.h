@@ -23,5 +23,6 @@
 #include "rANS/internal/containers/DenseSymbolTable.h"
 #include "rANS/internal/containers/Symbol.h"
 #include "rANS/internal/decode/Decoder.h"
+#include "rANS/internal/decode/ConditionalDecoder.h"
 
 #endif /* RANS_DECODE_H_ */
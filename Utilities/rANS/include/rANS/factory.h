@@ -37,6 +37,7 @@
 #include "rANS/internal/containers/SparseHistogram.h"
 
 #include "rANS/internal/containers/RenormedHistogram.h"
+#include "rANS/internal/containers/ConditionalHistogram.h"
 
 #include "rANS/internal/containers/LowRangeDecoderTable.h"
 #include "rANS/internal/containers/HighRangeDecoderTable.h"
@@ -45,9 +46,11 @@
 #include "rANS/internal/encode/Encoder.h"
 #include "rANS/internal/encode/SingleStreamEncoderImpl.h"
 #include "rANS/internal/encode/SIMDEncoderImpl.h"
+#include "rANS/internal/encode/ConditionalEncoder.h"
 
 #include "rANS/internal/decode/Decoder.h"
 #include "rANS/internal/decode/DecoderImpl.h"
+#include "rANS/internal/decode/ConditionalDecoder.h"
 
 namespace o2::rans
 {
@@ -225,6 +228,80 @@ class makeDecoder
   };
 };
 
+struct makeConditionalHistogram {
+  template <typename source_IT, typename context_IT>
+  [[nodiscard]] inline static decltype(auto) fromSamples(source_IT begin, source_IT end, context_IT contextBegin, size_t nContexts)
+  {
+    using source_type = typename std::iterator_traits<source_IT>::value_type;
+
+    ConditionalHistogram<source_type> f{nContexts};
+    f.addSamples(begin, end, contextBegin);
+    return f;
+  };
+};
+
+// The conditional coders switch the symbol table with every symbol, which rules out the SIMD encoders working on
+// a single table. The scalar coders are interleaved over nStreams_V states instead to keep the pipelines busy.
+template <size_t nStreams_V = 8,
+          size_t renormingLowerBound_V = defaults::internal::RenormingLowerBound>
+class makeConditionalEncoder
+{
+  using this_type = makeConditionalEncoder<nStreams_V, renormingLowerBound_V>;
+  using coder_type = internal::CompatEncoderImpl<renormingLowerBound_V>;
+
+ public:
+  template <typename source_T>
+  [[nodiscard]] inline static decltype(auto) fromRenormed(const RenormedConditionalHistogram<source_T>& renormed)
+  {
+    using symbolTable_type = DenseSymbolTable<source_T, internal::Symbol>;
+    return ConditionalEncoder<coder_type, symbolTable_type, nStreams_V>{renormed};
+  };
+
+  template <typename source_T>
+  [[nodiscard]] inline static decltype(auto) fromHistogram(ConditionalHistogram<source_T> histogram, RenormingPolicy renormingPolicy = RenormingPolicy::Auto)
+  {
+    const auto renormedHistogram = renorm(std::move(histogram), renormingPolicy);
+    return this_type::fromRenormed(renormedHistogram);
+  };
+
+  template <typename source_T>
+  [[nodiscard]] inline static decltype(auto) fromHistogram(ConditionalHistogram<source_T> histogram, size_t renormingPrecision, RenormingPolicy renormingPolicy = RenormingPolicy::Auto)
+  {
+    const auto renormedHistogram = renorm(std::move(histogram), renormingPrecision, renormingPolicy);
+    return this_type::fromRenormed(renormedHistogram);
+  };
+};
+
+// Every context holds a full reverse lookup table of 2^precision entries,
+// keep the number of contexts and the precision moderate.
+template <size_t renormingLowerBound_V = defaults::internal::RenormingLowerBound>
+class makeConditionalDecoder
+{
+  using this_type = makeConditionalDecoder<renormingLowerBound_V>;
+  using coder_type = internal::DecoderImpl<renormingLowerBound_V>;
+
+ public:
+  template <typename source_T>
+  [[nodiscard]] inline static decltype(auto) fromRenormed(const RenormedConditionalHistogram<source_T>& renormed)
+  {
+    return ConditionalDecoder<coder_type, LowRangeDecoderTable<source_T>>{renormed};
+  };
+
+  template <typename source_T>
+  [[nodiscard]] inline static decltype(auto) fromHistogram(ConditionalHistogram<source_T> histogram, RenormingPolicy renormingPolicy = RenormingPolicy::Auto)
+  {
+    const auto renormedHistogram = renorm(std::move(histogram), renormingPolicy);
+    return this_type::fromRenormed(renormedHistogram);
+  };
+
+  template <typename source_T>
+  [[nodiscard]] inline static decltype(auto) fromHistogram(ConditionalHistogram<source_T> histogram, size_t renormingPrecision, RenormingPolicy renormingPolicy = RenormingPolicy::Auto)
+  {
+    const auto renormedHistogram = renorm(std::move(histogram), renormingPrecision, renormingPolicy);
+    return this_type::fromRenormed(renormedHistogram);
+  };
+};
+
 template <typename source_T>
 using denseEncoder_type = decltype(makeDenseEncoder<>::fromRenormed(RenormedDenseHistogram<source_T>{}));
 
@@ -237,6 +314,12 @@ using sparseEncoder_type = decltype(makeSparseEncoder<>::fromRenormed(RenormedSp
 template <typename source_T>
 using defaultDecoder_type = decltype(makeDecoder<>::fromRenormed(RenormedDenseHistogram<source_T>{}));
 
+template <typename source_T>
+using conditionalEncoder_type = decltype(makeConditionalEncoder<>::fromRenormed(RenormedConditionalHistogram<source_T>{}));
+
+template <typename source_T>
+using conditionalDecoder_type = decltype(makeConditionalDecoder<>::fromRenormed(RenormedConditionalHistogram<source_T>{}));
+
 } // namespace o2::rans
 
 #endif /* RANS_FACTORY_H_ */
\ No newline at end of file
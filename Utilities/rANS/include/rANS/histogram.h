@@ -24,6 +24,7 @@
 #include "rANS/internal/containers/AdaptiveHistogram.h"
 #include "rANS/internal/containers/SparseHistogram.h"
 #include "rANS/internal/containers/RenormedHistogram.h"
+#include "rANS/internal/containers/ConditionalHistogram.h"
 #include "rANS/internal/transform/renorm.h"
 
 #endif /* RANS_HISTOGRAM_H_ */
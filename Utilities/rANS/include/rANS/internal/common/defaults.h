@@ -31,6 +31,12 @@ enum class CoderTag : uint8_t { Compat,
                                 SSE,
                                 AVX2 };
 
+// instruction set of the interleaved decoder, Auto picks the widest one supported by the CPU at runtime
+enum class DecoderKernel : uint8_t { Auto,
+                                     Scalar,
+                                     AVX2,
+                                     AVX512 };
+
 using count_t = uint32_t;
 
 namespace defaults
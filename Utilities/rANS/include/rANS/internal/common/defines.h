@@ -39,6 +39,9 @@
 #ifdef RANS_FMA
 #error RANS_FMA cannot be directly set
 #endif
+#ifdef RANS_SIMD_DISPATCH
+#error RANS_SIMD_DISPATCH cannot be directly set
+#endif
 
 #if (defined(__x86_64__) || defined(__aarch64__))
 #define RANS_COMPAT
@@ -64,6 +67,11 @@
 #define RANS_SIMD
 #endif
 
+// kernels compiled for a given instruction set and selected at runtime, independent of the -march flags
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define RANS_SIMD_DISPATCH
+#endif
+
 #if defined(__FMA__)
 #define RANS_FMA
 #endif
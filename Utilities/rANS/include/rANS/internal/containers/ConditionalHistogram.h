@@ -0,0 +1,149 @@
+// Copyright 2019-2023 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   ConditionalHistogram.h
+/// @brief  Family of histograms, one per value of a context stream, for conditional (order-1) entropy coding
+
+#ifndef RANS_INTERNAL_CONTAINERS_CONDITIONALHISTOGRAM_H_
+#define RANS_INTERNAL_CONTAINERS_CONDITIONALHISTOGRAM_H_
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+
+#include <fairlogger/Logger.h>
+
+#include "rANS/internal/common/utils.h"
+#include "rANS/internal/common/exceptions.h"
+#include "rANS/internal/containers/DenseHistogram.h"
+#include "rANS/internal/containers/RenormedHistogram.h"
+
+namespace o2::rans
+{
+
+// The symbol at position i of the message is counted in the histogram selected by the context at position i.
+// Contexts are indices in [0, nContexts), e.g. the preceding symbol or a (binned) correlated quantity.
+template <typename source_T>
+class ConditionalHistogram
+{
+ public:
+  using source_type = source_T;
+  using histogram_type = DenseHistogram<source_type>;
+  using context_type = uint32_t;
+  using container_type = std::vector<histogram_type>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using const_iterator = typename container_type::const_iterator;
+
+  ConditionalHistogram() = default;
+  explicit ConditionalHistogram(size_type nContexts) : mHistograms(nContexts){};
+
+  template <typename source_IT, typename context_IT>
+  ConditionalHistogram& addSamples(source_IT begin, source_IT end, context_IT contextBegin);
+
+  [[nodiscard]] inline const histogram_type& operator[](context_type context) const noexcept { return mHistograms[context]; };
+
+  [[nodiscard]] inline histogram_type& operator[](context_type context) noexcept { return mHistograms[context]; };
+
+  [[nodiscard]] inline size_type getNContexts() const noexcept { return mHistograms.size(); };
+
+  [[nodiscard]] inline size_type getNumSamples() const noexcept { return mNSamples; };
+
+  [[nodiscard]] inline bool empty() const noexcept { return mNSamples == 0; };
+
+  [[nodiscard]] inline const_iterator begin() const noexcept { return mHistograms.begin(); };
+
+  [[nodiscard]] inline const_iterator end() const noexcept { return mHistograms.end(); };
+
+  [[nodiscard]] inline container_type release() && noexcept { return std::move(mHistograms); };
+
+ private:
+  container_type mHistograms{};
+  size_type mNSamples{};
+};
+
+template <typename source_T>
+template <typename source_IT, typename context_IT>
+auto ConditionalHistogram<source_T>::addSamples(source_IT begin, source_IT end, context_IT contextBegin) -> ConditionalHistogram&
+{
+  static_assert(utils::isCompatibleIter_v<source_type, source_IT>);
+
+  if (begin == end) {
+    LOG(warning) << "Passed empty message to " << __func__;
+    return *this;
+  }
+
+  // scatter the samples by context, so that each histogram is filled by its optimized bulk path
+  std::vector<std::vector<source_type>> buckets(this->getNContexts());
+  context_IT contextIter = contextBegin;
+  for (source_IT iter = begin; iter != end; ++iter, ++contextIter) {
+    const auto context = static_cast<context_type>(*contextIter);
+    if (context >= this->getNContexts()) {
+      throw HistogramError(fmt::format("context {} of sample {} exceeds the number of contexts {}", context, std::distance(begin, iter), this->getNContexts()));
+    }
+    buckets[context].push_back(*iter);
+  }
+
+  for (size_type context = 0; context < buckets.size(); ++context) {
+    const auto& bucket = buckets[context];
+    if (!bucket.empty()) {
+      mHistograms[context].addSamples(bucket.data(), bucket.data() + bucket.size());
+      mNSamples += bucket.size();
+    }
+  }
+  return *this;
+};
+
+// Renormed family of histograms. All members share the renorming precision, so that a single coder state
+// can switch between them from symbol to symbol.
+template <typename source_T>
+class RenormedConditionalHistogram
+{
+ public:
+  using source_type = source_T;
+  using histogram_type = RenormedDenseHistogram<source_type>;
+  using context_type = uint32_t;
+  using container_type = std::vector<histogram_type>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using const_iterator = typename container_type::const_iterator;
+
+  RenormedConditionalHistogram() = default;
+
+  RenormedConditionalHistogram(container_type histograms, size_t renormingBits) : mHistograms{std::move(histograms)}, mRenormingBits{renormingBits}
+  {
+    for (size_type context = 0; context < mHistograms.size(); ++context) {
+      if (!mHistograms[context].isRenormedTo(mRenormingBits)) {
+        throw HistogramError(fmt::format("histogram of context {} is renormed to {} Bits instead of {} Bits", context, mHistograms[context].getRenormingBits(), mRenormingBits));
+      }
+    }
+  };
+
+  [[nodiscard]] inline const histogram_type& operator[](context_type context) const noexcept { return mHistograms[context]; };
+
+  [[nodiscard]] inline size_type getNContexts() const noexcept { return mHistograms.size(); };
+
+  [[nodiscard]] inline size_t getRenormingBits() const noexcept { return mRenormingBits; };
+
+  [[nodiscard]] inline bool isRenormedTo(size_t nBits) const noexcept { return nBits == mRenormingBits; };
+
+  [[nodiscard]] inline const_iterator begin() const noexcept { return mHistograms.begin(); };
+
+  [[nodiscard]] inline const_iterator end() const noexcept { return mHistograms.end(); };
+
+ private:
+  container_type mHistograms{};
+  size_t mRenormingBits{};
+};
+
+} // namespace o2::rans
+
+#endif /* RANS_INTERNAL_CONTAINERS_CONDITIONALHISTOGRAM_H_ */
@@ -58,6 +58,8 @@ class HighRangeDecoderTable
 
   [[nodiscard]] inline value_type operator[](count_type cumul) const;
 
+  [[nodiscard]] inline const internal::DecoderSymbol<source_type>* data() const noexcept { return mContainer.data(); };
+
   [[nodiscard]] inline size_type getPrecision() const noexcept { return mSymbolTablePrecision; };
 
  private:
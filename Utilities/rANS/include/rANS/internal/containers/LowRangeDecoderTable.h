@@ -67,6 +67,10 @@ class LowRangeDecoderTable
 
   [[nodiscard]] inline size_type getPrecision() const noexcept { return this->mSymbolTable.getPrecision(); };
 
+  [[nodiscard]] inline const symbolTable_type& getSymbolTable() const noexcept { return mSymbolTable; };
+
+  [[nodiscard]] inline const internal::ReverseSymbolLookupTable<source_type>& getReverseLookupTable() const noexcept { return mRLUT; };
+
  private:
   symbolTable_type mSymbolTable;
   internal::ReverseSymbolLookupTable<source_type> mRLUT;
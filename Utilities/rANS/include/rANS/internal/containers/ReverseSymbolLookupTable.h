@@ -48,7 +48,7 @@ class ReverseSymbolLookupTable
       LOG(warning) << "SymbolStatistics of empty message passed to " << __func__;
     }
 
-    mLut.reserve(renormedHistogram.getNumSamples());
+    mLut.reserve(renormedHistogram.getNumSamples() + Padding);
     const auto [trimmedBegin, trimmedEnd] = internal::trim(renormedHistogram);
 
     internal::forEachIndexValue(renormedHistogram, trimmedBegin, trimmedEnd, [&](const source_type& sourceSymbol, const count_type& frequency) {
@@ -56,9 +56,12 @@ class ReverseSymbolLookupTable
         this->mLut.insert(mLut.end(), frequency, sourceSymbol);
       }
     });
+    mSize = mLut.size();
+    // trailing entries, so that the SIMD decoder can gather 32 bit words also for narrower source types
+    mLut.insert(mLut.end(), Padding, source_type{});
   };
 
-  inline size_type size() const noexcept { return mLut.size(); };
+  inline size_type size() const noexcept { return mSize; };
 
   inline bool isIncompressible(count_type cumul) const noexcept
   {
@@ -75,6 +78,10 @@ class ReverseSymbolLookupTable
   inline iterator_type end() const noexcept { return mLut.data() + size(); };
 
   container_type mLut{};
+  size_type mSize{};
+
+ private:
+  inline static constexpr size_type Padding = sizeof(uint32_t);
 };
 
 } // namespace o2::rans::internal
@@ -17,6 +17,7 @@
 #ifndef RANS_INTERNAL_CONTAINERS_SYMBOL_H_
 #define RANS_INTERNAL_CONTAINERS_SYMBOL_H_
 
+#include <array>
 #include <cassert>
 #include <cstdint>
 #include <cstring>
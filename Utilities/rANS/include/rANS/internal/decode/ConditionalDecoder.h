@@ -0,0 +1,135 @@
+// Copyright 2019-2023 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   ConditionalDecoder.h
+/// @brief  Decoder with one decoder table per context, the table of each symbol is selected by a parallel context stream
+
+#ifndef RANS_INTERNAL_DECODE_CONDITIONALDECODER_H_
+#define RANS_INTERNAL_DECODE_CONDITIONALDECODER_H_
+
+#include <vector>
+
+#include <fairlogger/Logger.h>
+
+#include "rANS/internal/common/utils.h"
+#include "rANS/internal/common/exceptions.h"
+#include "rANS/internal/containers/ConditionalHistogram.h"
+
+namespace o2::rans
+{
+
+template <class decoder_T, class symbolTable_T>
+class ConditionalDecoder
+{
+ public:
+  using symbolTable_type = symbolTable_T;
+  using symbol_type = typename symbolTable_type::symbol_type;
+  using coder_type = decoder_T;
+  using source_type = typename symbolTable_type::source_type;
+  using stream_type = typename coder_type::stream_type;
+  using context_type = uint32_t;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+ private:
+  using value_type = typename symbolTable_type::value_type;
+
+ public:
+  ConditionalDecoder() = default;
+
+  explicit ConditionalDecoder(const RenormedConditionalHistogram<source_type>& renormedHistogram) : mPrecision{renormedHistogram.getRenormingBits()}
+  {
+    mSymbolTables.reserve(renormedHistogram.getNContexts());
+    for (const auto& contextHistogram : renormedHistogram) {
+      mSymbolTables.emplace_back(contextHistogram);
+    }
+  };
+
+  [[nodiscard]] inline const symbolTable_type& getSymbolTable(context_type context) const noexcept { return mSymbolTables[context]; };
+
+  [[nodiscard]] inline size_type getNContexts() const noexcept { return mSymbolTables.size(); };
+
+  [[nodiscard]] inline size_type getSymbolTablePrecision() const noexcept { return mPrecision; };
+
+  // the contexts of the message have to be known before decoding, i.e. come from a previously decoded stream
+  template <typename stream_IT, typename source_IT, typename context_IT, typename literals_IT = std::nullptr_t, std::enable_if_t<utils::isCompatibleIter_v<typename symbolTable_T::source_type, source_IT>, bool> = true>
+  void process(stream_IT inputEnd, source_IT outputBegin, context_IT contextBegin, size_t messageLength, size_t nStreams, literals_IT literalsEnd = nullptr) const;
+
+ protected:
+  std::vector<symbolTable_type> mSymbolTables{};
+  size_type mPrecision{};
+
+  static_assert(coder_type::getNstreams() == 1, "implementation supports only single stream encoders");
+};
+
+template <class decoder_T, class symbolTable_T>
+template <typename stream_IT, typename source_IT, typename context_IT, typename literals_IT, std::enable_if_t<utils::isCompatibleIter_v<typename symbolTable_T::source_type, source_IT>, bool>>
+void ConditionalDecoder<decoder_T, symbolTable_T>::process(stream_IT inputEnd, source_IT outputBegin, context_IT contextBegin, size_t messageLength, size_t nStreams, literals_IT literalsEnd) const
+{
+  if (messageLength == 0) {
+    LOG(warning) << "Empty message passed to decoder, skipping decode process";
+    return;
+  }
+
+  if (!(nStreams > 1 && internal::isPow2(nStreams))) {
+    throw DecodingError(fmt::format("Invalid number of decoder streams {}", nStreams));
+  }
+
+  stream_IT inputIter = inputEnd;
+  --inputIter;
+  source_IT outputIter = outputBegin;
+  context_IT contextIter = contextBegin;
+  literals_IT literalsIter = literalsEnd;
+
+  auto lookupSymbol = [&literalsIter](const symbolTable_type& symbolTable, uint32_t cumulativeFrequency) -> value_type {
+    if constexpr (!std::is_null_pointer_v<literals_IT>) {
+      if (symbolTable.isEscapeSymbol(cumulativeFrequency)) {
+        return value_type{*(--literalsIter), symbolTable.getEscapeSymbol()};
+      } else {
+        return symbolTable[cumulativeFrequency];
+      }
+    } else {
+      return symbolTable[cumulativeFrequency];
+    }
+  };
+
+  auto decode = [&, this](coder_type& decoder) {
+    const auto context = static_cast<context_type>(*contextIter++);
+    if (context >= mSymbolTables.size()) {
+      throw DecodingError(fmt::format("context {} exceeds the number of contexts {}", context, mSymbolTables.size()));
+    }
+    const auto cumul = decoder.get();
+    const value_type symbol = lookupSymbol(mSymbolTables[context], cumul);
+    return std::make_tuple(symbol.first, decoder.advanceSymbol(inputIter, symbol.second));
+  };
+
+  std::vector<coder_type> decoders{nStreams, coder_type{mPrecision}};
+  for (auto& decoder : decoders) {
+    inputIter = decoder.init(inputIter);
+  }
+
+  const size_t nLoops = messageLength / nStreams;
+  const size_t nLoopRemainder = messageLength % nStreams;
+
+  for (size_t i = 0; i < nLoops; ++i) {
+    for (auto& decoder : decoders) {
+      std::tie(*outputIter++, inputIter) = decode(decoder);
+    }
+  }
+
+  for (size_t i = 0; i < nLoopRemainder; ++i) {
+    std::tie(*outputIter++, inputIter) = decode(decoders[i]);
+  }
+};
+
+} // namespace o2::rans
+
+#endif /* RANS_INTERNAL_DECODE_CONDITIONALDECODER_H_ */
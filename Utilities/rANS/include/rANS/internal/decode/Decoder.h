@@ -77,6 +77,19 @@ class Decoder
     return precision;
   };
 
+  [[nodiscard]] inline DecoderKernel getKernel() const noexcept
+  {
+    DecoderKernel kernel{};
+    std::visit([&kernel](auto&& decoder) { kernel = decoder.getKernel(); }, mImpl);
+    return kernel;
+  };
+
+  // select the instruction set used to decode, Auto by default. Kernels not supported by the CPU fall back to narrower ones
+  inline void setKernel(DecoderKernel kernel) noexcept
+  {
+    std::visit([kernel](auto&& decoder) { decoder.setKernel(kernel); }, mImpl);
+  };
+
   template <typename stream_IT, typename source_IT, typename literals_IT = std::nullptr_t>
   void process(stream_IT inputEnd, source_IT outputBegin, size_t messageLength, size_t nStreams, literals_IT literalsEnd = nullptr) const
   {
@@ -22,6 +22,7 @@
 
 #include "rANS/internal/common/utils.h"
 #include "rANS/internal/containers/RenormedHistogram.h"
+#include "rANS/internal/decode/simdDecoderKernel.h"
 
 namespace o2::rans
 {
@@ -49,6 +50,10 @@ class DecoderConcept
 
   [[nodiscard]] inline const symbolTable_type& getSymbolTable() const noexcept { return this->mSymbolTable; };
 
+  [[nodiscard]] inline DecoderKernel getKernel() const noexcept { return this->mKernel; };
+
+  inline void setKernel(DecoderKernel kernel) noexcept { this->mKernel = kernel; };
+
   template <typename stream_IT, typename source_IT, typename literals_IT = std::nullptr_t, std::enable_if_t<utils::isCompatibleIter_v<typename symbolTable_T::source_type, source_IT>, bool> = true>
   void process(stream_IT inputEnd, source_IT outputBegin, size_t messageLength, size_t nStreams, literals_IT literalsEnd = nullptr) const
   {
@@ -63,6 +68,17 @@ class DecoderConcept
         throw DecodingError(fmt::format("Invalid number of decoder streams {}", nStreams));
       }
 
+#ifndef RANS_LOG_PROCESSED_DATA
+      if constexpr (internal::simd::isSIMDDecodable_v<coder_type, symbolTable_type, stream_IT>) {
+        const DecoderKernel kernel = internal::simd::selectDecoderKernel(mKernel, nStreams);
+        if (kernel != DecoderKernel::Scalar) {
+          constexpr size_t lowerBound = internal::simd::isSIMDDecodable<coder_type, symbolTable_type>::renormingLowerBound;
+          internal::simd::decodeInterleaved<lowerBound>(kernel, this->mSymbolTable, inputEnd, outputBegin, messageLength, nStreams, literalsEnd);
+          return;
+        }
+      }
+#endif
+
       stream_IT inputIter = inputEnd;
       --inputIter;
       source_IT outputIter = outputBegin;
@@ -124,6 +140,7 @@ class DecoderConcept
 
  protected:
   symbolTable_type mSymbolTable{};
+  DecoderKernel mKernel{DecoderKernel::Auto};
 
   static_assert(coder_type::getNstreams() == 1, "implementation supports only single stream encoders");
 };
@@ -0,0 +1,401 @@
+// Copyright 2019-2023 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   simdDecoderKernel.h
+/// @brief  decodes the interleaved rANS streams several states at a time, with the instruction set selected at runtime
+
+#ifndef RANS_INTERNAL_DECODE_SIMDDECODERKERNEL_H_
+#define RANS_INTERNAL_DECODE_SIMDDECODERKERNEL_H_
+
+#include "rANS/internal/common/defines.h"
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef RANS_SIMD_DISPATCH
+#include <immintrin.h>
+#endif
+
+#include "rANS/internal/common/defaults.h"
+#include "rANS/internal/common/utils.h"
+#include "rANS/internal/containers/Symbol.h"
+#include "rANS/internal/containers/HighRangeDecoderTable.h"
+#include "rANS/internal/containers/LowRangeDecoderTable.h"
+#include "rANS/internal/decode/DecoderImpl.h"
+
+namespace o2::rans::internal::simd
+{
+
+template <class coder_T, class table_T>
+struct isSIMDDecodable : std::false_type {
+};
+
+template <size_t lowerBound_V, typename source_T>
+struct isSIMDDecodable<DecoderImpl<lowerBound_V>, HighRangeDecoderTable<source_T>> : std::bool_constant<sizeof(source_T) <= sizeof(uint32_t)> {
+  inline static constexpr size_t renormingLowerBound = lowerBound_V;
+};
+
+template <size_t lowerBound_V, typename source_T>
+struct isSIMDDecodable<DecoderImpl<lowerBound_V>, LowRangeDecoderTable<source_T>> : std::bool_constant<sizeof(source_T) <= sizeof(uint32_t)> {
+  inline static constexpr size_t renormingLowerBound = lowerBound_V;
+};
+
+// the renorming gathers the words of the stream, it has to be contiguous
+template <class coder_T, class table_T, typename stream_IT>
+inline constexpr bool isSIMDDecodable_v = isSIMDDecodable<coder_T, table_T>::value && std::contiguous_iterator<stream_IT> && std::is_same_v<std::iter_value_t<stream_IT>, uint32_t>;
+
+[[nodiscard]] inline DecoderKernel getSupportedDecoderKernel() noexcept
+{
+#ifdef RANS_SIMD_DISPATCH
+  static const DecoderKernel supported = []() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return DecoderKernel::AVX512;
+    } else if (__builtin_cpu_supports("avx2")) {
+      return DecoderKernel::AVX2;
+    }
+    return DecoderKernel::Scalar;
+  }();
+  return supported;
+#else
+  return DecoderKernel::Scalar;
+#endif
+};
+
+// number of decoder states processed by one instruction
+[[nodiscard]] inline constexpr size_t getNLanes(DecoderKernel kernel) noexcept
+{
+  switch (kernel) {
+    case DecoderKernel::AVX512:
+      return 8;
+    case DecoderKernel::AVX2:
+      return 4;
+    default:
+      return 1;
+  }
+};
+
+// narrow the requested kernel down to what the CPU supports and to what the number of interleaved streams can fill
+[[nodiscard]] inline DecoderKernel selectDecoderKernel(DecoderKernel requested, size_t nStreams) noexcept
+{
+  const DecoderKernel supported = getSupportedDecoderKernel();
+  DecoderKernel kernel = (requested == DecoderKernel::Auto || requested > supported) ? supported : requested;
+  if (kernel == DecoderKernel::AVX512 && nStreams % getNLanes(DecoderKernel::AVX512) != 0) {
+    kernel = DecoderKernel::AVX2;
+  }
+  if (kernel == DecoderKernel::AVX2 && nStreams % getNLanes(DecoderKernel::AVX2) != 0) {
+    kernel = DecoderKernel::Scalar;
+  }
+  return kernel;
+};
+
+// states of the interleaved streams with the scalar decoding step of DecoderImpl, used by the SIMD kernels
+// for the escape symbols and for the tail of the message
+template <size_t lowerBound_V, class table_T, typename literals_IT>
+struct InterleavedDecoder {
+  using table_type = table_T;
+  using source_type = typename table_type::source_type;
+  using stream_type = uint32_t;
+  using state_type = uint64_t;
+
+  inline static constexpr state_type LowerBound = utils::pow2(lowerBound_V);
+  inline static constexpr size_t StreamBits = utils::toBits<stream_type>();
+
+  InterleavedDecoder(const table_type& table, const stream_type* inputEnd, literals_IT literalsEnd, size_t nStreams)
+    : mTable{table}, mPrecision{table.getPrecision()}, mMask{utils::pow2(table.getPrecision()) - 1}, mInputIter{inputEnd}, mLiteralsIter{literalsEnd}, mStates(nStreams)
+  {
+    --mInputIter;
+    for (auto& state : mStates) {
+      state = static_cast<state_type>(*mInputIter);
+      --mInputIter;
+      state |= static_cast<state_type>(*mInputIter) << StreamBits;
+      --mInputIter;
+    }
+  };
+
+  inline std::pair<source_type, Symbol> lookup(count_t cumul)
+  {
+    if constexpr (!std::is_null_pointer_v<literals_IT>) {
+      if (mTable.isEscapeSymbol(cumul)) {
+        return {*(--mLiteralsIter), mTable.getEscapeSymbol()};
+      }
+    }
+    const auto value = mTable[cumul];
+    return {value.first, value.second};
+  };
+
+  inline source_type decode(size_t lane)
+  {
+    state_type& state = mStates[lane];
+    const auto [sourceSymbol, symbol] = lookup(state & mMask);
+    state = symbol.getFrequency() * (state >> mPrecision) + (state & mMask) - symbol.getCumulative();
+    if (state < LowerBound) {
+      state = (state << StreamBits) | *mInputIter;
+      --mInputIter;
+    }
+    return sourceSymbol;
+  };
+
+  const table_type& mTable;
+  size_t mPrecision{};
+  state_type mMask{};
+  const stream_type* mInputIter{};
+  literals_IT mLiteralsIter;
+  std::vector<state_type> mStates{};
+};
+
+template <class table_T>
+inline constexpr bool isHighRangeTable_v = std::is_same_v<table_T, HighRangeDecoderTable<typename table_T::source_type>>;
+
+// the gathers read the frequency and the cumulative frequency of a symbol as one 64 bit word
+static_assert(sizeof(Symbol) == sizeof(uint64_t));
+
+template <typename source_T>
+inline constexpr size_t getDecoderSymbolOffset() noexcept
+{
+  static_assert(sizeof(DecoderSymbol<source_T>) == sizeof(uint32_t) + sizeof(Symbol));
+  return sizeof(uint32_t);
+};
+
+#ifdef RANS_SIMD_DISPATCH
+
+// for each combination of the lanes to renorm, the 32 bit indices which move the stream word read by a lane
+// into its lower half: the k-th lane to renorm reads the k-th word backwards from the stream position, which is
+// the last one of the 4 loaded words. The upper halves take the zeroed upper part of the source register.
+inline constexpr auto RenormPermutationAVX2 = []() {
+  std::array<std::array<int32_t, 8>, 16> permutations{};
+  for (size_t mask = 0; mask < permutations.size(); ++mask) {
+    int32_t rank = 0;
+    for (size_t lane = 0; lane < 4; ++lane) {
+      permutations[mask][2 * lane] = 3 - rank;
+      permutations[mask][2 * lane + 1] = 4;
+      rank += (mask >> lane) & 0x1;
+    }
+  }
+  return permutations;
+}();
+
+template <class decoder_T, typename source_IT>
+__attribute__((target("avx2"))) void decodeAVX2(decoder_T& decoder, source_IT& outputIter, size_t nLoops)
+{
+  using source_type = typename decoder_T::source_type;
+  using table_type = typename decoder_T::table_type;
+  constexpr size_t NLanes = getNLanes(DecoderKernel::AVX2);
+  constexpr int SourceShift = utils::toBits<uint32_t>() - utils::toBits<source_type>();
+
+  const size_t nStreams = decoder.mStates.size();
+  uint64_t* const states = decoder.mStates.data();
+  const uint32_t* inputIter = decoder.mInputIter;
+
+  const __m256i mask = _mm256_set1_epi64x(decoder.mMask);
+  const __m128i precision = _mm_cvtsi32_si128(decoder.mPrecision);
+  const __m128i tableSize = _mm_set1_epi32(decoder.mTable.size());
+  const __m256i lowerBound = _mm256_set1_epi64x(decoder_T::LowerBound);
+  const __m256i lowerHalf = _mm256_set1_epi64x(0xFFFFFFFFull);
+  const __m256i packLowerHalves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+  const __m128i wordIndices = _mm_setr_epi32(0, 1, 2, 3);
+
+  alignas(16) std::array<uint32_t, NLanes> sourceSymbols{};
+
+  for (size_t i = 0; i < nLoops; ++i) {
+    for (size_t lane = 0; lane < nStreams; lane += NLanes) {
+      __m256i state = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(states + lane));
+      const __m256i stateCumul = _mm256_and_si256(state, mask);
+      const __m128i index = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(stateCumul, packLowerHalves));
+
+      if (_mm_movemask_epi8(_mm_cmplt_epi32(index, tableSize)) != 0xFFFF) {
+        // escape symbols consume the literals in the order of the streams, decode the whole group scalar
+        decoder.mInputIter = inputIter;
+        for (size_t j = lane; j < lane + NLanes; ++j) {
+          *outputIter++ = decoder.decode(j);
+        }
+        inputIter = decoder.mInputIter;
+        continue;
+      }
+
+      __m256i symbols;
+      if constexpr (isHighRangeTable_v<table_type>) {
+        const char* base = reinterpret_cast<const char*>(decoder.mTable.data());
+        const __m128i offsets = _mm_mullo_epi32(index, _mm_set1_epi32(sizeof(DecoderSymbol<source_type>)));
+        symbols = _mm256_i32gather_epi64(reinterpret_cast<const long long*>(base + getDecoderSymbolOffset<source_type>()), offsets, 1);
+        _mm_store_si128(reinterpret_cast<__m128i*>(sourceSymbols.data()), _mm_i32gather_epi32(reinterpret_cast<const int*>(base), offsets, 1));
+      } else {
+        // 32 bit words are gathered from the reverse lookup table, the source symbol is in their lower bytes
+        __m128i sourceSymbol = _mm_i32gather_epi32(reinterpret_cast<const int*>(decoder.mTable.getReverseLookupTable().begin()), index, sizeof(source_type));
+        if constexpr (SourceShift > 0) {
+          sourceSymbol = _mm_slli_epi32(sourceSymbol, SourceShift);
+          sourceSymbol = std::is_signed_v<source_type> ? _mm_srai_epi32(sourceSymbol, SourceShift) : _mm_srli_epi32(sourceSymbol, SourceShift);
+        }
+        _mm_store_si128(reinterpret_cast<__m128i*>(sourceSymbols.data()), sourceSymbol);
+        const auto& symbolTable = decoder.mTable.getSymbolTable();
+        const __m128i symbolIndex = _mm_sub_epi32(sourceSymbol, _mm_set1_epi32(static_cast<int32_t>(symbolTable.getOffset())));
+        symbols = _mm256_i32gather_epi64(reinterpret_cast<const long long*>(&*symbolTable.begin()), symbolIndex, sizeof(Symbol));
+      }
+
+      // x' = frequency * (x >> precision) + (x & mask) - cumulative, with a 32x64 bit multiplication split in two
+      const __m256i frequency = _mm256_and_si256(symbols, lowerHalf);
+      const __m256i cumulative = _mm256_srli_epi64(symbols, 32);
+      const __m256i shifted = _mm256_srl_epi64(state, precision);
+      const __m256i product = _mm256_add_epi64(_mm256_mul_epu32(frequency, shifted),
+                                               _mm256_slli_epi64(_mm256_mul_epu32(frequency, _mm256_srli_epi64(shifted, 32)), 32));
+      state = _mm256_sub_epi64(_mm256_add_epi64(product, stateCumul), cumulative);
+
+      // states are below 2^63, the signed comparison is safe. The lanes to renorm read the next words backwards
+      // from the stream in the order of the lanes. Only these words are loaded, the masked load does not touch the others.
+      const __m256i renormLanes = _mm256_cmpgt_epi64(lowerBound, state);
+      const int renorm = _mm256_movemask_pd(_mm256_castsi256_pd(renormLanes));
+      if (renorm) {
+        const int nWords = __builtin_popcount(renorm);
+        const __m128i words = _mm_maskload_epi32(reinterpret_cast<const int*>(inputIter - (NLanes - 1)), _mm_cmpgt_epi32(wordIndices, _mm_set1_epi32(NLanes - 1 - nWords)));
+        const __m256i permutation = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(RenormPermutationAVX2[renorm].data()));
+        const __m256i laneWords = _mm256_permutevar8x32_epi32(_mm256_zextsi128_si256(words), permutation);
+        state = _mm256_blendv_epi8(state, _mm256_or_si256(_mm256_slli_epi64(state, 32), laneWords), renormLanes);
+        inputIter -= nWords;
+      }
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(states + lane), state);
+
+      for (size_t j = 0; j < NLanes; ++j) {
+        *outputIter++ = static_cast<source_type>(sourceSymbols[j]);
+      }
+    }
+  }
+  decoder.mInputIter = inputIter;
+};
+
+template <class decoder_T, typename source_IT>
+__attribute__((target("avx512f"))) void decodeAVX512(decoder_T& decoder, source_IT& outputIter, size_t nLoops)
+{
+  using source_type = typename decoder_T::source_type;
+  using table_type = typename decoder_T::table_type;
+  constexpr size_t NLanes = getNLanes(DecoderKernel::AVX512);
+  constexpr int SourceShift = utils::toBits<uint32_t>() - utils::toBits<source_type>();
+
+  const size_t nStreams = decoder.mStates.size();
+  uint64_t* const states = decoder.mStates.data();
+  const uint32_t* inputIter = decoder.mInputIter;
+
+  const __m512i mask = _mm512_set1_epi64(decoder.mMask);
+  const __m128i precision = _mm_cvtsi32_si128(decoder.mPrecision);
+  const __m512i tableSize = _mm512_set1_epi64(decoder.mTable.size());
+  const __m512i lowerBound = _mm512_set1_epi64(decoder_T::LowerBound);
+  const __m512i lowerHalf = _mm512_set1_epi64(0xFFFFFFFFll);
+  const __m512i lastWord = _mm512_set1_epi64(NLanes - 1);
+  const __m512i laneRanks = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i wordIndices = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+  alignas(32) std::array<uint32_t, NLanes> sourceSymbols{};
+
+  for (size_t i = 0; i < nLoops; ++i) {
+    for (size_t lane = 0; lane < nStreams; lane += NLanes) {
+      __m512i state = _mm512_loadu_si512(states + lane);
+      const __m512i stateCumul = _mm512_and_si512(state, mask);
+
+      if (_mm512_cmplt_epu64_mask(stateCumul, tableSize) != 0xFF) {
+        // escape symbols consume the literals in the order of the streams, decode the whole group scalar
+        decoder.mInputIter = inputIter;
+        for (size_t j = lane; j < lane + NLanes; ++j) {
+          *outputIter++ = decoder.decode(j);
+        }
+        inputIter = decoder.mInputIter;
+        continue;
+      }
+
+      const __m256i index = _mm512_cvtepi64_epi32(stateCumul);
+      __m512i symbols;
+      if constexpr (isHighRangeTable_v<table_type>) {
+        const char* base = reinterpret_cast<const char*>(decoder.mTable.data());
+        const __m256i offsets = _mm256_mullo_epi32(index, _mm256_set1_epi32(sizeof(DecoderSymbol<source_type>)));
+        symbols = _mm512_i32gather_epi64(offsets, base + getDecoderSymbolOffset<source_type>(), 1);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(sourceSymbols.data()), _mm256_i32gather_epi32(reinterpret_cast<const int*>(base), offsets, 1));
+      } else {
+        // 32 bit words are gathered from the reverse lookup table, the source symbol is in their lower bytes
+        __m256i sourceSymbol = _mm256_i32gather_epi32(reinterpret_cast<const int*>(decoder.mTable.getReverseLookupTable().begin()), index, sizeof(source_type));
+        if constexpr (SourceShift > 0) {
+          sourceSymbol = _mm256_slli_epi32(sourceSymbol, SourceShift);
+          sourceSymbol = std::is_signed_v<source_type> ? _mm256_srai_epi32(sourceSymbol, SourceShift) : _mm256_srli_epi32(sourceSymbol, SourceShift);
+        }
+        _mm256_store_si256(reinterpret_cast<__m256i*>(sourceSymbols.data()), sourceSymbol);
+        const auto& symbolTable = decoder.mTable.getSymbolTable();
+        const __m256i symbolIndex = _mm256_sub_epi32(sourceSymbol, _mm256_set1_epi32(static_cast<int32_t>(symbolTable.getOffset())));
+        symbols = _mm512_i32gather_epi64(symbolIndex, &*symbolTable.begin(), sizeof(Symbol));
+      }
+
+      // x' = frequency * (x >> precision) + (x & mask) - cumulative, with a 32x64 bit multiplication split in two
+      const __m512i frequency = _mm512_and_si512(symbols, lowerHalf);
+      const __m512i cumulative = _mm512_srli_epi64(symbols, 32);
+      const __m512i shifted = _mm512_srl_epi64(state, precision);
+      const __m512i product = _mm512_add_epi64(_mm512_mul_epu32(frequency, shifted),
+                                               _mm512_slli_epi64(_mm512_mul_epu32(frequency, _mm512_srli_epi64(shifted, 32)), 32));
+      state = _mm512_sub_epi64(_mm512_add_epi64(product, stateCumul), cumulative);
+
+      // The lanes to renorm read the next words backwards from the stream in the order of the lanes. Only these words
+      // are loaded, the masked load does not touch the others. Expanding the ranks 0, 1, 2... into the lanes to renorm
+      // gives the word each of them takes.
+      const __mmask8 renorm = _mm512_cmplt_epu64_mask(state, lowerBound);
+      if (renorm) {
+        const int nWords = __builtin_popcount(renorm);
+        const __m256i words = _mm256_maskload_epi32(reinterpret_cast<const int*>(inputIter - (NLanes - 1)), _mm256_cmpgt_epi32(wordIndices, _mm256_set1_epi32(NLanes - 1 - nWords)));
+        const __m512i laneWords = _mm512_permutexvar_epi64(_mm512_sub_epi64(lastWord, _mm512_maskz_expand_epi64(renorm, laneRanks)), _mm512_cvtepu32_epi64(words));
+        state = _mm512_mask_mov_epi64(state, renorm, _mm512_or_si512(_mm512_slli_epi64(state, 32), laneWords));
+        inputIter -= nWords;
+      }
+      _mm512_storeu_si512(states + lane, state);
+
+      for (size_t j = 0; j < NLanes; ++j) {
+        *outputIter++ = static_cast<source_type>(sourceSymbols[j]);
+      }
+    }
+  }
+  decoder.mInputIter = inputIter;
+};
+
+#endif /* RANS_SIMD_DISPATCH */
+
+// decodes the message of nStreams interleaved streams in the same order as DecoderConcept::process
+template <size_t lowerBound_V, class table_T, typename stream_IT, typename source_IT, typename literals_IT>
+void decodeInterleaved(DecoderKernel kernel, const table_T& table, stream_IT inputEnd, source_IT outputBegin, size_t messageLength, size_t nStreams, literals_IT literalsEnd)
+{
+  InterleavedDecoder<lowerBound_V, table_T, literals_IT> decoder{table, std::to_address(inputEnd), literalsEnd, nStreams};
+  source_IT outputIter = outputBegin;
+
+  const size_t nLoops = messageLength / nStreams;
+  const size_t nLoopRemainder = messageLength % nStreams;
+
+  switch (kernel) {
+#ifdef RANS_SIMD_DISPATCH
+    case DecoderKernel::AVX512:
+      decodeAVX512(decoder, outputIter, nLoops);
+      break;
+    case DecoderKernel::AVX2:
+      decodeAVX2(decoder, outputIter, nLoops);
+      break;
+#endif
+    default:
+      for (size_t i = 0; i < nLoops; ++i) {
+        for (size_t lane = 0; lane < nStreams; ++lane) {
+          *outputIter++ = decoder.decode(lane);
+        }
+      }
+  }
+
+  for (size_t lane = 0; lane < nLoopRemainder; ++lane) {
+    *outputIter++ = decoder.decode(lane);
+  }
+};
+
+} // namespace o2::rans::internal::simd
+
+#endif /* RANS_INTERNAL_DECODE_SIMDDECODERKERNEL_H_ */
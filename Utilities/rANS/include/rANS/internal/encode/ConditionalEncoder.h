@@ -0,0 +1,145 @@
+// Copyright 2019-2023 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   ConditionalEncoder.h
+/// @brief  Encoder with one symbol table per context, the table of each symbol is selected by a parallel context stream
+
+#ifndef RANS_INTERNAL_ENCODE_CONDITIONALENCODER_H_
+#define RANS_INTERNAL_ENCODE_CONDITIONALENCODER_H_
+
+#include <array>
+#include <vector>
+
+#include <fairlogger/Logger.h>
+
+#include "rANS/internal/common/utils.h"
+#include "rANS/internal/common/exceptions.h"
+#include "rANS/internal/containers/ConditionalHistogram.h"
+#include "rANS/internal/encode/Encoder.h"
+
+namespace o2::rans
+{
+
+template <class encoder_T, class symbolTable_T, std::size_t nStreams_V>
+class ConditionalEncoder
+{
+ public:
+  using symbolTable_type = symbolTable_T;
+  using symbol_type = typename symbolTable_T::value_type;
+  using coder_type = encoder_T;
+  using source_type = typename symbolTable_type::source_type;
+  using stream_type = typename coder_type::stream_type;
+  using context_type = uint32_t;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  static constexpr size_type NStreams = nStreams_V;
+
+  ConditionalEncoder() = default;
+
+  ConditionalEncoder(const RenormedConditionalHistogram<source_type>& renormedHistogram) : mPrecision{renormedHistogram.getRenormingBits()}
+  {
+    const size_t encoderLowerBound = coder_type::getStreamingLowerBound();
+    if (mPrecision > encoderLowerBound) {
+      throw EncodingError(fmt::format(
+        "Renorming precision of symbol tables ({} Bits) exceeds renorming lower bound of encoder ({} Bits).\
+      This can cause overflows during encoding.",
+        mPrecision, encoderLowerBound));
+    }
+    mSymbolTables.reserve(renormedHistogram.getNContexts());
+    for (const auto& contextHistogram : renormedHistogram) {
+      mSymbolTables.emplace_back(contextHistogram);
+      mHasEscapeSymbol = mHasEscapeSymbol || mSymbolTables.back().hasEscapeSymbol();
+    }
+  };
+
+  [[nodiscard]] inline const symbolTable_type& getSymbolTable(context_type context) const noexcept { return mSymbolTables[context]; };
+
+  [[nodiscard]] inline size_type getNContexts() const noexcept { return mSymbolTables.size(); };
+
+  [[nodiscard]] inline size_type getSymbolTablePrecision() const noexcept { return mPrecision; };
+
+  [[nodiscard]] inline static constexpr size_type getNStreams() noexcept { return NStreams; };
+
+  template <typename stream_IT, typename source_IT, typename context_IT, typename literals_IT = std::nullptr_t, std::enable_if_t<utils::isCompatibleIter_v<typename symbolTable_T::source_type, source_IT>, bool> = true>
+  decltype(auto) process(source_IT inputBegin, source_IT inputEnd, context_IT contextBegin, stream_IT outputBegin, literals_IT literalsBegin = nullptr) const;
+
+ protected:
+  std::vector<symbolTable_type> mSymbolTables{};
+  size_type mPrecision{};
+  bool mHasEscapeSymbol{false};
+
+  static_assert(internal::isPow2(nStreams_V), "the number of streams must be a power of 2");
+  static_assert(coder_type::getNstreams() == 1, "implementation supports only single stream encoders");
+};
+
+template <class encoder_T, class symbolTable_T, std::size_t nStreams_V>
+template <typename stream_IT, typename source_IT, typename context_IT, typename literals_IT, std::enable_if_t<utils::isCompatibleIter_v<typename symbolTable_T::source_type, source_IT>, bool>>
+decltype(auto) ConditionalEncoder<encoder_T, symbolTable_T, nStreams_V>::process(source_IT inputBegin, source_IT inputEnd, context_IT contextBegin, stream_IT outputBegin, literals_IT literalsBegin) const
+{
+  using namespace internal;
+  using namespace utils;
+  using namespace encoderImpl;
+
+  if (inputBegin == inputEnd) {
+    LOG(warning) << "passed empty message to encoder, skip encoding";
+    return makeReturn(outputBegin, literalsBegin);
+  }
+
+  if (std::is_null_pointer_v<literals_IT> && mHasEscapeSymbol) {
+    throw HistogramError("The Symbol tables used require you to pass a literals iterator");
+  }
+
+  std::array<coder_type, NStreams> coders;
+  for (auto& coder : coders) {
+    coder = coder_type{mPrecision};
+  }
+
+  auto lookupSymbol = [&literalsBegin, this](source_type source, context_type context) -> const symbol_type& {
+    if (context >= mSymbolTables.size()) {
+      throw EncodingError(fmt::format("context {} exceeds the number of contexts {}", context, mSymbolTables.size()));
+    }
+    const auto& symbolTable = mSymbolTables[context];
+    if constexpr (!std::is_null_pointer_v<literals_IT>) {
+      const symbol_type& symbol = symbolTable[source];
+      if (symbolTable.isEscapeSymbol(symbol)) {
+        *literalsBegin++ = source;
+      }
+      return symbol;
+    } else {
+      return *symbolTable.lookupUnsafe(source);
+    }
+  };
+
+  // Same layout as the Encoder: symbol i is coded by coder i % NStreams, everything runs backwards,
+  // so that the decoder can work in forward direction and knows the context before it decodes the symbol.
+  const size_type messageLength = std::distance(inputBegin, inputEnd);
+  stream_IT outputIter = outputBegin;
+  source_IT inputIter = inputEnd;
+  context_IT contextIter = advanceIter(contextBegin, messageLength);
+
+  for (size_type i = messageLength; i-- > 0;) {
+    --inputIter;
+    --contextIter;
+    const symbol_type& symbol = lookupSymbol(*inputIter, static_cast<context_type>(*contextIter));
+    outputIter = coders[i % NStreams].putSymbols(outputIter, &symbol);
+  }
+
+  for (size_t i = coders.size(); i-- > 0;) {
+    outputIter = coders[i].flush(outputIter);
+  }
+
+  return makeReturn(outputIter, literalsBegin);
+}
+
+}; // namespace o2::rans
+
+#endif /* RANS_INTERNAL_ENCODE_CONDITIONALENCODER_H_ */
@@ -22,6 +22,7 @@
 #include "rANS/internal/containers/DenseHistogram.h"
 #include "rANS/internal/containers/AdaptiveHistogram.h"
 #include "rANS/internal/containers/SparseHistogram.h"
+#include "rANS/internal/containers/ConditionalHistogram.h"
 #include "rANS/internal/metrics/Metrics.h"
 #include "rANS/internal/common/utils.h"
 #include "rANS/internal/transform/algorithm.h"
@@ -224,6 +225,40 @@ decltype(auto) renorm(histogram_T histogram, RenormingPolicy renormingPolicy = R
   return renorm(std::move(histogram), metrics, renormingPolicy);
 };
 
+template <typename source_T>
+RenormedConditionalHistogram<source_T> renorm(ConditionalHistogram<source_T> histogram, size_t newPrecision, RenormingPolicy renormingPolicy = RenormingPolicy::Auto, size_t lowProbabilityCutoffBits = 0)
+{
+  using renormedHistogram_type = typename RenormedConditionalHistogram<source_T>::histogram_type;
+
+  std::vector<renormedHistogram_type> renormedHistograms;
+  renormedHistograms.reserve(histogram.getNContexts());
+  for (auto& contextHistogram : std::move(histogram).release()) {
+    if (contextHistogram.empty()) {
+      // context never seen: everything coded with it goes through the escape symbol
+      renormedHistograms.emplace_back(typename renormedHistogram_type::container_type{}, newPrecision, utils::pow2(newPrecision));
+    } else {
+      Metrics<source_T> metrics{contextHistogram};
+      *metrics.getCoderProperties().renormingPrecisionBits = newPrecision;
+      renormedHistograms.push_back(renormImpl::renorm(std::move(contextHistogram), metrics, renormingPolicy, lowProbabilityCutoffBits));
+    }
+  }
+  return {std::move(renormedHistograms), newPrecision};
+};
+
+template <typename source_T>
+RenormedConditionalHistogram<source_T> renorm(ConditionalHistogram<source_T> histogram, RenormingPolicy renormingPolicy = RenormingPolicy::Auto)
+{
+  // the common precision has to satisfy the most demanding context
+  size_t precision = defaults::MinRenormPrecisionBits;
+  for (const auto& contextHistogram : histogram) {
+    if (!contextHistogram.empty()) {
+      Metrics<source_T> metrics{contextHistogram};
+      precision = std::max<size_t>(precision, *metrics.getCoderProperties().renormingPrecisionBits);
+    }
+  }
+  return renorm(std::move(histogram), precision, renormingPolicy);
+};
+
 } // namespace o2::rans
 
 #endif /* RANS_INTERNAL_TRANSFORM_RENORM_H_ */
@@ -24,6 +24,8 @@
 #include <cstdint>
 #include <stdexcept>
 #include <optional>
+#include <cstring>
+#include <vector>
 
 #ifdef RANS_ENABLE_JSON
 #include <rapidjson/writer.h>
@@ -31,6 +33,7 @@
 #include "rANS/internal/common/utils.h"
 #include "rANS/internal/common/typetraits.h"
 #include "rANS/internal/containers/HistogramView.h"
+#include "rANS/internal/containers/ConditionalHistogram.h"
 #include "rANS/internal/pack/pack.h"
 #include "rANS/internal/pack/eliasDelta.h"
 #include "rANS/internal/pack/DictionaryStreamReader.h"
@@ -100,6 +103,25 @@ template <typename T>
   }
 };
 
+// index at the head of a serialized conditional dictionary, followed by one entry per context
+struct ConditionalDictionaryPreamble {
+  uint32_t nContexts{};
+  uint32_t renormingBits{};
+};
+
+template <typename source_T>
+struct ConditionalDictionaryEntry {
+  source_T min{};
+  source_T max{};
+  uint32_t size{}; // of the compressed dictionary, in words of the serialization buffer
+};
+
+template <typename buffer_T, typename source_T>
+[[nodiscard]] inline constexpr size_t getConditionalDictionaryIndexSize(size_t nContexts) noexcept
+{
+  return utils::nBytesTo<buffer_T>(sizeof(ConditionalDictionaryPreamble) + nContexts * sizeof(ConditionalDictionaryEntry<source_T>));
+};
+
 }; // namespace internal
 
 #ifdef RANS_ENABLE_JSON
@@ -239,6 +261,85 @@ RenormedSparseHistogram<source_T> readRenormedSetDictionary(buffer_IT begin, buf
   return {std::move(setContainer), renormingPrecision, dictStream.getIncompressibleSymbolFrequency()};
 };
 
+// Upper bound of the serialized size of the conditional dictionary, use it to allocate the (zero initialized) buffer
+template <typename buffer_T = uint8_t, typename source_T>
+[[nodiscard]] size_t getCompressedConditionalDictionarySize(const RenormedConditionalHistogram<source_T>& renormed)
+{
+  using namespace internal;
+
+  size_t size = getConditionalDictionaryIndexSize<buffer_T, source_T>(renormed.getNContexts());
+  for (const auto& histogram : renormed) {
+    // index and frequency per used symbol, incompressible frequency and delimiter
+    const size_t nEliasDeltaCodes = 2 * countNUsedAlphabetSymbols(histogram) + 2;
+    size += utils::nBytesTo<buffer_T>(utils::toBytes(nEliasDeltaCodes * EliasDeltaDecodeMaxBits)) + 1;
+  }
+  // the bit packer reads and writes 64 Bit words
+  return size + utils::nBytesTo<buffer_T>(sizeof(uint64_t));
+};
+
+// Layout: ConditionalDictionaryPreamble | ConditionalDictionaryEntry[nContexts] | compressed dictionary of each context.
+// Like compressRenormedDictionary, the destination buffer has to be zero initialized.
+template <typename source_T, typename dest_IT>
+dest_IT compressRenormedConditionalDictionary(const RenormedConditionalHistogram<source_T>& renormed, dest_IT dstBufferBegin)
+{
+  using namespace internal;
+  static_assert(std::is_pointer_v<dest_IT>, "only raw pointers are permited as a target for serialization");
+  using buffer_type = typename std::iterator_traits<dest_IT>::value_type;
+  using entry_type = ConditionalDictionaryEntry<source_T>;
+
+  const ConditionalDictionaryPreamble preamble{static_cast<uint32_t>(renormed.getNContexts()), static_cast<uint32_t>(renormed.getRenormingBits())};
+  std::vector<entry_type> entries;
+  entries.reserve(renormed.getNContexts());
+
+  dest_IT dstIter = dstBufferBegin + getConditionalDictionaryIndexSize<buffer_type, source_T>(renormed.getNContexts());
+  for (const auto& histogram : renormed) {
+    const auto [min, max] = getMinMax(histogram);
+    dest_IT dictEnd = compressRenormedDictionary(histogram, dstIter);
+    entries.push_back({min, max, static_cast<uint32_t>(std::distance(dstIter, dictEnd))});
+    dstIter = dictEnd;
+  }
+
+  uint8_t* indexIter = reinterpret_cast<uint8_t*>(dstBufferBegin);
+  std::memcpy(indexIter, &preamble, sizeof(preamble));
+  std::memcpy(indexIter + sizeof(preamble), entries.data(), entries.size() * sizeof(entry_type));
+  return dstIter;
+};
+
+template <typename source_T, typename buffer_IT>
+RenormedConditionalHistogram<source_T> readRenormedConditionalDictionary(buffer_IT begin, buffer_IT end)
+{
+  using namespace internal;
+  static_assert(std::is_pointer_v<buffer_IT>, "can only deserialize from raw pointers");
+  using buffer_type = typename std::iterator_traits<buffer_IT>::value_type;
+  using entry_type = ConditionalDictionaryEntry<source_T>;
+
+  const size_t bufferSize = std::distance(begin, end);
+  ConditionalDictionaryPreamble preamble{};
+  if (bufferSize < getConditionalDictionaryIndexSize<buffer_type, source_T>(0)) {
+    throw ParsingError{"failed to read conditional dictionary: buffer is too small for the preamble"};
+  }
+  const uint8_t* indexIter = reinterpret_cast<const uint8_t*>(begin);
+  std::memcpy(&preamble, indexIter, sizeof(preamble));
+  const size_t indexSize = getConditionalDictionaryIndexSize<buffer_type, source_T>(preamble.nContexts);
+  if (bufferSize < indexSize) {
+    throw ParsingError{fmt::format("failed to read conditional dictionary: buffer of {} words is too small for the index of {} contexts", bufferSize, preamble.nContexts)};
+  }
+  std::vector<entry_type> entries(preamble.nContexts);
+  std::memcpy(entries.data(), indexIter + sizeof(preamble), entries.size() * sizeof(entry_type));
+
+  typename RenormedConditionalHistogram<source_T>::container_type histograms;
+  histograms.reserve(preamble.nContexts);
+  buffer_IT dictIter = begin + indexSize;
+  for (const auto& entry : entries) {
+    if (static_cast<std::ptrdiff_t>(entry.size) > std::distance(dictIter, end) || entry.min > entry.max) {
+      throw ParsingError{fmt::format("failed to read conditional dictionary: corrupted entry of context {}", histograms.size())};
+    }
+    histograms.push_back(readRenormedDictionary(dictIter, dictIter + entry.size, entry.min, entry.max, preamble.renormingBits));
+    dictIter += entry.size;
+  }
+  return {std::move(histograms), preamble.renormingBits};
+};
+
 } // namespace o2::rans
 
 #endif /* RANS_SERIALIZE_H_ */
\ No newline at end of file
@@ -0,0 +1,209 @@
+// Copyright 2019-2023 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   test_ransConditional.cxx
+/// @brief  Test coding with symbol tables selected by a context stream
+
+#define BOOST_TEST_MODULE Utility test
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#undef NDEBUG
+#include <cassert>
+
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/mp11.hpp>
+
+#include "rANS/factory.h"
+#include "rANS/histogram.h"
+#include "rANS/serialize.h"
+
+using namespace o2::rans;
+
+using source_types = boost::mp11::mp_list<int8_t, uint8_t, int16_t, uint16_t, int32_t, uint32_t>;
+using buffer_types = boost::mp11::mp_list<uint8_t, uint16_t, uint32_t, uint64_t>;
+
+inline constexpr size_t MessageLength = (1 << 16) + 7;
+inline constexpr size_t NContexts = 16;
+
+// source correlated with the context: a narrow distribution whose center moves with the context
+template <typename source_T>
+struct ConditionalMessage {
+  explicit ConditionalMessage(size_t nUsedContexts = NContexts) : source(MessageLength), context(MessageLength)
+  {
+    std::mt19937 mt(0);
+    std::uniform_int_distribution<uint32_t> contextDist(0, nUsedContexts - 1);
+    std::binomial_distribution<int32_t> sourceDist(16, 0.5);
+    const int32_t offset = std::is_signed_v<source_T> ? -64 : 0;
+    for (size_t i = 0; i < MessageLength; ++i) {
+      context[i] = contextDist(mt);
+      source[i] = static_cast<source_T>(offset + 6 * static_cast<int32_t>(context[i]) + sourceDist(mt));
+    }
+  };
+
+  std::vector<source_T> source;
+  std::vector<uint32_t> context;
+};
+
+template <typename source_T, typename encoder_T, typename decoder_T>
+void checkRoundTrip(const ConditionalMessage<source_T>& message, const encoder_T& encoder, const decoder_T& decoder)
+{
+  std::vector<uint32_t> encodeBuffer(message.source.size() + 1024);
+  std::vector<source_T> literals(message.source.size());
+  auto [encodeBufferEnd, literalsEnd] = encoder.process(message.source.begin(), message.source.end(), message.context.begin(), encodeBuffer.begin(), literals.begin());
+
+  std::vector<source_T> decodeBuffer(message.source.size());
+  decoder.process(encodeBufferEnd, decodeBuffer.begin(), message.context.begin(), message.source.size(), encoder.getNStreams(), literalsEnd);
+  BOOST_CHECK_EQUAL_COLLECTIONS(decodeBuffer.begin(), decodeBuffer.end(), message.source.begin(), message.source.end());
+};
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(test_conditionalHistogram, source_T, source_types)
+{
+  const ConditionalMessage<source_T> message{};
+  const auto histogram = makeConditionalHistogram::fromSamples(message.source.begin(), message.source.end(), message.context.begin(), NContexts);
+  BOOST_CHECK_EQUAL(histogram.getNContexts(), NContexts);
+  BOOST_CHECK_EQUAL(histogram.getNumSamples(), MessageLength);
+
+  for (uint32_t context = 0; context < NContexts; ++context) {
+    std::vector<source_T> samples;
+    for (size_t i = 0; i < MessageLength; ++i) {
+      if (message.context[i] == context) {
+        samples.push_back(message.source[i]);
+      }
+    }
+    const auto expected = makeDenseHistogram::fromSamples(samples.begin(), samples.end());
+    BOOST_CHECK_EQUAL(histogram[context].getNumSamples(), expected.getNumSamples());
+    for (auto symbol : samples) {
+      BOOST_CHECK_EQUAL(histogram[context][symbol], expected[symbol]);
+    }
+  }
+
+  ConditionalHistogram<source_T> tooFewContexts{NContexts / 2};
+  BOOST_CHECK_THROW(tooFewContexts.addSamples(message.source.begin(), message.source.end(), message.context.begin()), HistogramError);
+};
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(test_conditionalEncodeDecode, source_T, source_types)
+{
+  // the last contexts never appear in the message and end up with an escape-only table
+  const ConditionalMessage<source_T> message{NContexts - 2};
+  const auto histogram = makeConditionalHistogram::fromSamples(message.source.begin(), message.source.end(), message.context.begin(), NContexts);
+
+  for (size_t precision : {12, 16}) {
+    BOOST_TEST_CONTEXT("precision " << precision)
+    {
+      const auto renormed = renorm(histogram, precision);
+      BOOST_CHECK_EQUAL(renormed.getNContexts(), NContexts);
+      BOOST_CHECK(renormed.isRenormedTo(precision));
+      BOOST_CHECK_EQUAL(renormed[NContexts - 1].getIncompressibleSymbolFrequency(), utils::pow2(precision));
+
+      const auto decoder = makeConditionalDecoder<>::fromRenormed(renormed);
+      checkRoundTrip(message, makeConditionalEncoder<>::fromRenormed(renormed), decoder);
+      checkRoundTrip(message, makeConditionalEncoder<4>::fromRenormed(renormed), decoder);
+      checkRoundTrip(message, makeConditionalEncoder<16>::fromRenormed(renormed), decoder);
+    }
+  }
+};
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(test_conditionalLiterals, source_T, source_types)
+{
+  // the dictionary is built from the head of the message, symbols and contexts missing from it are stored as literals
+  const ConditionalMessage<source_T> message{};
+  const auto histogram = makeConditionalHistogram::fromSamples(message.source.begin(), message.source.begin() + 256, message.context.begin(), NContexts);
+  const auto renormed = renorm(histogram, RenormingPolicy::ForceIncompressible);
+  checkRoundTrip(message, makeConditionalEncoder<>::fromRenormed(renormed), makeConditionalDecoder<>::fromRenormed(renormed));
+};
+
+BOOST_AUTO_TEST_CASE(test_conditionalCompression)
+{
+  // conditioning on a correlated stream has to beat the order-0 code of the same source
+  using source_type = uint16_t;
+  const ConditionalMessage<source_type> message{};
+
+  const auto renormed = renorm(makeConditionalHistogram::fromSamples(message.source.begin(), message.source.end(), message.context.begin(), NContexts));
+  const auto conditionalEncoder = makeConditionalEncoder<>::fromRenormed(renormed);
+  std::vector<uint32_t> conditionalBuffer(MessageLength);
+  std::vector<source_type> literals(MessageLength);
+  auto conditionalEnd = conditionalEncoder.process(message.source.begin(), message.source.end(), message.context.begin(), conditionalBuffer.begin(), literals.begin()).first;
+
+  const auto encoder = makeDenseEncoder<>::fromHistogram(makeDenseHistogram::fromSamples(message.source.begin(), message.source.end()));
+  std::vector<uint32_t> buffer(MessageLength);
+  auto end = encoder.process(message.source.begin(), message.source.end(), buffer.begin(), literals.begin()).first;
+
+  BOOST_CHECK_LT(std::distance(conditionalBuffer.begin(), conditionalEnd), std::distance(buffer.begin(), end) * 3 / 4);
+};
+
+BOOST_AUTO_TEST_CASE(test_conditionalInvalidContext)
+{
+  using source_type = int16_t;
+  const ConditionalMessage<source_type> message{};
+  const auto renormed = renorm(makeConditionalHistogram::fromSamples(message.source.begin(), message.source.end(), message.context.begin(), NContexts));
+  const auto encoder = makeConditionalEncoder<>::fromRenormed(renormed);
+  const auto decoder = makeConditionalDecoder<>::fromRenormed(renormed);
+
+  std::vector<uint32_t> encodeBuffer(MessageLength + 1024);
+  std::vector<source_type> literals(MessageLength);
+  auto [encodeBufferEnd, literalsEnd] = encoder.process(message.source.begin(), message.source.end(), message.context.begin(), encodeBuffer.begin(), literals.begin());
+
+  auto badContext = message.context;
+  badContext[MessageLength / 2] = NContexts;
+  std::vector<source_type> decodeBuffer(MessageLength);
+  BOOST_CHECK_THROW(encoder.process(message.source.begin(), message.source.end(), badContext.begin(), encodeBuffer.begin(), literals.begin()), EncodingError);
+  BOOST_CHECK_THROW(decoder.process(encodeBufferEnd, decodeBuffer.begin(), badContext.begin(), MessageLength, encoder.getNStreams(), literalsEnd), DecodingError);
+};
+
+using serialize_types = boost::mp11::mp_product<boost::mp11::mp_list, source_types, buffer_types>;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(test_conditionalSerialize, T, serialize_types)
+{
+  using source_type = boost::mp11::mp_first<T>;
+  using buffer_type = boost::mp11::mp_second<T>;
+
+  const ConditionalMessage<source_type> message{NContexts - 2};
+  const auto renormed = renorm(makeConditionalHistogram::fromSamples(message.source.begin(), message.source.end(), message.context.begin(), NContexts));
+
+  std::vector<buffer_type> serializationBuffer(getCompressedConditionalDictionarySize<buffer_type>(renormed), 0);
+  auto begin = serializationBuffer.data();
+  auto end = compressRenormedConditionalDictionary(renormed, begin);
+  BOOST_CHECK_LE(std::distance(begin, end), serializationBuffer.size());
+
+  // fill the rest of the serialization buffer with 1s to test that we are not reading bits from the buffer that comes after.
+  for (auto iter = end; iter != begin + serializationBuffer.size(); ++iter) {
+    *iter = static_cast<buffer_type>(~0);
+  }
+
+  std::vector<source_type> symbols = message.source;
+  std::sort(symbols.begin(), symbols.end());
+  symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+
+  const auto restored = readRenormedConditionalDictionary<source_type>(static_cast<const buffer_type*>(begin), static_cast<const buffer_type*>(end));
+  BOOST_CHECK_EQUAL(restored.getNContexts(), renormed.getNContexts());
+  BOOST_CHECK_EQUAL(restored.getRenormingBits(), renormed.getRenormingBits());
+  for (uint32_t context = 0; context < NContexts; ++context) {
+    BOOST_TEST_CONTEXT("context " << context)
+    {
+      BOOST_CHECK_EQUAL(restored[context].getIncompressibleSymbolFrequency(), renormed[context].getIncompressibleSymbolFrequency());
+      DenseSymbolTable<source_type, internal::Symbol> srcSymbolTable(renormed[context]);
+      DenseSymbolTable<source_type, internal::Symbol> restoredSymbolTable(restored[context]);
+      for (auto symbol : symbols) {
+        BOOST_CHECK_EQUAL(restoredSymbolTable[symbol], srcSymbolTable[symbol]);
+      }
+    }
+  }
+
+  // the dictionary the decoder reads back must be able to decode what was encoded with the original
+  checkRoundTrip(message, makeConditionalEncoder<>::fromRenormed(renormed), makeConditionalDecoder<>::fromRenormed(restored));
+
+  BOOST_CHECK_THROW(readRenormedConditionalDictionary<source_type>(begin, begin + 1), ParsingError);
+};
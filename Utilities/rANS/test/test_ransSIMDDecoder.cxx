@@ -0,0 +1,127 @@
+// Copyright 2019-2023 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   test_ransSIMDDecoder.cxx
+/// @brief  Test that the SIMD decoder kernels reproduce the scalar decoder
+
+#define BOOST_TEST_MODULE Utility test
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#undef NDEBUG
+#include <cassert>
+
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/mp11.hpp>
+
+#include <gsl/span>
+
+#include "rANS/factory.h"
+#include "rANS/histogram.h"
+
+using namespace o2::rans;
+
+using source_types = boost::mp11::mp_list<int8_t, uint8_t, int16_t, uint16_t, int32_t, uint32_t>;
+
+inline constexpr std::array<DecoderKernel, 3> Kernels{DecoderKernel::Scalar, DecoderKernel::AVX2, DecoderKernel::AVX512};
+
+// odd length, so that the remainder of the interleaved streams is decoded as well
+inline constexpr size_t MessageLength = (1 << 16) + 7;
+
+template <typename source_T>
+std::vector<source_T> makeMessage(size_t rangeBits)
+{
+  std::mt19937 mt(0);
+  std::uniform_int_distribution<int64_t> dist(0, utils::pow2(rangeBits) - 1);
+  const int64_t offset = std::is_signed_v<source_T> ? utils::pow2(rangeBits - 1) : 0; // centered around 0 for the signed types
+  std::vector<source_T> message(MessageLength);
+  std::generate(message.begin(), message.end(), [&]() { return static_cast<source_T>(dist(mt) - offset); });
+  return message;
+};
+
+template <typename source_T, typename encoder_T, typename decoder_T>
+void checkKernels(const std::vector<source_T>& message, const encoder_T& encoder, decoder_T& decoder)
+{
+  std::vector<uint32_t> encodeBuffer(message.size() + 1024);
+  std::vector<source_T> literals(message.size());
+  auto [encodeBufferEnd, literalsEnd] = encoder.process(message.begin(), message.end(), encodeBuffer.begin(), literals.begin());
+
+  for (auto kernel : Kernels) {
+    BOOST_TEST_CONTEXT("kernel " << static_cast<int>(kernel))
+    {
+      decoder.setKernel(kernel);
+      BOOST_CHECK(decoder.getKernel() == kernel);
+      std::vector<source_T> decodeBuffer(message.size());
+      decoder.process(encodeBufferEnd, decodeBuffer.begin(), message.size(), encoder.getNStreams(), literalsEnd);
+      BOOST_CHECK_EQUAL_COLLECTIONS(decodeBuffer.begin(), decodeBuffer.end(), message.begin(), message.end());
+    }
+  }
+};
+
+BOOST_AUTO_TEST_CASE(test_selectDecoderKernel)
+{
+  using namespace internal::simd;
+  const auto supported = getSupportedDecoderKernel();
+  BOOST_CHECK(selectDecoderKernel(DecoderKernel::Auto, 16) == supported);
+  BOOST_CHECK(selectDecoderKernel(DecoderKernel::Scalar, 16) == DecoderKernel::Scalar);
+  BOOST_CHECK(selectDecoderKernel(DecoderKernel::AVX512, 16) <= supported);
+  // too few streams to fill the registers
+  BOOST_CHECK(selectDecoderKernel(DecoderKernel::Auto, 2) == DecoderKernel::Scalar);
+  BOOST_CHECK(selectDecoderKernel(DecoderKernel::AVX512, 4) != DecoderKernel::AVX512);
+};
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(test_SIMDDecoder, source_T, source_types)
+{
+  // alphabets narrower than the precision use the low range decoder table, the others the high range table
+  constexpr size_t Precision = 16;
+  const size_t maxRangeBits = std::min<size_t>(utils::toBits<source_T>(), 18);
+  for (size_t rangeBits : {4ul, maxRangeBits}) {
+    BOOST_TEST_CONTEXT("rangeBits " << rangeBits)
+    {
+      const auto message = makeMessage<source_T>(rangeBits);
+      const auto histogram = makeDenseHistogram::fromSamples(message.begin(), message.end());
+      const auto renormed = renorm(histogram, Precision);
+
+      for (size_t nStreams : {4, 8, 16}) {
+        BOOST_TEST_CONTEXT("nStreams " << nStreams)
+        {
+          auto decoder = makeDecoder<>::fromRenormed(renormed);
+          switch (nStreams) {
+            case 4:
+              checkKernels(message, makeDenseEncoder<CoderTag::Compat, 4>::fromRenormed(renormed), decoder);
+              break;
+            case 8:
+              checkKernels(message, makeDenseEncoder<CoderTag::Compat, 8>::fromRenormed(renormed), decoder);
+              break;
+            default:
+              checkKernels(message, makeDenseEncoder<>::fromRenormed(renormed), decoder);
+          }
+        }
+      }
+    }
+  }
+};
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(test_SIMDDecoderLiterals, source_T, source_types)
+{
+  // the dictionary is built from the head of the message, the symbols missing from it are stored as literals
+  const size_t rangeBits = std::min<size_t>(utils::toBits<source_T>(), 12);
+  const auto message = makeMessage<source_T>(rangeBits);
+  const auto histogram = makeDenseHistogram::fromSamples(message.begin(), message.begin() + 1024);
+  const auto renormed = renorm(histogram, RenormingPolicy::ForceIncompressible);
+
+  auto decoder = makeDecoder<>::fromRenormed(renormed);
+  checkKernels(message, makeDenseEncoder<>::fromRenormed(renormed), decoder);
+};